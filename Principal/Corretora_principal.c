@@ -1,123 +1,36 @@
 // main.c - Versão 1.5 build 700
 // Consolidado: proventos -> ContaInvestimento, venda com ativo correto, acumula meses por ativo.
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-#include <locale.h>
-#include <time.h>
-
-/* ======= Config ======= */
-#define MAX_TRANSACOES 200
-#define MAX_ATIVOS 50
-#define MAX_NOME 50
-#define MAX_CPF 16
-#define MAX_SENHA 20
-
-/* ======= Tipos ======= */
-
-/* Registro de transação para extrato */
-typedef struct {
-    char tipo[32];       // "PIX", "TED", "Transferência", "Compra", "Venda", "Resgate", "Provento"
-    char descricao[80];  // descrição curta
-    float valor;         // valor (positivo = entrada, negativo = saída)
-    float taxa;          // taxa aplicada (se houver)
-    float saldoFinal;    // saldo após operação (pode ser do banco ou do caixa invest)
-    char dataHora[20];   // "dd/mm HH:MM"
-} Transacao;
-
-/* Ativo disponível na simulação */
-typedef struct {
-    char ticker[16];
-    char nome[50];
-    float preco;                 // preço unitário atual (fixo na simulação)
-    float dividend_per_period;   // dividendo por cota por pagamento
-    int periods_per_year;        // quantas vezes paga por ano (1,2,4,12)
-    bool isFII;                  // FII tem rendimento isento (sim)
-    int mesesAcumulados;         // acumula meses simulados
-} AtivoRV;
-
-/* Entrada de carteira (posse do usuário) */
-typedef struct {
-    char ticker[16];
-    int quantidade;
-    float precoMedio; // preço médio de compra
-    int mesesAcumuladosLocal; // opcional: se quiser contar por posição (não usado hoje)
-} AtivoCarteira;
-
-/* Conta de investimento: saldo em caixa + carteira + extrato próprio */
-typedef struct {
-    float saldo;                       // caixa disponível para investir / resgatar
-    AtivoCarteira carteira[MAX_ATIVOS];
-    int numAtivos;
-    Transacao extrato[MAX_TRANSACOES];
-    int numTransacoes;
-} ContaInvestimento;
-
-/* Conta do banco: saldo + extrato */
-typedef struct {
-    float saldo;
-    Transacao extrato[MAX_TRANSACOES];
-    int numTransacoes;
-} ContaBanco;
-
-/* Usuário */
-typedef struct {
-    char nome[MAX_NOME];
-    char cpf[MAX_CPF];
-    char senha[MAX_SENHA];
-    ContaBanco banco;
-    ContaInvestimento investimento;
-} Usuario;
+#include "corretora.h"
 
 /* ======= Ativos pré-definidos ======= */
-/* Valores ilustrativos — ajuste se quiser */
-AtivoRV ativosDisponiveis[] = {
-    { "SANEPAR", "Sanepar",        20.00f, 1.50f, 1,  false, 0 },
-    { "CEMIG",   "Cemig",          10.00f, 0.60f, 2,  false, 0 },
-    { "BBAS3",   "Banco do Brasil",30.00f, 0.35f, 4,  false, 0 },
-    { "ITAU",    "Itaú",           25.00f, 0.05f,12,  false, 0 },
-    { "HGLG11",  "FII HGLG11",     80.00f, 0.60f,12,  true,  0 }
+/* Valores ilustrativos — ajuste se quiser (ou forneça ARQ_CATALOGO) */
+AtivoRV ativosPadrao[] = {
+    { "SANEPAR", "Sanepar",        20.00f, 1.50f, 1,  false, 0, CLASSE_ACAO },
+    { "CEMIG",   "Cemig",          10.00f, 0.60f, 2,  false, 0, CLASSE_ACAO },
+    { "BBAS3",   "Banco do Brasil",30.00f, 0.35f, 4,  false, 0, CLASSE_ACAO },
+    { "ITAU",    "Itaú",           25.00f, 0.05f,12,  false, 0, CLASSE_ACAO },
+    { "HGLG11",  "FII HGLG11",     80.00f, 0.60f,12,  true,  0, CLASSE_FII }
 };
-const int NUM_ATIVOS = sizeof(ativosDisponiveis) / sizeof(AtivoRV);
-
-/* ======= Protótipos ======= */
-/* utilitários */
-void clear_input(void);
-void read_line(char *buf, int size);
-void timestamp_now(char *out, int size);
-
-/* extrato */
-void registrarTransacaoBanco(Usuario *u, const char *tipo, const char *desc, float valor, float taxa);
-void registrarTransacaoInvest(Usuario *u, const char *tipo, const char *desc, float valor, float taxa);
-void exibirExtratoBanco(Usuario *u);
-void exibirExtratoInvest(Usuario *u);
-
-/* cadastro/login */
-void cadastrarUsuario(Usuario *u);
-bool validarLogin(Usuario *u);
-
-/* menus */
-void menuPrincipal(Usuario *u);
-void menuContaBanco(Usuario *u);
-void menuContaInvestimento(Usuario *u);
-void submenuAtivos(Usuario *u);
-
-/* banco/transações */
-void depositarBanco(Usuario *u);
-void transferirParaInvestimento(Usuario *u);
-void transferirParaBanco(Usuario *u);
-void transferirParaBancoExterno(Usuario *u);
-
-/* renda variável */
-void listarAtivosDisponiveis(void);
-void comprarAtivoRV(Usuario *u);
-void venderAtivoRV(Usuario *u);
-void mostrarCarteira(Usuario *u);
-
-/* simulação de proventos RV (acumula meses) */
-void simularProventosRV(Usuario *u);
+
+/* catálogo em uso: o embutido ou o carregado na partida (contíguo, posições estáveis) */
+AtivoRV *ativosDisponiveis = ativosPadrao;
+const int numAtivosPadrao = sizeof(ativosPadrao) / sizeof(AtivoRV);
+int NUM_ATIVOS = sizeof(ativosPadrao) / sizeof(AtivoRV);
+
+/* índices do catálogo: posições ordenadas por ticker e por nome (busca por prefixo) */
+int *catalogoPorTicker = NULL;
+int *catalogoPorNome = NULL;
+
+/* ======= Cadastro de clientes (book) ======= */
+/* usuários alocados individualmente: ponteiros continuam válidos quando o vetor cresce */
+Usuario **usuarios = NULL;
+int numUsuarios = 0;
+int capUsuarios = 0;
+int *indiceCpf = NULL;     // ids ordenados por CPF (busca binária)
+
+/* ======= Fila de TED (liquidação em lote) ======= */
+FilaTED filaTED = { NULL, 0, 0, 0, 0 };
 
 /* ======= Implementações utilitárias ======= */
 
@@ -133,69 +46,238 @@ void read_line(char *buf, int size) {
 }
 
 void timestamp_now(char *out, int size) {
-    time_t now = time(NULL);
-    struct tm *lt = localtime(&now);
-    if (lt) strftime(out, size, "%d/%m %H:%M", lt);
-    else strncpy(out, "00/00 00:00", size);
+    timestamp_formatar(relogio_seg(), out, size);
 }
 
-/* ======= Extrato / registro de transações ======= */
+void timestamp_formatar(long long ts, char *out, int size) {
+    time_t t = (time_t)ts;
+    struct tm lt;
+#ifdef _WIN32
+    bool ok = localtime_s(&lt, &t) == 0;
+#else
+    bool ok = localtime_r(&t, &lt) != NULL;
+#endif
+    if (ok) strftime(out, size, "%d/%m %H:%M", &lt);
+    else { strncpy(out, "00/00 00:00", size - 1); out[size - 1] = '\0'; }
+}
 
-/* registra em extrato do banco */
-void registrarTransacaoBanco(Usuario *u, const char *tipo, const char *desc, float valor, float taxa) {
-    if (u->banco.numTransacoes >= MAX_TRANSACOES) return;
-    Transacao *t = &u->banco.extrato[u->banco.numTransacoes++];
-    strncpy(t->tipo, tipo, sizeof(t->tipo)-1); t->tipo[sizeof(t->tipo)-1] = '\0';
-    strncpy(t->descricao, desc, sizeof(t->descricao)-1); t->descricao[sizeof(t->descricao)-1] = '\0';
-    t->valor = valor;
-    t->taxa = taxa;
-    t->saldoFinal = u->banco.saldo;
-    timestamp_now(t->dataHora, sizeof(t->dataHora));
+/* relógio monotônico em segundos (para medir benchmarks) */
+double cronometro_seg(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, cont;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&cont);
+    return (double)cont.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
 }
 
-/* registra em extrato do investimento */
-void registrarTransacaoInvest(Usuario *u, const char *tipo, const char *desc, float valor, float taxa) {
-    if (u->investimento.numTransacoes >= MAX_TRANSACOES) return;
-    Transacao *t = &u->investimento.extrato[u->investimento.numTransacoes++];
-    strncpy(t->tipo, tipo, sizeof(t->tipo)-1); t->tipo[sizeof(t->tipo)-1] = '\0';
-    strncpy(t->descricao, desc, sizeof(t->descricao)-1); t->descricao[sizeof(t->descricao)-1] = '\0';
-    t->valor = valor;
-    t->taxa = taxa;
-    t->saldoFinal = u->investimento.saldo;
-    timestamp_now(t->dataHora, sizeof(t->dataHora));
+/* gerador congruente linear das massas sintéticas: mesma semente, mesma massa */
+unsigned aleatorio(unsigned *semente) {
+    return *semente = *semente * 1103515245u + 12345u;
 }
 
-void exibirExtratoBanco(Usuario *u) {
-    printf("\n=== EXTRATO - CONTA BANCO ===\n");
-    if (u->banco.numTransacoes == 0) {
-        printf("Nenhuma transação no banco.\n");
-    } else {
-        for (int i = 0; i < u->banco.numTransacoes; ++i) {
-            Transacao *t = &u->banco.extrato[i];
-            printf("[%s] %-12s | %-30s | Valor: R$ %8.2f | Taxa: R$ %7.2f | Saldo: R$ %8.2f\n",
-                   t->dataHora, t->tipo, t->descricao, t->valor, t->taxa, t->saldoFinal);
-        }
+/*
+ * Relógio de parede plugável: todo carimbo de data do sistema (extrato,
+ * lotes, velas, alertas, TED) sai de relogio_ns/relogio_seg. No modo real
+ * lê o relógio do sistema; no modo virtual devolve um instante fixado,
+ * que só anda quando alguém o avança (simulações, backtests, testes e
+ * benchmarks reproduzíveis, sem esperar o tempo passar). cronometro_seg
+ * continua real: mede duração, não carimba.
+ */
+static _Atomic long long relogioVirtualNs = -1;          // < 0: modo real
+
+static long long relogioSistemaNs(void) {
+#ifdef _WIN32
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft);
+    long long t = ((long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;   // 100 ns desde 1601
+    return (t - 116444736000000000LL) * 100;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/* relógio de parede em ns desde o epoch (real ou virtual) */
+long long relogio_ns(void) {
+    long long v = atomic_load_explicit(&relogioVirtualNs, memory_order_relaxed);
+    return v >= 0 ? v : relogioSistemaNs();
+}
+
+long long relogio_seg(void) {
+    return relogio_ns() / 1000000000LL;
+}
+
+bool relogioEhVirtual(void) {
+    return atomic_load_explicit(&relogioVirtualNs, memory_order_relaxed) >= 0;
+}
+
+/* passa ao modo virtual parado em 'ts' (segundos desde o epoch) */
+void relogioFixar(long long ts) {
+    atomic_store_explicit(&relogioVirtualNs, ts < 0 ? 0 : ts * 1000000000LL, memory_order_relaxed);
+}
+
+/* avança 'seg' segundos; no modo real, congela o instante atual e avança a partir dele */
+void relogioAvancar(long long seg) {
+    relogioFixar(relogio_seg() + seg);
+}
+
+void relogioReal(void) {
+    atomic_store_explicit(&relogioVirtualNs, -1, memory_order_relaxed);
+}
+
+/* ---- interface de comandos (modo lote): corretora consulta <cpf> [opções] ---- */
+
+static void ajudaComandos(void) {
+    printf("Uso: corretora [--relogio AAAA-MM-DD] <comando> ...\n"
+           "       corretora consulta <cpf> [banco|investimento] [--dias N] [--de AAAA-MM-DD]\n"
+           "                        [--ate AAAA-MM-DD] [--tipo T] [--ativo X] [--limite N]\n"
+           "                        [--cursor C] [--formato csv|jsonl]\n"
+           "       corretora consolidado <cpf> [--formato csv|jsonl]\n"
+           "       corretora relatorio-mensal [arquivo.csv]\n"
+           "       corretora bancada   (benchmarks; não grava journal nem cadastro)\n"
+           "       corretora verificar (checagens das regras em contas sintéticas)\n");
+}
+
+static int comandoConsulta(int argc, char **argv) {
+    if (argc < 2) { ajudaComandos(); return 2; }
+    Usuario *u = buscarUsuarioPorCpf(argv[1]);
+    if (!u) { fprintf(stderr, "CPF %s não cadastrado.\n", argv[1]); return 1; }
+    ConsultaExtrato q = { CONTA_BANCO, 0, LLONG_MAX, NULL, NULL, PAGINA_EXTRATO, -1 };
+    int formato = FORMATO_CSV;
+    for (int i = 2; i < argc; ++i) {
+        const char *op = argv[i], *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(op, "banco") == 0) { q.conta = CONTA_BANCO; continue; }
+        if (strcmp(op, "investimento") == 0) { q.conta = CONTA_INVEST; continue; }
+        if (!val) { ajudaComandos(); return 2; }
+        i++;
+        if (strcmp(op, "--dias") == 0) q.tsIni = relogio_seg() - atoll(val) * 86400;
+        else if (strcmp(op, "--de") == 0) q.tsIni = lerData(val);
+        else if (strcmp(op, "--ate") == 0) { long long d = lerData(val); q.tsFim = d < 0 ? -1 : d + 86399; }
+        else if (strcmp(op, "--tipo") == 0) q.tipo = val;
+        else if (strcmp(op, "--ativo") == 0) q.ativo = val;
+        else if (strcmp(op, "--limite") == 0) q.limite = atoi(val);
+        else if (strcmp(op, "--cursor") == 0) q.cursor = atoi(val);
+        else if (strcmp(op, "--formato") == 0) formato = strcmp(val, "jsonl") == 0 ? FORMATO_JSONL : FORMATO_CSV;
+        else { ajudaComandos(); return 2; }
+        if (q.tsIni < 0 || q.tsFim < 0 || q.limite <= 0) { fprintf(stderr, "Valor inválido para %s.\n", op); return 2; }
     }
-    printf("Saldo Banco: R$ %.2f\n", u->banco.saldo);
+
+    const Transacao **itens = malloc(sizeof(*itens) * (size_t)q.limite);
+    SaidaBuffer s;
+    if (!itens || !saidaAbrirFd(&s, 1)) { free(itens); return 1; }
+    int prox, n = consultarExtrato(u, &q, itens, &prox);
+    if (formato == FORMATO_CSV) cabecalhoCsv(&s);
+    for (int i = 0; i < n; ++i) exportarLancamento(&s, formato, u, q.conta, itens[i]);
+    if (formato == FORMATO_CSV) { saidaTexto(&s, "# proximo_cursor="); saidaInteiro(&s, prox); saidaCaractere(&s, '\n'); }
+    else { saidaTexto(&s, "{\"proximo_cursor\":"); saidaInteiro(&s, prox); saidaTexto(&s, "}\n"); }
+    bool ok = saidaFechar(&s);
+    free(itens);
+    return ok ? 0 : 1;
 }
 
-void exibirExtratoInvest(Usuario *u) {
-    printf("\n=== EXTRATO - CONTA INVESTIMENTO (CAIXA) ===\n");
-    if (u->investimento.numTransacoes == 0) {
-        printf("Nenhuma transação no investimento.\n");
-    } else {
-        for (int i = 0; i < u->investimento.numTransacoes; ++i) {
-            Transacao *t = &u->investimento.extrato[i];
-            printf("[%s] %-12s | %-30s | Valor: R$ %8.2f | Taxa: R$ %7.2f | Saldo: R$ %8.2f\n",
-                   t->dataHora, t->tipo, t->descricao, t->valor, t->taxa, t->saldoFinal);
-        }
+/* extrato consolidado completo em streaming, sem materializar */
+static int comandoConsolidado(int argc, char **argv) {
+    if (argc < 2) { ajudaComandos(); return 2; }
+    Usuario *u = buscarUsuarioPorCpf(argv[1]);
+    if (!u) { fprintf(stderr, "CPF %s não cadastrado.\n", argv[1]); return 1; }
+    int formato = FORMATO_CSV;
+    if (argc == 4 && strcmp(argv[2], "--formato") == 0 && strcmp(argv[3], "jsonl") == 0) formato = FORMATO_JSONL;
+    else if (argc != 2 && !(argc == 4 && strcmp(argv[2], "--formato") == 0)) { ajudaComandos(); return 2; }
+    IntercaladorExtrato it;
+    intercaladorDoUsuario(&it, u);
+    SaidaBuffer s;
+    if (!saidaAbrirFd(&s, 1)) return 1;
+    if (formato == FORMATO_CSV) cabecalhoCsv(&s);
+    const Transacao *t;
+    int conta;
+    while ((t = intercaladorProximo(&it, &conta)) != NULL) exportarLancamento(&s, formato, u, conta, t);
+    return saidaFechar(&s) ? 0 : 1;
+}
+
+/* executa um comando sem abrir os menus; retorna o código de saída do processo */
+int executarComando(int argc, char **argv) {
+    if (strcmp(argv[0], "--relogio") == 0) {                      // relógio virtual: consultas reproduzíveis
+        long long d = argc > 2 ? lerData(argv[1]) : -1;
+        if (d < 0) { ajudaComandos(); return 2; }
+        relogioFixar(d);
+        return executarComando(argc - 2, argv + 2);
     }
-    printf("Saldo caixa investimento: R$ %.2f\n", u->investimento.saldo);
+    if (strcmp(argv[0], "consulta") == 0) return comandoConsulta(argc, argv);
+    if (strcmp(argv[0], "consolidado") == 0) return comandoConsolidado(argc, argv);
+    if (strcmp(argv[0], "bancada") == 0) { menuBancada(); return 0; }
+    if (strcmp(argv[0], "verificar") == 0) return verificarFuncionalidades() == 0 ? 0 : 1;
+    if (strcmp(argv[0], "relatorio-mensal") == 0) {
+        const char *arq = argc > 1 ? argv[1] : "relatorio_mensal.csv";
+        int linhas = gerarRelatorioMensal(usuarios, numUsuarios, THREADS_RELATORIO, arq, NULL);
+        if (linhas < 0) { fprintf(stderr, "Falha ao gravar %s.\n", arq); return 1; }
+        printf("%s: %d linhas.\n", arq, linhas);
+        return 0;
+    }
+    ajudaComandos();
+    return 2;
 }
 
 /* ======= Cadastro / Login ======= */
 
-void cadastrarUsuario(Usuario *u) {
+/* busca binária no índice de CPFs */
+static int posicaoCpf(const char *cpf, bool *achou) {
+    int lo = 0, hi = numUsuarios;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int c = strcmp(usuarios[indiceCpf[mid]]->cpf, cpf);
+        if (c == 0) { *achou = true; return mid; }
+        if (c < 0) lo = mid + 1; else hi = mid;
+    }
+    *achou = false;
+    return lo;
+}
+
+Usuario *buscarUsuarioPorCpf(const char *cpf) {
+    bool achou;
+    int pos = posicaoCpf(cpf, &achou);
+    return achou ? usuarios[indiceCpf[pos]] : NULL;
+}
+
+/* aloca um usuário zerado no fim do cadastro (CPF ainda vazio, fora do índice) */
+Usuario *adicionarUsuario(void) {
+    if (numUsuarios == capUsuarios) {
+        int novaCap = capUsuarios ? capUsuarios * 2 : 16;
+        Usuario **nu = realloc(usuarios, sizeof(Usuario *) * novaCap);
+        if (!nu) return NULL;
+        usuarios = nu;
+        int *ni = realloc(indiceCpf, sizeof(int) * novaCap);
+        if (!ni) return NULL;
+        indiceCpf = ni;
+        capUsuarios = novaCap;
+    }
+    Usuario *u = calloc(1, sizeof(Usuario));
+    if (!u) return NULL;
+    u->id = numUsuarios;
+    usuarios[numUsuarios] = u;
+    return u;
+}
+
+/* insere o usuário recém-preenchido no cadastro, mantendo o índice por CPF ordenado */
+bool confirmarUsuario(Usuario *u) {
+    bool achou;
+    int pos = posicaoCpf(u->cpf, &achou);
+    if (achou) return false;
+    memmove(&indiceCpf[pos + 1], &indiceCpf[pos], sizeof(int) * (numUsuarios - pos));
+    indiceCpf[pos] = u->id;
+    numUsuarios++;
+    return true;
+}
+
+Usuario *cadastrarUsuario(void) {
+    Usuario *u = adicionarUsuario();
+    if (!u) { printf("Memória insuficiente para novo usuário.\n"); return NULL; }
+
     printf("\n=== Cadastro de Usuário ===\n");
     clear_input();
     printf("Nome: ");
@@ -207,15 +289,23 @@ void cadastrarUsuario(Usuario *u) {
 
     /* inicializa contas e histórico */
     u->banco.saldo = 0.0f;
+    u->banco.tedPendente = 0.0f;
     u->banco.numTransacoes = 0;
     u->investimento.saldo = 0.0f;
     u->investimento.numAtivos = 0;
     u->investimento.numTransacoes = 0;
 
+    if (!confirmarUsuario(u)) {
+        printf("CPF %s já cadastrado.\n", u->cpf);
+        liberarUsuario(u);
+        return NULL;
+    }
+
     printf("Usuário '%s' cadastrado com sucesso!\n", u->nome);
+    return u;
 }
 
-bool validarLogin(Usuario *u) {
+Usuario *validarLogin(void) {
     char cpf[16], senha[21];
     printf("\n=== Login ===\n");
     printf("CPF: ");
@@ -223,12 +313,13 @@ bool validarLogin(Usuario *u) {
     printf("Senha: ");
     scanf("%20s", senha);
 
-    if (strcmp(cpf, u->cpf) == 0 && strcmp(senha, u->senha) == 0) {
+    Usuario *u = buscarUsuarioPorCpf(cpf);
+    if (u && strcmp(senha, u->senha) == 0) {
         printf("Login efetuado! Bem-vindo, %s.\n", u->nome);
-        return true;
+        return u;
     } else {
         printf("CPF ou senha incorretos.\n");
-        return false;
+        return NULL;
     }
 }
 
@@ -247,7 +338,7 @@ void depositarBanco(Usuario *u) {
     if (scanf("%f", &valor) != 1 || valor <= 0.0f) { clear_input(); printf("Valor inválido.\n"); return; }
 
     if (tipo == 2) {
-        float taxa = valor * 0.01f;
+        float taxa = valor * TAXA_TED;
         u->banco.saldo += (valor - taxa);
         char desc[80]; snprintf(desc, sizeof(desc), "Depósito TED R$ %.2f", valor);
         registrarTransacaoBanco(u, "Depósito", desc, valor - taxa, taxa);
@@ -260,14 +351,21 @@ void depositarBanco(Usuario *u) {
     printf("Depósito realizado. Saldo banco: R$ %.2f\n", u->banco.saldo);
 }
 
+/* saldo que pode sair do banco agora (desconta TEDs ainda não liquidados) */
+float saldoDisponivelBanco(Usuario *u) {
+    return u->banco.saldo - u->banco.tedPendente;
+}
+
 void transferirParaInvestimento(Usuario *u) {
     float valor;
     printf("\n=== Transferência Banco -> Investimentos ===\n");
-    printf("Saldo banco: R$ %.2f\n", u->banco.saldo);
+    printf("Saldo banco: R$ %.2f", u->banco.saldo);
+    if (u->banco.tedPendente > 0.0f) printf(" (TED a liquidar: R$ %.2f)", u->banco.tedPendente);
+    printf("\n");
     printf("Digite o valor para transferir: R$ ");
     if (scanf("%f", &valor) != 1 || valor <= 0.0f) { clear_input(); printf("Valor inválido.\n"); return; }
 
-    if (valor > u->banco.saldo) { printf("Saldo insuficiente.\n"); return; }
+    if (valor > saldoDisponivelBanco(u)) { printf("Saldo insuficiente.\n"); return; }
 
     u->banco.saldo -= valor;
     u->investimento.saldo += valor;
@@ -294,29 +392,123 @@ void transferirParaBanco(Usuario *u) {
     printf("Resgate realizado. Saldo banco: R$ %.2f | saldo invest: R$ %.2f\n", u->banco.saldo, u->investimento.saldo);
 }
 
+/* PIX entre clientes: lança imediatamente nas duas pontas */
+void transferirPIX(Usuario *origem, Usuario *destino, float valor) {
+    origem->banco.saldo -= valor;
+    destino->banco.saldo += valor;
+    char desc[80];
+    snprintf(desc, sizeof(desc), "PIX enviado p/ %s R$ %.2f", destino->cpf, valor);
+    registrarTransacaoBanco(origem, "PIX", desc, -valor, 0.0f);
+    snprintf(desc, sizeof(desc), "PIX recebido de %s R$ %.2f", origem->cpf, valor);
+    registrarTransacaoBanco(destino, "PIX", desc, valor, 0.0f);
+}
+
+/* TED entre clientes: reserva o valor na origem e entra na fila do próximo lote */
+bool agendarTED(FilaTED *f, Usuario *origem, Usuario *destino, float valor) {
+    if (f->num == f->cap) {
+        int novaCap = f->cap ? f->cap * 2 : 1024;
+        TransferenciaTED *n = realloc(f->itens, sizeof(TransferenciaTED) * novaCap);
+        if (!n) return false;
+        f->itens = n; f->cap = novaCap;
+    }
+    TransferenciaTED *t = &f->itens[f->num++];
+    t->origem = origem->id;
+    t->destino = destino->id;
+    t->valor = valor;
+    t->taxa = valor * TAXA_TED;
+    origem->banco.tedPendente += valor;
+    return true;
+}
+
 void transferirParaBancoExterno(Usuario *u) {
     float valor;
-    printf("\n=== Transferência Banco -> Externo ===\n");
-    printf("Saldo banco: R$ %.2f\n", u->banco.saldo);
+    char cpf[MAX_CPF];
+    int tipo;
+    printf("\n=== Transferência Banco -> Outra Conta ===\n");
+    printf("Saldo banco: R$ %.2f", u->banco.saldo);
+    if (u->banco.tedPendente > 0.0f) printf(" (TED a liquidar: R$ %.2f)", u->banco.tedPendente);
+    printf("\n");
+    printf("CPF do destinatário (cliente da corretora) ou 0 p/ banco externo: ");
+    if (scanf("%15s", cpf) != 1) { clear_input(); printf("Entrada inválida.\n"); return; }
+
+    Usuario *destino = NULL;
+    if (strcmp(cpf, "0") != 0) {
+        destino = buscarUsuarioPorCpf(cpf);
+        if (!destino) { printf("CPF não encontrado.\n"); return; }
+        if (destino == u) { printf("Não é possível transferir para a própria conta.\n"); return; }
+        printf("Destinatário: %s\n", destino->nome);
+    }
+
+    printf("1 - PIX (imediato, sem taxa)\n");
+    printf("2 - TED (liquidação em lote, taxa de %.0f%%)\n", TAXA_TED * 100.0f);
+    printf("Escolha: ");
+    if (scanf("%d", &tipo) != 1 || (tipo != 1 && tipo != 2)) { clear_input(); printf("Entrada inválida.\n"); return; }
+
     printf("Digite o valor para transferir: R$ ");
     if (scanf("%f", &valor) != 1 || valor <= 0.0f) { clear_input(); printf("Valor inválido.\n"); return; }
 
-    if (valor > u->banco.saldo) { printf("Saldo insuficiente.\n"); return; }
-
-    u->banco.saldo -= valor;
-    char desc[80]; snprintf(desc, sizeof(desc), "Transferência Externa R$ %.2f", valor);
-    registrarTransacaoBanco(u, "Transferência Ext", desc, -valor, 0.0f);
-    printf("Transferência externa concluída. Saldo banco: R$ %.2f\n", u->banco.saldo);
+    if (valor > saldoDisponivelBanco(u)) { printf("Saldo insuficiente.\n"); return; }
+
+    if (destino == NULL) {
+        /* banco externo: o dinheiro sai da corretora */
+        float taxa = (tipo == 2) ? valor * TAXA_TED : 0.0f;
+        u->banco.saldo -= valor;
+        char desc[80]; snprintf(desc, sizeof(desc), "Transferência Externa %s R$ %.2f", tipo == 2 ? "TED" : "PIX", valor);
+        registrarTransacaoBanco(u, "Transferência Ext", desc, -valor, taxa);
+        printf("Transferência externa concluída. Saldo banco: R$ %.2f\n", u->banco.saldo);
+    } else if (tipo == 1) {
+        transferirPIX(u, destino, valor);
+        printf("PIX enviado para %s. Saldo banco: R$ %.2f\n", destino->nome, u->banco.saldo);
+    } else {
+        if (!agendarTED(&filaTED, u, destino, valor)) { printf("Falha ao agendar TED.\n"); return; }
+        /* vai ao journal: uma queda antes do lote não perde o TED (ver refazerFilaTED) */
+        long long c = paraCentavos(valor);
+        char desc[80]; snprintf(desc, sizeof(desc), "TED agendado p/ %s R$ %lld.%02lld", destino->cpf, c / 100, c % 100);
+        registrarTransacaoBanco(u, "TED agendado", desc, 0.0f, 0.0f);
+        printf("TED agendado para %s (%d na fila). Será liquidado no próximo lote.\n", destino->nome, filaTED.num);
+    }
 }
 
 /* ======= Renda Variável: listagem, compra, venda, carteira ======= */
 
+static void imprimirAtivo(int i) {
+    AtivoRV *a = &ativosDisponiveis[i];
+    printf("%2d) %s (%s) | Preço: R$ %.2f | Dividendo/p: R$ %.2f | %dx/ano | %s\n",
+           i+1, a->nome, a->ticker, a->preco, a->dividend_per_period, a->periods_per_year, nomeClasse(a->classe));
+    if (indicadores && indicadores[i].n > 0) {
+        Indicadores v;
+        indicadoresValores(&indicadores[i], &parametrosIndicadores, &v);
+        printf("    SMA%d %.2f | EMA%d %.2f | RSI%d %.1f | Bollinger [%.2f, %.2f]\n",
+               parametrosIndicadores.sma, v.sma, parametrosIndicadores.ema, v.ema,
+               parametrosIndicadores.rsi, v.rsi, v.bandaInf, v.bandaSup);
+    }
+}
+
+/* catálogo pequeno: lista tudo; grande: busca por prefixo do ticker (ou do nome) e pagina */
 void listarAtivosDisponiveis(void) {
     printf("\n=== ATIVOS DISPONÍVEIS ===\n");
-    for (int i = 0; i < NUM_ATIVOS; ++i) {
-        AtivoRV *a = &ativosDisponiveis[i];
-        printf("%2d) %s (%s) | Preço: R$ %.2f | Dividendo/p: R$ %.2f | %dx/ano | %s\n",
-               i+1, a->nome, a->ticker, a->preco, a->dividend_per_period, a->periods_per_year, a->isFII ? "FII (isento)" : "Ação");
+    if (NUM_ATIVOS <= PAGINA_CATALOGO || !catalogoPorTicker) {
+        for (int i = 0; i < NUM_ATIVOS; ++i) imprimirAtivo(i);
+        return;
+    }
+    char prefixo[50];
+    clear_input();
+    printf("%d ativos. Prefixo do ticker ou do nome (Enter = todos): ", NUM_ATIVOS);
+    read_line(prefixo, sizeof(prefixo));
+    const int *ordem = catalogoPorTicker;
+    int fim, ini = buscarPrefixoCatalogo(ativosDisponiveis, ordem, NUM_ATIVOS, false, prefixo, &fim);
+    if (ini == fim) {
+        ordem = catalogoPorNome;
+        ini = buscarPrefixoCatalogo(ativosDisponiveis, ordem, NUM_ATIVOS, true, prefixo, &fim);
+    }
+    if (ini == fim) { printf("Nenhum ativo encontrado.\n"); return; }
+    for (int k = ini; k < fim; ) {
+        for (int n = 0; n < PAGINA_CATALOGO && k < fim; ++n, ++k) imprimirAtivo(ordem[k]);
+        if (k >= fim) break;
+        int continuar;
+        printf("1 - Próxima página | 0 - Escolher: ");
+        if (scanf("%d", &continuar) != 1) { clear_input(); break; }
+        if (continuar != 1) break;
     }
 }
 
@@ -334,49 +526,40 @@ void comprarAtivoRV(Usuario *u) {
     if (scanf("%d", &quantidade) != 1 || quantidade <= 0) { clear_input(); printf("Quantidade inválida.\n"); return; }
 
     float custoTotal = a->preco * (float)quantidade;
-    if (custoTotal > u->investimento.saldo) {
-        printf("Saldo insuficiente! Caixa invest: R$ %.2f | Custo: R$ %.2f\n", u->investimento.saldo, custoTotal);
+    TaxasOperacao taxas;
+    float taxa = (float)(calcularTaxas(paraCentavos(custoTotal), 0, &taxas) / 100.0);
+    if (custoTotal + taxa > u->investimento.saldo) {
+        printf("Saldo insuficiente! Caixa invest: R$ %.2f | Custo: R$ %.2f + taxas R$ %.2f\n",
+               u->investimento.saldo, custoTotal, taxa);
         return;
     }
 
-    /* debita caixa */
-    u->investimento.saldo -= custoTotal;
+    /* debita caixa (ativos + taxas) */
+    u->investimento.saldo -= custoTotal + taxa;
 
-    /* atualiza carteira: acha por ticker */
-    bool achou = false;
-    for (int i = 0; i < u->investimento.numAtivos; ++i) {
-        if (strcmp(u->investimento.carteira[i].ticker, a->ticker) == 0) {
-            /* recalcula preço médio */
-            int oldQtd = u->investimento.carteira[i].quantidade;
-            float oldPM = u->investimento.carteira[i].precoMedio;
-            int newQtd = oldQtd + quantidade;
-            float newPM = ((oldPM * oldQtd) + (a->preco * quantidade)) / (float)newQtd;
-            u->investimento.carteira[i].quantidade = newQtd;
-            u->investimento.carteira[i].precoMedio = newPM;
-            achou = true;
-            break;
-        }
-    }
-    if (!achou) {
+    /* atualiza carteira: acha por ticker (preço médio e resultado em resultadoCompra) */
+    AtivoCarteira *pos = posicaoDoTicker(u, a->ticker);
+    if (!pos) {
         if (u->investimento.numAtivos >= MAX_ATIVOS) {
             printf("Limite carteira atingido.\n");
             /* opcional: re-credite o saldo -- aqui vamos creditar de volta */
-            u->investimento.saldo += custoTotal;
+            u->investimento.saldo += custoTotal + taxa;
             return;
         }
-        int idx = u->investimento.numAtivos++;
-        strncpy(u->investimento.carteira[idx].ticker, a->ticker, sizeof(u->investimento.carteira[idx].ticker)-1);
-        u->investimento.carteira[idx].ticker[sizeof(u->investimento.carteira[idx].ticker)-1] = '\0';
-        u->investimento.carteira[idx].quantidade = quantidade;
-        u->investimento.carteira[idx].precoMedio = a->preco;
-        u->investimento.carteira[idx].mesesAcumuladosLocal = 0;
+        pos = &u->investimento.carteira[u->investimento.numAtivos++];
+        memset(pos, 0, sizeof(*pos));
+        memcpy(pos->ticker, a->ticker, sizeof(pos->ticker));
     }
+    resultadoCompra(u, pos, quantidade, a->preco);
+    velasTick(escolha - 1, relogio_seg(), a->preco, quantidade);
 
     /* registra transação de compra no extrato de investimento */
     char desc[80]; snprintf(desc, sizeof(desc), "Compra %dx %s @ R$ %.2f", quantidade, a->ticker, a->preco);
-    registrarTransacaoInvest(u, "Compra", desc, -custoTotal, 0.0f);
+    registrarTransacaoAtivo(u, "Compra", desc, a->ticker, -custoTotal, taxa, quantidade, 0.0f);
 
     printf("Compra efetuada: %d cotas de %s | Custo: R$ %.2f\n", quantidade, a->ticker, custoTotal);
+    printf("Taxas: corretagem R$ %.2f | emolumentos R$ %.2f | liquidação R$ %.2f\n",
+           taxas.corretagem / 100.0, taxas.emolumentos / 100.0, taxas.liquidacao / 100.0);
     printf("Saldo caixa invest: R$ %.2f\n", u->investimento.saldo);
 }
 
@@ -428,8 +611,6 @@ void venderAtivoRV(Usuario *u) {
     }
 
     float valorVenda = precoAtual * (float)qtdVenda;
-    /* credita na conta de investimento (caixa) */
-    u->investimento.saldo += valorVenda;
 
     /* registra transação de venda - usa ticker/nome correto */
     char desc[120];
@@ -438,10 +619,24 @@ void venderAtivoRV(Usuario *u) {
     } else {
         snprintf(desc, sizeof(desc), "Venda %dx %s @ R$ %.2f", qtdVenda, pos->ticker, precoAtual);
     }
-    registrarTransacaoInvest(u, "Venda", desc, valorVenda, 0.0f);
+    /* atualiza posição e resultado; o lançamento leva o resultado realizado */
+    ConsumoLotes consumo;
+    float resultado = resultadoVenda(u, pos, qtdVenda, precoAtual, &consumo);
+
+    /* taxas: a parte vinda de lotes do dia paga emolumentos e liquidação de day trade */
+    TaxasOperacao taxas;
+    long long valorCent = paraCentavos(valorVenda);
+    long long dayTradeCent = qtdVenda > 0 ? valorCent * consumo.qtdDayTrade / qtdVenda : 0;
+    long long taxaCent = calcularTaxas(valorCent, dayTradeCent, &taxas);
+    if (taxaCent > valorCent) taxaCent = valorCent;
+    float taxa = (float)(taxaCent / 100.0);
+
+    /* credita na conta de investimento (caixa), líquido das taxas */
+    u->investimento.saldo += valorVenda - taxa;
+    apurarVendaUsuario(u, pos->ticker, relogio_seg(), qtdVenda, valorVenda, taxa, resultado, &consumo);
+    velasTick(ativoIdx, relogio_seg(), precoAtual, qtdVenda);
+    registrarTransacaoAtivo(u, "Venda", desc, pos->ticker, valorVenda, taxa, qtdVenda, resultado);
 
-    /* atualiza posição (após registrar o extrato) */
-    pos->quantidade -= qtdVenda;
     if (pos->quantidade == 0) {
         /* remove entry (shift) */
         for (int k = escolha - 1; k < u->investimento.numAtivos - 1; ++k) {
@@ -450,7 +645,12 @@ void venderAtivoRV(Usuario *u) {
         u->investimento.numAtivos--;
     }
 
-    printf("Venda efetuada! Recebeu R$ %.2f no caixa de investimento.\n", valorVenda);
+    printf("Venda efetuada! Recebeu R$ %.2f no caixa de investimento (resultado: R$ %.2f).\n", valorVenda - taxa, resultado);
+    printf("Taxas: corretagem R$ %.2f | emolumentos R$ %.2f | liquidação R$ %.2f\n",
+           taxas.corretagem / 100.0, taxas.emolumentos / 100.0, taxas.liquidacao / 100.0);
+    if (consumo.qtdDayTrade > 0)
+        printf("Day trade: %d cota(s) compradas hoje (custo R$ %.2f); %d de lotes anteriores (custo FIFO R$ %.2f).\n",
+               consumo.qtdDayTrade, consumo.custoDayTrade, consumo.qtdComum, consumo.custoComum);
     printf("Saldo caixa investimento: R$ %.2f\n", u->investimento.saldo);
 }
 
@@ -493,15 +693,37 @@ void mostrarCarteira(Usuario *u) {
         }
         float valorAtivo = precoAtual * (float)u->investimento.carteira[i].quantidade;
         float perc = (total > 0.0f) ? (valorAtivo / total * 100.0f) : 0.0f;
+        const AtivoCarteira *c = &u->investimento.carteira[i];
         printf("- %s (%s): %d cotas | Preço atual: R$ %.2f | Valor: R$ %.2f | %.2f%% | P. médio: R$ %.2f\n",
-               u->investimento.carteira[i].ticker,
+               c->ticker,
                nomeAtivo,
-               u->investimento.carteira[i].quantidade,
+               c->quantidade,
                precoAtual,
                valorAtivo,
                perc,
-               u->investimento.carteira[i].precoMedio);
+               c->precoMedio);
+        printf("    Resultado realizado: R$ %.2f | Não realizado: R$ %.2f | Proventos: R$ %.2f | Lotes abertos: %d\n",
+               c->resultadoRealizado, (c->precoMarcado - c->precoMedio) * (float)c->quantidade, c->proventos, c->lotes.num);
     }
+    printf("Conta: realizado R$ %.2f | não realizado R$ %.2f | proventos R$ %.2f\n",
+           u->investimento.resultadoRealizado, u->investimento.valorMercado - u->investimento.custoCarteira,
+           u->investimento.proventosRecebidos);
+    const ApuracaoIR *ir = &u->investimento.ir;
+    if (ir->mes != 0)
+        printf("IR %04d-%02d: vendas de ações R$ %.2f%s | ganhos: comum R$ %.2f, day trade R$ %.2f, FII R$ %.2f\n",
+               ir->mes / 100, ir->mes % 100, ir->vendasAcoes / 100.0,
+               ir->vendasAcoes <= LIMITE_ISENCAO_ACOES ? " (comum isento)" : "",
+               ir->ganhoComum / 100.0, ir->ganhoDayTrade / 100.0, ir->ganhoFII / 100.0);
+    RiscoCarteira risco;
+    int st = riscoUsuario(u, &risco);
+    if (st == 0 && risco.valor > 0.0)
+        printf("Risco em 1 dia (%d pregões): volatilidade R$ %.2f (%.2f%%) | VaR 95%% paramétrico R$ %.2f | histórico R$ %.2f\n",
+               risco.dias, risco.volatilidade, risco.volatilidade / risco.valor * 100.0,
+               risco.varParametrico, risco.varHistorico);
+    else if (st == -2)
+        printf("Risco: memória insuficiente para calcular a covariância.\n");
+    else if (st == -1)
+        printf("Risco: histórico de preços insuficiente (são necessários 2 fechamentos).\n");
 }
 
 /* ========== simulação de proventos RV (acumula meses) ========== */
@@ -510,13 +732,19 @@ void simularProventosRV(Usuario *u) {
     int meses;
     printf("\nQuantos meses deseja simular? ");
     if (scanf("%d", &meses) != 1 || meses <= 0) { clear_input(); printf("Entrada inválida.\n"); return; }
+    int modo;
+    printf("Proventos: 0 - em caixa | 1 - DRIP no próprio ativo | 2 - DRIP por alocação-alvo: ");
+    if (scanf("%d", &modo) != 1 || modo < DRIP_DESLIGADO || modo > DRIP_ALVO) { clear_input(); printf("Entrada inválida.\n"); return; }
+    if (modo != DRIP_DESLIGADO) { simularProventosDrip(u, meses, modo); return; }
 
     float totalRendimento = 0.0f;
     float perAssetTotals[MAX_ATIVOS] = {0.0f};
 
     printf("\n=== Simulação de Proventos (Renda Variável) por %d meses ===\n", meses);
 
-    /* Para cada ativo na carteira do usuário, acumulamos meses no ativo global correspondente. */
+    /* Para cada ativo na carteira do usuário, localiza o ativo global correspondente. */
+    AtivoRV *ativoDe[MAX_ATIVOS] = { NULL };
+    int mesesPorPagamento[MAX_ATIVOS];
     for (int iCarteira = 0; iCarteira < u->investimento.numAtivos; ++iCarteira) {
         AtivoCarteira *c = &u->investimento.carteira[iCarteira];
         if (c->quantidade <= 0) continue;
@@ -530,33 +758,47 @@ void simularProventosRV(Usuario *u) {
 
         AtivoRV *a = &ativosDisponiveis[idx];
         if (a->periods_per_year <= 0) continue;
+        ativoDe[iCarteira] = a;
+        mesesPorPagamento[iCarteira] = 12 / a->periods_per_year;
+        if (mesesPorPagamento[iCarteira] <= 0) mesesPorPagamento[iCarteira] = 12;
+    }
 
-        /* acumula meses solicitados */
-        a->mesesAcumulados += meses;
-
-        int monthsPerPay = 12 / a->periods_per_year;
-        if (monthsPerPay <= 0) monthsPerPay = 12;
-
-        /* enquanto houver mês suficiente para um pagamento, efetua provento */
-        while (a->mesesAcumulados >= monthsPerPay) {
-            float rendimento = a->dividend_per_period * (float)c->quantidade;
-
-            if (rendimento > 0.0f) {
-                /* creditamos NO CAIXA DA CONTA DE INVESTIMENTO */
-                u->investimento.saldo += rendimento;
-                totalRendimento += rendimento;
-                perAssetTotals[iCarteira] += rendimento;
+    /* mês a mês: no relógio virtual cada provento sai com a data do mês simulado,
+       e o extrato fica em ordem de data */
+    bool carimbar = relogioEhVirtual();
+    long long inicio = relogio_seg();
+    for (int m = 1; m <= meses; ++m) {
+        for (int iCarteira = 0; iCarteira < u->investimento.numAtivos; ++iCarteira) {
+            AtivoRV *a = ativoDe[iCarteira];
+            if (!a) continue;
+            AtivoCarteira *c = &u->investimento.carteira[iCarteira];
+            int monthsPerPay = mesesPorPagamento[iCarteira];
+
+            /* acumula o mês; se houver mês suficiente para um pagamento, efetua provento */
+            a->mesesAcumulados++;
+            while (a->mesesAcumulados >= monthsPerPay) {
+                float rendimento = a->dividend_per_period * (float)c->quantidade;
+
+                if (rendimento > 0.0f) {
+                    if (carimbar) relogioFixar(somarMesesTs(inicio, m));
+                    /* creditamos NO CAIXA DA CONTA DE INVESTIMENTO */
+                    u->investimento.saldo += rendimento;
+                    totalRendimento += rendimento;
+                    perAssetTotals[iCarteira] += rendimento;
+                    resultadoProvento(u, c, rendimento);
+
+                    /* registra no extrato de investimento */
+                    char descInv[100];
+                    snprintf(descInv, sizeof(descInv), "Provento %s (%d meses) R$ %.2f", a->ticker, monthsPerPay, rendimento);
+                    registrarTransacaoAtivo(u, "Provento", descInv, a->ticker, rendimento, 0.0f, c->quantidade, 0.0f);
+                }
 
-                /* registra no extrato de investimento */
-                char descInv[100];
-                snprintf(descInv, sizeof(descInv), "Provento %s (%d meses) R$ %.2f", a->ticker, monthsPerPay, rendimento);
-                registrarTransacaoInvest(u, "Provento", descInv, rendimento, 0.0f);
+                /* reduz o contador de meses do ativo global */
+                a->mesesAcumulados -= monthsPerPay;
             }
-
-            /* reduz o contador de meses do ativo global */
-            a->mesesAcumulados -= monthsPerPay;
         }
     }
+    if (carimbar) relogioFixar(somarMesesTs(inicio, meses));
 
     /* exibe resumo por ativo (somente os da carteira) */
     printf("\n--- Resumo da Simulação ---\n");
@@ -579,6 +821,8 @@ void submenuAtivos(Usuario *u) {
         printf("3 - Vender ativo\n");
         printf("4 - Mostrar carteira\n");
         printf("5 - Simular Proventos (RV)\n");
+        printf("6 - Projeção Monte Carlo (patrimônio e proventos)\n");
+        printf("7 - Backtest de estratégias (histórico)\n");
         printf("0 - Voltar\n");
         printf("Escolha: ");
         if (scanf("%d", &op) != 1) { clear_input(); printf("Entrada inválida.\n"); op = -1; }
@@ -589,6 +833,8 @@ void submenuAtivos(Usuario *u) {
             case 3: venderAtivoRV(u); break;
             case 4: mostrarCarteira(u); break;
             case 5: simularProventosRV(u); break;
+            case 6: menuMonteCarlo(u); break;
+            case 7: menuBacktest(u); break;
             case 0: break;
             default: printf("Opção inválida.\n"); break;
         }
@@ -604,7 +850,7 @@ void menuContaBanco(Usuario *u) {
         printf("Olá %s | Saldo banco: R$ %.2f\n", u->nome, u->banco.saldo);
         printf("1 - Depositar (PIX/TED)\n");
         printf("2 - Transferir para Investimentos\n");
-        printf("3 - Transferir para banco externo\n");
+        printf("3 - Transferir (PIX/TED) para cliente ou banco externo\n");
         printf("4 - Extrato (Banco)\n");
         printf("0 - Voltar\n");
         printf("Escolha: ");
@@ -648,10 +894,17 @@ void menuContaInvestimento(Usuario *u) {
 void menuPrincipal(Usuario *u) {
     int opc;
     do {
+        liquidarTEDSeVencido();
+        salvarUsuarios();
+        mostrarNotificacoes(u);
         printf("\n=== MENU PRINCIPAL ===\n");
         printf("1 - Conta do Banco\n");
         printf("2 - Conta de Investimentos\n");
-        printf("3 - Extrato completo (ambos)\n");
+        printf("3 - Extrato consolidado (banco + investimento)\n");
+        printf("4 - Exportar extrato (CSV/JSON/OFX)\n");
+        printf("5 - Consultar extrato (filtros e páginas)\n");
+        printf("6 - Saldo em uma data\n");
+        printf("7 - Watchlist e alertas de preço\n");
         printf("0 - Logout\n");
         printf("Escolha: ");
         if (scanf("%d", &opc) != 1) { clear_input(); printf("Entrada inválida.\n"); opc = -1; }
@@ -659,49 +912,264 @@ void menuPrincipal(Usuario *u) {
         switch(opc) {
             case 1: menuContaBanco(u); break;
             case 2: menuContaInvestimento(u); break;
-            case 3:
-                exibirExtratoBanco(u);
-                exibirExtratoInvest(u);
-                break;
+            case 3: exibirExtratoConsolidado(u); break;
+            case 4: menuExportarExtrato(u); break;
+            case 5: menuConsultarExtrato(u); break;
+            case 6: menuSaldoNaData(u); break;
+            case 7: menuAlertas(u); break;
             case 0: printf("Logout...\n"); break;
             default: printf("Opção inválida.\n"); break;
         }
     } while(opc != 0);
 }
 
+/* menu de operações de retaguarda (lotes e medições) */
+/* a administração exige a senha de CORRETORA_ADMIN_SENHA; sem a variável, fica fechada */
+static bool autenticarAdministrador(void) {
+    const char *esperada = getenv("CORRETORA_ADMIN_SENHA");
+    if (!esperada || !esperada[0]) { printf("Administração desabilitada: defina CORRETORA_ADMIN_SENHA.\n"); return false; }
+    char senha[64];
+    printf("Senha de administração: ");
+    if (scanf("%63s", senha) != 1) { clear_input(); return false; }
+    /* compara tudo, sem sair no primeiro byte diferente */
+    size_t n = strlen(esperada), m = strlen(senha);
+    unsigned dif = (unsigned)(n != m);
+    for (size_t i = 0; i < m; ++i) dif |= (unsigned)((unsigned char)senha[i] ^ (unsigned char)esperada[i % n]);
+    if (dif) { thread_dormir_ms(1000); printf("Senha incorreta.\n"); return false; }
+    return true;
+}
+
+/* operações sobre o livro real; os benchmarks ficam no comando 'bancada' (sem gravadores) */
+void menuAdministracao(void) {
+    int opc;
+    do {
+        printf("\n=== ADMINISTRAÇÃO ===\n");
+        printf("Clientes cadastrados: %d | TEDs na fila: %d | Segmentos arquivados: %d\n",
+               numUsuarios, filaTED.num, numSegmentos);
+        printf("1 - Liquidar lote de TED agora\n");
+        printf("2 - Selar extratos antigos no arquivo colunar\n");
+        printf("3 - Consulta analítica: soma por tipo e ano\n");
+        printf("4 - Exportar extratos de todos os usuários\n");
+        printf("5 - Saldos de todos os clientes em uma data\n");
+        printf("6 - Relatório mensal de fluxo de caixa e resultado (CSV)\n");
+        printf("7 - Atualizar preço de um ativo\n");
+        printf("8 - Fechamento mensal de IR (DARF)\n");
+        printf("9 - Cobrar custódia do dia\n");
+        printf("10 - Histórico de preços de um ativo\n");
+        printf("11 - Velas OHLCV de um ativo\n");
+        printf("12 - Períodos dos indicadores técnicos\n");
+        printf("13 - Simular calendário de eventos (todas as contas, só em ensaio)\n");
+        printf("14 - Relógio do sistema (real ou virtual)\n");
+        printf("0 - Voltar\n");
+        printf("Escolha: ");
+        if (scanf("%d", &opc) != 1) { clear_input(); printf("Entrada inválida.\n"); opc = -1; }
+
+        switch(opc) {
+            case 1: {
+                int n = liquidarLoteTED(&filaTED, usuarios);
+                filaTED.ultimaLiquidacao = (time_t)relogio_seg();
+                printf("Lote liquidado: %d participantes atualizados.\n", n);
+                break;
+            }
+            case 2: {
+                int dias;
+                if (sessaoEnsaio) { printf("Sessão de ensaio (relógio virtual): nada é selado.\n"); break; }
+                printf("Selar lançamentos com mais de quantos dias? ");
+                if (scanf("%d", &dias) != 1 || dias < 0) { clear_input(); printf("Entrada inválida.\n"); break; }
+                int n = selarExtratos(relogio_seg() - (long long)dias * 86400);
+                if (n == -2) printf("Dicionário de tipos cheio (%d): nada foi selado.\n", MAX_TIPOS_DIC);
+                else if (n < 0) printf("Falha ao gravar o segmento.\n");
+                else printf("%d lançamentos selados (%d segmentos no arquivo).\n", n, numSegmentos);
+                break;
+            }
+            case 3: consultarArquivoPorTipoAno(); break;
+            case 4: {
+                int formato = lerFormatoExportacao();
+                if (!formato) break;
+                int n = exportarTodos(formato, "extratos");
+                if (n < 0) printf("Falha na exportação.\n");
+                else printf("%d arquivo(s) gerado(s) com prefixo 'extratos'.\n", n);
+                break;
+            }
+            case 5: relatorioSaldosNaData(); break;
+            case 6: menuRelatorioMensal(); break;
+            case 7: menuAtualizarPreco(); break;
+            case 8: menuFechamentoIR(); break;
+            case 9: menuCobrarCustodia(); break;
+            case 10: menuHistoricoPrecos(); break;
+            case 11: menuVelas(); break;
+            case 12: menuParametrosIndicadores(); break;
+            case 13:
+                if (!sessaoEnsaio) { printf("A simulação lança anos de eventos nas contas: só numa sessão de ensaio (opção 14).\n"); break; }
+                menuSimularCalendario();
+                break;
+            case 14: menuRelogio(); break;
+            case 0: break;
+            default: printf("Opção inválida.\n"); break;
+        }
+    } while(opc != 0);
+}
+
+/* benchmarks: rodam no modo comando, com os dados carregados só para leitura e sem journal nem snapshot */
+void menuBancada(void) {
+    int opc;
+    do {
+        printf("\n=== BANCADA DE BENCHMARKS (nada é gravado no livro) ===\n");
+        printf("1 - Benchmark de liquidação (1M TEDs)\n");
+        printf("2 - Teste de estresse do extrato (16 produtores)\n");
+        printf("3 - Benchmark de persistência (io_uring x pwrite)\n");
+        printf("4 - Benchmark de varredura do arquivo colunar\n");
+        printf("5 - Benchmark do codec de compressão do arquivo\n");
+        printf("6 - Benchmark de exportação\n");
+        printf("7 - Benchmark de consulta paginada ao extrato\n");
+        printf("8 - Benchmark do extrato consolidado (intercalação)\n");
+        printf("9 - Benchmark de saldo por data\n");
+        printf("10 - Benchmark do relatório mensal\n");
+        printf("11 - Benchmark de resultado da carteira\n");
+        printf("12 - Benchmark de lotes FIFO\n");
+        printf("13 - Benchmark do fechamento de IR\n");
+        printf("14 - Benchmark do cálculo de taxas\n");
+        printf("15 - Benchmark do catálogo de ativos\n");
+        printf("16 - Benchmark do histórico de preços\n");
+        printf("17 - Benchmark de velas OHLCV\n");
+        printf("18 - Benchmark de indicadores técnicos\n");
+        printf("19 - Benchmark de alertas de preço\n");
+        printf("20 - Benchmark de risco (covariância e VaR)\n");
+        printf("21 - Benchmark Monte Carlo\n");
+        printf("22 - Benchmark de DRIP\n");
+        printf("23 - Benchmark do simulador de calendário\n");
+        printf("24 - Benchmark de backtest (grade de 10.000 estratégias)\n");
+        printf("0 - Sair\n");
+        printf("Escolha: ");
+        if (scanf("%d", &opc) != 1) { clear_input(); printf("Entrada inválida.\n"); opc = -1; }
+
+        switch(opc) {
+            case 1: benchmarkLiquidacaoTED(); break;
+            case 2: testeEstresseExtrato(); break;
+            case 3: benchmarkGravador(); break;
+            case 4: benchmarkVarreduraArquivo(); break;
+            case 5: benchmarkCodec(); break;
+            case 6: benchmarkExportacao(); break;
+            case 7: benchmarkConsultaExtrato(); break;
+            case 8: benchmarkIntercalacao(); break;
+            case 9: benchmarkSaldoNaData(); break;
+            case 10: benchmarkRelatorioMensal(); break;
+            case 11: benchmarkResultadoCarteira(); break;
+            case 12: benchmarkLotes(); break;
+            case 13: benchmarkFechamentoIR(); break;
+            case 14: benchmarkTaxas(); break;
+            case 15: benchmarkCatalogo(); break;
+            case 16: benchmarkHistoricoPrecos(); break;
+            case 17: benchmarkVelas(); break;
+            case 18: benchmarkIndicadores(); break;
+            case 19: benchmarkAlertas(); break;
+            case 20: benchmarkRisco(); break;
+            case 21: benchmarkMonteCarlo(); break;
+            case 22: benchmarkDrip(); break;
+            case 23: benchmarkCalendario(); break;
+            case 24: benchmarkBacktest(); break;
+            case 0: break;
+            default: printf("Opção inválida.\n"); break;
+        }
+    } while(opc != 0);
+}
+
 /* ======= Main ======= */
 
-int main(void) {
+int main(int argc, char **argv) {
     setlocale(LC_ALL, "");
-    Usuario usuario;
-    memset(&usuario, 0, sizeof(usuario)); // zera tudo
+    carregarTabelaTaxas(ARQ_TAXAS);
+    carregarCatalogo(ARQ_CATALOGO);
+    if (!criarAneisExtrato(&filaExtrato)) { printf("Memória insuficiente.\n"); return 1; }
+    /* cotações antes do cadastro: a carga marca as posições e arma os alertas no último preço */
+    carregarPrecos(ARQ_PRECOS);
+    if (!motorDoCatalogo()) printf("Aviso: memória insuficiente para os alertas de preço.\n");
+    carregarDados();
+
+    /* modo comando: só leitura, sem menus nem gravadores */
+    if (argc > 1) {
+        int r = executarComando(argc - 1, argv + 1);
+        for (int i = 0; i < numUsuarios; ++i) liberarUsuario(usuarios[i]);
+        free(usuarios);
+        free(indiceCpf);
+        free(ativosDic);
+        liberarDetentores();
+        liberarHistorico();
+        liberarSegmentosMapeados();
+        liberarVelas();
+        liberarIndicadores();
+        alertasLiberar(&motorAlertas);
+        liberarCatalogo();
+        return r;
+    }
+
+    /* journal e snapshot gravados em segundo plano; sem arquivo, segue só em memória */
+    static Gravador gravJournal;
+    bool temJournal = gravadorAbrir(&gravJournal, ARQ_JOURNAL, BACKEND_IO_URING);
+    if (temJournal && gravJournal.proxOffset == 0) {
+        CabecalhoArquivo c;
+        preencherCabecalho(&c, "JOURNAL", (int)sizeof(RegistroJournal));
+        gravadorAnexar(&gravJournal, &c, sizeof(c));
+    }
+    if (!temJournal) printf("Aviso: não foi possível abrir %s; extrato só em memória.\n", ARQ_JOURNAL);
+    if (!snapshotAbrir(&gravUsuarios, ARQ_USUARIOS))
+        printf("Aviso: não foi possível abrir %s; cadastro não será salvo.\n", ARQ_USUARIOS);
+    if (!iniciarFilaExtrato(&filaExtrato, temJournal ? &gravJournal : NULL)) { printf("Memória insuficiente.\n"); return 1; }
+    carregarSegmentos();
+    if (!abrirRegistroPrecos(ARQ_PRECOS))
+        printf("Aviso: não foi possível abrir %s; cotações só em memória.\n", ARQ_PRECOS);
 
     int opc;
     do {
+        liquidarTEDSeVencido();
+        salvarUsuarios();
         printf("\n=== Sistema Corretora ===\n");
         printf("1 - Cadastrar Usuário\n");
         printf("2 - Login\n");
+        printf("3 - Administração\n");
         printf("0 - Sair\n");
         printf("Escolha: ");
         if (scanf("%d", &opc) != 1) { clear_input(); printf("Entrada inválida.\n"); opc = -1; }
 
         switch(opc) {
             case 1:
-                cadastrarUsuario(&usuario);
+                /* o cadastro vai ao disco antes dos primeiros lançamentos (a carga precisa dele para reconciliar) */
+                if (cadastrarUsuario() && salvarUsuarios()) snapshotAguardar(&gravUsuarios, gravUsuarios.entregues);
                 break;
-            case 2:
-                if (strlen(usuario.cpf) == 0) {
+            case 2: {
+                if (numUsuarios == 0) {
                     printf("Nenhum usuário cadastrado. Cadastre primeiro.\n");
                     break;
                 }
-                if (validarLogin(&usuario)) {
-                    menuPrincipal(&usuario);
+                Usuario *u = validarLogin();
+                if (u) {
+                    menuPrincipal(u);
                 }
                 break;
+            }
+            case 3: if (autenticarAdministrador()) menuAdministracao(); break;
             case 0: printf("Encerrando...\n"); break;
             default: printf("Opção inválida.\n"); break;
         }
     } while(opc != 0);
 
+    /* fecha o lote ao sair; numa queda os agendados voltam à fila pelo journal */
+    liquidarLoteTED(&filaTED, usuarios);
+    encerrarFilaExtrato(&filaExtrato);
+    salvarUsuarios();
+    snapshotFechar(&gravUsuarios);
+    for (int i = 0; i < numUsuarios; ++i) liberarUsuario(usuarios[i]);
+    free(usuarios);
+    free(indiceCpf);
+    free(filaTED.itens);
+    fecharRegistroPrecos();
+    free(ativosDic);
+    liberarDetentores();
+    liberarHistorico();
+    liberarSegmentosMapeados();
+    liberarVelas();
+    liberarIndicadores();
+    alertasLiberar(&motorAlertas);
+    liberarCatalogo();
     return 0;
 }
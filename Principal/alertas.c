@@ -0,0 +1,434 @@
+#include "corretora.h"
+
+/* ======= Alertas de preço e watchlist ======= */
+
+/*
+ * Um tick só olha o fim dos dois lados do ativo: enquanto o último
+ * gatilho cruzou, ele sai do array e vira evento. O custo por tick é
+ * O(1 + disparos), independente de quantos alertas estão em repouso.
+ * Cancelar só marca o registro; o gatilho é descartado quando chega ao
+ * fim. Os eventos passam por uma fila em memória e são entregues às
+ * caixas dos usuários fora do caminho do tick (entregarAlertas).
+ */
+
+MotorAlertas motorAlertas;                // do catálogo (iniciado na carga)
+static bool motorAlertasPronto = false;
+
+bool alertasIniciar(MotorAlertas *m, int numAtivos) {
+    memset(m, 0, sizeof(*m));
+    m->lados = calloc((size_t)numAtivos, sizeof(*m->lados));
+    m->ultimoPreco = calloc((size_t)numAtivos, sizeof(float));
+    m->fila = calloc(1, sizeof(FilaEventosAlerta));
+    if (!m->lados || !m->ultimoPreco || !m->fila) { alertasLiberar(m); return false; }
+    m->numAtivos = numAtivos;
+    return true;
+}
+
+void alertasLiberar(MotorAlertas *m) {
+    if (m->lados)
+        for (int j = 0; j < m->numAtivos; ++j) { free(m->lados[j][0].g); free(m->lados[j][1].g); }
+    free(m->lados);
+    free(m->ultimoPreco);
+    free(m->reg);
+    free(m->fila);
+    memset(m, 0, sizeof(*m));
+}
+
+/* 'a' dispara antes de 'b' no lado? (fica mais perto do fim) */
+static inline bool gatilhoDepois(int direcao, float a, float b) {
+    return direcao == ALERTA_ABAIXO ? a > b : a < b;
+}
+
+static int compararGatilhoAbaixo(const void *a, const void *b) {
+    float x = ((const GatilhoAlerta *)a)->limite, y = ((const GatilhoAlerta *)b)->limite;
+    return (x > y) - (x < y);
+}
+
+static int compararGatilhoAcima(const void *a, const void *b) {
+    return compararGatilhoAbaixo(b, a);
+}
+
+static void alertasDisparar(MotorAlertas *m, uint32_t id, float preco, long long ts) {
+    RegistroAlerta *r = &m->reg[id];
+    if (r->estado != ALERTA_ATIVO) return;            // cancelado: só sai do array
+    r->estado = ALERTA_DISPARADO;
+    FilaEventosAlerta *f = m->fila;
+    unsigned cauda = atomic_load_explicit(&f->cauda, memory_order_relaxed);
+    if (cauda - atomic_load_explicit(&f->cabeca, memory_order_acquire) == TAM_FILA_ALERTAS) {
+        atomic_fetch_add_explicit(&f->perdidos, 1, memory_order_relaxed);
+        return;
+    }
+    EventoAlerta *ev = &f->itens[cauda & (TAM_FILA_ALERTAS - 1)];
+    ev->id = id; ev->usuario = r->usuario; ev->ativo = r->ativo;
+    ev->limite = r->limite; ev->preco = preco; ev->ts = ts; ev->direcao = r->direcao;
+    atomic_store_explicit(&f->cauda, cauda + 1, memory_order_release);
+}
+
+/*
+ * Novo alerta; se a condição já vale no último preço, dispara na hora.
+ * 'emLote' só anexa e deixa o lado para ordenar no próximo tick (carga
+ * de muitos alertas); senão entra na posição ordenada.
+ */
+uint32_t alertasRegistrar(MotorAlertas *m, int usuario, int ativo, int direcao, float limite, bool emLote) {
+    if (ativo < 0 || ativo >= m->numAtivos) return UINT32_MAX;
+    if (m->num == m->cap) {
+        uint32_t novaCap = m->cap ? m->cap * 2 : 1024;
+        RegistroAlerta *n = realloc(m->reg, sizeof(RegistroAlerta) * novaCap);
+        if (!n) return UINT32_MAX;
+        m->reg = n; m->cap = novaCap;
+    }
+    uint32_t id = m->num++;
+    m->reg[id] = (RegistroAlerta){ usuario, ativo, limite, (unsigned char)direcao, ALERTA_ATIVO };
+    float atual = m->ultimoPreco[ativo];
+    if (atual > 0.0f && (direcao == ALERTA_ABAIXO ? atual < limite : atual > limite)) {
+        alertasDisparar(m, id, atual, relogio_seg());
+        return id;
+    }
+    LadoAlertas *l = &m->lados[ativo][direcao];
+    if (l->num == l->cap) {
+        int novaCap = l->cap ? l->cap * 2 : 8;
+        GatilhoAlerta *g = realloc(l->g, sizeof(GatilhoAlerta) * (size_t)novaCap);
+        if (!g) { m->reg[id].estado = ALERTA_CANCELADO; return UINT32_MAX; }
+        l->g = g; l->cap = novaCap;
+    }
+    int pos = l->num;
+    if (emLote) {
+        l->desordenado = true;
+    } else if (!l->desordenado) {
+        int lo = 0, hi = l->num;                      // depois dos que disparam antes dele
+        while (lo < hi) {
+            int meio = (lo + hi) / 2;
+            if (gatilhoDepois(direcao, limite, l->g[meio].limite)) lo = meio + 1; else hi = meio;
+        }
+        pos = lo;
+        memmove(&l->g[pos + 1], &l->g[pos], sizeof(GatilhoAlerta) * (size_t)(l->num - pos));
+    }
+    l->g[pos] = (GatilhoAlerta){ limite, id };
+    l->num++;
+    return id;
+}
+
+bool alertasCancelar(MotorAlertas *m, uint32_t id) {
+    if (id >= m->num || m->reg[id].estado != ALERTA_ATIVO) return false;
+    m->reg[id].estado = ALERTA_CANCELADO;
+    return true;
+}
+
+/* novo preço de um ativo: dispara os alertas cruzados; retorna quantos saíram dos arrays */
+int alertasPreco(MotorAlertas *m, int ativo, float preco, long long ts) {
+    if (ativo < 0 || ativo >= m->numAtivos) return 0;
+    m->ultimoPreco[ativo] = preco;
+    int saidos = 0;
+    for (int dir = 0; dir < 2; ++dir) {
+        LadoAlertas *l = &m->lados[ativo][dir];
+        if (l->desordenado) {
+            qsort(l->g, (size_t)l->num, sizeof(GatilhoAlerta), dir == ALERTA_ABAIXO ? compararGatilhoAbaixo : compararGatilhoAcima);
+            l->desordenado = false;
+        }
+        if (dir == ALERTA_ABAIXO)
+            while (l->num > 0 && preco < l->g[l->num - 1].limite) { alertasDisparar(m, l->g[--l->num].id, preco, ts); saidos++; }
+        else
+            while (l->num > 0 && preco > l->g[l->num - 1].limite) { alertasDisparar(m, l->g[--l->num].id, preco, ts); saidos++; }
+    }
+    return saidos;
+}
+
+bool alertasRetirar(MotorAlertas *m, EventoAlerta *ev) {
+    FilaEventosAlerta *f = m->fila;
+    unsigned cabeca = atomic_load_explicit(&f->cabeca, memory_order_relaxed);
+    if (cabeca == atomic_load_explicit(&f->cauda, memory_order_acquire)) return false;
+    *ev = f->itens[cabeca & (TAM_FILA_ALERTAS - 1)];
+    atomic_store_explicit(&f->cabeca, cabeca + 1, memory_order_release);
+    return true;
+}
+
+/* motor do catálogo, iniciado no main antes da carga com os preços já relidos */
+bool motorDoCatalogo(void) {
+    if (motorAlertasPronto) return true;
+    if (!alertasIniciar(&motorAlertas, NUM_ATIVOS)) return false;
+    for (int j = 0; j < NUM_ATIVOS; ++j) motorAlertas.ultimoPreco[j] = ativosDisponiveis[j].preco;
+    return motorAlertasPronto = true;
+}
+
+void alertasPrecoCatalogo(int idx, float preco, long long ts) {
+    if (motorAlertasPronto) alertasPreco(&motorAlertas, idx, preco, ts);
+}
+
+static AlertasUsuario *alertasDoUsuario(Usuario *u) {
+    if (!u->alertas) u->alertas = calloc(1, sizeof(AlertasUsuario));
+    return u->alertas;
+}
+
+static bool anexarIdAlerta(AlertasUsuario *a, uint32_t id) {
+    if (a->numIds == a->capIds) {
+        int novaCap = a->capIds ? a->capIds * 2 : 8;
+        uint32_t *n = realloc(a->ids, sizeof(uint32_t) * (size_t)novaCap);
+        if (!n) return false;
+        a->ids = n; a->capIds = novaCap;
+    }
+    a->ids[a->numIds++] = id;
+    return true;
+}
+
+/*
+ * Watchlists e alertas ainda ativos, como itens do snapshot (out NULL só
+ * conta). Disparados e cancelados não voltam; tickers em vez de índices,
+ * porque o catálogo pode mudar entre execuções.
+ */
+int alertasParaSalvar(ItemAlertaSalvo *out) {
+    int n = 0;
+    for (int i = 0; i < numUsuarios; ++i) {
+        const Usuario *u = usuarios[i];
+        const AlertasUsuario *a = u->alertas;
+        if (!a) continue;
+        for (int k = 0; k < a->numWatchlist; ++k, ++n) {
+            if (!out) continue;
+            memset(&out[n], 0, sizeof(out[n]));
+            memcpy(out[n].cpf, u->cpf, sizeof(out[n].cpf));
+            memcpy(out[n].ticker, ativosDisponiveis[a->watchlist[k]].ticker, sizeof(out[n].ticker));
+            out[n].tipo = ITEM_WATCHLIST;
+        }
+        for (int k = 0; motorAlertasPronto && k < a->numIds; ++k) {
+            const RegistroAlerta *r = &motorAlertas.reg[a->ids[k]];
+            if (r->estado != ALERTA_ATIVO) continue;
+            if (out) {
+                memset(&out[n], 0, sizeof(out[n]));
+                memcpy(out[n].cpf, u->cpf, sizeof(out[n].cpf));
+                memcpy(out[n].ticker, ativosDisponiveis[r->ativo].ticker, sizeof(out[n].ticker));
+                out[n].limite = r->limite;
+                out[n].tipo = r->direcao == ALERTA_ABAIXO ? ITEM_ALERTA_ABAIXO : ITEM_ALERTA_ACIMA;
+            }
+            n++;
+        }
+    }
+    return n;
+}
+
+/* recoloca os itens do snapshot; usuário ou ticker que sumiu é ignorado */
+void restaurarAlertas(const ItemAlertaSalvo *itens, int n) {
+    for (int i = 0; i < n; ++i) {
+        const ItemAlertaSalvo *it = &itens[i];
+        char cpf[MAX_CPF], ticker[16];
+        snprintf(cpf, sizeof(cpf), "%.*s", (int)sizeof(it->cpf) - 1, it->cpf);
+        snprintf(ticker, sizeof(ticker), "%.*s", (int)sizeof(it->ticker) - 1, it->ticker);
+        Usuario *u = buscarUsuarioPorCpf(cpf);
+        int j = indiceCatalogo(ticker);
+        AlertasUsuario *a;
+        if (!u || j < 0 || !(a = alertasDoUsuario(u))) continue;
+        if (it->tipo == ITEM_WATCHLIST) {
+            bool repetido = false;
+            for (int k = 0; k < a->numWatchlist; ++k) repetido |= a->watchlist[k] == j;
+            if (!repetido && a->numWatchlist < MAX_WATCHLIST) a->watchlist[a->numWatchlist++] = j;
+        } else if ((it->tipo == ITEM_ALERTA_ABAIXO || it->tipo == ITEM_ALERTA_ACIMA) && motorDoCatalogo()) {
+            uint32_t id = alertasRegistrar(&motorAlertas, u->id, j, it->tipo == ITEM_ALERTA_ABAIXO ? ALERTA_ABAIXO : ALERTA_ACIMA,
+                                           it->limite, true);
+            if (id != UINT32_MAX && !anexarIdAlerta(a, id)) alertasCancelar(&motorAlertas, id);
+        }
+    }
+}
+
+/* esvazia a fila de eventos nas caixas dos usuários */
+void entregarAlertas(void) {
+    if (!motorAlertasPronto) return;
+    EventoAlerta ev;
+    while (alertasRetirar(&motorAlertas, &ev)) {
+        if (ev.usuario < 0 || ev.usuario >= numUsuarios) continue;
+        AlertasUsuario *a = alertasDoUsuario(usuarios[ev.usuario]);
+        if (!a) continue;
+        if (a->numCaixa == a->capCaixa) {
+            int novaCap = a->capCaixa ? a->capCaixa * 2 : 8;
+            EventoAlerta *c = realloc(a->caixa, sizeof(EventoAlerta) * (size_t)novaCap);
+            if (!c) continue;
+            a->caixa = c; a->capCaixa = novaCap;
+        }
+        a->caixa[a->numCaixa++] = ev;
+    }
+}
+
+void mostrarNotificacoes(Usuario *u) {
+    entregarAlertas();
+    if (!u->alertas || u->alertas->numCaixa == 0) return;
+    AlertasUsuario *a = u->alertas;
+    printf("\n*** %d alerta(s) de preço ***\n", a->numCaixa);
+    for (int i = 0; i < a->numCaixa; ++i) {
+        const EventoAlerta *ev = &a->caixa[i];
+        printf("  %s %s R$ %.2f (preço: R$ %.2f)\n", ativosDisponiveis[ev->ativo].ticker,
+               ev->direcao == ALERTA_ABAIXO ? "abaixo de" : "acima de", ev->limite, ev->preco);
+    }
+    a->numCaixa = 0;
+}
+
+void liberarAlertasUsuario(Usuario *u) {
+    if (!u->alertas) return;
+    free(u->alertas->ids);
+    free(u->alertas->caixa);
+    free(u->alertas);
+    u->alertas = NULL;
+}
+
+static void criarAlertaUsuario(Usuario *u) {
+    int idx;
+    char dir[4];
+    float limite;
+    listarAtivosDisponiveis();
+    printf("Ativo (número): ");
+    if (scanf("%d", &idx) != 1 || idx < 1 || idx > NUM_ATIVOS) { clear_input(); printf("Ativo inválido.\n"); return; }
+    printf("Avisar quando %s ficar ('<' abaixo de, '>' acima de): ", ativosDisponiveis[idx - 1].ticker);
+    if (scanf("%3s", dir) != 1 || (dir[0] != '<' && dir[0] != '>')) { clear_input(); printf("Direção inválida.\n"); return; }
+    printf("Preço: R$ ");
+    if (scanf("%f", &limite) != 1 || limite <= 0.0f) { clear_input(); printf("Preço inválido.\n"); return; }
+    AlertasUsuario *a = alertasDoUsuario(u);
+    if (!a || !motorDoCatalogo()) { printf("Memória insuficiente.\n"); return; }
+    uint32_t id = alertasRegistrar(&motorAlertas, u->id, idx - 1, dir[0] == '<' ? ALERTA_ABAIXO : ALERTA_ACIMA, limite, false);
+    if (id == UINT32_MAX) { printf("Memória insuficiente.\n"); return; }
+    if (!anexarIdAlerta(a, id)) { alertasCancelar(&motorAlertas, id); printf("Memória insuficiente.\n"); return; }
+    printf("Alerta criado: %s %s R$ %.2f.\n", ativosDisponiveis[idx - 1].ticker, dir[0] == '<' ? "abaixo de" : "acima de", limite);
+}
+
+static void listarAlertasUsuario(Usuario *u) {
+    static const char *estados[] = { "ativo", "disparado", "cancelado" };
+    if (!u->alertas || u->alertas->numIds == 0) { printf("Nenhum alerta.\n"); return; }
+    for (int i = 0; i < u->alertas->numIds; ++i) {
+        const RegistroAlerta *r = &motorAlertas.reg[u->alertas->ids[i]];
+        printf("%2d) %s %s R$ %.2f | %s\n", i + 1, ativosDisponiveis[r->ativo].ticker,
+               r->direcao == ALERTA_ABAIXO ? "abaixo de" : "acima de", r->limite, estados[r->estado]);
+    }
+}
+
+static void mostrarWatchlist(Usuario *u) {
+    if (!u->alertas || u->alertas->numWatchlist == 0) { printf("Watchlist vazia.\n"); return; }
+    for (int i = 0; i < u->alertas->numWatchlist; ++i) {
+        int j = u->alertas->watchlist[i];
+        const AtivoRV *a = &ativosDisponiveis[j];
+        printf("%2d) %s (%s) | Preço: R$ %.2f", i + 1, a->nome, a->ticker, a->preco);
+        if (indicadores && indicadores[j].n > 0) {
+            Indicadores v;
+            indicadoresValores(&indicadores[j], &parametrosIndicadores, &v);
+            printf(" | SMA%d %.2f | RSI%d %.1f", parametrosIndicadores.sma, v.sma, parametrosIndicadores.rsi, v.rsi);
+        }
+        printf("\n");
+    }
+}
+
+void menuAlertas(Usuario *u) {
+    int opc;
+    do {
+        printf("\n=== WATCHLIST E ALERTAS DE PREÇO ===\n");
+        printf("1 - Ver watchlist\n");
+        printf("2 - Adicionar ativo à watchlist\n");
+        printf("3 - Remover ativo da watchlist\n");
+        printf("4 - Criar alerta de preço\n");
+        printf("5 - Meus alertas\n");
+        printf("6 - Cancelar alerta\n");
+        printf("0 - Voltar\n");
+        printf("Escolha: ");
+        if (scanf("%d", &opc) != 1) { clear_input(); printf("Entrada inválida.\n"); opc = -1; }
+        int idx;
+        AlertasUsuario *a;
+        switch (opc) {
+            case 1: mostrarWatchlist(u); break;
+            case 2:
+                listarAtivosDisponiveis();
+                printf("Ativo (número): ");
+                if (scanf("%d", &idx) != 1 || idx < 1 || idx > NUM_ATIVOS) { clear_input(); printf("Ativo inválido.\n"); break; }
+                if (!(a = alertasDoUsuario(u))) { printf("Memória insuficiente.\n"); break; }
+                if (a->numWatchlist == MAX_WATCHLIST) { printf("Watchlist cheia (%d ativos).\n", MAX_WATCHLIST); break; }
+                for (int i = 0; i < a->numWatchlist; ++i) if (a->watchlist[i] == idx - 1) { idx = 0; break; }
+                if (idx == 0) { printf("Ativo já está na watchlist.\n"); break; }
+                a->watchlist[a->numWatchlist++] = idx - 1;
+                printf("%s adicionado.\n", ativosDisponiveis[idx - 1].ticker);
+                break;
+            case 3:
+                mostrarWatchlist(u);
+                if (!u->alertas || u->alertas->numWatchlist == 0) break;
+                printf("Remover (número): ");
+                if (scanf("%d", &idx) != 1 || idx < 1 || idx > u->alertas->numWatchlist) { clear_input(); printf("Opção inválida.\n"); break; }
+                a = u->alertas;
+                memmove(&a->watchlist[idx - 1], &a->watchlist[idx], sizeof(int) * (size_t)(a->numWatchlist - idx));
+                a->numWatchlist--;
+                break;
+            case 4: criarAlertaUsuario(u); break;
+            case 5: listarAlertasUsuario(u); break;
+            case 6:
+                listarAlertasUsuario(u);
+                if (!u->alertas || u->alertas->numIds == 0) break;
+                printf("Cancelar (número): ");
+                if (scanf("%d", &idx) != 1 || idx < 1 || idx > u->alertas->numIds) { clear_input(); printf("Opção inválida.\n"); break; }
+                printf(alertasCancelar(&motorAlertas, u->alertas->ids[idx - 1]) ? "Alerta cancelado.\n" : "Alerta não está ativo.\n");
+                break;
+            case 0: break;
+            default: printf("Opção inválida.\n"); break;
+        }
+        mostrarNotificacoes(u);
+    } while (opc != 0);
+}
+
+/*
+ * 10M alertas em repouso em 2.000 ativos e 1M ticks em passeio aleatório;
+ * um consumidor esvazia a fila. Confere que nenhum alerta em repouso
+ * ficou cruzado e que disparos + repouso + cancelados fecham o total.
+ */
+void benchmarkAlertas(void) {
+    const int num = 2000, ticks = 1000000;
+    const uint32_t total = 10000000;
+    printf("\n=== Benchmark de alertas de preço (%u alertas, %d ativos, %d ticks) ===\n", total, num, ticks);
+    MotorAlertas m;
+    if (!alertasIniciar(&m, num)) { printf("Memória insuficiente.\n"); return; }
+    unsigned semente = 5150u;
+    for (int j = 0; j < num; ++j) m.ultimoPreco[j] = 50.0f;
+    double t0 = cronometro_seg();
+    for (uint32_t k = 0; k < total; ++k) {
+        aleatorio(&semente);
+        int j = (int)((semente >> 8) % (unsigned)num), dir = (int)(semente & 1);
+        float dist = (float)((semente >> 4) % 2000 + 1) / 100.0f;   // R$ 0,01 a R$ 20 do preço
+        if (alertasRegistrar(&m, -1, j, dir, dir == ALERTA_ABAIXO ? 50.0f - dist : 50.0f + dist, true) == UINT32_MAX) {
+            printf("Memória insuficiente.\n");
+            alertasLiberar(&m);
+            return;
+        }
+    }
+    for (uint32_t k = 0; k < total; k += 97) alertasCancelar(&m, k);
+    double dCarga = cronometro_seg() - t0;
+    t0 = cronometro_seg();
+    for (int j = 0; j < num; ++j) alertasPreco(&m, j, 50.0f, 0);   // ordena os lados carregados em lote
+    double dOrdenar = cronometro_seg() - t0;
+
+    float *preco = malloc(sizeof(float) * (size_t)num);
+    if (!preco) { alertasLiberar(&m); printf("Memória insuficiente.\n"); return; }
+    for (int j = 0; j < num; ++j) preco[j] = 50.0f;
+    long long entregues = 0;
+    EventoAlerta ev;
+    t0 = cronometro_seg();
+    for (int k = 0; k < ticks; ++k) {
+        aleatorio(&semente);
+        int j = (int)((semente >> 8) % (unsigned)num);
+        preco[j] += ((semente >> 4) & 1) ? 0.01f : -0.01f;
+        alertasPreco(&m, j, preco[j], k);
+        if ((k & 255) == 0) while (alertasRetirar(&m, &ev)) entregues++;
+    }
+    while (alertasRetirar(&m, &ev)) entregues++;
+    double dTicks = cronometro_seg() - t0;
+
+    long long repouso = 0, cruzados = 0, ativos = 0, disparados = 0, cancelados = 0;
+    for (int j = 0; j < num; ++j)
+        for (int dir = 0; dir < 2; ++dir) {
+            const LadoAlertas *l = &m.lados[j][dir];
+            for (int i = 0; i < l->num; ++i) {
+                repouso += m.reg[l->g[i].id].estado == ALERTA_ATIVO;
+                cruzados += dir == ALERTA_ABAIXO ? preco[j] < l->g[i].limite : preco[j] > l->g[i].limite;
+            }
+        }
+    for (uint32_t k = 0; k < m.num; ++k) {
+        ativos += m.reg[k].estado == ALERTA_ATIVO;
+        disparados += m.reg[k].estado == ALERTA_DISPARADO;
+        cancelados += m.reg[k].estado == ALERTA_CANCELADO;
+    }
+    printf("Carga: %.2f s | ordenação dos lados: %.2f s\n", dCarga, dOrdenar);
+    printf("Ticks: %.1f ns por tick | %lld disparos (%.1f ns por tick+disparo) | %lld entregues, %lld perdidos\n",
+           dTicks / ticks * 1e9, disparados, dTicks / (ticks + disparados) * 1e9, entregues,
+           (long long)atomic_load(&m.fila->perdidos));
+    printf("Conferência: %lld em repouso cruzado(s) | ativos %lld = em repouso %lld | total %lld = %u\n",
+           cruzados, ativos, repouso, ativos + disparados + cancelados, total);
+    free(preco);
+    alertasLiberar(&m);
+}
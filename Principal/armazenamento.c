@@ -0,0 +1,738 @@
+#include "corretora.h"
+
+/* ======= Armazenamento ======= */
+
+GravadorSnapshot gravUsuarios;           // snapshot do cadastro (usuarios.dat)
+
+#ifdef _WIN32
+static int abrirArquivo(const char *arq) { return _open(arq, _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE); }
+static long long tamanhoArquivo(int fd) { return _lseeki64(fd, 0, SEEK_END); }
+static void fecharArquivo(int fd) { _close(fd); }
+static bool escreverPosicional(Gravador *g, const char *buf, int tam, long long off) {
+    /* sem pwrite: seek + write sob mutex próprio */
+    mutex_travar(&g->mIo);
+    bool ok = _lseeki64(g->fd, off, SEEK_SET) == off && _write(g->fd, buf, tam) == tam;
+    mutex_destravar(&g->mIo);
+    return ok;
+}
+bool sincronizarDados(int fd) { return _commit(fd) == 0; }
+static int criarArquivo(const char *arq) { return _open(arq, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE); }
+static bool escreverTudo(int fd, const char *buf, size_t tam) {
+    while (tam > 0) {
+        int n = _write(fd, buf, tam > INT_MAX ? INT_MAX : (unsigned)tam);
+        if (n <= 0) return false;
+        buf += n; tam -= (size_t)n;
+    }
+    return true;
+}
+bool substituirArquivo(const char *tmp, const char *arq) {
+    return MoveFileExA(tmp, arq, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+#else
+static int abrirArquivo(const char *arq) { return open(arq, O_WRONLY | O_CREAT, 0644); }
+static long long tamanhoArquivo(int fd) { return (long long)lseek(fd, 0, SEEK_END); }
+static void fecharArquivo(int fd) { close(fd); }
+static bool escreverPosicional(Gravador *g, const char *buf, int tam, long long off) {
+    while (tam > 0) {
+        ssize_t n = pwrite(g->fd, buf, (size_t)tam, (off_t)off);
+        if (n <= 0) return false;
+        buf += n; tam -= (int)n; off += n;
+    }
+    return true;
+}
+bool sincronizarDados(int fd) { return fdatasync(fd) == 0; }
+static int criarArquivo(const char *arq) { return open(arq, O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+static bool escreverTudo(int fd, const char *buf, size_t tam) {
+    while (tam > 0) {
+        ssize_t n = write(fd, buf, tam);
+        if (n <= 0) return false;
+        buf += n; tam -= (size_t)n;
+    }
+    return true;
+}
+/* rename atômico + fsync do diretório (os arquivos ficam no diretório corrente) */
+bool substituirArquivo(const char *tmp, const char *arq) {
+    if (rename(tmp, arq) != 0) return false;
+    int dir = open(".", O_RDONLY);
+    if (dir < 0) return false;
+    bool ok = fsync(dir) == 0;
+    close(dir);
+    return ok;
+}
+#endif
+
+#ifdef USAR_IO_URING
+static bool uringIniciar(Uring *r, unsigned entradas) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+    r->fd = (int)syscall(__NR_io_uring_setup, entradas, &p);
+    if (r->fd < 0) return false;
+
+    r->sqTam = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cqTam = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cqTam > r->sqTam) r->sqTam = r->cqTam;
+        r->cqTam = r->sqTam;
+    }
+    r->sqMem = mmap(NULL, r->sqTam, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sqMem == MAP_FAILED) { close(r->fd); return false; }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cqMem = r->sqMem;
+    } else {
+        r->cqMem = mmap(NULL, r->cqTam, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cqMem == MAP_FAILED) { munmap(r->sqMem, r->sqTam); close(r->fd); return false; }
+    }
+    r->sqesTam = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqesTam, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        if (r->cqMem != r->sqMem) munmap(r->cqMem, r->cqTam);
+        munmap(r->sqMem, r->sqTam);
+        close(r->fd);
+        return false;
+    }
+
+    char *sq = r->sqMem, *cq = r->cqMem;
+    r->sqCabeca = (unsigned *)(sq + p.sq_off.head);
+    r->sqCauda = (unsigned *)(sq + p.sq_off.tail);
+    r->sqMascara = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sqVetor = (unsigned *)(sq + p.sq_off.array);
+    r->cqCabeca = (unsigned *)(cq + p.cq_off.head);
+    r->cqCauda = (unsigned *)(cq + p.cq_off.tail);
+    r->cqMascara = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->entradas = p.sq_entries;
+    return true;
+}
+
+static void uringFechar(Uring *r) {
+    munmap(r->sqes, r->sqesTam);
+    if (r->cqMem != r->sqMem) munmap(r->cqMem, r->cqTam);
+    munmap(r->sqMem, r->sqTam);
+    close(r->fd);
+}
+
+/* reserva a próxima SQE (o anel tem folga para todos os buffers, nunca enche) */
+static struct io_uring_sqe *uringProximaSqe(Uring *r, unsigned *cauda) {
+    unsigned idx = *cauda & *r->sqMascara;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sqVetor[idx] = idx;
+    (*cauda)++;
+    return sqe;
+}
+
+/* escrita do buffer registrado + fdatasync encadeado (IOSQE_IO_LINK) */
+static void uringPrepararCommit(Gravador *g, int idx, unsigned *cauda) {
+    BufferGravador *b = &g->buf[idx];
+    struct io_uring_sqe *w = uringProximaSqe(&g->ring, cauda);
+    w->opcode = IORING_OP_WRITE_FIXED;
+    w->fd = g->fd;
+    w->addr = (unsigned long long)(uintptr_t)b->dados;
+    w->len = (unsigned)b->tam;
+    w->off = (unsigned long long)b->offset;
+    w->buf_index = (unsigned short)idx;
+    w->flags = IOSQE_IO_LINK;
+    w->user_data = (unsigned long long)idx << 1;
+
+    struct io_uring_sqe *f = uringProximaSqe(&g->ring, cauda);
+    f->opcode = IORING_OP_FSYNC;
+    f->fd = g->fd;
+    f->fsync_flags = IORING_FSYNC_DATASYNC;
+    f->user_data = ((unsigned long long)idx << 1) | 1;
+}
+#endif
+
+/* marca o buffer como gravado e avança 'duravel' pelos commits contíguos (mutex travado) */
+static void gravadorConcluir(Gravador *g, int idx, bool ok) {
+    g->buf[idx].estado = BUF_DURAVEL;
+    if (!ok) g->erro = true;
+    bool avancou = true;
+    while (avancou) {
+        avancou = false;
+        for (int i = 0; i < NUM_BUFFERS_GRAVADOR; ++i) {
+            BufferGravador *b = &g->buf[i];
+            if (b->estado == BUF_DURAVEL && b->commit == g->duravel + 1) {
+                b->estado = BUF_LIVRE;
+                b->tam = 0;
+                b->falhou = false;
+                b->semFsync = false;
+                g->duravel++;
+                if (g->aoDuravel) g->aoDuravel(g->ctxDuravel, g->duravel);
+                avancou = true;
+            }
+        }
+    }
+    cond_acordar_todos(&g->mudou);
+}
+
+static void *threadGravadorPwrite(void *arg) {
+    Gravador *g = arg;
+    mutex_travar(&g->m);
+    for (;;) {
+        while (g->numSel == 0 && !g->parar) cond_esperar(&g->mudou, &g->m);
+        if (g->numSel == 0) break;
+        int idx = g->selados[g->iniSel];
+        g->iniSel = (g->iniSel + 1) % NUM_BUFFERS_GRAVADOR;
+        g->numSel--;
+        BufferGravador *b = &g->buf[idx];
+        b->estado = BUF_EM_VOO;
+        mutex_destravar(&g->m);
+
+        bool ok = escreverPosicional(g, b->dados, b->tam, b->offset) && sincronizarDados(g->fd);
+
+        mutex_travar(&g->m);
+        gravadorConcluir(g, idx, ok);
+    }
+    mutex_destravar(&g->m);
+    return NULL;
+}
+
+#ifdef USAR_IO_URING
+/* uma thread submete em lote tudo o que estiver selado e colhe as conclusões */
+static void *threadGravadorUring(void *arg) {
+    Gravador *g = arg;
+    Uring *r = &g->ring;
+    mutex_travar(&g->m);
+    for (;;) {
+        while (g->numSel == 0 && g->emVoo == 0 && !g->parar) cond_esperar(&g->mudou, &g->m);
+        if (g->numSel == 0 && g->emVoo == 0) break;
+
+        unsigned cauda = *r->sqCauda;
+        unsigned submeter = 0;
+        while (g->numSel > 0) {
+            int idx = g->selados[g->iniSel];
+            g->iniSel = (g->iniSel + 1) % NUM_BUFFERS_GRAVADOR;
+            g->numSel--;
+            g->buf[idx].estado = BUF_EM_VOO;
+            uringPrepararCommit(g, idx, &cauda);
+            submeter += 2;
+            g->emVoo++;
+        }
+        atomic_store_explicit((_Atomic unsigned *)r->sqCauda, cauda, memory_order_release);
+        mutex_destravar(&g->m);
+
+        int ret;
+        do {
+            ret = (int)syscall(__NR_io_uring_enter, r->fd, submeter, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            submeter = cauda - atomic_load_explicit((_Atomic unsigned *)r->sqCabeca, memory_order_acquire);
+        } while (ret < 0 && errno == EINTR && submeter > 0);
+
+        mutex_travar(&g->m);
+        /*
+         * SQEs que o anel não consumiu (erro do enter ou submissão parcial)
+         * nunca completam: saem do anel e só os seus buffers falham. O que
+         * foi consumido segue sendo colhido abaixo e nas próximas voltas.
+         */
+        unsigned consumida = atomic_load_explicit((_Atomic unsigned *)r->sqCabeca, memory_order_acquire);
+        if (consumida != cauda) {
+            for (unsigned k = consumida; k != cauda; ++k) {
+                unsigned long long ud = r->sqes[k & *r->sqMascara].user_data;
+                if (!(ud & 1)) continue;                        // o buffer responde pela fsync do par
+                int idx = (int)(ud >> 1);
+                if (k == consumida) g->buf[idx].semFsync = true;  // a escrita do par já foi aceita
+                else { gravadorConcluir(g, idx, false); g->emVoo--; }
+            }
+            atomic_store_explicit((_Atomic unsigned *)r->sqCauda, consumida, memory_order_release);
+        }
+        unsigned cabeca = *r->cqCabeca;
+        unsigned fim = atomic_load_explicit((_Atomic unsigned *)r->cqCauda, memory_order_acquire);
+        while (cabeca != fim) {
+            struct io_uring_cqe *cqe = &r->cqes[cabeca & *r->cqMascara];
+            int idx = (int)(cqe->user_data >> 1);
+            BufferGravador *b = &g->buf[idx];
+            if (cqe->user_data & 1) {
+                gravadorConcluir(g, idx, !b->falhou && cqe->res >= 0);
+                g->emVoo--;
+            } else if (b->semFsync) {
+                gravadorConcluir(g, idx, false);
+                g->emVoo--;
+            } else if (cqe->res != b->tam) {
+                b->falhou = true;     // o fsync encadeado volta cancelado
+            }
+            cabeca++;
+        }
+        atomic_store_explicit((_Atomic unsigned *)r->cqCabeca, cabeca, memory_order_release);
+    }
+    mutex_destravar(&g->m);
+    return NULL;
+}
+
+static bool gravadorIniciarUring(Gravador *g) {
+    if (!uringIniciar(&g->ring, NUM_BUFFERS_GRAVADOR * 2)) return false;
+    struct iovec iov[NUM_BUFFERS_GRAVADOR];
+    for (int i = 0; i < NUM_BUFFERS_GRAVADOR; ++i) {
+        iov[i].iov_base = g->buf[i].dados;
+        iov[i].iov_len = TAM_BUFFER_GRAVADOR;
+    }
+    if (syscall(__NR_io_uring_register, g->ring.fd, IORING_REGISTER_BUFFERS, iov, NUM_BUFFERS_GRAVADOR) < 0) {
+        uringFechar(&g->ring);
+        return false;
+    }
+    if (!thread_criar(&g->threads[0], threadGravadorUring, g)) {
+        uringFechar(&g->ring);
+        return false;
+    }
+    g->numThreads = 1;
+    return true;
+}
+#endif
+
+bool gravadorAbrir(Gravador *g, const char *arq, int backendPreferido) {
+    memset(g, 0, sizeof(*g));
+    g->fd = abrirArquivo(arq);
+    if (g->fd < 0) return false;
+    g->memoria = malloc((size_t)NUM_BUFFERS_GRAVADOR * TAM_BUFFER_GRAVADOR);
+    if (!g->memoria) { fecharArquivo(g->fd); return false; }
+    for (int i = 0; i < NUM_BUFFERS_GRAVADOR; ++i) {
+        g->buf[i].dados = g->memoria + (size_t)i * TAM_BUFFER_GRAVADOR;
+        g->buf[i].estado = BUF_LIVRE;
+    }
+    g->atual = -1;
+    g->proxOffset = tamanhoArquivo(g->fd);
+    if (g->proxOffset < 0) g->proxOffset = 0;
+    mutex_iniciar(&g->m);
+    mutex_iniciar(&g->mIo);
+    cond_iniciar(&g->mudou);
+
+#ifdef USAR_IO_URING
+    if (backendPreferido == BACKEND_IO_URING && gravadorIniciarUring(g)) {
+        g->backend = BACKEND_IO_URING;
+        return true;
+    }
+#else
+    (void)backendPreferido;
+#endif
+    g->backend = BACKEND_PWRITE;
+    for (int i = 0; i < THREADS_GRAVADOR; ++i)
+        if (thread_criar(&g->threads[g->numThreads], threadGravadorPwrite, g)) g->numThreads++;
+    if (g->numThreads == 0) {
+        mutex_destruir(&g->m); mutex_destruir(&g->mIo); cond_destruir(&g->mudou);
+        free(g->memoria); fecharArquivo(g->fd);
+        return false;
+    }
+    return true;
+}
+
+/* fecha o buffer atual como um commit e o entrega às threads (mutex travado) */
+static void gravadorSelar(Gravador *g) {
+    BufferGravador *b = &g->buf[g->atual];
+    b->offset = g->proxOffset;
+    g->proxOffset += b->tam;
+    b->commit = ++g->ultimoCommit;
+    b->estado = BUF_SELADO;
+    g->selados[(g->iniSel + g->numSel) % NUM_BUFFERS_GRAVADOR] = g->atual;
+    g->numSel++;
+    g->atual = -1;
+    cond_acordar_todos(&g->mudou);
+}
+
+/* copia para o buffer atual; só bloqueia se todos os buffers estiverem em uso */
+void gravadorAnexar(Gravador *g, const void *dados, int tam) {
+    const char *p = dados;
+    mutex_travar(&g->m);
+    while (tam > 0) {
+        if (g->atual < 0) {
+            for (;;) {
+                for (int i = 0; i < NUM_BUFFERS_GRAVADOR; ++i)
+                    if (g->buf[i].estado == BUF_LIVRE) { g->atual = i; break; }
+                if (g->atual >= 0) break;
+                cond_esperar(&g->mudou, &g->m);
+            }
+            g->buf[g->atual].estado = BUF_ENCHENDO;
+            g->buf[g->atual].tam = 0;
+        }
+        BufferGravador *b = &g->buf[g->atual];
+        int n = TAM_BUFFER_GRAVADOR - b->tam;
+        if (n > tam) n = tam;
+        memcpy(b->dados + b->tam, p, (size_t)n);
+        b->tam += n; p += n; tam -= n;
+        if (b->tam == TAM_BUFFER_GRAVADOR) gravadorSelar(g);
+    }
+    mutex_destravar(&g->m);
+}
+
+/* sela o que estiver pendente; retorna o id a aguardar para ter tudo em disco */
+long long gravadorCommit(Gravador *g) {
+    mutex_travar(&g->m);
+    if (g->atual >= 0 && g->buf[g->atual].tam > 0) gravadorSelar(g);
+    long long c = g->ultimoCommit;
+    mutex_destravar(&g->m);
+    return c;
+}
+
+bool gravadorAguardar(Gravador *g, long long commit) {
+    mutex_travar(&g->m);
+    while (g->duravel < commit) cond_esperar(&g->mudou, &g->m);
+    bool ok = !g->erro;
+    mutex_destravar(&g->m);
+    return ok;
+}
+
+void gravadorFechar(Gravador *g) {
+    if (!g->memoria) return;
+    gravadorAguardar(g, gravadorCommit(g));
+    mutex_travar(&g->m);
+    g->parar = true;
+    cond_acordar_todos(&g->mudou);
+    mutex_destravar(&g->m);
+    for (int i = 0; i < g->numThreads; ++i) thread_aguardar(g->threads[i]);
+#ifdef USAR_IO_URING
+    if (g->backend == BACKEND_IO_URING) uringFechar(&g->ring);
+#endif
+    mutex_destruir(&g->m);
+    mutex_destruir(&g->mIo);
+    cond_destruir(&g->mudou);
+    fecharArquivo(g->fd);
+    free(g->memoria);
+    g->memoria = NULL;
+}
+
+/* ---- snapshot: temporário + fdatasync + rename ---- */
+
+static bool gravarArquivoAtomico(const char *arq, const char *dados, size_t tam) {
+    char tmp[80];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", arq);
+    int fd = criarArquivo(tmp);
+    if (fd < 0) return false;
+    bool ok = escreverTudo(fd, dados, tam) && sincronizarDados(fd);
+    fecharArquivo(fd);
+    if (!ok) { remove(tmp); return false; }
+    return substituirArquivo(tmp, arq);
+}
+
+static void *threadSnapshot(void *arg) {
+    GravadorSnapshot *s = arg;
+    mutex_travar(&s->m);
+    for (;;) {
+        while (!s->pendente && !s->parar) cond_esperar(&s->mudou, &s->m);
+        if (!s->pendente) break;
+        char *dados = s->pendente;
+        size_t tam = s->tamPendente;
+        long long id = s->entregues;
+        s->pendente = NULL;
+        mutex_destravar(&s->m);
+
+        bool ok = gravarArquivoAtomico(s->arq, dados, tam);
+        free(dados);
+
+        mutex_travar(&s->m);
+        if (!ok) s->erro = true;
+        s->gravados = id;
+        cond_acordar_todos(&s->mudou);
+    }
+    mutex_destravar(&s->m);
+    return NULL;
+}
+
+bool snapshotAbrir(GravadorSnapshot *s, const char *arq) {
+    memset(s, 0, sizeof(*s));
+    snprintf(s->arq, sizeof(s->arq), "%s", arq);
+    mutex_iniciar(&s->m);
+    cond_iniciar(&s->mudou);
+    if (!thread_criar(&s->thread, threadSnapshot, s)) {
+        mutex_destruir(&s->m); cond_destruir(&s->mudou);
+        return false;
+    }
+    s->ativo = true;
+    return true;
+}
+
+/* entrega um snapshot montado (o gravador passa a ser dono de 'dados'); retorna o id a aguardar */
+long long snapshotEntregar(GravadorSnapshot *s, char *dados, size_t tam) {
+    mutex_travar(&s->m);
+    free(s->pendente);                          // ainda não começou: o novo cobre o antigo
+    s->pendente = dados;
+    s->tamPendente = tam;
+    long long id = ++s->entregues;
+    cond_acordar_todos(&s->mudou);
+    mutex_destravar(&s->m);
+    return id;
+}
+
+bool snapshotAguardar(GravadorSnapshot *s, long long id) {
+    mutex_travar(&s->m);
+    while (s->gravados < id) cond_esperar(&s->mudou, &s->m);
+    bool ok = !s->erro;
+    mutex_destravar(&s->m);
+    return ok;
+}
+
+void snapshotFechar(GravadorSnapshot *s) {
+    if (!s->ativo) return;
+    mutex_travar(&s->m);
+    s->parar = true;
+    cond_acordar_todos(&s->mudou);
+    mutex_destravar(&s->m);
+    thread_aguardar(s->thread);                 // a thread grava o pendente antes de sair
+    mutex_destruir(&s->m);
+    cond_destruir(&s->mudou);
+    s->ativo = false;
+}
+
+/* ---- benchmark: commits duráveis por segundo e latência de cauda ---- */
+
+#define BENCH_COMMITS 2000
+#define BENCH_TAM_COMMIT 4096
+
+typedef struct {
+    double *emissao;
+    double *duravel;
+} TemposBench;
+
+static void registrarTempoDuravel(void *ctx, long long commit) {
+    TemposBench *t = ctx;
+    if (commit >= 1 && commit <= BENCH_COMMITS) t->duravel[commit] = cronometro_seg();
+}
+
+static int compararDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void medirBackend(int backend, const char *nome) {
+    const char *arq = "bench_gravador.tmp";
+    remove(arq);
+    Gravador g;
+    if (!gravadorAbrir(&g, arq, backend)) { printf("%-18s: não foi possível abrir %s\n", nome, arq); return; }
+    if (g.backend != backend) {
+        printf("%-18s: indisponível neste sistema\n", nome);
+        gravadorFechar(&g);
+        remove(arq);
+        return;
+    }
+
+    TemposBench t;
+    t.emissao = calloc(BENCH_COMMITS + 1, sizeof(double));
+    t.duravel = calloc(BENCH_COMMITS + 1, sizeof(double));
+    double *lat = malloc(sizeof(double) * BENCH_COMMITS);
+    char *registro = malloc(BENCH_TAM_COMMIT);
+    if (!t.emissao || !t.duravel || !lat || !registro) {
+        printf("Memória insuficiente.\n");
+    } else {
+        memset(registro, 'x', BENCH_TAM_COMMIT);
+        mutex_travar(&g.m);
+        g.aoDuravel = registrarTempoDuravel;
+        g.ctxDuravel = &t;
+        mutex_destravar(&g.m);
+
+        double t0 = cronometro_seg();
+        long long ultimo = 0;
+        for (int i = 0; i < BENCH_COMMITS; ++i) {
+            gravadorAnexar(&g, registro, BENCH_TAM_COMMIT);
+            double agora = cronometro_seg();
+            ultimo = gravadorCommit(&g);
+            t.emissao[ultimo] = agora;
+        }
+        bool ok = gravadorAguardar(&g, ultimo);
+        double t1 = cronometro_seg();
+
+        for (int i = 0; i < BENCH_COMMITS; ++i) lat[i] = (t.duravel[i + 1] - t.emissao[i + 1]) * 1e6;
+        qsort(lat, BENCH_COMMITS, sizeof(double), compararDouble);
+        printf("%-18s: %8.0f commits/s | p50 %7.0f us | p99 %7.0f us | p99.9 %7.0f us | máx %7.0f us%s\n",
+               nome, BENCH_COMMITS / (t1 - t0),
+               lat[BENCH_COMMITS / 2], lat[BENCH_COMMITS * 99 / 100], lat[BENCH_COMMITS * 999 / 1000],
+               lat[BENCH_COMMITS - 1], ok ? "" : " (ERROS DE E/S)");
+    }
+    gravadorFechar(&g);
+    free(t.emissao); free(t.duravel); free(lat); free(registro);
+    remove(arq);
+}
+
+void benchmarkGravador(void) {
+    printf("\n=== Benchmark de persistência: %d commits duráveis de %d bytes ===\n", BENCH_COMMITS, BENCH_TAM_COMMIT);
+    medirBackend(BACKEND_IO_URING, "io_uring");
+    medirBackend(BACKEND_PWRITE, "pwrite+fdatasync");
+}
+
+/* ---- snapshot de usuários e replay do journal ---- */
+
+void preencherCabecalho(CabecalhoArquivo *c, const char *magica, int tamRegistro) {
+    memset(c, 0, sizeof(*c));
+    snprintf(c->magica, sizeof(c->magica), "%s", magica);
+    c->versao = VERSAO_ARQUIVOS;
+    c->tamRegistro = tamRegistro;
+}
+
+/* lê e confere o cabeçalho; arquivo incompatível é renomeado para não ser sobrescrito */
+static FILE *abrirParaCarga(const char *arq, const char *magica, int tamRegistro) {
+    FILE *fp = fopen(arq, "rb");
+    if (!fp) return NULL;
+    CabecalhoArquivo c, esperado;
+    preencherCabecalho(&esperado, magica, tamRegistro);
+    if (fread(&c, sizeof(c), 1, fp) == 1 && memcmp(&c, &esperado, sizeof(c)) == 0) return fp;
+    fclose(fp);
+    char antigo[64];
+    snprintf(antigo, sizeof(antigo), "%s.antigo", arq);
+    remove(antigo);
+    rename(arq, antigo);
+    printf("Aviso: %s em formato antigo, movido para %s.\n", arq, antigo);
+    return NULL;
+}
+
+/*
+ * Lançamento do journal mais novo que o snapshot (queda entre um salvamento
+ * e outro): o saldo da conta passa ao saldo após o lançamento e compras e
+ * vendas refazem a posição, com o preço médio ponderado pelo custo.
+ */
+static void reconciliarLancamento(Usuario *u, int conta, const Transacao *t) {
+    if (conta == CONTA_BANCO) { u->banco.saldo = t->saldoFinal; return; }
+    ContaInvestimento *c = &u->investimento;
+    c->saldo = t->saldoFinal;
+    if (!t->ativo[0] || t->quantidade <= 0) return;
+    AtivoCarteira *pos = posicaoDoTicker(u, t->ativo);
+    if (strcmp(t->tipo, "Compra") == 0) {
+        if (!pos) {
+            if (c->numAtivos >= MAX_ATIVOS) return;
+            pos = &c->carteira[c->numAtivos++];
+            memset(pos, 0, sizeof(*pos));
+            snprintf(pos->ticker, sizeof(pos->ticker), "%s", t->ativo);
+        }
+        int total = pos->quantidade + t->quantidade;
+        pos->precoMedio = (pos->precoMedio * (float)pos->quantidade - t->valor) / (float)total;
+        pos->quantidade = total;
+    } else if (strcmp(t->tipo, "Venda") == 0 && pos) {
+        pos->quantidade -= t->quantidade;
+        if (pos->quantidade <= 0) {
+            int k = (int)(pos - c->carteira);
+            memmove(pos, pos + 1, sizeof(*pos) * (size_t)(c->numAtivos - k - 1));
+            c->numAtivos--;
+        }
+    }
+}
+
+/*
+ * TEDs agendados e não liquidados antes de uma queda: o agendamento vai ao
+ * extrato da origem ("TED agendado", valor zero, destino e valor em centavos
+ * na descrição) e a liquidação deixa um "TED" na mesma conta, depois na
+ * ordem de seq. Na releitura o agendamento volta à fila e o lote o retira.
+ */
+void refazerFilaTED(Usuario *u, const Transacao *t) {
+    if (strcmp(t->tipo, "TED agendado") == 0) {
+        char cpf[MAX_CPF];
+        long long reais, centavos;
+        int fim = 0;
+        Usuario *destino;
+        if (sscanf(t->descricao, "TED agendado p/ %15s R$ %lld.%2lld%n", cpf, &reais, &centavos, &fim) == 3
+            && t->descricao[fim] == '\0' && (destino = buscarUsuarioPorCpf(cpf)) != NULL && destino != u)
+            agendarTED(&filaTED, u, destino, (float)(reais * 100 + centavos) / 100.0f);
+    } else if (strcmp(t->tipo, "TED") == 0) {
+        int k = 0;
+        for (int i = 0; i < filaTED.num; ++i) {
+            if (filaTED.itens[i].origem == u->id) u->banco.tedPendente -= filaTED.itens[i].valor;
+            else filaTED.itens[k++] = filaTED.itens[i];
+        }
+        filaTED.num = k;
+        if (u->banco.tedPendente < 0.005f) u->banco.tedPendente = 0.0f;
+    }
+}
+
+void carregarDados(void) {
+    /* marca do journal no snapshot: por shard, a primeira seq que ele não reflete */
+    unsigned long long marca[NUM_SHARDS_EXTRATO];
+    bool temMarca = false;
+    FILE *fp = abrirParaCarga(ARQ_USUARIOS, "USUARIO", (int)sizeof(RegistroUsuario));
+    if (fp) {
+        int n = 0;
+        if (fread(&n, sizeof(n), 1, fp) != 1) n = 0;
+        RegistroUsuario r;
+        for (int i = 0; i < n && fread(&r, sizeof(r), 1, fp) == 1; ++i) {
+            Usuario *u = adicionarUsuario();
+            if (!u) break;
+            memcpy(u->nome, r.nome, sizeof(u->nome));
+            memcpy(u->cpf, r.cpf, sizeof(u->cpf));
+            memcpy(u->senha, r.senha, sizeof(u->senha));
+            u->banco.saldo = r.saldoBanco;
+            u->investimento.saldo = r.saldoInvest;
+            u->investimento.numAtivos = r.numAtivos;
+            for (int k = 0; k < MAX_ATIVOS; ++k) {
+                AtivoCarteira *c = &u->investimento.carteira[k];
+                memcpy(c->ticker, r.carteira[k].ticker, sizeof(c->ticker));
+                c->quantidade = r.carteira[k].quantidade;
+                c->precoMedio = r.carteira[k].precoMedio;
+                c->mesesAcumuladosLocal = r.carteira[k].mesesAcumuladosLocal;
+            }
+            if (!confirmarUsuario(u)) liberarUsuario(u);
+        }
+        temMarca = fread(marca, sizeof(marca), 1, fp) == 1;     // snapshots antigos não têm
+        int numItens = 0;
+        if (temMarca && fread(&numItens, sizeof(int), 1, fp) == 1 && numItens > 0) {
+            ItemAlertaSalvo *itens = malloc(sizeof(ItemAlertaSalvo) * (size_t)numItens);
+            if (itens) {
+                numItens = (int)fread(itens, sizeof(ItemAlertaSalvo), (size_t)numItens, fp);
+                restaurarAlertas(itens, numItens);
+                free(itens);
+            }
+        }
+        fclose(fp);
+    }
+
+    fp = abrirParaCarga(ARQ_JOURNAL, "JOURNAL", (int)sizeof(RegistroJournal));
+    if (fp) {
+        RegistroJournal r;
+        while (fread(&r, sizeof(r), 1, fp) == 1) {
+            Usuario *u = buscarUsuarioPorCpf(r.cpf);
+            if (!u) continue;
+            AnelExtrato *a = shardDaConta(&filaExtrato, u, r.conta);
+            if (r.t.seq + 1 > a->seqBase) a->seqBase = r.t.seq + 1;
+            if (temMarca && r.t.seq >= marca[a - filaExtrato.shards]) reconciliarLancamento(u, r.conta, &r.t);
+            if (r.conta == CONTA_BANCO) {
+                refazerFilaTED(u, &r.t);
+                anexarExtrato(&u->banco.extrato, &u->banco.numTransacoes, &u->banco.capTransacoes, &u->banco.saldos, &r.t);
+            } else
+                anexarExtrato(&u->investimento.extrato, &u->investimento.numTransacoes, &u->investimento.capTransacoes,
+                              &u->investimento.saldos, &r.t);
+        }
+        fclose(fp);
+    }
+    for (int i = 0; i < numUsuarios; ++i) reconstruirResultados(usuarios[i]);
+}
+
+/*
+ * Ensaio: o relógio virtual aberto pelo menu vale para o resto da sessão e
+ * nada dela chega ao disco (journal, snapshot, segmentos, cotações), para
+ * que carimbos no futuro nunca se misturem ao livro real. Reiniciar
+ * descarta o ensaio.
+ */
+_Atomic bool sessaoEnsaio = false;
+
+/* monta o snapshot e o entrega à thread de gravação, sem esperar o disco */
+bool salvarUsuarios(void) {
+    if (atomic_load_explicit(&sessaoEnsaio, memory_order_relaxed)) return false;
+    if (!gravUsuarios.ativo || !filaExtrato.shards) return false;
+    unsigned long long marca[NUM_SHARDS_EXTRATO];
+    int numItens = alertasParaSalvar(NULL);
+    size_t tam = sizeof(CabecalhoArquivo) + sizeof(int) + sizeof(RegistroUsuario) * (size_t)numUsuarios + sizeof(marca)
+               + sizeof(int) + sizeof(ItemAlertaSalvo) * (size_t)numItens;
+    char *buf = calloc(1, tam);
+    if (!buf) return false;
+    preencherCabecalho((CabecalhoArquivo *)buf, "USUARIO", (int)sizeof(RegistroUsuario));
+    memcpy(buf + sizeof(CabecalhoArquivo), &numUsuarios, sizeof(int));
+    RegistroUsuario *r = (RegistroUsuario *)(buf + sizeof(CabecalhoArquivo) + sizeof(int));
+    for (int i = 0; i < numUsuarios; ++i, ++r) {
+        Usuario *u = usuarios[i];
+        memcpy(r->nome, u->nome, sizeof(r->nome));
+        memcpy(r->cpf, u->cpf, sizeof(r->cpf));
+        memcpy(r->senha, u->senha, sizeof(r->senha));
+        r->saldoBanco = u->banco.saldo;
+        r->saldoInvest = u->investimento.saldo;
+        r->numAtivos = u->investimento.numAtivos;
+        for (int k = 0; k < MAX_ATIVOS; ++k) {
+            const AtivoCarteira *c = &u->investimento.carteira[k];
+            memcpy(r->carteira[k].ticker, c->ticker, sizeof(c->ticker));
+            r->carteira[k].quantidade = c->quantidade;
+            r->carteira[k].precoMedio = c->precoMedio;
+            r->carteira[k].mesesAcumuladosLocal = c->mesesAcumuladosLocal;
+        }
+    }
+    /* o que for publicado daqui em diante não está nos saldos: a carga reconcilia pelo journal */
+    for (int k = 0; k < NUM_SHARDS_EXTRATO; ++k)
+        marca[k] = filaExtrato.shards[k].seqBase + atomic_load_explicit(&filaExtrato.shards[k].cauda, memory_order_relaxed);
+    memcpy(r, marca, sizeof(marca));
+    char *p = (char *)r + sizeof(marca);
+    memcpy(p, &numItens, sizeof(int));
+    alertasParaSalvar((ItemAlertaSalvo *)(p + sizeof(int)));
+    /* usuários nunca são removidos: o snapshot novo cobre o antigo por inteiro */
+    snapshotEntregar(&gravUsuarios, buf, tam);
+    return true;
+}
@@ -0,0 +1,950 @@
+#include "corretora.h"
+
+/* ======= Arquivo colunar do extrato ======= */
+
+/* dicionário global de tipos de lançamento (código = posição) */
+char tiposDic[MAX_TIPOS_DIC][32];
+int numTiposDic = 0;
+char (*ativosDic)[16] = NULL;             // código 0 = sem ativo
+int numAtivosDic = 0;
+int capAtivosDic = 0;
+int numSegmentos = 0;
+
+long long paraCentavos(float valor) {
+    double c = (double)valor * 100.0;
+    return (long long)(c >= 0 ? c + 0.5 : c - 0.5);
+}
+
+/* código do tipo no dicionário global (-1 = tipo novo com o dicionário cheio) */
+int codigoTipo(const char *tipo) {
+    for (int i = 0; i < numTiposDic; ++i)
+        if (strcmp(tiposDic[i], tipo) == 0) return i;
+    if (numTiposDic == MAX_TIPOS_DIC) return -1;
+    snprintf(tiposDic[numTiposDic], sizeof(tiposDic[0]), "%s", tipo);
+    return numTiposDic++;
+}
+
+/* código do ativo no dicionário global (0 = sem ativo ou dicionário cheio) */
+int codigoAtivo(const char *ticker) {
+    static int ultimo = 0;
+    if (!ticker || !ticker[0]) return 0;
+    if (ultimo > 0 && ultimo < numAtivosDic && strcmp(ativosDic[ultimo], ticker) == 0) return ultimo;
+    for (int i = 1; i < numAtivosDic; ++i)
+        if (strcmp(ativosDic[i], ticker) == 0) return ultimo = i;
+    if (numAtivosDic == 0) numAtivosDic = 1;      // reserva o código 0
+    if (numAtivosDic >= MAX_ATIVOS_DIC) return 0;
+    if (numAtivosDic >= capAtivosDic) {
+        int novaCap = capAtivosDic ? capAtivosDic * 2 : 64;
+        char (*n)[16] = realloc(ativosDic, sizeof(*ativosDic) * novaCap);
+        if (!n) return 0;
+        if (capAtivosDic == 0) n[0][0] = '\0';
+        ativosDic = n; capAtivosDic = novaCap;
+    }
+    snprintf(ativosDic[numAtivosDic], sizeof(ativosDic[0]), "%s", ticker);
+    return ultimo = numAtivosDic++;
+}
+
+/* ---- codec de blocos: delta-de-delta, zigzag + Stream VByte, dicionário com bits empacotados ---- */
+
+/*
+ * Modo da coluna numérica (1º byte). MODO_PREVISTO só marca a coluna de
+ * saldo gravada como resíduo da previsão (ver codificarBloco); blocos antigos
+ * não têm o bit e continuam relativos ao mínimo do bloco.
+ */
+enum { MODO_SVB = 0, MODO_BRUTO64 = 1, MODO_BITS = 2, MODO_ESPARSO = 3, MODO_PREVISTO = 0x80 };
+
+static unsigned long long zigzag(long long x) { return ((unsigned long long)x << 1) ^ (unsigned long long)(x >> 63); }
+static long long deszigzag(unsigned long long u) { return (long long)(u >> 1) ^ -(long long)(u & 1); }
+
+/* Stream VByte: 2 bits de tamanho por inteiro (bytes de controle) + bytes de dados */
+static int svbCodificar(const unsigned *v, int n, unsigned char *out) {
+    if (n <= 0) return 0;
+    int nCtrl = (n + 3) / 4;
+    unsigned char *d = out + nCtrl;
+    memset(out, 0, (size_t)nCtrl);
+    for (int i = 0; i < n; ++i) {
+        unsigned x = v[i];
+        int len = x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4;
+        out[i >> 2] |= (unsigned char)((len - 1) << ((i & 3) * 2));
+        for (int k = 0; k < len; ++k) *d++ = (unsigned char)(x >> (8 * k));
+    }
+    return (int)(d - out);
+}
+
+static void svbDecodificarEscalar(const unsigned char *ctrl, const unsigned char *d, int i, int n, unsigned *out) {
+    for (; i < n; ++i) {
+        int len = ((ctrl[i >> 2] >> ((i & 3) * 2)) & 3) + 1;
+        unsigned x = 0;
+        for (int k = 0; k < len; ++k) x |= (unsigned)d[k] << (8 * k);
+        out[i] = x;
+        d += len;
+    }
+}
+
+#ifdef USAR_SIMD_X86
+static unsigned char svbMascaras[256][16];
+static unsigned char svbTamanhos[256];
+static int simdDisponivel = -1;
+
+static void svbIniciarTabelas(void) {
+    for (int c = 0; c < 256; ++c) {
+        int pos = 0;
+        for (int k = 0; k < 4; ++k) {
+            int len = ((c >> (2 * k)) & 3) + 1;
+            for (int j = 0; j < 4; ++j)
+                svbMascaras[c][4 * k + j] = j < len ? (unsigned char)(pos + j) : 0x80;
+            pos += len;
+        }
+        svbTamanhos[c] = (unsigned char)pos;
+    }
+    simdDisponivel = __builtin_cpu_supports("ssse3") ? 1 : 0;
+}
+
+/* 4 inteiros por pshufb; o final (sem 16 bytes garantidos para a carga) vai no escalar */
+__attribute__((target("ssse3")))
+static void svbDecodificarSsse3(const unsigned char *in, int tamIn, int n, unsigned *out) {
+    const unsigned char *ctrl = in, *d = in + (n + 3) / 4, *fim = in + tamIn;
+    int i = 0;
+    for (; i + 4 <= n && d + 16 <= fim; i += 4) {
+        unsigned c = ctrl[i >> 2];
+        __m128i dados = _mm_loadu_si128((const __m128i *)d);
+        __m128i m = _mm_loadu_si128((const __m128i *)svbMascaras[c]);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_shuffle_epi8(dados, m));
+        d += svbTamanhos[c];
+    }
+    svbDecodificarEscalar(ctrl, d, i, n, out);
+}
+#endif
+
+bool codecUsarSimd = true;         // desligável para o benchmark comparar
+
+static void svbDecodificar(const unsigned char *in, int tamIn, int n, unsigned *out) {
+#ifdef USAR_SIMD_X86
+    if (simdDisponivel < 0) svbIniciarTabelas();
+    if (simdDisponivel && codecUsarSimd) { svbDecodificarSsse3(in, tamIn, n, out); return; }
+#endif
+    (void)tamIn;
+    svbDecodificarEscalar(in, in + (n + 3) / 4, 0, n, out);
+}
+
+static int codificarColunaDic(const unsigned *v, int n, unsigned char *out);
+static const unsigned char *decodificarColunaDic(const unsigned char *in, int n, unsigned *v);
+
+/*
+ * coluna numérica: zigzag e o menor entre SVB, bits empacotados (largura do
+ * maior) e esparso (bitmap dos não nulos + SVB só deles); int64 bruto se
+ * algum valor não couber em 32 bits. Empate fica com o SVB, que decodifica
+ * com SIMD.
+ */
+static int codificarColunaNum(const long long *v, int n, unsigned char *out) {
+    unsigned z[TAM_BLOCO_COL];
+    bool cabe = true;
+    unsigned maior = 0;
+    int tamSvb = (n + 3) / 4, tamEsparso = (n + 7) / 8, naoNulos = 0;
+    for (int i = 0; i < n && cabe; ++i) {
+        unsigned long long u = zigzag(v[i]);
+        if (u > 0xFFFFFFFFULL) { cabe = false; break; }
+        z[i] = (unsigned)u;
+        int len = z[i] < (1u << 8) ? 1 : z[i] < (1u << 16) ? 2 : z[i] < (1u << 24) ? 3 : 4;
+        tamSvb += len;
+        if (z[i]) { naoNulos++; tamEsparso += len; }
+        if (z[i] > maior) maior = z[i];
+    }
+    int tam;
+    if (cabe) {
+        int largura = 0;
+        while (largura < 32 && (maior >> largura) != 0) largura++;
+        int tamBits = 1 + (int)(((long long)n * largura + 7) / 8);
+        tamEsparso += (naoNulos + 3) / 4;
+        if (tamBits < tamSvb && tamBits <= tamEsparso) {
+            out[0] = MODO_BITS;
+            tam = codificarColunaDic(z, n, out + 5);
+        } else if (tamEsparso < tamSvb) {
+            out[0] = MODO_ESPARSO;
+            unsigned char *mapa = out + 5;
+            int nm = (n + 7) / 8, k = 0;
+            memset(mapa, 0, (size_t)nm);
+            for (int i = 0; i < n; ++i)
+                if (z[i]) { mapa[i >> 3] |= (unsigned char)(1u << (i & 7)); z[k++] = z[i]; }
+            tam = nm + svbCodificar(z, k, mapa + nm);
+        } else {
+            out[0] = MODO_SVB;
+            tam = svbCodificar(z, n, out + 5);
+        }
+    } else {
+        out[0] = MODO_BRUTO64;
+        tam = (int)(sizeof(long long) * n);
+        memcpy(out + 5, v, (size_t)tam);
+    }
+    memcpy(out + 1, &tam, sizeof(int));
+    return 5 + tam;
+}
+
+static const unsigned char *decodificarColunaNum(const unsigned char *in, int n, long long *v) {
+    int tam;
+    memcpy(&tam, in + 1, sizeof(int));
+    int modo = in[0] & ~MODO_PREVISTO;
+    if (modo == MODO_BRUTO64) {
+        memcpy(v, in + 5, sizeof(long long) * n);
+    } else if (modo == MODO_ESPARSO) {
+        const unsigned char *mapa = in + 5;
+        int nm = (n + 7) / 8, k = 0;
+        for (int i = 0; i < nm; ++i) k += __builtin_popcount(mapa[i]);
+        unsigned z[TAM_BLOCO_COL];
+        svbDecodificar(mapa + nm, tam - nm, k, z);
+        for (int i = 0, j = 0; i < n; ++i)
+            v[i] = (mapa[i >> 3] >> (i & 7) & 1) ? deszigzag(z[j++]) : 0;
+    } else {
+        unsigned z[TAM_BLOCO_COL];
+        if (modo == MODO_BITS) decodificarColunaDic(in + 5, n, z);
+        else svbDecodificar(in + 5, tam, n, z);
+        for (int i = 0; i < n; ++i) v[i] = deszigzag(z[i]);
+    }
+    return in + 5 + tam;
+}
+
+static const unsigned char *pularColunaNum(const unsigned char *in) {
+    int tam;
+    memcpy(&tam, in + 1, sizeof(int));
+    return in + 5 + tam;
+}
+
+/* coluna de dicionário: códigos com a menor largura de bits que cabe o maior */
+static int codificarColunaDic(const unsigned *v, int n, unsigned char *out) {
+    unsigned maior = 0;
+    for (int i = 0; i < n; ++i) if (v[i] > maior) maior = v[i];
+    int largura = 0;
+    while (largura < 32 && (maior >> largura) != 0) largura++;
+    out[0] = (unsigned char)largura;
+    int bytes = (int)(((long long)n * largura + 7) / 8);
+    memset(out + 1, 0, (size_t)bytes);
+    long long bit = 0;
+    for (int i = 0; i < n; ++i, bit += largura)
+        for (int k = 0; k < largura; ++k)
+            if (v[i] >> k & 1) out[1 + ((bit + k) >> 3)] |= (unsigned char)(1u << ((bit + k) & 7));
+    return 1 + bytes;
+}
+
+static const unsigned char *decodificarColunaDic(const unsigned char *in, int n, unsigned *v) {
+    int largura = in[0];
+    const unsigned char *d = in + 1;
+    if (largura == 8) {
+        for (int i = 0; i < n; ++i) v[i] = d[i];
+    } else {
+        unsigned long long acc = 0;
+        int bits = 0;
+        unsigned mascara = largura >= 32 ? 0xFFFFFFFFu : (1u << largura) - 1;
+        for (int i = 0; i < n; ++i) {
+            while (bits < largura) { acc |= (unsigned long long)*d++ << bits; bits += 8; }
+            v[i] = (unsigned)acc & mascara;
+            acc >>= largura; bits -= largura;
+        }
+    }
+    return in + 1 + (((long long)n * largura + 7) / 8);
+}
+
+static const unsigned char *pularColunaDic(const unsigned char *in, int n) {
+    return in + 1 + (((long long)n * in[0] + 7) / 8);
+}
+
+/*
+ * Saldo previsto: saldo anterior da mesma conta no bloco + valor - taxa (é
+ * assim que o extrato fecha o saldo); a primeira linha de cada conta no bloco
+ * prevê saldoMin. Só o resíduo vai à coluna -- zero quase sempre, e a coluna
+ * esparsa o reduz a um bit por linha. Tabela aberta por conta, tamanho
+ * potência de 2 com folga sobre TAM_BLOCO_COL.
+ */
+#define TAM_PREVISAO (2 * TAM_BLOCO_COL)
+
+typedef struct {
+    unsigned chave[TAM_PREVISAO];         // conta + 1; 0 = livre
+    long long saldo[TAM_PREVISAO];
+} PrevisaoSaldo;
+
+static long long *previsaoDaConta(PrevisaoSaldo *p, unsigned conta, bool *nova) {
+    unsigned h = (conta * 2654435761u) & (TAM_PREVISAO - 1);
+    while (p->chave[h] != 0 && p->chave[h] != conta + 1) h = (h + 1) & (TAM_PREVISAO - 1);
+    *nova = p->chave[h] == 0;
+    p->chave[h] = conta + 1;
+    return &p->saldo[h];
+}
+
+/*
+ * Bloco comprimido: ts (delta-de-delta), valor, taxa, saldo (resíduo da
+ * previsão acima), tipo, ativo, conta. Retorna o tamanho em bytes.
+ */
+int codificarBloco(const LinhaArquivo *l, int n, long long tsBase, long long saldoBase, unsigned char *out) {
+    if (n <= 0 || n > TAM_BLOCO_COL) return 0;
+    long long v[TAM_BLOCO_COL] = { 0 };
+    unsigned c[TAM_BLOCO_COL] = { 0 };
+    unsigned char *p = out;
+    long long deltaAnt = 0, tsAnt = tsBase;
+    for (int i = 0; i < n; ++i) {
+        long long delta = l[i].ts - tsAnt;
+        v[i] = delta - deltaAnt;
+        deltaAnt = delta; tsAnt = l[i].ts;
+    }
+    p += codificarColunaNum(v, n, p);
+    for (int i = 0; i < n; ++i) v[i] = l[i].valor;
+    p += codificarColunaNum(v, n, p);
+    for (int i = 0; i < n; ++i) v[i] = l[i].taxa;
+    p += codificarColunaNum(v, n, p);
+    PrevisaoSaldo prev;
+    memset(prev.chave, 0, sizeof(prev.chave));
+    for (int i = 0; i < n; ++i) {
+        bool nova;
+        long long *s = previsaoDaConta(&prev, l[i].conta, &nova);
+        v[i] = l[i].saldo - (nova ? saldoBase : *s + l[i].valor - l[i].taxa);
+        *s = l[i].saldo;
+    }
+    unsigned char *col = p;
+    p += codificarColunaNum(v, n, p);
+    *col |= MODO_PREVISTO;
+    for (int i = 0; i < n; ++i) c[i] = l[i].tipo;
+    p += codificarColunaDic(c, n, p);
+    for (int i = 0; i < n; ++i) c[i] = l[i].ativo;
+    p += codificarColunaDic(c, n, p);
+    for (int i = 0; i < n; ++i) c[i] = l[i].conta;
+    p += codificarColunaDic(c, n, p);
+    return (int)(p - out);
+}
+
+/* decodifica as colunas pedidas (máscara COL_*) do bloco b, em qualquer codec */
+bool decodificarBloco(const SegmentoColunar *seg, int b, int colunas, BlocoDecodificado *out) {
+    const ZonaBloco *z = &seg->zonas[b];
+    int n = z->linhas;
+    if (seg->info->codec == CODEC_FIXO) {
+        const unsigned *col = (const unsigned *)(seg->base + z->offset);
+        const unsigned char *tp = (const unsigned char *)(col + 5 * (size_t)n);
+        for (int i = 0; i < n; ++i) {
+            if (colunas & COL_TS) out->ts[i] = z->tsMin + col[i];
+            if (colunas & COL_VALOR) out->valor[i] = z->valorMin + col[n + i];
+            if (colunas & COL_TAXA) out->taxa[i] = z->taxaMin + col[2 * n + i];
+            if (colunas & COL_SALDO) out->saldo[i] = z->saldoMin + col[3 * n + i];
+            if (colunas & COL_CONTA) out->conta[i] = col[4 * n + i];
+            if (colunas & COL_TIPO) out->tipo[i] = tp[i];
+            if (colunas & COL_ATIVO) out->ativo[i] = 0;
+        }
+        return true;
+    }
+
+    const unsigned char *p = (const unsigned char *)seg->base + z->offset;
+    unsigned c[TAM_BLOCO_COL];
+    /* saldo previsto precisa de valor, taxa e conta para se reconstruir */
+    if (colunas & COL_SALDO) colunas |= COL_VALOR | COL_TAXA | COL_CONTA;
+    if (colunas & COL_TS) {
+        p = decodificarColunaNum(p, n, out->ts);
+        long long ts = z->tsMin, delta = 0;
+        for (int i = 0; i < n; ++i) { delta += out->ts[i]; ts += delta; out->ts[i] = ts; }
+    } else p = pularColunaNum(p);
+    if (colunas & COL_VALOR) p = decodificarColunaNum(p, n, out->valor); else p = pularColunaNum(p);
+    if (colunas & COL_TAXA) p = decodificarColunaNum(p, n, out->taxa); else p = pularColunaNum(p);
+    bool previsto = (*p & MODO_PREVISTO) != 0;
+    if (colunas & COL_SALDO) {
+        p = decodificarColunaNum(p, n, out->saldo);
+        if (!previsto)
+            for (int i = 0; i < n; ++i) out->saldo[i] += z->saldoMin;
+    } else p = pularColunaNum(p);
+    if (colunas & COL_TIPO) {
+        p = decodificarColunaDic(p, n, c);
+        for (int i = 0; i < n; ++i) out->tipo[i] = (unsigned char)c[i];
+    } else p = pularColunaDic(p, n);
+    if (colunas & COL_ATIVO) {
+        p = decodificarColunaDic(p, n, c);
+        for (int i = 0; i < n; ++i) out->ativo[i] = (unsigned short)c[i];
+    } else p = pularColunaDic(p, n);
+    if (colunas & COL_CONTA) decodificarColunaDic(p, n, out->conta);
+    if ((colunas & COL_SALDO) && previsto) {
+        PrevisaoSaldo prev;
+        memset(prev.chave, 0, sizeof(prev.chave));
+        for (int i = 0; i < n; ++i) {
+            bool nova;
+            long long *s = previsaoDaConta(&prev, out->conta[i], &nova);
+            out->saldo[i] += nova ? z->saldoMin : *s + out->valor[i] - out->taxa[i];
+            *s = out->saldo[i];
+        }
+    }
+    return true;
+}
+
+#ifdef _WIN32
+char *mapearArquivo(const char *arq, size_t *tam) {
+    HANDLE h = CreateFileA(arq, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER t;
+    if (!GetFileSizeEx(h, &t) || t.QuadPart == 0) { CloseHandle(h); return NULL; }
+    HANDLE m = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(h);
+    if (!m) return NULL;
+    char *p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(m);
+    *tam = (size_t)t.QuadPart;
+    return p;
+}
+void desmapearArquivo(char *p, size_t tam) { (void)tam; UnmapViewOfFile(p); }
+#else
+char *mapearArquivo(const char *arq, size_t *tam) {
+    int fd = open(arq, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return NULL; }
+    char *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    *tam = (size_t)st.st_size;
+    return p;
+}
+void desmapearArquivo(char *p, size_t tam) { munmap(p, tam); }
+#endif
+
+static void nomeSegmento(char *out, int size, int num) {
+    snprintf(out, size, DIR_ARQUIVO "%06d.col", num);
+}
+
+static int compararLinhaArquivo(const void *a, const void *b) {
+    const LinhaArquivo *x = a, *y = b;
+    if (x->ts != y->ts) return (x->ts > y->ts) - (x->ts < y->ts);
+    return (x->conta > y->conta) - (x->conta < y->conta);
+}
+
+/* cabe mais uma linha no bloco sem estourar o uint32 de alguma coluna? */
+static bool cabeNoBloco(const ZonaBloco *z, const LinhaArquivo *l, long long taxaMax, long long saldoMax) {
+    if (z->linhas == 0) return true;
+    if (z->linhas == TAM_BLOCO_COL) return false;
+    long long tsMin = l->ts < z->tsMin ? l->ts : z->tsMin, tsMax = l->ts > z->tsMax ? l->ts : z->tsMax;
+    long long vMin = l->valor < z->valorMin ? l->valor : z->valorMin, vMax = l->valor > z->valorMax ? l->valor : z->valorMax;
+    long long tMin = l->taxa < z->taxaMin ? l->taxa : z->taxaMin, tMax = l->taxa > taxaMax ? l->taxa : taxaMax;
+    long long sMin = l->saldo < z->saldoMin ? l->saldo : z->saldoMin, sMax = l->saldo > saldoMax ? l->saldo : saldoMax;
+    return tsMax - tsMin <= 0xFFFFFFFFLL && vMax - vMin <= 0xFFFFFFFFLL &&
+           tMax - tMin <= 0xFFFFFFFFLL && sMax - sMin <= 0xFFFFFFFFLL;
+}
+
+/*
+ * Layout: cabeçalho | InfoSegmento | tipos[numTipos][32] | contas[] | zonas[] |
+ * (CODEC_COMPRIMIDO: numAtivos + ativos[][16]) | blocos.
+ * CODEC_FIXO: ts, valor, taxa, saldo, conta em uint32 (relativos ao mínimo do
+ * bloco) e tipo em uint8 -- varredura direta na velocidade da memória.
+ * CODEC_COMPRIMIDO: ver codificarBloco -- ocupa bem menos disco e page cache.
+ * As linhas são ordenadas por tempo para que os mapas de zona sejam seletivos.
+ */
+bool escreverSegmento(const char *arq, LinhaArquivo *linhas, long long n, const ContaSegmento *contas, int numContas, int codec) {
+    qsort(linhas, (size_t)n, sizeof(LinhaArquivo), compararLinhaArquivo);
+
+    /* primeira passada: fecha blocos e calcula os mapas de zona */
+    int capZonas = (int)(n / TAM_BLOCO_COL) + 16;
+    ZonaBloco *zonas = calloc((size_t)capZonas, sizeof(ZonaBloco));
+    if (!zonas) return false;
+    int numBlocos = 0;
+    long long taxaMax = 0, saldoMax = 0;
+    for (long long i = 0; i < n; ++i) {
+        LinhaArquivo *l = &linhas[i];
+        ZonaBloco *z = numBlocos ? &zonas[numBlocos - 1] : NULL;
+        if (!z || !cabeNoBloco(z, l, taxaMax, saldoMax)) {
+            if (numBlocos == capZonas) {
+                ZonaBloco *nz = realloc(zonas, sizeof(ZonaBloco) * (size_t)capZonas * 2);
+                if (!nz) { free(zonas); return false; }
+                zonas = nz; capZonas *= 2;
+            }
+            z = &zonas[numBlocos++];
+            memset(z, 0, sizeof(*z));
+            z->tsMin = z->tsMax = l->ts;
+            z->valorMin = z->valorMax = l->valor;
+            z->taxaMin = taxaMax = l->taxa;
+            z->saldoMin = saldoMax = l->saldo;
+        }
+        if (l->ts < z->tsMin) z->tsMin = l->ts;
+        if (l->ts > z->tsMax) z->tsMax = l->ts;
+        if (l->valor < z->valorMin) z->valorMin = l->valor;
+        if (l->valor > z->valorMax) z->valorMax = l->valor;
+        if (l->taxa < z->taxaMin) z->taxaMin = l->taxa;
+        if (l->taxa > taxaMax) taxaMax = l->taxa;
+        if (l->saldo < z->saldoMin) z->saldoMin = l->saldo;
+        if (l->saldo > saldoMax) saldoMax = l->saldo;
+        z->mascaraTipos |= 1ULL << l->tipo;
+        z->linhas++;
+    }
+
+    InfoSegmento info = { n, numBlocos, numTiposDic, numContas, codec };
+    char tmp[80];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", arq);
+    FILE *fp = fopen(tmp, "wb");
+    unsigned *col = malloc(sizeof(unsigned) * TAM_BLOCO_COL);
+    unsigned char *bloco = malloc(64 * TAM_BLOCO_COL);       // folga para o pior caso do codec
+    bool ok = fp && col && bloco;
+    long long posZonas = 0;
+    if (ok) {
+        CabecalhoArquivo c;
+        preencherCabecalho(&c, "COLUNAR", (int)sizeof(ZonaBloco));
+        ok = fwrite(&c, sizeof(c), 1, fp) == 1 && fwrite(&info, sizeof(info), 1, fp) == 1
+          && fwrite(tiposDic, sizeof(tiposDic[0]), (size_t)numTiposDic, fp) == (size_t)numTiposDic
+          && fwrite(contas, sizeof(ContaSegmento), (size_t)numContas, fp) == (size_t)numContas;
+        posZonas = ftell(fp);
+        /* zonas provisórias: offsets e tamanhos só são conhecidos depois de gravar os blocos */
+        ok = ok && fwrite(zonas, sizeof(ZonaBloco), (size_t)numBlocos, fp) == (size_t)numBlocos;
+        if (ok && codec == CODEC_COMPRIMIDO) {
+            int nAtivos = numAtivosDic ? numAtivosDic : 1;
+            char vazio[16] = "";
+            ok = fwrite(&nAtivos, sizeof(int), 1, fp) == 1
+              && (numAtivosDic ? fwrite(ativosDic, sizeof(ativosDic[0]), (size_t)numAtivosDic, fp) == (size_t)numAtivosDic
+                               : fwrite(vazio, sizeof(vazio), 1, fp) == 1);
+        }
+    }
+    long long linha = 0;
+    for (int b = 0; ok && b < numBlocos; ++b) {
+        ZonaBloco *z = &zonas[b];
+        LinhaArquivo *l = &linhas[linha];
+        static const char zeros[64];
+        long long pos = ftell(fp);
+        z->offset = (pos + 63) & ~63LL;              // blocos alinhados a linha de cache
+        if (z->offset > pos) ok = fwrite(zeros, 1, (size_t)(z->offset - pos), fp) == (size_t)(z->offset - pos);
+        if (codec == CODEC_COMPRIMIDO) {
+            z->tamComprimido = codificarBloco(l, z->linhas, z->tsMin, z->saldoMin, bloco);
+            ok = ok && fwrite(bloco, 1, (size_t)z->tamComprimido, fp) == (size_t)z->tamComprimido;
+        } else {
+            for (int col_i = 0; ok && col_i < 5; ++col_i) {
+                for (int i = 0; i < z->linhas; ++i) {
+                    switch (col_i) {
+                        case 0: col[i] = (unsigned)(l[i].ts - z->tsMin); break;
+                        case 1: col[i] = (unsigned)(l[i].valor - z->valorMin); break;
+                        case 2: col[i] = (unsigned)(l[i].taxa - z->taxaMin); break;
+                        case 3: col[i] = (unsigned)(l[i].saldo - z->saldoMin); break;
+                        default: col[i] = l[i].conta; break;
+                    }
+                }
+                ok = fwrite(col, sizeof(unsigned), (size_t)z->linhas, fp) == (size_t)z->linhas;
+            }
+            for (int i = 0; ok && i < z->linhas; ++i) bloco[i] = l[i].tipo;
+            if (ok) ok = fwrite(bloco, 1, (size_t)z->linhas, fp) == (size_t)z->linhas;
+        }
+        linha += z->linhas;
+    }
+    if (ok) {
+        ok = fseek(fp, posZonas, SEEK_SET) == 0
+          && fwrite(zonas, sizeof(ZonaBloco), (size_t)numBlocos, fp) == (size_t)numBlocos;
+    }
+    /* como o snapshot: dados no disco antes do rename, e o rename no disco antes de retornar */
+    ok = ok && fflush(fp) == 0 && sincronizarDados(fileno(fp));
+    if (fp && fclose(fp) != 0) ok = false;
+    if (ok) ok = substituirArquivo(tmp, arq);
+    else remove(tmp);
+    free(col); free(bloco); free(zonas);
+    return ok;
+}
+
+bool abrirSegmento(const char *arq, SegmentoColunar *seg) {
+    memset(seg, 0, sizeof(*seg));
+    seg->base = mapearArquivo(arq, &seg->tam);
+    if (!seg->base) return false;
+    CabecalhoArquivo esperado;
+    preencherCabecalho(&esperado, "COLUNAR", (int)sizeof(ZonaBloco));
+    size_t pos = sizeof(CabecalhoArquivo) + sizeof(InfoSegmento);
+    if (seg->tam < pos || memcmp(seg->base, &esperado, sizeof(esperado)) != 0) { fecharSegmento(seg); return false; }
+    seg->info = (const InfoSegmento *)(seg->base + sizeof(CabecalhoArquivo));
+    const InfoSegmento *in = seg->info;
+    if (in->numTipos < 0 || in->numTipos > MAX_TIPOS_DIC || in->numContas < 0 || in->numBlocos < 0
+        || (size_t)in->numContas > seg->tam || (size_t)in->numBlocos > seg->tam
+        || (in->codec != CODEC_FIXO && in->codec != CODEC_COMPRIMIDO)) { fecharSegmento(seg); return false; }
+    seg->tipos = (const char (*)[32])(seg->base + pos);
+    pos += sizeof(tiposDic[0]) * seg->info->numTipos;
+    seg->contas = (const ContaSegmento *)(seg->base + pos);
+    pos += sizeof(ContaSegmento) * seg->info->numContas;
+    seg->zonas = (const ZonaBloco *)(seg->base + pos);
+    pos += sizeof(ZonaBloco) * seg->info->numBlocos;
+    if (pos > seg->tam) { fecharSegmento(seg); return false; }
+    if (seg->info->codec == CODEC_COMPRIMIDO) {
+        if (pos + sizeof(int) > seg->tam) { fecharSegmento(seg); return false; }
+        memcpy(&seg->numAtivos, seg->base + pos, sizeof(int));
+        pos += sizeof(int);
+        if (seg->numAtivos < 0 || (size_t)seg->numAtivos > seg->tam) { fecharSegmento(seg); return false; }
+        seg->ativos = (const char (*)[16])(seg->base + pos);
+        pos += sizeof(seg->ativos[0]) * seg->numAtivos;
+        if (pos > seg->tam) { fecharSegmento(seg); return false; }
+    }
+    /* cada bloco tem de caber no arquivo, depois do diretório: um segmento corrompido é recusado inteiro */
+    long long linhas = 0;
+    for (int b = 0; b < in->numBlocos; ++b) {
+        const ZonaBloco *z = &seg->zonas[b];
+        long long bytes = in->codec == CODEC_FIXO ? (long long)z->linhas * (long long)(5 * sizeof(unsigned) + 1) : z->tamComprimido;
+        if (z->linhas < 0 || z->linhas > TAM_BLOCO_COL || bytes < 0 || z->offset < (long long)pos
+            || z->offset > (long long)seg->tam - bytes || (in->codec == CODEC_FIXO && z->offset % sizeof(unsigned) != 0)) {
+            fecharSegmento(seg);
+            return false;
+        }
+        linhas += z->linhas;
+    }
+    if (linhas != in->numLinhas) { fecharSegmento(seg); return false; }
+    return true;
+}
+
+void fecharSegmento(SegmentoColunar *seg) {
+    if (seg->base) desmapearArquivo(seg->base, seg->tam);
+    seg->base = NULL;
+}
+
+static int tipoNoSegmento(const SegmentoColunar *seg, const char *tipo) {
+    for (int i = 0; i < seg->info->numTipos; ++i)
+        if (strncmp(seg->tipos[i], tipo, 32) == 0) return i;
+    return -1;
+}
+
+/*
+ * Segmentos selados são imutáveis: cada um é mapeado uma vez (na carga ou
+ * na primeira consulta depois de selado) e fica mapeado até o fim.
+ */
+static SegmentoColunar *segmentosMapeados;
+static int capSegmentosMapeados;
+
+/* segmento 'num' (1..numSegmentos) já mapeado; NULL se não abrir */
+const SegmentoColunar *segmentoMapeado(int num) {
+    if (num < 1 || num > numSegmentos) return NULL;
+    if (num > capSegmentosMapeados) {
+        int novaCap = capSegmentosMapeados ? capSegmentosMapeados : 16;
+        while (novaCap < num) novaCap *= 2;
+        SegmentoColunar *n = realloc(segmentosMapeados, sizeof(SegmentoColunar) * (size_t)novaCap);
+        if (!n) return NULL;
+        memset(n + capSegmentosMapeados, 0, sizeof(SegmentoColunar) * (size_t)(novaCap - capSegmentosMapeados));
+        segmentosMapeados = n; capSegmentosMapeados = novaCap;
+    }
+    SegmentoColunar *seg = &segmentosMapeados[num - 1];
+    if (!seg->base) {
+        char arq[64];
+        nomeSegmento(arq, sizeof(arq), num);
+        if (!abrirSegmento(arq, seg)) return NULL;
+    }
+    return seg;
+}
+
+void liberarSegmentosMapeados(void) {
+    for (int i = 0; i < capSegmentosMapeados; ++i) fecharSegmento(&segmentosMapeados[i]);
+    free(segmentosMapeados);
+    segmentosMapeados = NULL;
+    capSegmentosMapeados = 0;
+}
+
+/* descobre os segmentos existentes e até onde cada conta já foi selada */
+void carregarSegmentos(void) {
+    liberarSegmentosMapeados();
+    numSegmentos = 0;
+    for (;;) {
+        numSegmentos++;
+        const SegmentoColunar *seg = segmentoMapeado(numSegmentos);
+        if (!seg) { numSegmentos--; break; }
+        for (int i = 0; i < seg->info->numTipos; ++i) codigoTipo(seg->tipos[i]);
+        for (int i = 1; i < seg->numAtivos; ++i) codigoAtivo(seg->ativos[i]);
+        for (int i = 0; i < seg->info->numContas; ++i) {
+            const ContaSegmento *c = &seg->contas[i];
+            Usuario *u = buscarUsuarioPorCpf(c->cpf);
+            if (!u) continue;
+            unsigned long long *prox = c->conta == CONTA_BANCO ? &u->banco.seqArquivar : &u->investimento.seqArquivar;
+            if (c->seqMax + 1 > *prox) *prox = c->seqMax + 1;
+        }
+    }
+}
+
+/*
+ * Sela num novo segmento todos os lançamentos ainda não arquivados com
+ * ts <= tsCorte. O extrato em memória continua com sua cópia.
+ * Retorna quantos lançamentos foram selados (-1 em erro de gravação, -2 se
+ * algum tipo não couber no dicionário: o segmento guardaria o tipo errado).
+ */
+int selarExtratos(long long tsCorte) {
+    sincronizarExtrato(&filaExtrato);
+    long long n = 0;
+    int numContas = 0;
+    for (int i = 0; i < numUsuarios; ++i) {
+        for (int conta = 0; conta < 2; ++conta) {
+            Usuario *u = usuarios[i];
+            Transacao *ext = conta == CONTA_BANCO ? u->banco.extrato : u->investimento.extrato;
+            int num = conta == CONTA_BANCO ? u->banco.numTransacoes : u->investimento.numTransacoes;
+            unsigned long long prox = conta == CONTA_BANCO ? u->banco.seqArquivar : u->investimento.seqArquivar;
+            bool temConta = false;
+            for (int k = 0; k < num; ++k)
+                if (ext[k].seq >= prox && ext[k].ts <= tsCorte) {
+                    if (codigoTipo(ext[k].tipo) < 0) return -2;
+                    n++;
+                    temConta = true;
+                }
+            if (temConta) numContas++;
+        }
+    }
+    if (n == 0) return 0;
+
+    LinhaArquivo *linhas = malloc(sizeof(LinhaArquivo) * (size_t)n);
+    ContaSegmento *contas = calloc((size_t)numContas, sizeof(ContaSegmento));
+    if (!linhas || !contas) { free(linhas); free(contas); return -1; }
+
+    long long l = 0;
+    int c = 0;
+    for (int i = 0; i < numUsuarios; ++i) {
+        for (int conta = 0; conta < 2; ++conta) {
+            Usuario *u = usuarios[i];
+            Transacao *ext = conta == CONTA_BANCO ? u->banco.extrato : u->investimento.extrato;
+            int num = conta == CONTA_BANCO ? u->banco.numTransacoes : u->investimento.numTransacoes;
+            unsigned long long prox = conta == CONTA_BANCO ? u->banco.seqArquivar : u->investimento.seqArquivar;
+            bool temConta = false;
+            for (int k = 0; k < num; ++k) {
+                Transacao *t = &ext[k];
+                if (t->seq < prox || t->ts > tsCorte) continue;
+                if (!temConta) {
+                    memcpy(contas[c].cpf, u->cpf, sizeof(contas[c].cpf));
+                    contas[c].conta = conta;
+                    temConta = true;
+                }
+                contas[c].seqMax = t->seq;
+                LinhaArquivo *la = &linhas[l++];
+                la->ts = t->ts;
+                la->valor = paraCentavos(t->valor);
+                la->taxa = paraCentavos(t->taxa);
+                la->saldo = paraCentavos(t->saldoFinal);
+                la->conta = (unsigned)c;
+                la->tipo = (unsigned char)codigoTipo(t->tipo);
+                la->ativo = (unsigned short)codigoAtivo(t->ativo);
+            }
+            if (temConta) c++;
+        }
+    }
+
+    char arq[64];
+    nomeSegmento(arq, sizeof(arq), numSegmentos + 1);
+    bool ok = escreverSegmento(arq, linhas, n, contas, numContas, CODEC_COMPRIMIDO);
+    if (ok) {
+        numSegmentos++;
+        for (int k = 0; k < numContas; ++k) {
+            Usuario *u = buscarUsuarioPorCpf(contas[k].cpf);
+            if (!u) continue;
+            if (contas[k].conta == CONTA_BANCO) u->banco.seqArquivar = contas[k].seqMax + 1;
+            else u->investimento.seqArquivar = contas[k].seqMax + 1;
+        }
+    }
+    free(linhas); free(contas);
+    return ok ? (int)n : -1;
+}
+
+/*
+ * Soma (centavos) do valor dos lançamentos de um tipo em [tsIni, tsFim).
+ * Blocos cujo mapa de zona não cruza o período ou não contém o tipo nem são
+ * tocados; dentro do bloco o laço é sem desvios (o compilador vetoriza).
+ * 'bd' é a área de decodificação do chamador (só usada em CODEC_COMPRIMIDO).
+ */
+long long somarArquivoPorTipo(const SegmentoColunar *seg, int tipo, long long tsIni, long long tsFim, BlocoDecodificado *bd,
+                              long long *linhas, int *blocosLidos, int *blocosPulados) {
+    long long soma = 0;
+    for (int b = 0; b < seg->info->numBlocos; ++b) {
+        const ZonaBloco *z = &seg->zonas[b];
+        if (z->tsMax < tsIni || z->tsMin >= tsFim || !(z->mascaraTipos & (1ULL << tipo))) { (*blocosPulados)++; continue; }
+        (*blocosLidos)++;
+        int n = z->linhas;
+        if (seg->info->codec == CODEC_COMPRIMIDO) {
+            bool inteiro = z->tsMin >= tsIni && z->tsMax < tsFim;
+            decodificarBloco(seg, b, COL_VALOR | COL_TIPO | (inteiro ? 0 : COL_TS), bd);
+            long long s = 0, cont = 0;
+            for (int i = 0; i < n; ++i) {
+                long long m = (bd->tipo[i] == (unsigned char)tipo) & (inteiro || (bd->ts[i] >= tsIni && bd->ts[i] < tsFim));
+                s += bd->valor[i] & -m;
+                cont += m;
+            }
+            soma += s;
+            *linhas += cont;
+            continue;
+        }
+        const unsigned *ts = (const unsigned *)(seg->base + z->offset);
+        const unsigned *valor = ts + n;
+        const unsigned char *tp = (const unsigned char *)(ts + 5 * (size_t)n);
+        unsigned long long somaDelta = 0;
+        unsigned cont = 0;
+        if (z->tsMin >= tsIni && z->tsMax < tsFim) {
+            for (int i = 0; i < n; ++i) {
+                unsigned m = tp[i] == (unsigned char)tipo;
+                somaDelta += (unsigned long long)(valor[i] & -m);
+                cont += m;
+            }
+        } else {
+            /* bloco parcial: compara o delta do tempo sem reconstruir o timestamp */
+            unsigned lo = tsIni > z->tsMin ? (unsigned)(tsIni - z->tsMin) : 0u;
+            unsigned long long hi64 = (unsigned long long)(tsFim - z->tsMin);
+            unsigned hi = hi64 > 0xFFFFFFFFULL ? 0xFFFFFFFFu : (unsigned)hi64;
+            bool hiAberto = hi64 > 0xFFFFFFFFULL;
+            for (int i = 0; i < n; ++i) {
+                unsigned m = (tp[i] == (unsigned char)tipo) & (ts[i] >= lo) & (hiAberto | (ts[i] < hi));
+                somaDelta += (unsigned long long)(valor[i] & -m);
+                cont += m;
+            }
+        }
+        soma += (long long)somaDelta + (long long)cont * z->valorMin;
+        *linhas += cont;
+    }
+    return soma;
+}
+
+long long inicioDoAno(int ano) {
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = ano - 1900;
+    t.tm_mday = 1;
+    t.tm_isdst = -1;
+    return (long long)mktime(&t);
+}
+
+/* ex.: soma de Provento em 2025 para todos os usuários */
+void consultarArquivoPorTipoAno(void) {
+    char tipo[32];
+    int ano;
+    printf("\nTipo de lançamento (ex.: Provento, Compra, Venda): ");
+    if (scanf("%31s", tipo) != 1) { clear_input(); printf("Entrada inválida.\n"); return; }
+    printf("Ano: ");
+    if (scanf("%d", &ano) != 1) { clear_input(); printf("Entrada inválida.\n"); return; }
+
+    long long tsIni = inicioDoAno(ano), tsFim = inicioDoAno(ano + 1);
+    long long soma = 0, linhas = 0;
+    int lidos = 0, pulados = 0;
+    BlocoDecodificado *bd = malloc(sizeof(BlocoDecodificado));
+    if (!bd) { printf("Memória insuficiente.\n"); return; }
+    double t0 = cronometro_seg();
+    for (int k = 1; k <= numSegmentos; ++k) {
+        const SegmentoColunar *seg = segmentoMapeado(k);
+        if (!seg) continue;
+        int tipoSeg = tipoNoSegmento(seg, tipo);
+        if (tipoSeg >= 0) soma += somarArquivoPorTipo(seg, tipoSeg, tsIni, tsFim, bd, &linhas, &lidos, &pulados);
+        else pulados += seg->info->numBlocos;
+    }
+    double t1 = cronometro_seg();
+    free(bd);
+    printf("%s em %d (todos os usuários, arquivo selado): R$ %.2f em %lld lançamentos\n",
+           tipo, ano, (double)soma / 100.0, linhas);
+    printf("Blocos lidos: %d | pulados pelo mapa de zona: %d | %.3f ms\n", lidos, pulados, (t1 - t0) * 1e3);
+}
+
+/* gera um segmento sintético grande e mede a varredura (soma de um tipo num ano) */
+void benchmarkVarreduraArquivo(void) {
+    const long long n = 20000000;
+    const char *arq = "bench_colunar.tmp";
+    printf("\n=== Benchmark: varredura colunar de %lld lançamentos ===\n", n);
+    LinhaArquivo *linhas = malloc(sizeof(LinhaArquivo) * (size_t)n);
+    ContaSegmento conta;
+    memset(&conta, 0, sizeof(conta));
+    if (!linhas) { printf("Memória insuficiente.\n"); return; }
+
+    const char *tipos[] = { "Depósito", "Compra", "Venda", "Provento", "PIX", "TED" };
+    int codigos[6];
+    for (int i = 0; i < 6; ++i)
+        if ((codigos[i] = codigoTipo(tipos[i])) < 0) { printf("Dicionário de tipos cheio.\n"); free(linhas); return; }
+    long long ts0 = inicioDoAno(2021), ts1 = inicioDoAno(2026);
+    unsigned semente = 987654321u;
+    for (long long i = 0; i < n; ++i) {
+        aleatorio(&semente);
+        linhas[i].ts = ts0 + (ts1 - ts0) * i / n;
+        linhas[i].valor = (long long)((semente >> 8) % 100000);
+        linhas[i].taxa = 0;
+        linhas[i].saldo = (long long)((semente >> 4) % 10000000);
+        linhas[i].conta = 0;
+        linhas[i].tipo = (unsigned char)codigos[(semente >> 24) % 6];
+    }
+    double t0 = cronometro_seg();
+    bool ok = escreverSegmento(arq, linhas, n, &conta, 1, CODEC_FIXO);
+    double t1 = cronometro_seg();
+    free(linhas);
+    SegmentoColunar seg;
+    if (!ok || !abrirSegmento(arq, &seg)) { printf("Falha ao gravar %s.\n", arq); remove(arq); return; }
+    printf("Selagem: %.2f s | arquivo: %.1f MB (%.1f bytes/lançamento, Transacao tem %d)\n",
+           t1 - t0, seg.tam / 1e6, (double)seg.tam / n, (int)sizeof(Transacao));
+
+    int provento = tipoNoSegmento(&seg, "Provento");
+    for (int rodada = 0; rodada < 2; ++rodada) {
+        long long linhasSoma = 0;
+        int lidos = 0, pulados = 0;
+        long long tsIni = rodada == 0 ? ts0 : inicioDoAno(2025);
+        long long tsFim = rodada == 0 ? ts1 : inicioDoAno(2026);
+        double a = cronometro_seg();
+        long long soma = somarArquivoPorTipo(&seg, provento, tsIni, tsFim, NULL, &linhasSoma, &lidos, &pulados);
+        double b = cronometro_seg();
+        /* bytes efetivamente lidos: colunas valor + tipo (+ ts nos blocos parciais) dos blocos não pulados */
+        double bytes = (double)lidos * TAM_BLOCO_COL * (2 * sizeof(unsigned) + 1);
+        printf("Provento %s: R$ %.2f (%lld linhas) | %d blocos lidos, %d pulados | %.2f ms | %.2f GB/s\n",
+               rodada == 0 ? "2021-2025" : "2025     ", soma / 100.0, linhasSoma, lidos, pulados,
+               (b - a) * 1e3, bytes / (b - a) / 1e9);
+    }
+    fecharSegmento(&seg);
+    remove(arq);
+}
+
+/* mede taxa de compressão e vazão de decodificação do codec (SIMD x escalar) */
+void benchmarkCodec(void) {
+    const long long n = 4000000;
+    const char *arq = "bench_codec.tmp";
+    printf("\n=== Benchmark do codec de arquivo: %lld lançamentos ===\n", n);
+    LinhaArquivo *linhas = malloc(sizeof(LinhaArquivo) * (size_t)n);
+    BlocoDecodificado *bd = malloc(sizeof(BlocoDecodificado));
+    ContaSegmento *contas = calloc(1000, sizeof(ContaSegmento));
+    if (!linhas || !bd || !contas) { printf("Memória insuficiente.\n"); free(linhas); free(bd); free(contas); return; }
+
+    /* massa parecida com a real: 1000 contas, lançamentos a cada ~40 s, valores e saldos em centavos */
+    const char *tipos[] = { "Depósito", "Compra", "Venda", "Provento", "PIX", "TED" };
+    const char *tickers[] = { "", "SANEPAR", "CEMIG", "BBAS3", "ITAU", "HGLG11" };
+    int codTipos[6], codAtivos[6];
+    for (int i = 0; i < 6; ++i) { codTipos[i] = codigoTipo(tipos[i]); codAtivos[i] = codigoAtivo(tickers[i]); }
+    for (int i = 0; i < 6; ++i)
+        if (codTipos[i] < 0) { printf("Dicionário de tipos cheio.\n"); free(linhas); free(bd); free(contas); return; }
+    long long saldos[1000];
+    for (int i = 0; i < 1000; ++i) saldos[i] = 1000000 + i * 1000;
+    unsigned semente = 42u;
+    long long ts = inicioDoAno(2020);
+    for (long long i = 0; i < n; ++i) {
+        aleatorio(&semente);
+        int conta = (int)((semente >> 8) % 1000);
+        int t = (int)((semente >> 20) % 6);
+        ts += 20 + (semente >> 26) % 40;
+        long long valor = (long long)((semente >> 6) % 50000) - (t == 1 ? 50000 : 0);
+        long long taxa = t == 5 ? valor / 100 : 0;
+        saldos[conta] += valor - taxa;               // como o extrato fecha o saldo
+        linhas[i].ts = ts;
+        linhas[i].valor = valor;
+        linhas[i].taxa = taxa;
+        linhas[i].saldo = saldos[conta];
+        linhas[i].conta = (unsigned)conta;
+        linhas[i].tipo = (unsigned char)codTipos[t];
+        linhas[i].ativo = (unsigned short)codAtivos[(t >= 1 && t <= 3) ? 1 + (semente >> 12) % 5 : 0];
+    }
+
+    double t0 = cronometro_seg();
+    bool ok = escreverSegmento(arq, linhas, n, contas, 1000, CODEC_COMPRIMIDO);
+    double t1 = cronometro_seg();
+    SegmentoColunar seg;
+    if (!ok || !abrirSegmento(arq, &seg)) { printf("Falha ao gravar %s.\n", arq); remove(arq); free(linhas); free(bd); free(contas); return; }
+
+    /* ida e volta: escreverSegmento ordenou 'linhas' na mesma ordem do arquivo */
+    long long divergencias = 0, linha = 0;
+    for (int b = 0; b < seg.info->numBlocos; ++b) {
+        decodificarBloco(&seg, b, COL_TODAS, bd);
+        for (int i = 0; i < seg.zonas[b].linhas; ++i, ++linha) {
+            LinhaArquivo *l = &linhas[linha];
+            if (bd->ts[i] != l->ts || bd->valor[i] != l->valor || bd->taxa[i] != l->taxa || bd->saldo[i] != l->saldo
+                || bd->conta[i] != l->conta || bd->tipo[i] != l->tipo || bd->ativo[i] != l->ativo) divergencias++;
+        }
+    }
+    free(linhas);
+    printf("Ida e volta: %s (%lld divergências)\n", divergencias == 0 ? "OK" : "FALHA", divergencias);
+    /* a razão vale contra as colunas que o segmento guarda; descrição, data formatada e seq ficam de fora */
+    double bruto = (double)n * (4 * sizeof(long long) + sizeof(unsigned) + sizeof(unsigned short) + sizeof(unsigned char));
+    double registro = (double)n * sizeof(Transacao);
+    printf("Codificação: %.2f s | %.1f MB comprimido x %.1f MB das colunas codificadas (%.1fx, %.2f bytes/lançamento)\n",
+           t1 - t0, seg.tam / 1e6, bruto / 1e6, bruto / seg.tam, (double)seg.tam / n);
+    printf("Contra o Transacao inteiro: %.1f MB (%.1fx), mas descrição, data formatada e seq não vão ao segmento\n",
+           registro / 1e6, registro / seg.tam);
+
+    for (int modo = 0; modo < 2; ++modo) {
+        codecUsarSimd = modo == 0;
+        double a = cronometro_seg();
+        long long verif = 0;
+        for (int b = 0; b < seg.info->numBlocos; ++b) {
+            decodificarBloco(&seg, b, COL_TODAS, bd);
+            verif += bd->ts[seg.zonas[b].linhas - 1] + bd->saldo[0] + bd->ativo[0];
+        }
+        double d = cronometro_seg() - a;
+        printf("Decodificação %-8s: %.3f s | %.1f M lançamentos/s | %.2f GB/s lógicos (verif. %lld)\n",
+               modo == 0 ? "SIMD" : "escalar", d, n / d / 1e6, bruto / d / 1e9, verif % 1000);
+    }
+    codecUsarSimd = true;
+    fecharSegmento(&seg);
+    remove(arq);
+    free(bd); free(contas);
+}
@@ -0,0 +1,489 @@
+#include "corretora.h"
+
+/* ========== backtest de estratégias ========== */
+
+/*
+ * A simulação anda mês a mês sobre as colunas do histórico. No primeiro
+ * pregão do mês entram os proventos (provento por cota x cotas, como em
+ * simularProventosRV), a custódia, o aporte e as ordens da estratégia, ao
+ * fechamento do dia e com as taxas de calcularTaxas (compra como em
+ * comprarAtivoRV, venda como em venderAtivoRV, sem day trade). Depois a
+ * coluna de cada ativo é varrida no trecho do mês, somando o valor diário
+ * da posição e testando o stop móvel. O patrimônio diário dividido pelas
+ * cotas da carteira (aportes e retiradas compram e resgatam cotas) dá o
+ * retorno ponderado no tempo: CAGR e drawdown máximo não dependem dos
+ * aportes.
+ */
+
+/* venda de 'n' cotas a 'preco': valor líquido das taxas */
+static double backtestVender(float preco, int n, double *taxa) {
+    TaxasOperacao t;
+    double valor = (double)preco * n;
+    long long cent = paraCentavos((float)valor), tx = calcularTaxas(cent, 0, &t);
+    if (tx > cent) tx = cent;
+    *taxa = tx / 100.0;
+    return valor - *taxa;
+}
+
+void backtestExecutar(const DadosBacktest *h, const ParametrosBacktest *p, ResultadoBacktest *r) {
+    const int k = h->numAtivos, mesesCompra = p->mesesCompra > 0 ? p->mesesCompra : 1;
+    int q[MAX_ATIVOS] = { 0 }, liberadoEm[MAX_ATIVOS] = { 0 };
+    float ultimo[MAX_ATIVOS] = { 0.0f }, pico[MAX_ATIVOS] = { 0.0f }, preco[MAX_ATIVOS];
+    double valorDia[MAX_PREGOES_MES];
+    double caixa = h->caixaInicial, cotas = h->caixaInicial, picoCota = 1.0, cota = 1.0;
+    memset(r, 0, sizeof(*r));
+    r->aportado = h->caixaInicial;
+    for (int m = 0; m < h->meses; ++m) {
+        const int d0 = h->inicioMes[m], len = h->inicioMes[m + 1] - d0;
+        double carteira = 0.0;
+        for (int a = 0; a < k; ++a) {
+            preco[a] = h->precos[(size_t)a * h->dias + d0];
+            carteira += (double)q[a] * preco[a];
+        }
+
+        /* proventos, custódia e aporte */
+        double pago = 0.0;
+        for (int a = 0; a < k; ++a) pago += (double)h->proventos[(size_t)a * h->meses + m] * q[a];
+        if (pago > 0.0) {
+            r->proventos += pago;
+            if (m >= h->meses - 12) r->renda12 += pago;
+            if (p->reinvestir) caixa += pago;
+            else if (cotas > 0.0) cotas -= pago * cotas / (caixa + carteira + pago);   // retirada resgata cotas
+        }
+        if (carteira > 0.0) {
+            double custodia = taxaDaFaixa(&tabelaTaxas.custodia, (long long)(carteira * 100.0 + 0.5)) / 100.0;
+            caixa -= custodia;
+            r->custodia += custodia;
+        }
+        if (p->aporte > 0.0f) {
+            double nav = caixa + carteira;
+            cotas += cotas > 0.0 && nav > 0.0 ? p->aporte * cotas / nav : p->aporte;
+            caixa += p->aporte;
+            r->aportado += p->aporte;
+        }
+
+        /* rebalanceamento: vende o que passou da banda */
+        bool rebalancear = p->mesesRebalanceamento > 0 && m > 0 && m % p->mesesRebalanceamento == 0;
+        if (rebalancear) {
+            double nav = caixa + carteira;
+            for (int a = 0; a < k; ++a) {
+                double excesso = (double)q[a] * preco[a] - h->alvo[a] * nav;
+                if (q[a] == 0 || excesso <= p->banda * nav) continue;
+                int n = (int)(excesso / preco[a]);
+                if (n > q[a]) n = q[a];
+                if (n == 0) continue;
+                double taxa;
+                caixa += backtestVender(preco[a], n, &taxa);
+                carteira -= (double)preco[a] * n;
+                q[a] -= n;
+                r->taxas += taxa;
+                r->operacoes++;
+            }
+        }
+
+        /* compra periódica: o caixa vai para quem está abaixo do alvo, em proporção à falta */
+        if ((m % mesesCompra == 0 || rebalancear) && caixa > 0.0) {
+            double nav = caixa + carteira, falta[MAX_ATIVOS], somaFalta = 0.0, somaAlvo = 0.0;
+            for (int a = 0; a < k; ++a) {
+                falta[a] = 0.0;
+                if (preco[a] <= 0.0f || m < liberadoEm[a] || h->alvo[a] <= 0.0f) continue;
+                double f = h->alvo[a] * nav - (double)q[a] * preco[a];
+                falta[a] = f > 0.0 ? f : 0.0;
+                somaFalta += falta[a];
+                somaAlvo += h->alvo[a];
+            }
+            double verba = caixa;
+            for (int a = 0; somaAlvo > 0.0 && a < k; ++a) {
+                if (preco[a] <= 0.0f || m < liberadoEm[a] || h->alvo[a] <= 0.0f) continue;
+                double v = somaFalta >= verba ? verba * falta[a] / somaFalta
+                                              : falta[a] + (verba - somaFalta) * h->alvo[a] / somaAlvo;
+                double custo, taxa;
+                int n = dripCotas(v, preco[a], &custo, &taxa);
+                if (n == 0) continue;
+                if (q[a] == 0) pico[a] = preco[a];
+                q[a] += n;
+                caixa -= custo + taxa;
+                carteira += custo;
+                r->taxas += taxa;
+                r->operacoes++;
+            }
+        }
+
+        /* varredura do mês, coluna a coluna */
+        const double caixaMes = caixa;
+        for (int i = 0; i < len; ++i) valorDia[i] = 0.0;
+        for (int a = 0; a < k; ++a) {
+            const float *col = h->precos + (size_t)a * h->dias + d0;
+            ultimo[a] = col[len - 1];
+            if (q[a] == 0) continue;
+            const double qa = q[a];
+            if (p->stop <= 0.0f) {
+                for (int i = 0; i < len; ++i) valorDia[i] += qa * col[i];
+                continue;
+            }
+            const float fator = 1.0f - p->stop;
+            for (int i = 0; i < len; ++i) {
+                float x = col[i];
+                if (x > pico[a]) pico[a] = x;
+                else if (x < pico[a] * fator) {
+                    double taxa, liquido = backtestVender(x, q[a], &taxa);
+                    caixa += liquido;
+                    r->taxas += taxa;
+                    r->operacoes++;
+                    r->stops++;
+                    for (int j = i; j < len; ++j) valorDia[j] += liquido;
+                    q[a] = 0;
+                    liberadoEm[a] = m + 1 + p->carencia;
+                    break;
+                }
+                valorDia[i] += qa * x;
+            }
+        }
+        for (int i = 0; i < len; ++i) {
+            cota = cotas > 0.0 ? (caixaMes + valorDia[i]) / cotas : cota;
+            if (cota > picoCota) picoCota = cota;
+            else if (1.0 - cota / picoCota > r->drawdown) r->drawdown = (float)(1.0 - cota / picoCota);
+        }
+    }
+    r->patrimonio = caixa;
+    for (int a = 0; a < k; ++a) r->patrimonio += (double)q[a] * ultimo[a];
+    r->cagr = h->anos > 0.0 && cota > 0.0 ? (float)(pow(cota, 1.0 / h->anos) - 1.0) : 0.0f;
+}
+
+typedef struct {
+    const DadosBacktest *h;
+    const ParametrosBacktest *grade;
+    int n;
+    atomic_int proximo;                   // próximo bloco de BLOCO_BACKTEST conjuntos
+    ResultadoBacktest *resultados;
+} TrabalhoBacktest;
+
+static void *threadBacktest(void *arg) {
+    TrabalhoBacktest *tb = arg;
+    for (;;) {
+        int ini = atomic_fetch_add_explicit(&tb->proximo, BLOCO_BACKTEST, memory_order_relaxed);
+        if (ini >= tb->n) break;
+        for (int i = ini; i < ini + BLOCO_BACKTEST && i < tb->n; ++i)
+            backtestExecutar(tb->h, &tb->grade[i], &tb->resultados[i]);
+    }
+    return NULL;
+}
+
+/* roda os 'n' conjuntos da grade em 'numThreads' workers; out[i] é o resultado de grade[i] */
+bool backtestGrade(const DadosBacktest *h, const ParametrosBacktest *grade, int n, int numThreads, ResultadoBacktest *out) {
+    TrabalhoBacktest *tb = calloc(1, sizeof(TrabalhoBacktest));
+    if (!tb) return false;
+    tb->h = h;
+    tb->grade = grade;
+    tb->n = n;
+    tb->resultados = out;
+    if (numThreads > THREADS_BACKTEST) numThreads = THREADS_BACKTEST;
+    Thread th[THREADS_BACKTEST];
+    int criadas = 0;
+    for (int i = 1; i < numThreads; ++i)
+        if (thread_criar(&th[criadas], threadBacktest, tb)) criadas++;
+    threadBacktest(tb);                   // a thread chamadora também trabalha
+    for (int i = 0; i < criadas; ++i) thread_aguardar(th[i]);
+    free(tb);
+    return true;
+}
+
+void liberarDadosBacktest(DadosBacktest *h) {
+    free(h->precos);
+    free(h->proventos);
+    free(h->inicioMes);
+    h->precos = h->proventos = NULL;
+    h->inicioMes = NULL;
+}
+
+static int compararPontoBacktest(const void *a, const void *b) {
+    const PontoBacktest *x = a, *y = b;
+    if (x->dia != y->dia) return (x->dia > y->dia) - (x->dia < y->dia);
+    return x->ativo - y->ativo;
+}
+
+/*
+ * Monta as colunas de 'k' ativos a partir dos pontos (reordena 'pts').
+ * Pregões são as datas com algum ponto e meses, os meses com pregão. Com
+ * 'mesesPorPagamento', os proventos seguem a cadência do catálogo
+ * (porCota[a] a cada mesesPorPagamento[a] meses); senão vêm dos pontos.
+ */
+static bool montarDadosBacktest(PontoBacktest *pts, int n, int k, const int *mesesPorPagamento, const float *porCota, DadosBacktest *h) {
+    if (n == 0) return false;
+    qsort(pts, (size_t)n, sizeof(PontoBacktest), compararPontoBacktest);
+    int dias = 0, meses = 0, diaAnt = INT_MIN, chaveAnt = INT_MIN, ano, mes, dia;
+    for (int i = 0; i < n; ++i) {
+        if (pts[i].dia == diaAnt) continue;
+        diaAnt = pts[i].dia;
+        dias++;
+        dataDoDia(diaAnt, &ano, &mes, &dia);
+        if (ano * 12 + mes != chaveAnt) { chaveAnt = ano * 12 + mes; meses++; }
+    }
+    if (dias < 2) return false;
+    h->numAtivos = k; h->dias = dias; h->meses = meses;
+    h->precos = calloc((size_t)k * dias, sizeof(float));
+    h->proventos = calloc((size_t)k * meses, sizeof(float));
+    h->inicioMes = malloc(sizeof(int) * (size_t)(meses + 1));
+    if (!h->precos || !h->proventos || !h->inicioMes) { liberarDadosBacktest(h); return false; }
+    int d = -1, m = -1;
+    diaAnt = chaveAnt = INT_MIN;
+    for (int i = 0; i < n; ++i) {
+        if (pts[i].dia != diaAnt) {
+            diaAnt = pts[i].dia;
+            d++;
+            dataDoDia(diaAnt, &ano, &mes, &dia);
+            if (ano * 12 + mes != chaveAnt) { chaveAnt = ano * 12 + mes; h->inicioMes[++m] = d; }
+        }
+        if (pts[i].preco > 0.0f) h->precos[(size_t)pts[i].ativo * dias + d] = pts[i].preco;
+        if (!mesesPorPagamento) h->proventos[(size_t)pts[i].ativo * meses + m] += pts[i].provento;
+    }
+    h->inicioMes[meses] = dias;
+    for (int a = 0; a < k; ++a) {                                    // dias sem cotação repetem o último fechamento
+        float *col = h->precos + (size_t)a * dias, u = 0.0f;
+        for (int i = 0; i < dias; ++i) { if (col[i] > 0.0f) u = col[i]; else col[i] = u; }
+    }
+    for (int a = 0; mesesPorPagamento && a < k; ++a)
+        for (int i = 0; mesesPorPagamento[a] > 0 && i < meses; ++i)
+            if ((i + 1) % mesesPorPagamento[a] == 0) h->proventos[(size_t)a * meses + i] = porCota[a];
+    h->primeiroDia = pts[0].dia;
+    h->ultimoDia = pts[n - 1].dia;
+    h->anos = (h->ultimoDia - h->primeiroDia) / 365.25;
+    return true;
+}
+
+/* decimal que ocupa o campo inteiro (espaços nas pontas tolerados) */
+static bool decimalDoCampo(const char *p, const char *fim, float *v) {
+    const char *parou;
+    while (fim > p && fim[-1] == ' ') --fim;
+    *v = decimalCatalogo(p, fim, &parou);
+    return parou == fim && fim > p;
+}
+
+/*
+ * Pontos de ARQ_HISTORICO dos ativos pedidos; NULL se não houver arquivo.
+ * Linha "ticker;AAAA-MM-DD;preço[;provento]" com ponto decimal, lida sem o
+ * locale do processo; linha que não casa inteira é descartada.
+ */
+PontoBacktest *pontosDoArquivo(const char *arq, const int *ativoGlobal, int k, int *n) {
+    FILE *fp = fopen(arq, "r");
+    if (!fp) return NULL;
+    PontoBacktest *pts = NULL;
+    int cap = 0;
+    char linha[160], ticker[32];
+    *n = 0;
+    while (fgets(linha, sizeof(linha), fp)) {
+        const char *fim = linha + strlen(linha), *f[4], *ff[4], *p = linha;
+        int campos = 0;
+        while (campos < 4 && p < fim && *p != '\n' && *p != '\r') { f[campos] = p; p = campoCatalogo(p, fim, &ff[campos]); campos++; }
+        if (campos < 3 || (p < fim && *p != '\n' && *p != '\r')) continue;   // cabeçalho, campo faltando ou sobrando
+        int a, m, d, usados = 0;
+        float preco, provento = 0.0f;
+        if (sscanf(f[1], "%4d-%2d-%2d%n", &a, &m, &d, &usados) != 3 || f[1] + usados != ff[1]) continue;
+        if (!decimalDoCampo(f[2], ff[2], &preco) || (campos == 4 && !decimalDoCampo(f[3], ff[3], &provento))) continue;
+        copiarCampo(ticker, sizeof(ticker), f[0], ff[0]);
+        int j = -1;
+        for (int i = 0; i < k && j < 0; ++i) if (strcmp(ativosDisponiveis[ativoGlobal[i]].ticker, ticker) == 0) j = i;
+        if (j < 0 || m < 1 || m > 12 || d < 1 || d > 31) continue;
+        if (*n == cap) {
+            cap = cap ? cap * 2 : 4096;
+            PontoBacktest *novo = realloc(pts, sizeof(PontoBacktest) * (size_t)cap);
+            if (!novo) { free(pts); fclose(fp); *n = 0; return NULL; }
+            pts = novo;
+        }
+        pts[(*n)++] = (PontoBacktest){ diaDaData(a, m, d), j, preco, provento };
+    }
+    fclose(fp);
+    return pts;
+}
+
+/* pontos dos fechamentos gravados no histórico de preços */
+static PontoBacktest *pontosDoHistorico(const int *ativoGlobal, int k, int *n) {
+    *n = 0;
+    if (!historico) return NULL;
+    int total = 0, maior = 0;
+    for (int i = 0; i < k; ++i) {
+        int p = (int)historico[ativoGlobal[i]].fechamentos.pontos;
+        total += p;
+        if (p > maior) maior = p;
+    }
+    PontoBacktest *pts = malloc(sizeof(PontoBacktest) * (size_t)(total ? total : 1));
+    long long *ts = malloc(sizeof(long long) * (size_t)(maior ? maior : 1));
+    float *col = malloc(sizeof(float) * (size_t)(maior ? maior : 1));
+    if (!pts || !ts || !col) { free(pts); free(ts); free(col); return NULL; }
+    for (int i = 0; i < k; ++i) {
+        int lidos = serieLer(&historico[ativoGlobal[i]].fechamentos, 0, LLONG_MAX, ts, col, maior);
+        for (int p = 0; p < lidos; ++p) pts[(*n)++] = (PontoBacktest){ (int)(ts[p] / 86400), i, col[p], 0.0f };
+    }
+    free(ts); free(col);
+    return pts;
+}
+
+/*
+ * Backtest da carteira: alvo = pesos atuais a preço de mercado, histórico
+ * de ARQ_HISTORICO (com os proventos do arquivo) ou, sem arquivo, dos
+ * fechamentos registrados (com a cadência de proventos do catálogo).
+ * Roda uma grade pequena de regras e lista do maior CAGR para o menor.
+ */
+void menuBacktest(Usuario *u) {
+    DadosBacktest h;
+    memset(&h, 0, sizeof(h));
+    int ativoGlobal[MAX_ATIVOS], mesesPorPagamento[MAX_ATIVOS], k = 0;
+    float porCota[MAX_ATIVOS];
+    double total = 0.0;
+    for (int i = 0; i < u->investimento.numAtivos; ++i) {
+        const AtivoCarteira *c = &u->investimento.carteira[i];
+        int j = indiceCatalogo(c->ticker);
+        if (j < 0 || c->quantidade <= 0) continue;
+        const AtivoRV *a = &ativosDisponiveis[j];
+        ativoGlobal[k] = j;
+        mesesPorPagamento[k] = mesesPorPagamentoAtivo(a);
+        porCota[k] = a->dividend_per_period;
+        h.alvo[k] = (float)c->quantidade * a->preco;
+        total += h.alvo[k++];
+    }
+    if (k == 0 || total <= 0.0) { printf("Carteira sem posições com preço.\n"); return; }
+    for (int a = 0; a < k; ++a) h.alvo[a] = (float)(h.alvo[a] / total);
+
+    int n;
+    PontoBacktest *pts = pontosDoArquivo(ARQ_HISTORICO, ativoGlobal, k, &n);
+    bool doArquivo = pts != NULL;
+    if (!doArquivo) pts = pontosDoHistorico(ativoGlobal, k, &n);
+    bool ok = pts && montarDadosBacktest(pts, n, k, doArquivo ? NULL : mesesPorPagamento, porCota, &h);
+    free(pts);
+    if (!ok) { printf("Sem histórico de fechamentos para a carteira (%s ou preços registrados).\n", ARQ_HISTORICO); return; }
+
+    float capital, aporte;
+    char resp[8];
+    printf("Capital inicial (R$): ");
+    if (scanf("%f", &capital) != 1 || capital < 0.0f) { clear_input(); printf("Valor inválido.\n"); liberarDadosBacktest(&h); return; }
+    printf("Aporte mensal (R$, 0 = nenhum): ");
+    if (scanf("%f", &aporte) != 1 || aporte < 0.0f) { clear_input(); printf("Valor inválido.\n"); liberarDadosBacktest(&h); return; }
+    if (capital <= 0.0f && aporte <= 0.0f) { printf("Informe capital inicial ou aporte.\n"); liberarDadosBacktest(&h); return; }
+    printf("Reinvestir proventos? (s/n): ");
+    if (scanf("%7s", resp) != 1) { clear_input(); printf("Entrada inválida.\n"); liberarDadosBacktest(&h); return; }
+    h.caixaInicial = capital;
+
+    static const int compras[] = { 1, 3, 12 }, rebalanceamentos[] = { 0, 6, 12 };
+    static const float stops[] = { 0.0f, 0.15f };
+    enum { NUM_GRADE = 18 };
+    ParametrosBacktest grade[NUM_GRADE];
+    ResultadoBacktest res[NUM_GRADE];
+    int ordem[NUM_GRADE], g = 0;
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r)
+            for (int s = 0; s < 2; ++s, ++g) {
+                grade[g] = (ParametrosBacktest){ aporte, compras[c], rebalanceamentos[r], 0.05f, stops[s], 3, resp[0] == 's' || resp[0] == 'S' };
+                ordem[g] = g;
+            }
+    double t0 = cronometro_seg();
+    if (!backtestGrade(&h, grade, NUM_GRADE, THREADS_BACKTEST, res)) { printf("Memória insuficiente.\n"); liberarDadosBacktest(&h); return; }
+    double dt = cronometro_seg() - t0;
+    for (int i = 1; i < NUM_GRADE; ++i)                               // do maior CAGR para o menor
+        for (int j = i; j > 0 && res[ordem[j]].cagr > res[ordem[j - 1]].cagr; --j) { int t = ordem[j]; ordem[j] = ordem[j - 1]; ordem[j - 1] = t; }
+
+    int a0, m0, d0, a1, m1, d1;
+    dataDoDia(h.primeiroDia, &a0, &m0, &d0);
+    dataDoDia(h.ultimoDia, &a1, &m1, &d1);
+    printf("\n=== Backtest da carteira: %04d-%02d-%02d a %04d-%02d-%02d (%d pregões, %d ativos, %s) ===\n",
+           a0, m0, d0, a1, m1, d1, h.dias, k, doArquivo ? ARQ_HISTORICO : "preços registrados");
+    printf("Compra  Rebal.  Stop |   CAGR  DD máx |   Patrimônio |    Aportado |   Proventos | Renda 12m |  Taxas+cust. | Ops\n");
+    for (int i = 0; i < NUM_GRADE; ++i) {
+        const ParametrosBacktest *p = &grade[ordem[i]];
+        const ResultadoBacktest *r = &res[ordem[i]];
+        char rebal[8];
+        if (p->mesesRebalanceamento) snprintf(rebal, sizeof(rebal), "%2dm", p->mesesRebalanceamento);
+        else snprintf(rebal, sizeof(rebal), "não");
+        printf("%4dm  %6s  %3.0f%% | %5.1f%%  %5.1f%% | %12.2f | %11.2f | %11.2f | %9.2f | %12.2f | %3d\n",
+               p->mesesCompra, rebal, p->stop * 100.0f, r->cagr * 100.0f, r->drawdown * 100.0f,
+               r->patrimonio, r->aportado, r->proventos, r->renda12, r->taxas + r->custodia, r->operacoes);
+    }
+    printf("(banda de rebalanceamento 5%%; após um stop, 3 meses sem recompra; %.1f ms)\n", dt * 1e3);
+    liberarDadosBacktest(&h);
+}
+
+/*
+ * 10 ativos sintéticos x 20 anos de pregões (21 por mês) e uma grade de
+ * 10.000 conjuntos de regras: tempo com 1 e THREADS_BACKTEST threads e
+ * conferência de que o resultado não depende da divisão entre threads.
+ */
+void benchmarkBacktest(void) {
+    const int k = 10, anos = 20, pregoesMes = 21, meses = anos * 12, dias = meses * pregoesMes;
+    printf("\n=== Benchmark de backtest (%d ativos x %d anos, grade de 10.000 conjuntos) ===\n", k, anos);
+    DadosBacktest h;
+    memset(&h, 0, sizeof(h));
+    h.numAtivos = k; h.dias = dias; h.meses = meses; h.anos = anos; h.caixaInicial = 100000.0;
+    h.primeiroDia = diaDaData(2005, 1, 3);
+    h.ultimoDia = diaDaData(2005 + anos, 1, 3);
+    h.precos = malloc(sizeof(float) * (size_t)k * dias);
+    h.proventos = calloc((size_t)k * meses, sizeof(float));
+    h.inicioMes = malloc(sizeof(int) * (size_t)(meses + 1));
+    if (!h.precos || !h.proventos || !h.inicioMes) { liberarDadosBacktest(&h); printf("Memória insuficiente.\n"); return; }
+    for (int m = 0; m <= meses; ++m) h.inicioMes[m] = m * pregoesMes;
+    /* passeio lognormal diário com fator de mercado; FIIs (ímpares) pagam todo mês, ações a cada trimestre */
+    unsigned semente = 2718u;
+    double logp[10];
+    for (int a = 0; a < k; ++a) { logp[a] = log(10.0 + 7.0 * a); h.alvo[a] = 1.0f / k; }
+    for (int d = 0; d < dias; ++d) {
+        aleatorio(&semente);
+        double zm = normalInversa(((semente >> 8) + 0.5) / 16777216.0);
+        for (int a = 0; a < k; ++a) {
+            aleatorio(&semente);
+            double z = normalInversa(((semente >> 8) + 0.5) / 16777216.0), sigma = (a % 2 ? 0.15 : 0.30) / sqrt(252.0);
+            logp[a] += (a % 2 ? 0.02 : 0.08) / 252.0 - 0.5 * sigma * sigma + sigma * (0.6 * zm + 0.8 * z);
+            h.precos[(size_t)a * dias + d] = (float)exp(logp[a]);
+        }
+    }
+    for (int a = 0; a < k; ++a)
+        for (int m = 0; m < meses; ++m) {
+            int mpp = a % 2 ? 1 : 3;
+            if ((m + 1) % mpp == 0) h.proventos[(size_t)a * meses + m] = h.precos[(size_t)a * dias + h.inicioMes[m]] * (a % 2 ? 0.007f : 0.012f);
+        }
+
+    static const float aportes[] = { 0.0f, 250.0f, 500.0f, 1000.0f, 2000.0f }, bandas[] = { 0.02f, 0.05f, 0.10f, 0.20f };
+    static const float stops[] = { 0.0f, 0.05f, 0.10f, 0.20f, 0.30f };
+    static const int compras[] = { 1, 2, 3, 6, 12 }, rebalanceamentos[] = { 0, 3, 6, 12, 24 }, carencias[] = { 1, 6 };
+    const int n = 10000;
+    ParametrosBacktest *grade = malloc(sizeof(ParametrosBacktest) * (size_t)n);
+    ResultadoBacktest *res = malloc(sizeof(ResultadoBacktest) * (size_t)n * 2);
+    if (!grade || !res) { free(grade); free(res); liberarDadosBacktest(&h); printf("Memória insuficiente.\n"); return; }
+    for (int i = 0, x; i < n; ++i) {
+        x = i;
+        ParametrosBacktest *p = &grade[i];
+        p->aporte = aportes[x % 5]; x /= 5;
+        p->mesesCompra = compras[x % 5]; x /= 5;
+        p->mesesRebalanceamento = rebalanceamentos[x % 5]; x /= 5;
+        p->banda = bandas[x % 4]; x /= 4;
+        p->stop = stops[x % 5]; x /= 5;
+        p->carencia = carencias[x % 2]; x /= 2;
+        p->reinvestir = x % 2 == 0;
+    }
+    ResultadoBacktest *ref = res + n;
+    double t0 = cronometro_seg();
+    backtestGrade(&h, grade, n, 1, ref);
+    double dUm = cronometro_seg() - t0;
+    t0 = cronometro_seg();
+    backtestGrade(&h, grade, n, THREADS_BACKTEST, res);
+    double dVarias = cronometro_seg() - t0;
+    long long divergentes = 0;
+    int melhor = 0, menorDd = 0;
+    for (int i = 0; i < n; ++i) {
+        divergentes += memcmp(&res[i], &ref[i], sizeof(ResultadoBacktest)) != 0;
+        if (res[i].cagr > res[melhor].cagr) melhor = i;
+        if (res[i].drawdown < res[menorDd].drawdown) menorDd = i;
+    }
+    printf("1 thread: %.2f s (%.1f µs por conjunto, %.2f ns por ativo-pregão)\n", dUm, dUm / n * 1e6, dUm / ((double)n * k * dias) * 1e9);
+    printf("%d threads: %.2f s\n", THREADS_BACKTEST, dVarias);
+    for (int t = 0; t < 2; ++t) {
+        int i = t ? menorDd : melhor;
+        const ParametrosBacktest *p = &grade[i];
+        printf("%s: compra %dm, rebal. %dm (banda %.0f%%), stop %.0f%%, aporte R$ %.0f, proventos %s -> CAGR %.2f%% | DD %.1f%% | "
+               "proventos R$ %.2f (12m R$ %.2f) | %d ops, %d stops\n",
+               t ? "Menor drawdown" : "Maior CAGR", p->mesesCompra, p->mesesRebalanceamento, p->banda * 100.0f, p->stop * 100.0f,
+               p->aporte, p->reinvestir ? "reinvestidos" : "retirados", res[i].cagr * 100.0f, res[i].drawdown * 100.0f,
+               res[i].proventos, res[i].renda12, res[i].operacoes, res[i].stops);
+    }
+    printf("Conferência: %lld conjunto(s) diferente(s) entre 1 e %d threads\n", divergentes, THREADS_BACKTEST);
+    free(grade);
+    free(res);
+    liberarDadosBacktest(&h);
+}
@@ -0,0 +1,496 @@
+#include "corretora.h"
+
+/* ======= Simulador de calendário de eventos ======= */
+
+/*
+ * Anda pelo tempo de evento em evento, sem passar pelos dias vazios:
+ * data com de cada ativo (fotografa quem tem a cota e agenda o pagamento),
+ * pagamento, aporte mensal, custódia mensal e liquidação de TED. Eventos
+ * de um mesmo dia geram postagens que são aplicadas juntas quando o dia
+ * vira. Aporte e custódia são um evento por mês para todas as contas, e
+ * proventos visitam só os detentores do ativo, então a heap fica com
+ * poucos eventos e anos passam em segundos.
+ */
+
+static bool eventoAntes(const EventoCalendario *a, const EventoCalendario *b) {
+    return a->dia != b->dia ? a->dia < b->dia : a->seq < b->seq;
+}
+
+bool calendarioInserir(HeapCalendario *h, int dia, int tipo, int ativo, int lote) {
+    if (h->num == h->cap) {
+        int novaCap = h->cap ? h->cap * 2 : 64;
+        EventoCalendario *n = realloc(h->itens, sizeof(EventoCalendario) * (size_t)novaCap);
+        if (!n) return false;
+        h->itens = n; h->cap = novaCap;
+    }
+    EventoCalendario ev = { dia, h->seq++, (unsigned char)tipo, ativo, lote };
+    int i = h->num++;
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!eventoAntes(&ev, &h->itens[pai])) break;
+        h->itens[i] = h->itens[pai];
+        i = pai;
+    }
+    h->itens[i] = ev;
+    return true;
+}
+
+bool calendarioRetirar(HeapCalendario *h, EventoCalendario *ev) {
+    if (h->num == 0) return false;
+    *ev = h->itens[0];
+    EventoCalendario ultimo = h->itens[--h->num];
+    int i = 0;
+    for (;;) {
+        int f = 2 * i + 1;
+        if (f >= h->num) break;
+        if (f + 1 < h->num && eventoAntes(&h->itens[f + 1], &h->itens[f])) f++;
+        if (!eventoAntes(&h->itens[f], &ultimo)) break;
+        h->itens[i] = h->itens[f];
+        i = f;
+    }
+    if (h->num > 0) h->itens[i] = ultimo;
+    return true;
+}
+
+/* dias desde o epoch de uma data civil (inverso de dataCivil) */
+int diaDaData(int ano, int mes, int dia) {
+    ano -= mes <= 2;
+    long long era = (ano >= 0 ? ano : ano - 399) / 400;
+    unsigned yoe = (unsigned)(ano - era * 400);
+    unsigned doy = (153 * (unsigned)(mes > 2 ? mes - 3 : mes + 9) + 2) / 5 + (unsigned)dia - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int)(era * 146097 + (long long)doe - 719468);
+}
+
+void dataDoDia(int d, int *ano, int *mes, int *dia) {
+    int hora, min, seg;
+    dataCivil((long long)d * 86400, 0, ano, mes, dia, &hora, &min, &seg);
+}
+
+/* mesmo dia do mês 'meses' adiante (dias de evento vão até 28) */
+static int somarMeses(int d, int meses) {
+    int ano, mes, dia;
+    dataDoDia(d, &ano, &mes, &dia);
+    mes += meses;
+    ano += (mes - 1) / 12;
+    mes = (mes - 1) % 12 + 1;
+    return diaDaData(ano, mes, dia > 28 ? 28 : dia);
+}
+
+/* meio-dia local de um dia do calendário: instante dos lançamentos simulados */
+long long tsDoDia(int dia) {
+    return (long long)dia * 86400 - fusoProcesso() + 12 * 3600;
+}
+
+/* 'ts' deslocado de 'meses' meses, na mesma hora do dia */
+long long somarMesesTs(long long ts, int meses) {
+    long long dia = diaLocal(ts, fusoProcesso());
+    return ts + ((long long)somarMeses((int)dia, meses) - dia) * 86400;
+}
+
+/* primeira data com do ativo a partir de 'inicio': dia 10..24 dos meses de pagamento */
+static int primeiraDataCom(int ativo, int inicio) {
+    const AtivoRV *a = &ativosDisponiveis[ativo];
+    int mpp = a->periods_per_year > 0 ? 12 / a->periods_per_year : 12;
+    if (mpp <= 0) mpp = 12;
+    int ano, mes, dia;
+    dataDoDia(inicio, &ano, &mes, &dia);
+    for (int k = 0; k < 24; ++k) {
+        int m = (mes - 1 + k) % 12 + 1, y = ano + (mes - 1 + k) / 12;
+        int d = diaDaData(y, m, 10 + ativo % 15);
+        if ((m - 1) % mpp == ativo % mpp && d >= inicio) return d;
+    }
+    return inicio;
+}
+
+static bool postar(SimuladorCalendario *sim, int usuario, int posicao, int tipo, float valor, int quantidade) {
+    if (sim->numPostagens == sim->capPostagens) {
+        int novaCap = sim->capPostagens ? sim->capPostagens * 2 : 1024;
+        PostagemCalendario *n = realloc(sim->postagens, sizeof(PostagemCalendario) * (size_t)novaCap);
+        if (!n) return false;
+        sim->postagens = n; sim->capPostagens = novaCap;
+    }
+    sim->postagens[sim->numPostagens++] = (PostagemCalendario){ usuario, posicao, (unsigned char)tipo, valor, quantidade };
+    return true;
+}
+
+/* sem extrato: postagens em arrays densos (cabem na cache), sem tocar nas contas */
+static void aplicarPostagensDensas(SimuladorCalendario *sim) {
+    for (int i = 0; i < sim->numPostagens; ++i) {
+        const PostagemCalendario *p = &sim->postagens[i];
+        int u = p->usuario;
+        if (p->tipo == EV_PAGAMENTO) {
+            sim->caixa[u] += p->valor;
+            sim->provento[sim->basePosicao[u] + p->posicao] += p->valor;
+            sim->proventos += p->valor;
+        } else if (p->tipo == EV_APORTE) {
+            if (sim->banco[u] < p->valor) continue;
+            sim->banco[u] -= p->valor;
+            sim->caixa[u] += p->valor;
+            sim->aportes += p->valor;
+        } else if (p->tipo == EV_CUSTODIA) {
+            if (sim->lista[u]->investimento.saldo + sim->caixa[u] < p->valor) { sim->custodiaSemCaixa++; continue; }
+            sim->caixa[u] -= p->valor;
+            sim->custodia += p->valor;
+        }
+    }
+    sim->numPostagens = 0;
+}
+
+static bool prepararDenso(SimuladorCalendario *sim) {
+    int total = 0;
+    sim->basePosicao = malloc(sizeof(int) * (size_t)(sim->n + 1));
+    if (!sim->basePosicao) return false;
+    for (int i = 0; i < sim->n; ++i) { sim->basePosicao[i] = total; total += sim->lista[i]->investimento.numAtivos; }
+    sim->basePosicao[sim->n] = total;
+    sim->caixa = calloc((size_t)sim->n + 1, sizeof(double));
+    sim->banco = malloc(sizeof(double) * ((size_t)sim->n + 1));
+    sim->provento = calloc((size_t)total + 1, sizeof(double));
+    sim->custodiaConta = malloc(sizeof(float) * ((size_t)sim->n + 1));
+    if (!sim->caixa || !sim->banco || !sim->provento || !sim->custodiaConta) return false;
+    for (int i = 0; i < sim->n; ++i) {
+        const Usuario *u = sim->lista[i];
+        sim->banco[i] = (double)u->banco.saldo - u->banco.tedPendente;
+        sim->custodiaConta[i] = (float)(custodiaMensal(u) / 100.0);
+    }
+    return true;
+}
+
+/* devolve às contas o que foi acumulado nos arrays densos */
+static void devolverDenso(SimuladorCalendario *sim) {
+    for (int i = 0; i < sim->n; ++i) {
+        Usuario *u = sim->lista[i];
+        u->investimento.saldo += (float)sim->caixa[i];
+        u->banco.saldo = (float)(sim->banco[i] + u->banco.tedPendente);
+        for (int p = 0; p < u->investimento.numAtivos; ++p) {
+            double v = sim->provento[sim->basePosicao[i] + p];
+            if (v != 0.0) resultadoProvento(u, &u->investimento.carteira[p], (float)v);
+        }
+    }
+}
+
+/* aplica as postagens do dia às contas (e ao extrato, se 'lancar') */
+static void aplicarPostagens(SimuladorCalendario *sim, int dia) {
+    if (!sim->lancar) { aplicarPostagensDensas(sim); return; }
+    if (relogioEhVirtual()) relogioFixar(tsDoDia(dia));               // extrato e lotes carimbados no dia simulado
+    int ano, mes, d;
+    dataDoDia(dia, &ano, &mes, &d);
+    char desc[100];
+    for (int i = 0; i < sim->numPostagens; ++i) {
+        const PostagemCalendario *p = &sim->postagens[i];
+        Usuario *u = sim->lista[p->usuario];
+        if (p->tipo == EV_PAGAMENTO) {
+            AtivoCarteira *c = &u->investimento.carteira[p->posicao];
+            u->investimento.saldo += p->valor;
+            resultadoProvento(u, c, p->valor);
+            sim->proventos += p->valor;
+            snprintf(desc, sizeof(desc), "Provento %s em %04d-%02d-%02d R$ %.2f", c->ticker, ano, mes, d, p->valor);
+            registrarTransacaoAtivo(u, "Provento", desc, c->ticker, p->valor, 0.0f, p->quantidade, 0.0f);
+            sim->lancamentos++;
+        } else if (p->tipo == EV_APORTE) {
+            if (saldoDisponivelBanco(u) < p->valor) continue;
+            u->banco.saldo -= p->valor;
+            u->investimento.saldo += p->valor;
+            sim->aportes += p->valor;
+            snprintf(desc, sizeof(desc), "Aporte programado em %04d-%02d-%02d R$ %.2f", ano, mes, d, p->valor);
+            registrarTransacaoBanco(u, "Transferência", desc, -p->valor, 0.0f);
+            registrarTransacaoInvest(u, "Recebido", desc, p->valor, 0.0f);
+            sim->lancamentos += 2;
+        } else if (p->tipo == EV_CUSTODIA) {
+            /* como cobrarCustodia: sem caixa não cobra, e o dia fica marcado para a cobrança diária não repetir */
+            if (paraCentavos(u->investimento.saldo) < paraCentavos(p->valor)) { sim->custodiaSemCaixa++; continue; }
+            u->investimento.saldo -= p->valor;
+            u->investimento.diaCustodia = dia;
+            sim->custodia += p->valor;
+            snprintf(desc, sizeof(desc), "Custódia mensal %04d-%02d (carteira R$ %.2f)", ano, mes, u->investimento.valorMercado);
+            registrarTransacaoInvest(u, "Custódia", desc, 0.0f, p->valor);
+            sim->lancamentos++;
+        }
+    }
+    sim->numPostagens = 0;
+}
+
+/* fotografa os detentores do ativo na data com */
+static int gravarElegiveis(SimuladorCalendario *sim, int ativo) {
+    if (sim->numLotes == sim->capLotes) {
+        int novaCap = sim->capLotes ? sim->capLotes * 2 : 64;
+        Elegivel **l = realloc(sim->lotes, sizeof(Elegivel *) * (size_t)novaCap);
+        int *n = realloc(sim->numLote, sizeof(int) * (size_t)novaCap);
+        if (l) sim->lotes = l;
+        if (n) sim->numLote = n;
+        if (!l || !n) return -1;
+        sim->capLotes = novaCap;
+    }
+    int total = sim->numDetentores[ativo], k = 0;
+    Elegivel *e = malloc(sizeof(Elegivel) * (size_t)(total ? total : 1));
+    if (!e) return -1;
+    for (int i = 0; i < total; ++i)
+        if (sim->detentores[ativo][i].quantidade > 0) e[k++] = sim->detentores[ativo][i];
+    sim->lotes[sim->numLotes] = e;
+    sim->numLote[sim->numLotes] = k;
+    return sim->numLotes++;
+}
+
+/* índice de detentores por ativo do catálogo, montado uma vez para a simulação */
+static bool indexarDetentoresCalendario(SimuladorCalendario *sim) {
+    sim->numDetentores = calloc((size_t)NUM_ATIVOS, sizeof(int));
+    sim->detentores = calloc((size_t)NUM_ATIVOS, sizeof(Elegivel *));
+    if (!sim->numDetentores || !sim->detentores) return false;
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            for (int j = 0; j < NUM_ATIVOS; ++j) {
+                sim->detentores[j] = malloc(sizeof(Elegivel) * (size_t)(sim->numDetentores[j] ? sim->numDetentores[j] : 1));
+                if (!sim->detentores[j]) return false;
+                sim->numDetentores[j] = 0;
+            }
+        }
+        for (int i = 0; i < sim->n; ++i) {
+            const ContaInvestimento *c = &sim->lista[i]->investimento;
+            for (int p = 0; p < c->numAtivos; ++p) {
+                int j = indiceCatalogo(c->carteira[p].ticker);
+                if (j < 0) continue;
+                if (pass == 1) sim->detentores[j][sim->numDetentores[j]] = (Elegivel){ i, p, c->carteira[p].quantidade };
+                sim->numDetentores[j]++;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Simula de 'diaInicio' até 'diaFim' (inclusive) sobre sim->lista. O
+ * simulador chega preenchido com lista, n, lancar, aporte e diaAporte.
+ * Com 'lancar' e o relógio virtual, cada dia é carimbado com a própria
+ * data e o relógio termina no fim do período; no relógio real os
+ * lançamentos saem com a hora atual, como qualquer outro.
+ */
+bool simularCalendario(SimuladorCalendario *sim, int diaInicio, int diaFim) {
+    if (!indexarDetentoresCalendario(sim)) return false;
+    if (!sim->lancar && !prepararDenso(sim)) return false;
+    HeapCalendario *h = &sim->heap;
+    bool ok = true;
+    for (int j = 0; j < NUM_ATIVOS; ++j)
+        if (sim->numDetentores[j] > 0 && ativosDisponiveis[j].dividend_per_period > 0.0f)
+            ok = ok && calendarioInserir(h, primeiraDataCom(j, diaInicio), EV_DATA_COM, j, -1);
+    if (sim->aporte > 0.0f) {
+        int ano, mes, dia;
+        dataDoDia(diaInicio, &ano, &mes, &dia);
+        int d = diaDaData(ano, mes, sim->diaAporte);
+        ok = ok && calendarioInserir(h, d >= diaInicio ? d : somarMeses(d, 1), EV_APORTE, -1, -1);
+    }
+    int ano, mes, dia;
+    dataDoDia(diaInicio, &ano, &mes, &dia);
+    ok = ok && calendarioInserir(h, somarMeses(diaDaData(ano, mes, 1), 1), EV_CUSTODIA, -1, -1);
+    if (sim->lista == usuarios) ok = ok && calendarioInserir(h, diaInicio, EV_LIQUIDACAO_TED, -1, -1);
+
+    EventoCalendario ev;
+    int diaAtual = diaInicio;
+    while (ok && h->num > 0 && h->itens[0].dia <= diaFim) {
+        calendarioRetirar(h, &ev);
+        if (ev.dia != diaAtual) { aplicarPostagens(sim, diaAtual); diaAtual = ev.dia; }
+        sim->eventos[ev.tipo]++;
+        switch (ev.tipo) {
+            case EV_DATA_COM: {
+                const AtivoRV *a = &ativosDisponiveis[ev.ativo];
+                int mpp = a->periods_per_year > 0 ? 12 / a->periods_per_year : 12;
+                int lote = gravarElegiveis(sim, ev.ativo);
+                ok = lote >= 0 && calendarioInserir(h, ev.dia + (a->isFII ? 14 : 30), EV_PAGAMENTO, ev.ativo, lote)
+                     && calendarioInserir(h, somarMeses(ev.dia, mpp > 0 ? mpp : 12), EV_DATA_COM, ev.ativo, -1);
+                break;
+            }
+            case EV_PAGAMENTO: {
+                float porCota = ativosDisponiveis[ev.ativo].dividend_per_period;
+                const Elegivel *e = sim->lotes[ev.lote];
+                for (int i = 0; ok && i < sim->numLote[ev.lote]; ++i)
+                    ok = postar(sim, e[i].usuario, e[i].posicao, EV_PAGAMENTO, porCota * (float)e[i].quantidade, e[i].quantidade);
+                free(sim->lotes[ev.lote]);
+                sim->lotes[ev.lote] = NULL;
+                break;
+            }
+            case EV_APORTE:
+                for (int i = 0; ok && i < sim->n; ++i) ok = postar(sim, i, -1, EV_APORTE, sim->aporte, 0);
+                ok = ok && calendarioInserir(h, somarMeses(ev.dia, 1), EV_APORTE, -1, -1);
+                break;
+            case EV_CUSTODIA:
+                aplicarPostagens(sim, diaAtual);                      // custódia sobre a carteira já com o dia aplicado
+                for (int i = 0; ok && i < sim->n; ++i) {
+                    float taxa = sim->lancar ? (float)(custodiaMensal(sim->lista[i]) / 100.0) : sim->custodiaConta[i];
+                    if (taxa > 0.0f) ok = postar(sim, i, -1, EV_CUSTODIA, taxa, 0);
+                }
+                ok = ok && calendarioInserir(h, somarMeses(ev.dia, 1), EV_CUSTODIA, -1, -1);
+                break;
+            case EV_LIQUIDACAO_TED:
+                if (sim->lancar && relogioEhVirtual()) relogioFixar(tsDoDia(ev.dia));
+                liquidarLoteTED(&filaTED, usuarios);
+                filaTED.ultimaLiquidacao = (time_t)relogio_seg();
+                ok = calendarioInserir(h, ev.dia + 1, EV_LIQUIDACAO_TED, -1, -1);
+                break;
+        }
+    }
+    aplicarPostagens(sim, diaAtual);
+    if (!sim->lancar) devolverDenso(sim);
+    else if (relogioEhVirtual()) relogioFixar(tsDoDia(diaFim));
+    return ok;
+}
+
+void liberarSimuladorCalendario(SimuladorCalendario *sim) {
+    for (int j = 0; sim->detentores && j < NUM_ATIVOS; ++j) free(sim->detentores[j]);
+    free(sim->detentores);
+    free(sim->numDetentores);
+    for (int i = 0; i < sim->numLotes; ++i) free(sim->lotes[i]);
+    free(sim->lotes);
+    free(sim->numLote);
+    free(sim->postagens);
+    free(sim->heap.itens);
+    free(sim->caixa); free(sim->banco); free(sim->provento); free(sim->custodiaConta); free(sim->basePosicao);
+    memset(sim, 0, sizeof(*sim));
+}
+
+static void imprimirSimulacaoCalendario(const SimuladorCalendario *sim, int diaInicio, int diaFim, double seg) {
+    static const char *nomes[] = { "datas com", "pagamentos", "aportes", "custódias", "liquidações TED" };
+    int a0, m0, d0, a1, m1, d1;
+    dataDoDia(diaInicio, &a0, &m0, &d0);
+    dataDoDia(diaFim, &a1, &m1, &d1);
+    printf("Período %04d-%02d-%02d a %04d-%02d-%02d, %d conta(s), %.2f s\n", a0, m0, d0, a1, m1, d1, sim->n, seg);
+    printf("Eventos:");
+    for (int t = 0; t < NUM_TIPOS_EVENTO; ++t) printf(" %s %lld%s", nomes[t], sim->eventos[t], t + 1 < NUM_TIPOS_EVENTO ? " |" : "\n");
+    printf("Proventos R$ %.2f | aportes R$ %.2f | custódia R$ %.2f (%lld sem caixa) | lançamentos %lld\n",
+           sim->proventos, sim->aportes, sim->custodia, sim->custodiaSemCaixa, sim->lancamentos);
+}
+
+/* avança o calendário das contas cadastradas (grava no extrato) */
+void menuSimularCalendario(void) {
+    int anos, diaAporte = 5;
+    float aporte;
+    printf("Anos a simular (1 a 50): ");
+    if (scanf("%d", &anos) != 1 || anos < 1 || anos > 50) { clear_input(); printf("Entrada inválida.\n"); return; }
+    printf("Aporte mensal banco -> investimento por conta (R$, 0 = nenhum): ");
+    if (scanf("%f", &aporte) != 1 || aporte < 0.0f) { clear_input(); printf("Valor inválido.\n"); return; }
+    if (aporte > 0.0f) {
+        printf("Dia do aporte (1 a 28): ");
+        if (scanf("%d", &diaAporte) != 1 || diaAporte < 1 || diaAporte > 28) { clear_input(); printf("Dia inválido.\n"); return; }
+    }
+    SimuladorCalendario sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.lista = usuarios; sim.n = numUsuarios; sim.lancar = true; sim.aporte = aporte; sim.diaAporte = diaAporte;
+    int inicio = (int)diaLocal(relogio_seg(), fusoProcesso()), ano, mes, dia;
+    dataDoDia(inicio, &ano, &mes, &dia);
+    int fim = diaDaData(ano + anos, mes, dia > 28 ? 28 : dia);
+    double t0 = cronometro_seg();
+    bool ok = simularCalendario(&sim, inicio, fim);
+    printf("\n=== Simulação de calendário (%d anos) ===\n", anos);
+    if (!ok) printf("Memória insuficiente; simulação interrompida.\n");
+    imprimirSimulacaoCalendario(&sim, inicio, fim, cronometro_seg() - t0);
+    liberarSimuladorCalendario(&sim);
+}
+
+/* primeiro uso do relógio virtual: o que já foi lançado vai ao journal antes, o resto da sessão é ensaio */
+static bool entrarEnsaio(void) {
+    if (sessaoEnsaio) return true;
+    printf("O relógio virtual abre uma sessão de ensaio: daqui até sair, nada é gravado\n"
+           "(extrato, cadastro, segmentos) e não há volta ao relógio real. Confirmar (s/n)? ");
+    char r[8];
+    if (scanf("%7s", r) != 1 || (r[0] != 's' && r[0] != 'S')) { clear_input(); return false; }
+    sincronizarExtrato(&filaExtrato);
+    if (salvarUsuarios()) snapshotAguardar(&gravUsuarios, gravUsuarios.entregues);   // o último snapshot real fica em disco
+    atomic_store_explicit(&sessaoEnsaio, true, memory_order_relaxed);
+    return true;
+}
+
+/* relógio do sistema: real, ou virtual fixado e avançado à mão (o próximo ciclo do menu liquida o que venceu) */
+void menuRelogio(void) {
+    int op;
+    do {
+        int ano, mes, dia, hora, min, seg;
+        dataCivil(relogio_seg(), fusoProcesso(), &ano, &mes, &dia, &hora, &min, &seg);
+        printf("\n=== Relógio (%s) ===\n", relogioEhVirtual() ? "virtual, ensaio sem gravação" : "real");
+        printf("Agora: %04d-%02d-%02d %02d:%02d:%02d\n", ano, mes, dia, hora, min, seg);
+        printf("1 - Fixar data (relógio virtual)\n");
+        printf("2 - Avançar dias\n");
+        printf("3 - Avançar meses\n");
+        printf("4 - Voltar ao relógio real\n");
+        printf("0 - Voltar\n");
+        printf("Escolha: ");
+        if (scanf("%d", &op) != 1) { clear_input(); printf("Entrada inválida.\n"); op = -1; }
+        switch (op) {
+            case 1: {
+                char data[16];
+                printf("Data (AAAA-MM-DD): ");
+                if (scanf("%15s", data) != 1) { clear_input(); break; }
+                long long d = lerData(data);
+                if (d < 0) { printf("Data inválida.\n"); break; }
+                if (!entrarEnsaio()) break;
+                relogioFixar(d);
+                break;
+            }
+            case 2:
+            case 3: {
+                int n;
+                printf(op == 2 ? "Dias: " : "Meses: ");
+                if (scanf("%d", &n) != 1 || n < 0) { clear_input(); printf("Entrada inválida.\n"); break; }
+                if (!entrarEnsaio()) break;
+                if (op == 2) relogioAvancar((long long)n * 86400);
+                else relogioFixar(somarMesesTs(relogio_seg(), n));
+                break;
+            }
+            case 4:
+                if (sessaoEnsaio) printf("Ensaio em curso: reinicie o sistema para voltar ao relógio real (nada do ensaio foi gravado).\n");
+                else relogioReal();
+                break;
+            case 0: break;
+            default: printf("Opção inválida.\n"); break;
+        }
+    } while (op != 0);
+}
+
+/* 200k contas sintéticas com 4 posições, 20 anos, sem extrato (como uma projeção em lote) */
+void benchmarkCalendario(void) {
+    const int n = 200000, anos = 20, posicoes = 4;
+    printf("\n=== Benchmark do simulador de calendário (%d contas x %d anos) ===\n", n, anos);
+    Usuario **lista = calloc((size_t)n, sizeof(Usuario *));
+    if (!lista) { printf("Memória insuficiente.\n"); return; }
+    int criados = 0;
+    unsigned semente = 31337u;
+    for (; criados < n; ++criados) {
+        Usuario *u = calloc(1, sizeof(Usuario));
+        if (!u) break;
+        u->id = -1;
+        u->efemero = true;
+        u->banco.saldo = 1e6f;
+        for (int p = 0; p < posicoes && p < NUM_ATIVOS; ++p) {
+            aleatorio(&semente);
+            int j = (int)((semente >> 8) % (unsigned)NUM_ATIVOS);
+            bool repetido = false;
+            for (int q = 0; q < u->investimento.numAtivos; ++q) repetido |= strcmp(u->investimento.carteira[q].ticker, ativosDisponiveis[j].ticker) == 0;
+            if (repetido) continue;
+            AtivoCarteira *c = &u->investimento.carteira[u->investimento.numAtivos++];
+            memcpy(c->ticker, ativosDisponiveis[j].ticker, sizeof(c->ticker));
+            c->quantidade = 10 + (int)((semente >> 4) % 500);
+            c->precoMedio = c->precoMarcado = ativosDisponiveis[j].preco;
+            u->investimento.valorMercado += (double)c->quantidade * c->precoMarcado;
+        }
+        lista[criados] = u;
+    }
+    if (criados < n) printf("Memória para só %d contas.\n", criados);
+    SimuladorCalendario sim;
+    memset(&sim, 0, sizeof(sim));
+    sim.lista = lista; sim.n = criados; sim.aporte = 500.0f; sim.diaAporte = 5;
+    int inicio = diaDaData(2025, 1, 1), fim = diaDaData(2025 + anos, 1, 1);
+    double t0 = cronometro_seg();
+    bool ok = simularCalendario(&sim, inicio, fim);
+    double dt = cronometro_seg() - t0;
+    if (!ok) printf("Memória insuficiente; simulação interrompida.\n");
+    imprimirSimulacaoCalendario(&sim, inicio, fim, dt);
+    long long postagens = 0;
+    for (int t = 0; t < NUM_TIPOS_EVENTO; ++t) postagens += sim.eventos[t];
+    /* conferência nos acumuladores densos (double): o saldo float das contas arredonda na devolução */
+    double caixa = 0.0;
+    for (int i = 0; ok && i < criados; ++i) caixa += sim.caixa[i];
+    double esperado = sim.aportes + sim.proventos - sim.custodia;
+    double tolerancia = fmax(0.01, fabs(esperado) * 1e-9);           // ordem de soma diferente, só arredondamento do double
+    printf("Conferência: caixa das contas R$ %.2f x aportes + proventos - custódia R$ %.2f: %s | %.1f anos-conta por ms\n",
+           caixa, esperado, ok && fabs(caixa - esperado) <= tolerancia ? "OK" : "FALHA", (double)criados * anos / (dt * 1e3));
+    liberarSimuladorCalendario(&sim);
+    for (int i = 0; i < criados; ++i) free(lista[i]);
+    free(lista);
+}
@@ -0,0 +1,249 @@
+#include "corretora.h"
+
+/* ======= Catálogo de ativos (arquivo mapeado e índices por prefixo) ======= */
+
+/*
+ * ARQ_CATALOGO: uma linha por ativo, campos separados por ';'
+ *   ticker;nome;preco;dividendo_por_pagamento;pagamentos_por_ano;classe
+ * classe = ACAO, FII, BDR ou ETF; linha que começa com '#' ou "ticker" é
+ * ignorada. O arquivo é mapeado e lido no lugar, sem buffer de linha; os
+ * números são lidos à mão (o locale do processo usaria vírgula decimal).
+ */
+
+const char *campoCatalogo(const char *p, const char *fim, const char **fimCampo) {
+    const char *q = p;
+    while (q < fim && *q != ';' && *q != '\n' && *q != '\r') ++q;
+    *fimCampo = q;
+    return q < fim && *q == ';' ? q + 1 : q;
+}
+
+/* *parou (opcional) recebe onde a leitura parou, ou o início se não houver dígito */
+float decimalCatalogo(const char *p, const char *fim, const char **parou) {
+    const char *inicio = p;
+    while (p < fim && *p == ' ') ++p;
+    double v = 0.0, escala = 1.0;
+    bool depois = false, digito = false;
+    for (; p < fim; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            v = v * 10.0 + (*p - '0');
+            if (depois) escala *= 10.0;
+            digito = true;
+        } else if ((*p == '.' || *p == ',') && !depois) {
+            depois = true;
+        } else {
+            break;
+        }
+    }
+    if (parou) *parou = digito ? p : inicio;
+    return (float)(v / escala);
+}
+
+void copiarCampo(char *dest, size_t tam, const char *p, const char *fim) {
+    size_t n = (size_t)(fim - p);
+    if (n >= tam) n = tam - 1;
+    memcpy(dest, p, n);
+    dest[n] = '\0';
+}
+
+static int classeDoTexto(const char *p, const char *fim) {
+    size_t n = (size_t)(fim - p);
+    if (n == 3 && memcmp(p, "FII", 3) == 0) return CLASSE_FII;
+    if (n == 3 && memcmp(p, "BDR", 3) == 0) return CLASSE_BDR;
+    if (n == 3 && memcmp(p, "ETF", 3) == 0) return CLASSE_ETF;
+    return CLASSE_ACAO;
+}
+
+const char *nomeClasse(int classe) {
+    switch (classe) {
+        case CLASSE_FII: return "FII (isento)";
+        case CLASSE_BDR: return "BDR";
+        case CLASSE_ETF: return "ETF";
+        default: return "Ação";
+    }
+}
+
+/* lê o catálogo de 'arq' para um array novo; falha sem tocar em *ativos */
+bool lerCatalogo(const char *arq, AtivoRV **ativos, int *num) {
+    size_t tam;
+    char *base = mapearArquivo(arq, &tam);
+    if (!base) return false;
+    const char *p = base, *fim = base + tam;
+    int linhas = 0;
+    for (const char *q = p; q < fim; ++q) linhas += *q == '\n';
+    AtivoRV *v = calloc((size_t)linhas + 1, sizeof(AtivoRV));
+    if (!v) { desmapearArquivo(base, tam); return false; }
+    int n = 0;
+    while (p < fim) {
+        const char *eol = memchr(p, '\n', (size_t)(fim - p));
+        if (!eol) eol = fim;
+        if (eol > p && *p != '#' && !(eol - p >= 6 && memcmp(p, "ticker", 6) == 0)) {
+            const char *f[6], *ff[6], *q = p;
+            for (int k = 0; k < 6; ++k) { f[k] = q; q = campoCatalogo(q, eol, &ff[k]); }
+            if (ff[0] > f[0]) {
+                AtivoRV *a = &v[n++];
+                copiarCampo(a->ticker, sizeof(a->ticker), f[0], ff[0]);
+                copiarCampo(a->nome, sizeof(a->nome), f[1], ff[1]);
+                a->preco = decimalCatalogo(f[2], ff[2], NULL);
+                a->dividend_per_period = decimalCatalogo(f[3], ff[3], NULL);
+                a->periods_per_year = (int)decimalCatalogo(f[4], ff[4], NULL);
+                a->classe = (unsigned char)classeDoTexto(f[5], ff[5]);
+                a->isFII = a->classe == CLASSE_FII;
+            }
+        }
+        p = eol + 1;
+    }
+    desmapearArquivo(base, tam);
+    if (n == 0) { free(v); return false; }
+    *ativos = v;
+    *num = n;
+    return true;
+}
+
+/* comparação de nomes sem diferenciar maiúsculas (ASCII; acentos comparam pelo byte) */
+static int compararNomeCatalogo(const char *a, const char *b, size_t limite) {
+    for (size_t i = 0; i < limite; ++i) {
+        int x = (unsigned char)a[i], y = (unsigned char)b[i];
+        if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+        if (x != y || x == 0) return x - y;
+    }
+    return 0;
+}
+
+static const AtivoRV *catalogoOrdenando;   // contexto do qsort
+
+static int compararPorTicker(const void *a, const void *b) {
+    return strcmp(catalogoOrdenando[*(const int *)a].ticker, catalogoOrdenando[*(const int *)b].ticker);
+}
+
+static int compararPorNome(const void *a, const void *b) {
+    int r = compararNomeCatalogo(catalogoOrdenando[*(const int *)a].nome, catalogoOrdenando[*(const int *)b].nome,
+                                 sizeof(catalogoOrdenando[0].nome));
+    return r ? r : *(const int *)a - *(const int *)b;
+}
+
+bool indexarCatalogo(const AtivoRV *ativos, int num, int **porTicker, int **porNome) {
+    int *t = malloc(sizeof(int) * (size_t)num), *n = malloc(sizeof(int) * (size_t)num);
+    if (!t || !n) { free(t); free(n); return false; }
+    for (int i = 0; i < num; ++i) t[i] = n[i] = i;
+    catalogoOrdenando = ativos;
+    qsort(t, (size_t)num, sizeof(int), compararPorTicker);
+    qsort(n, (size_t)num, sizeof(int), compararPorNome);
+    *porTicker = t;
+    *porNome = n;
+    return true;
+}
+
+/*
+ * Faixa [retorno, *fim) de 'ordem' cujos tickers (ou nomes) começam com
+ * 'prefixo': duas buscas binárias, então a página seguinte é só avançar
+ * na faixa. Ticker diferencia maiúsculas; nome não.
+ */
+int buscarPrefixoCatalogo(const AtivoRV *ativos, const int *ordem, int num, bool porNome, const char *prefixo, int *fim) {
+    size_t tam = strlen(prefixo);
+    int lo = 0, hi = num;
+    while (lo < hi) {
+        int m = (lo + hi) / 2;
+        const AtivoRV *a = &ativos[ordem[m]];
+        int r = porNome ? compararNomeCatalogo(a->nome, prefixo, tam) : strncmp(a->ticker, prefixo, tam);
+        if (r < 0) lo = m + 1; else hi = m;
+    }
+    int ini = lo;
+    hi = num;
+    while (lo < hi) {
+        int m = (lo + hi) / 2;
+        const AtivoRV *a = &ativos[ordem[m]];
+        int r = porNome ? compararNomeCatalogo(a->nome, prefixo, tam) : strncmp(a->ticker, prefixo, tam);
+        if (r <= 0) lo = m + 1; else hi = m;
+    }
+    *fim = lo;
+    return ini;
+}
+
+/* troca o catálogo embutido pelo de 'arq' (antes da carga dos usuários) e monta os índices */
+bool carregarCatalogo(const char *arq) {
+    AtivoRV *novos;
+    int num;
+    bool carregou = lerCatalogo(arq, &novos, &num);
+    if (carregou) {
+        ativosDisponiveis = novos;
+        NUM_ATIVOS = num;
+    }
+    if (!indexarCatalogo(ativosDisponiveis, NUM_ATIVOS, &catalogoPorTicker, &catalogoPorNome))
+        catalogoPorTicker = catalogoPorNome = NULL;   // sem índice: buscas lineares
+    return carregou;
+}
+
+void liberarCatalogo(void) {
+    free(catalogoPorTicker);
+    free(catalogoPorNome);
+    catalogoPorTicker = catalogoPorNome = NULL;
+    if (ativosDisponiveis != ativosPadrao) free(ativosDisponiveis);
+    ativosDisponiveis = ativosPadrao;
+    NUM_ATIVOS = numAtivosPadrao;
+}
+
+/* catálogo sintético de 10k ativos: carga (mmap + índices) e buscas por prefixo paginadas */
+void benchmarkCatalogo(void) {
+    const int num = 10000, buscas = 200000;
+    const char *arq = "catalogo_bench.csv";
+    printf("\n=== Benchmark do catálogo de ativos (%d ativos) ===\n", num);
+    FILE *fp = fopen(arq, "w");
+    if (!fp) { printf("Não foi possível criar %s.\n", arq); return; }
+    static const char *classes[] = { "ACAO", "FII", "BDR", "ETF" };
+    static const char *sufixos[] = { "3", "11", "34", "11" };
+    fprintf(fp, "ticker;nome;preco;dividendo;pagamentos;classe\n");
+    unsigned semente = 777u;
+    for (int i = 0; i < num; ++i) {
+        aleatorio(&semente);
+        int c = (int)((semente >> 12) & 3);
+        char raiz[5];
+        for (int k = 0, x = i * 7919 % (26 * 26 * 26 * 26); k < 4; ++k, x /= 26) raiz[3 - k] = (char)('A' + x % 26);
+        raiz[4] = '\0';
+        fprintf(fp, "%s%s;Empresa %s %s;%d.%02d;0.%02d;%d;%s\n", raiz, sufixos[c], raiz, classes[c],
+                1 + (int)((semente >> 8) % 300), (int)(semente % 100), (int)((semente >> 3) % 90), c == 1 ? 12 : 4, classes[c]);
+    }
+    fclose(fp);
+
+    AtivoRV *ativos;
+    int n, *porTicker, *porNome;
+    double t0 = cronometro_seg();
+    bool ok = lerCatalogo(arq, &ativos, &n);
+    double dLer = cronometro_seg() - t0;
+    remove(arq);
+    if (!ok) { printf("Falha ao ler o catálogo.\n"); return; }
+    t0 = cronometro_seg();
+    if (!indexarCatalogo(ativos, n, &porTicker, &porNome)) { free(ativos); printf("Memória insuficiente.\n"); return; }
+    double dIndexar = cronometro_seg() - t0;
+    printf("Carga: %.2f ms (leitura) + %.2f ms (índices) | %d ativos\n", dLer * 1e3, dIndexar * 1e3, n);
+
+    /* buscas por prefixo de 1 a 3 letras, cada uma lendo a primeira página */
+    long long achados = 0;
+    t0 = cronometro_seg();
+    for (int i = 0; i < buscas; ++i) {
+        aleatorio(&semente);
+        char prefixo[4] = { (char)('A' + (semente >> 8) % 26), (char)('A' + (semente >> 16) % 26), 0, 0 };
+        prefixo[(semente & 1) + 1] = '\0';
+        bool nome = (semente & 2) != 0;
+        char prefNome[16];
+        if (nome) snprintf(prefNome, sizeof(prefNome), "empresa %s", prefixo);
+        int fim, ini = buscarPrefixoCatalogo(ativos, nome ? porNome : porTicker, n, nome, nome ? prefNome : prefixo, &fim);
+        for (int k = ini; k < fim && k < ini + PAGINA_CATALOGO; ++k) achados += ativos[(nome ? porNome : porTicker)[k]].preco > 0.0f;
+    }
+    double d = cronometro_seg() - t0;
+    printf("Busca por prefixo + página de %d: %.2f us por busca (%lld ativos listados)\n",
+           PAGINA_CATALOGO, d / buscas * 1e6, achados);
+
+    /* confere a busca por ticker exato e a faixa de um prefixo contra varredura */
+    int erros = 0;
+    for (int i = 0; i < n; i += 97) {
+        int fim, ini = buscarPrefixoCatalogo(ativos, porTicker, n, false, ativos[i].ticker, &fim);
+        bool achou = false;
+        for (int k = ini; k < fim; ++k) achou |= porTicker[k] == i;
+        erros += !achou;
+    }
+    int fim, ini = buscarPrefixoCatalogo(ativos, porTicker, n, false, "B", &fim), esperados = 0;
+    for (int i = 0; i < n; ++i) esperados += ativos[i].ticker[0] == 'B';
+    printf("Conferência: %d erro(s) em buscas exatas | prefixo \"B\": %d (varredura: %d)\n", erros, fim - ini, esperados);
+    free(ativos); free(porTicker); free(porNome);
+}
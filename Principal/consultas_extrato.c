@@ -0,0 +1,548 @@
+#include "corretora.h"
+
+/* ======= Consultas paginadas ao extrato ======= */
+
+static bool listaAnexar(ListaPosicoes *l, int pos) {
+    if (l->num == l->cap) {
+        int novaCap = l->cap ? l->cap * 2 : 16;
+        int *n = realloc(l->pos, sizeof(int) * (size_t)novaCap);
+        if (!n) return false;
+        l->pos = n; l->cap = novaCap;
+    }
+    l->pos[l->num++] = pos;
+    return true;
+}
+
+void liberarIndiceExtrato(IndiceExtrato *ix) {
+    if (!ix) return;
+    for (int i = 0; i < ix->numChaves; ++i) free(ix->chaves[i].lista.pos);
+    free(ix->chaves);
+    free(ix);
+}
+
+/* lista da chave (tipo, ativo); 'criar' acrescenta a chave que faltar (NULL = não existe ou sem memória) */
+static ListaPosicoes *listaDaChave(IndiceExtrato *ix, const char *tipo, const char *ativo, bool criar) {
+    for (int i = 0; i < ix->numChaves; ++i)
+        if (strcmp(ix->chaves[i].tipo, tipo) == 0 && strcmp(ix->chaves[i].ativo, ativo) == 0) return &ix->chaves[i].lista;
+    if (!criar) return NULL;
+    if (ix->numChaves == ix->capChaves) {
+        int novaCap = ix->capChaves ? ix->capChaves * 2 : 16;
+        ChaveIndice *n = realloc(ix->chaves, sizeof(ChaveIndice) * (size_t)novaCap);
+        if (!n) return NULL;
+        ix->chaves = n; ix->capChaves = novaCap;
+    }
+    ChaveIndice *c = &ix->chaves[ix->numChaves++];
+    memset(c, 0, sizeof(*c));
+    snprintf(c->tipo, sizeof(c->tipo), "%s", tipo);
+    snprintf(c->ativo, sizeof(c->ativo), "%s", ativo);
+    return &c->lista;
+}
+
+/* alcança os lançamentos anexados desde a última consulta */
+static IndiceExtrato *indiceDaConta(Usuario *u, int conta) {
+    IndiceExtrato **pix = conta == CONTA_BANCO ? &u->banco.indice : &u->investimento.indice;
+    if (!*pix) *pix = calloc(1, sizeof(IndiceExtrato));
+    IndiceExtrato *ix = *pix;
+    if (!ix) return NULL;
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, conta, &ext, &num);
+    for (; ix->indexados < num; ix->indexados++) {
+        const Transacao *t = &ext[ix->indexados];
+        ListaPosicoes *l;
+        if (t->tipo[0] && (!(l = listaDaChave(ix, t->tipo, "", true)) || !listaAnexar(l, ix->indexados))) return NULL;
+        if (!t->ativo[0]) continue;
+        if (!(l = listaDaChave(ix, "", t->ativo, true)) || !listaAnexar(l, ix->indexados)) return NULL;
+        if (t->tipo[0] && (!(l = listaDaChave(ix, t->tipo, t->ativo, true)) || !listaAnexar(l, ix->indexados))) return NULL;
+    }
+    return ix;
+}
+
+/* primeira posição com ts >= alvo (o extrato está em ordem de ts) */
+static int primeiraComTs(const Transacao *ext, int num, long long alvo) {
+    int lo = 0, hi = num;
+    while (lo < hi) {
+        int m = lo + (hi - lo) / 2;
+        if (ext[m].ts < alvo) lo = m + 1; else hi = m;
+    }
+    return lo;
+}
+
+/* primeira posição da lista com valor >= alvo */
+static int primeiraNaLista(const ListaPosicoes *l, int alvo) {
+    int lo = 0, hi = l->num;
+    while (lo < hi) {
+        int m = lo + (hi - lo) / 2;
+        if (l->pos[m] < alvo) lo = m + 1; else hi = m;
+    }
+    return lo;
+}
+
+/*
+ * Página de lançamentos que passam nos filtros, do mais recente para o mais
+ * antigo. O intervalo de tempo vira [lo, hi) por busca binária; com filtro de
+ * tipo, ativo ou os dois percorre a lista exata daquele filtro a partir do
+ * cursor, em que todo candidato passa, então uma página custa O(chaves da
+ * conta + log n + página). Retorna o número de itens; *proxCursor recebe o
+ * cursor da próxima página ou -1 quando não há mais.
+ */
+int consultarExtrato(Usuario *u, const ConsultaExtrato *q, const Transacao **itens, int *proxCursor) {
+    *proxCursor = -1;
+    if (q->limite <= 0) return 0;
+    IndiceExtrato *ix = indiceDaConta(u, q->conta);
+    if (!ix) return 0;
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, q->conta, &ext, &num);
+
+    bool filtraTipo = q->tipo && q->tipo[0], filtraAtivo = q->ativo && q->ativo[0];
+    int lo = primeiraComTs(ext, num, q->tsIni);
+    int hi = q->tsFim == LLONG_MAX ? num : primeiraComTs(ext, num, q->tsFim + 1);
+    if (q->cursor >= 0 && q->cursor < hi) hi = q->cursor;
+
+    /* lista do filtro (NULL = sem filtro, varre as posições direto); filtro sem chave não tem lançamento */
+    const ListaPosicoes *lista = NULL;
+    if (filtraTipo || filtraAtivo) {
+        lista = listaDaChave(ix, filtraTipo ? q->tipo : "", filtraAtivo ? q->ativo : "", false);
+        if (!lista) return 0;
+    }
+
+    int n = 0, ultima = -1;
+    int i = lista ? primeiraNaLista(lista, hi) - 1 : hi - 1;
+    while (n < q->limite) {
+        int p;
+        if (lista) { if (i < 0) break; p = lista->pos[i]; }
+        else p = i;
+        if (p < lo) break;
+        i--;
+        itens[n++] = &ext[p];
+        ultima = p;
+    }
+    if (n == q->limite && ultima > lo) *proxCursor = ultima;
+    return n;
+}
+
+/* "AAAA-MM-DD" no horário local; retorna -1 se inválida */
+long long lerData(const char *txt) {
+    int a, m, d;
+    if (sscanf(txt, "%d-%d-%d", &a, &m, &d) != 3 || m < 1 || m > 12 || d < 1 || d > 31) return -1;
+    struct tm tm = { 0 };
+    tm.tm_year = a - 1900; tm.tm_mon = m - 1; tm.tm_mday = d; tm.tm_isdst = -1;
+    return (long long)mktime(&tm);
+}
+
+void menuConsultarExtrato(Usuario *u) {
+    ConsultaExtrato q = { CONTA_BANCO, 0, LLONG_MAX, NULL, NULL, PAGINA_EXTRATO, -1 };
+    char tipo[32], ativo[16];
+    int conta, dias;
+    printf("\n=== Consultar extrato ===\n");
+    printf("Conta (1 - Banco | 2 - Investimento): ");
+    if (scanf("%d", &conta) != 1 || conta < 1 || conta > 2) { clear_input(); printf("Conta inválida.\n"); return; }
+    q.conta = conta == 1 ? CONTA_BANCO : CONTA_INVEST;
+    printf("Últimos quantos dias (0 = todos): ");
+    if (scanf("%d", &dias) != 1 || dias < 0) { clear_input(); printf("Valor inválido.\n"); return; }
+    if (dias > 0) q.tsIni = relogio_seg() - (long long)dias * 86400;
+    printf("Tipo (ex.: Compra, Venda, PIX; '-' = todos): ");
+    if (scanf("%31s", tipo) != 1) { clear_input(); return; }
+    printf("Ativo (ex.: HGLG11; '-' = todos): ");
+    if (scanf("%15s", ativo) != 1) { clear_input(); return; }
+    if (strcmp(tipo, "-") != 0) q.tipo = tipo;
+    if (strcmp(ativo, "-") != 0) q.ativo = ativo;
+
+    sincronizarExtrato(&filaExtrato);
+    const Transacao *itens[PAGINA_EXTRATO];
+    int pagina = 1;
+    for (;;) {
+        int prox, n = consultarExtrato(u, &q, itens, &prox);
+        fflush(stdout);
+        SaidaBuffer s;
+        if (!saidaAbrirFd(&s, 1)) return;
+        saidaTexto(&s, "\n--- Página "); saidaInteiro(&s, pagina); saidaTexto(&s, " ---\n");
+        if (n == 0) saidaTexto(&s, "Nenhum lançamento encontrado.\n");
+        for (int i = 0; i < n; ++i) saidaLinhaTabela(&s, itens[i]);
+        saidaFechar(&s);
+        if (prox < 0) break;
+        int continuar;
+        printf("1 - Próxima página | 0 - Sair: ");
+        if (scanf("%d", &continuar) != 1) { clear_input(); break; }
+        if (continuar != 1) break;
+        q.cursor = prox;
+        pagina++;
+    }
+}
+
+/* página de 50 sobre 1M lançamentos, com e sem filtros */
+void benchmarkConsultaExtrato(void) {
+    const int total = 1000000, consultas = 20000;
+    static const char *tipos[] = { "PIX", "Compra", "Venda", "Provento", "Transferência" };
+    static const char *tickers[] = { "PETR4", "VALE3", "ITUB4", "BBAS3", "HGLG11", "MXRF11", "KNRI11", "BBDC4" };
+    printf("\n=== Benchmark de consulta paginada (%d lançamentos, página de %d) ===\n", total, PAGINA_EXTRATO);
+    Usuario *u = calloc(1, sizeof(Usuario));
+    if (!u) { printf("Memória insuficiente.\n"); return; }
+    u->efemero = true;
+    u->investimento.extrato = malloc(sizeof(Transacao) * (size_t)total);
+    if (!u->investimento.extrato) { printf("Memória insuficiente.\n"); liberarUsuario(u); return; }
+    u->investimento.numTransacoes = u->investimento.capTransacoes = total;
+    long long ts0 = 1704067200LL;          // 01/01/2024 00:00 UTC, um lançamento a cada 60 s
+    unsigned semente = 12345u;
+    for (int i = 0; i < total; ++i) {
+        Transacao *t = &u->investimento.extrato[i];
+        memset(t, 0, sizeof(*t));
+        aleatorio(&semente);
+        int k = (int)(semente >> 16) % 5;
+        snprintf(t->tipo, sizeof(t->tipo), "%s", tipos[k]);
+        if (k >= 1 && k <= 3) snprintf(t->ativo, sizeof(t->ativo), "%s", tickers[(semente >> 8) % 8]);
+        t->valor = (float)(i % 1000);
+        t->seq = (unsigned long long)i;
+        t->ts = ts0 + (long long)i * 60;
+    }
+
+    double t0 = cronometro_seg();
+    ConsultaExtrato q = { CONTA_INVEST, 0, LLONG_MAX, NULL, NULL, PAGINA_EXTRATO, -1 };
+    const Transacao *itens[PAGINA_EXTRATO];
+    int prox;
+    consultarExtrato(u, &q, itens, &prox);
+    printf("Construção do índice: %.1f ms\n", (cronometro_seg() - t0) * 1e3);
+
+    struct { const char *nome; const char *tipo; const char *ativo; int dias; } casos[] = {
+        { "sem filtro", NULL, NULL, 0 },
+        { "últimos 30 dias", NULL, NULL, 30 },
+        { "só Compra", "Compra", NULL, 0 },
+        { "só HGLG11", NULL, "HGLG11", 0 },
+        { "Venda de HGLG11, 30 dias", "Venda", "HGLG11", 30 },
+    };
+    long long tsFim = ts0 + (long long)(total - 1) * 60;
+    for (int c = 0; c < (int)(sizeof(casos) / sizeof(casos[0])); ++c) {
+        q.tipo = casos[c].tipo; q.ativo = casos[c].ativo;
+        q.tsIni = casos[c].dias ? tsFim - casos[c].dias * 86400LL : 0;
+        long long devolvidos = 0;
+        t0 = cronometro_seg();
+        for (int i = 0; i < consultas; ++i) {
+            /* páginas a partir de posições espalhadas (cursores de navegação) */
+            q.cursor = (i % 2) ? -1 : total - (int)((i * 7919LL) % (total / 10));
+            devolvidos += consultarExtrato(u, &q, itens, &prox);
+        }
+        double d = cronometro_seg() - t0;
+        printf("%-26s: %.2f us por página (%.1f itens em média)\n", casos[c].nome,
+               d / consultas * 1e6, devolvidos / (double)consultas);
+    }
+
+    /* paginação completa de um filtro deve ver cada lançamento uma vez, em ordem decrescente */
+    q.tipo = "Compra"; q.ativo = NULL; q.tsIni = 0; q.cursor = -1;
+    long long vistos = 0, esperados = 0;
+    int anterior = total;
+    bool ordemOk = true;
+    for (int i = 0; i < total; ++i) esperados += strcmp(u->investimento.extrato[i].tipo, "Compra") == 0;
+    do {
+        int n = consultarExtrato(u, &q, itens, &prox);
+        for (int i = 0; i < n; ++i) {
+            int p = (int)(itens[i] - u->investimento.extrato);
+            if (p >= anterior) ordemOk = false;
+            anterior = p;
+        }
+        vistos += n;
+        q.cursor = prox;
+    } while (prox >= 0);
+    printf("Paginação completa de 'Compra': %lld de %lld lançamentos, ordem %s\n",
+           vistos, esperados, ordemOk ? "OK" : "INCORRETA");
+    liberarUsuario(u);
+}
+
+/* ======= Saldo por data (somas de prefixo) ======= */
+
+/*
+ * O extrato é só de anexação e está em ordem de ts, então as somas de
+ * prefixo do IndiceSaldo nunca precisam ser refeitas: saldo na data é uma
+ * busca binária e a integral do saldo até T é integral[k] + saldo[k] *
+ * (T - ts[k]). Saldo médio de um período = diferença das integrais / duração.
+ */
+
+/* posição do último lançamento com ts <= alvo (-1 se nenhum) */
+static int ultimoAte(Usuario *u, int conta, long long alvo, const IndiceSaldo **ix) {
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, conta, &ext, &num);
+    *ix = conta == CONTA_BANCO ? &u->banco.saldos : &u->investimento.saldos;
+    if ((*ix)->num < num) num = (*ix)->num;
+    return primeiraComTs(ext, num, alvo == LLONG_MAX ? alvo : alvo + 1) - 1;
+}
+
+/* saldo em centavos ao fim do instante ts (0 antes do primeiro lançamento) */
+long long saldoNaData(Usuario *u, int conta, long long ts) {
+    const IndiceSaldo *ix;
+    int k = ultimoAte(u, conta, ts, &ix);
+    return k < 0 ? 0 : ix->saldoCent[k];
+}
+
+/* integral do saldo de -inf até ts, em centavos x segundos */
+static double integralSaldo(Usuario *u, int conta, long long ts) {
+    const IndiceSaldo *ix;
+    int k = ultimoAte(u, conta, ts, &ix);
+    if (k < 0) return 0.0;
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, conta, &ext, &num);
+    return ix->integral[k] + (double)ix->saldoCent[k] * (double)(ts - ext[k].ts);
+}
+
+/* saldo médio (ponderado pelo tempo) em centavos no período [tsIni, tsFim) */
+double saldoMedioPeriodo(Usuario *u, int conta, long long tsIni, long long tsFim) {
+    if (tsFim <= tsIni) return (double)saldoNaData(u, conta, tsIni);
+    return (integralSaldo(u, conta, tsFim) - integralSaldo(u, conta, tsIni)) / (double)(tsFim - tsIni);
+}
+
+static long long inicioDoMesAtual(void) {
+    time_t agora = (time_t)relogio_seg();
+    struct tm t = *localtime(&agora);
+    t.tm_mday = 1; t.tm_hour = 0; t.tm_min = 0; t.tm_sec = 0; t.tm_isdst = -1;
+    return (long long)mktime(&t);
+}
+
+void menuSaldoNaData(Usuario *u) {
+    char data[16];
+    printf("\n=== Saldo em uma data ===\n");
+    printf("Data (AAAA-MM-DD): ");
+    if (scanf("%15s", data) != 1) { clear_input(); return; }
+    long long d = lerData(data);
+    if (d < 0) { printf("Data inválida.\n"); return; }
+    sincronizarExtrato(&filaExtrato);
+    long long fimDoDia = d + 86399;
+    long long iniMes = inicioDoMesAtual(), agora = relogio_seg();
+    printf("Saldo Banco em %s: R$ %.2f\n", data, saldoNaData(u, CONTA_BANCO, fimDoDia) / 100.0);
+    printf("Saldo caixa investimento em %s: R$ %.2f\n", data, saldoNaData(u, CONTA_INVEST, fimDoDia) / 100.0);
+    printf("Saldo médio no mês atual: Banco R$ %.2f | Investimento R$ %.2f\n",
+           saldoMedioPeriodo(u, CONTA_BANCO, iniMes, agora) / 100.0,
+           saldoMedioPeriodo(u, CONTA_INVEST, iniMes, agora) / 100.0);
+}
+
+/* ex.: saldo de todos os clientes em 31/03/2025 (uma busca binária por conta) */
+void relatorioSaldosNaData(void) {
+    char data[16];
+    printf("\n=== Saldos de todos os clientes em uma data ===\n");
+    printf("Data (AAAA-MM-DD): ");
+    if (scanf("%15s", data) != 1) { clear_input(); return; }
+    long long d = lerData(data);
+    if (d < 0) { printf("Data inválida.\n"); return; }
+    sincronizarExtrato(&filaExtrato);
+    long long totalBanco = 0, totalInvest = 0;
+    for (int i = 0; i < numUsuarios; ++i) {
+        long long b = saldoNaData(usuarios[i], CONTA_BANCO, d + 86399);
+        long long v = saldoNaData(usuarios[i], CONTA_INVEST, d + 86399);
+        printf("%-20s | %-12s | Banco: R$ %10.2f | Investimento: R$ %10.2f\n",
+               usuarios[i]->nome, usuarios[i]->cpf, b / 100.0, v / 100.0);
+        totalBanco += b; totalInvest += v;
+    }
+    printf("Total em %s: Banco R$ %.2f | Investimento R$ %.2f\n", data, totalBanco / 100.0, totalInvest / 100.0);
+}
+
+/* 1M lançamentos anexados e 1M consultas de saldo/saldo médio, conferidas por varredura */
+void benchmarkSaldoNaData(void) {
+    const int total = 1000000, consultas = 1000000, conferidas = 200;
+    printf("\n=== Benchmark de saldo por data (%d lançamentos) ===\n", total);
+    Usuario *u = calloc(1, sizeof(Usuario));
+    if (!u) { printf("Memória insuficiente.\n"); return; }
+    u->efemero = true;
+    long long ts = 1704067200LL;
+    float saldo = 0.0f;
+    unsigned semente = 4242u;
+    Transacao t;
+    memset(&t, 0, sizeof(t));
+    double t0 = cronometro_seg();
+    for (int i = 0; i < total; ++i) {
+        aleatorio(&semente);
+        ts += (semente >> 16) % 600;
+        t.valor = (float)((int)((semente >> 8) % 20001) - 10000) / 100.0f;
+        saldo += t.valor;
+        t.saldoFinal = saldo;
+        t.ts = ts;
+        t.seq = (unsigned long long)i;
+        if (!anexarExtrato(&u->banco.extrato, &u->banco.numTransacoes, &u->banco.capTransacoes, &u->banco.saldos, &t)) {
+            printf("Memória insuficiente.\n"); liberarUsuario(u); return;
+        }
+    }
+    printf("Anexação com índice: %.1f ms\n", (cronometro_seg() - t0) * 1e3);
+
+    long long ts0 = u->banco.extrato[0].ts, ts1 = ts;
+    double soma = 0.0;
+    t0 = cronometro_seg();
+    for (int i = 0; i < consultas; ++i) {
+        long long alvo = ts0 + (long long)((unsigned long long)i * 2654435761u % (unsigned long long)(ts1 - ts0));
+        soma += (double)saldoNaData(u, CONTA_BANCO, alvo);
+    }
+    double d = cronometro_seg() - t0;
+    printf("Saldo na data:      %.0f ns por consulta\n", d / consultas * 1e9);
+    t0 = cronometro_seg();
+    for (int i = 0; i < consultas; ++i) {
+        long long a = ts0 + (long long)((unsigned long long)i * 2654435761u % (unsigned long long)(ts1 - ts0));
+        soma += saldoMedioPeriodo(u, CONTA_BANCO, a, a + 30 * 86400LL);
+    }
+    d = cronometro_seg() - t0;
+    printf("Saldo médio 30 dias: %.0f ns por consulta (soma de controle %.0f)\n", d / consultas * 1e9, soma);
+
+    /* confere com varredura direta do extrato */
+    int erros = 0;
+    for (int c = 0; c < conferidas; ++c) {
+        long long a = ts0 + (long long)((unsigned long long)c * 97531u % (unsigned long long)(ts1 - ts0)), b = a + 7 * 86400LL;
+        long long saldoAtual = 0, esperadoSaldo = 0;
+        double integ = 0.0;
+        long long tPrev = a;
+        for (int i = 0; i < total; ++i) {
+            const Transacao *x = &u->banco.extrato[i];
+            if (x->ts <= a) { saldoAtual = paraCentavos(x->saldoFinal); esperadoSaldo = saldoAtual; continue; }
+            if (x->ts >= b) break;
+            integ += (double)saldoAtual * (double)(x->ts - tPrev);
+            saldoAtual = paraCentavos(x->saldoFinal);
+            tPrev = x->ts;
+        }
+        integ += (double)saldoAtual * (double)(b - tPrev);
+        double medio = saldoMedioPeriodo(u, CONTA_BANCO, a, b);
+        if (saldoNaData(u, CONTA_BANCO, a) != esperadoSaldo || medio - integ / (double)(b - a) > 0.5
+            || integ / (double)(b - a) - medio > 0.5) erros++;
+    }
+    printf("Conferência por varredura: %d de %d consultas divergentes\n", erros, conferidas);
+    liberarUsuario(u);
+}
+
+/* ======= Extrato consolidado (intercalação k-way) ======= */
+
+/*
+ * Os extratos das contas já estão em ordem de ts; o consolidado é a
+ * intercalação deles por um heap mínimo de k fontes, O(n log k), sem
+ * materializar nem copiar lançamentos: cada chamada devolve o próximo.
+ * Dentro do mesmo segundo desempata pelo instante em ns, que deixa as duas
+ * pernas de uma transferência lado a lado; empates restantes seguem a
+ * ordem das fontes.
+ */
+
+static bool fonteAntes(const IntercaladorExtrato *it, int a, int b) {
+    const FonteExtrato *fa = &it->fontes[a], *fb = &it->fontes[b];
+    long long ta = fa->ext[fa->pos].ts, tb = fb->ext[fb->pos].ts;
+    if (ta != tb) return ta < tb;
+    long long na = fa->ext[fa->pos].tsNs, nb = fb->ext[fb->pos].tsNs;
+    if (na != nb) return na < nb;
+    return a < b;                         // dentro da fonte a ordem já é a do seq
+}
+
+static void heapDescer(IntercaladorExtrato *it, int i) {
+    for (;;) {
+        int menor = i, e = 2 * i + 1, d = e + 1;
+        if (e < it->tamHeap && fonteAntes(it, it->heap[e], it->heap[menor])) menor = e;
+        if (d < it->tamHeap && fonteAntes(it, it->heap[d], it->heap[menor])) menor = d;
+        if (menor == i) return;
+        int tmp = it->heap[i]; it->heap[i] = it->heap[menor]; it->heap[menor] = tmp;
+        i = menor;
+    }
+}
+
+static void heapSubir(IntercaladorExtrato *it, int i) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!fonteAntes(it, it->heap[i], it->heap[pai])) return;
+        int tmp = it->heap[i]; it->heap[i] = it->heap[pai]; it->heap[pai] = tmp;
+        i = pai;
+    }
+}
+
+void intercaladorIniciar(IntercaladorExtrato *it) {
+    it->numFontes = 0;
+    it->tamHeap = 0;
+}
+
+/* as fontes devem ser adicionadas na ordem de desempate desejada */
+bool intercaladorAdicionar(IntercaladorExtrato *it, const Transacao *ext, int num, int conta) {
+    if (it->numFontes == MAX_FONTES_EXTRATO) return false;
+    int f = it->numFontes++;
+    it->fontes[f] = (FonteExtrato){ ext, num, 0, conta };
+    if (num > 0) {
+        it->heap[it->tamHeap++] = f;
+        heapSubir(it, it->tamHeap - 1);
+    }
+    return true;
+}
+
+/* próximo lançamento em ordem cronológica (NULL no fim); *conta recebe a conta de origem */
+const Transacao *intercaladorProximo(IntercaladorExtrato *it, int *conta) {
+    if (it->tamHeap == 0) return NULL;
+    FonteExtrato *f = &it->fontes[it->heap[0]];
+    const Transacao *t = &f->ext[f->pos++];
+    if (conta) *conta = f->conta;
+    if (f->pos == f->num) it->heap[0] = it->heap[--it->tamHeap];
+    if (it->tamHeap > 0) heapDescer(it, 0);
+    return t;
+}
+
+void intercaladorDoUsuario(IntercaladorExtrato *it, Usuario *u) {
+    intercaladorIniciar(it);
+    intercaladorAdicionar(it, u->banco.extrato, u->banco.numTransacoes, CONTA_BANCO);
+    intercaladorAdicionar(it, u->investimento.extrato, u->investimento.numTransacoes, CONTA_INVEST);
+}
+
+/* extrato consolidado no terminal, em páginas (o intercalador guarda a posição) */
+void exibirExtratoConsolidado(Usuario *u) {
+    sincronizarExtrato(&filaExtrato);
+    IntercaladorExtrato it;
+    intercaladorDoUsuario(&it, u);
+    printf("\n=== EXTRATO CONSOLIDADO (BANCO + INVESTIMENTO) ===\n");
+    if (it.tamHeap == 0) printf("Nenhuma transação.\n");
+    while (it.tamHeap > 0) {
+        fflush(stdout);
+        SaidaBuffer s;
+        if (!saidaAbrirFd(&s, 1)) return;
+        const Transacao *t;
+        int conta;
+        for (int n = 0; n < PAGINA_EXTRATO && (t = intercaladorProximo(&it, &conta)) != NULL; ++n) {
+            saidaTexto(&s, conta == CONTA_BANCO ? "Banco  | " : "Invest | ");
+            saidaLinhaTabela(&s, t);
+        }
+        saidaFechar(&s);
+        if (it.tamHeap == 0) break;
+        int continuar;
+        printf("1 - Próxima página | 0 - Sair: ");
+        if (scanf("%d", &continuar) != 1) { clear_input(); break; }
+        if (continuar != 1) break;
+    }
+    printf("Saldo Banco: R$ %.2f | Saldo caixa investimento: R$ %.2f\n", u->banco.saldo, u->investimento.saldo);
+    long long iniMes = inicioDoMesAtual(), agora = relogio_seg();
+    printf("Saldo médio no mês: Banco R$ %.2f | Investimento R$ %.2f\n",
+           saldoMedioPeriodo(u, CONTA_BANCO, iniMes, agora) / 100.0,
+           saldoMedioPeriodo(u, CONTA_INVEST, iniMes, agora) / 100.0);
+}
+
+/* intercala 8 extratos sintéticos com 4M lançamentos no total e confere a ordem */
+void benchmarkIntercalacao(void) {
+    const int porFonte = 500000;
+    printf("\n=== Benchmark do extrato consolidado (%d extratos x %d lançamentos) ===\n",
+           MAX_FONTES_EXTRATO, porFonte);
+    Transacao *base = malloc(sizeof(Transacao) * (size_t)porFonte * MAX_FONTES_EXTRATO);
+    if (!base) { printf("Memória insuficiente.\n"); return; }
+    unsigned semente = 777u;
+    for (int f = 0; f < MAX_FONTES_EXTRATO; ++f) {
+        long long ts = 1704067200LL;
+        for (int i = 0; i < porFonte; ++i) {
+            Transacao *t = &base[(size_t)f * porFonte + i];
+            aleatorio(&semente);
+            ts += (semente >> 16) % 120;      // passos irregulares, com empates entre fontes
+            t->ts = ts;
+            t->tsNs = ts * 1000000000LL;
+            t->seq = (unsigned long long)i;
+        }
+    }
+    IntercaladorExtrato it;
+    intercaladorIniciar(&it);
+    for (int f = 0; f < MAX_FONTES_EXTRATO; ++f)
+        intercaladorAdicionar(&it, base + (size_t)f * porFonte, porFonte, f);
+
+    double t0 = cronometro_seg();
+    long long n = 0;
+    bool ordemOk = true;
+    long long tsAnt = 0;
+    const Transacao *t;
+    while ((t = intercaladorProximo(&it, NULL)) != NULL) {
+        if (t->ts < tsAnt) ordemOk = false;
+        tsAnt = t->ts;
+        n++;
+    }
+    double d = cronometro_seg() - t0;
+    printf("%lld lançamentos em %.3f s (%.1f M/s), ordem %s\n", n, d, n / d / 1e6, ordemOk ? "OK" : "INCORRETA");
+    free(base);
+}
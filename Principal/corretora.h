@@ -0,0 +1,1288 @@
+// corretora.h - configuração, tipos, estado global e protótipos comuns aos módulos da corretora
+// Compilação: gcc -O2 -pthread Principal/*.c -o corretora -lm
+
+#ifndef CORRETORA_H
+#define CORRETORA_H
+
+/* pwrite, fdatasync, clock_gettime, MAP_POPULATE etc. também com -std=c11 */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <locale.h>
+#include <time.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/* io_uring opcional (Linux): syscalls diretas, sem depender da liburing */
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define USAR_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+#endif
+
+/* ======= Config ======= */
+#define MAX_TRANSACOES 200             // capacidade inicial do extrato (cresce sob demanda)
+#define MAX_ATIVOS 50
+#define MAX_NOME 50
+#define MAX_CPF 16
+#define MAX_SENHA 20
+
+#define TAXA_TED 0.01f                 // taxa do TED (1%), descontada do valor creditado
+#define INTERVALO_LIQUIDACAO_TED 60    // segundos entre lotes de liquidação de TED
+
+#define NUM_SHARDS_EXTRATO 16          // anéis MPSC de lançamentos (conta -> shard)
+#define TAM_ANEL_EXTRATO 4096          // posições por anel (potência de 2)
+#define LOTE_EXTRATO 256               // lançamentos drenados por shard a cada passada
+#define ARQ_JOURNAL "extrato.journal"
+#define ARQ_USUARIOS "usuarios.dat"
+#define ARQ_TAXAS "taxas.cfg"          // tabela de taxas opcional (sem arquivo, vale a tabela embutida)
+#define ARQ_CATALOGO "ativos.csv"      // catálogo de ativos opcional (sem arquivo, vale o embutido)
+#define ARQ_HISTORICO "historico.csv"  // fechamentos e proventos para o backtest (ticker;AAAA-MM-DD;fechamento[;provento])
+#define ARQ_PRECOS "precos.csv"        // cotações do feed (ticker;ts;centavos), relidas na carga
+
+#define NUM_BUFFERS_GRAVADOR 16        // buffers de gravação (registrados no io_uring)
+#define TAM_BUFFER_GRAVADOR (256 * 1024)
+#define THREADS_GRAVADOR 4             // pool do backend pwrite+fdatasync
+#define THREADS_RELATORIO 8            // workers do relatório mensal (usuários divididos entre eles)
+#define LIMITE_ISENCAO_ACOES 2000000LL // vendas de ações no mês até R$ 20.000,00 (centavos): ganho comum isento
+#define ALIQUOTA_COMUM 0.15            // ações, operações comuns
+#define ALIQUOTA_DAY_TRADE 0.20
+#define ALIQUOTA_FII 0.20
+#define DARF_MINIMO 1000LL             // DARF abaixo de R$ 10,00 acumula para o mês seguinte
+#define MAX_FAIXAS_TAXA 8              // faixas por tabela de taxa (corretagem, custódia)
+#define VERSAO_ARQUIVOS 1
+
+#define TAM_BLOCO_COL 4096             // linhas por bloco do arquivo colunar
+#define MAX_TIPOS_DIC 64               // tipos no dicionário (cabem na máscara do bloco)
+#define DIR_ARQUIVO "arquivo_"         // prefixo dos segmentos selados (arquivo_000001.col)
+#define TAM_BUFFER_SAIDA (1 << 20)     // buffer da exportação (uma chamada write por MB)
+#define MAX_ATIVOS_DIC 65535           // códigos de ativo cabem em unsigned short (0 = nenhum)
+#define PAGINA_EXTRATO 50              // lançamentos por página nas consultas
+#define PAGINA_CATALOGO 20             // ativos por página na listagem do catálogo
+#define TAM_BLOCO_SERIE 1024           // bytes de dados por bloco da série de preços
+#define MAX_PONTOS_BLOCO (TAM_BLOCO_SERIE * 4)   // cada ponto ocupa ao menos 2 bits
+#define NUM_PERIODOS_VELA 3            // 1 minuto, 1 hora, 1 dia
+#define VELAS_1MIN 240                 // velas guardadas por período (anel): 4 h de 1 min,
+#define VELAS_1H 168                   // ~3 semanas de pregão em 1 h
+#define VELAS_1D 260                   // ~1 ano de pregões
+#define VELAS_POR_ATIVO (VELAS_1MIN + VELAS_1H + VELAS_1D)
+#define MAX_JANELA_INDICADOR 256       // maior período aceito para SMA/Bollinger (anel de fechamentos)
+#define MAX_WATCHLIST 32               // ativos acompanhados por usuário
+#define TAM_FILA_ALERTAS (1 << 16)     // eventos de alerta disparados aguardando entrega (potência de 2)
+#define JANELA_RISCO 252               // retornos diários usados na covariância (~1 ano)
+#define PAINEL_COVARIANCIA 64          // colunas da covariância por painel (séries do painel ficam na cache)
+#define Z_VAR_95 1.6448536269514722    // quantil 95% da normal
+#define THREADS_MONTE_CARLO 8          // workers da projeção Monte Carlo (caminhos divididos entre eles)
+#define LANES_MONTE_CARLO 8            // caminhos simulados juntos (uma lane AVX2 de 32 bits cada)
+#define BLOCO_MONTE_CARLO 64           // caminhos por retirada de trabalho (múltiplo de LANES_MONTE_CARLO)
+#define TAM_TABELA_NORMAL 1024         // pontos da inversa da normal interpolada
+#define THREADS_BACKTEST 8             // workers da grade de parâmetros do backtest
+#define BLOCO_BACKTEST 16              // conjuntos de parâmetros por retirada de trabalho
+#define MAX_PREGOES_MES 31             // pregões de um mês no histórico do backtest (um por data)
+#define MAX_FONTES_EXTRATO 8           // extratos intercalados no extrato consolidado
+
+/* SSSE3 só é usado se a CPU tiver (verificado em tempo de execução) */
+#if defined(__x86_64__) || defined(__i386__)
+#define USAR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/* ======= Tipos ======= */
+
+/* Registro de transação para extrato */
+typedef struct {
+    char tipo[32];       // "PIX", "TED", "Transferência", "Compra", "Venda", "Resgate", "Provento"
+    char descricao[80];  // descrição curta
+    float valor;         // valor (positivo = entrada, negativo = saída)
+    float taxa;          // taxa aplicada (se houver)
+    float saldoFinal;    // saldo após operação (pode ser do banco ou do caixa invest)
+    char dataHora[20];   // "dd/mm HH:MM"
+    unsigned long long seq; // número de sequência (monotônico por conta)
+    long long ts;        // instante do lançamento (epoch, segundos)
+    long long tsNs;      // mesmo instante em ns (ordena lançamentos do mesmo segundo entre contas)
+    char ativo[16];      // ticker envolvido (compra, venda, provento) ou vazio
+    int quantidade;      // cotas envolvidas (compra, venda, provento)
+    float resultado;     // lucro/prejuízo realizado na venda (contra o preço médio)
+} Transacao;
+
+/* Ativo disponível na simulação */
+typedef struct {
+    char ticker[16];
+    char nome[50];
+    float preco;                 // preço unitário atual (fixo na simulação)
+    float dividend_per_period;   // dividendo por cota por pagamento
+    int periods_per_year;        // quantas vezes paga por ano (1,2,4,12)
+    bool isFII;                  // FII tem rendimento isento (sim)
+    int mesesAcumulados;         // acumula meses simulados
+    unsigned char classe;        // CLASSE_ACAO, CLASSE_FII, CLASSE_BDR, CLASSE_ETF
+} AtivoRV;
+
+enum { CLASSE_ACAO = 0, CLASSE_FII, CLASSE_BDR, CLASSE_ETF };
+
+/*
+ * Série de preços comprimida (estilo Gorilla): blocos de tamanho fixo com
+ * ts em delta-de-delta e preço em XOR com o anterior; tsBloco[] é o
+ * índice de tempo (primeiro ts de cada bloco) para leituras por faixa.
+ */
+typedef struct {
+    int pontos;
+    int bits;                             // bits ocupados em dados
+    unsigned char dados[TAM_BLOCO_SERIE + 8];   // +8: leitura de 64 bits sem passar do fim
+} BlocoSerie;
+
+typedef struct {
+    BlocoSerie **blocos;
+    long long *tsBloco;
+    int num, cap;
+    long long pontos;
+    int escala;                           // segundos por unidade de ts gravada (0 ou 1 = segundos)
+    /* estado do codificador no bloco aberto (ts em unidades da escala) */
+    long long tsAnt, deltaAnt;
+    uint32_t valorAnt;
+    int zerosEsq, zerosDir;               // janela de bits significativos do último XOR
+} SeriePrecos;
+
+/* histórico de um ativo do catálogo: ticks e fechamentos diários */
+typedef struct {
+    SeriePrecos ticks;
+    SeriePrecos fechamentos;              // ts = data (dia local * 86400), escala diária
+    long long diaUltimo, tsUltimo;        // último tick (fecha o dia quando o dia muda)
+    float precoUltimo;
+} HistoricoAtivo;
+
+/* vela OHLCV de um período */
+typedef struct {
+    long long inicio;                     // início do período (0 = vela vazia)
+    float abertura, maxima, minima, fechamento;
+    long long volume;                     // cotas negociadas no período
+} Vela;
+
+/*
+ * Velas de um ativo: um anel pré-alocado por período, contíguos em
+ * 'anel'. Um produtor por ativo; 'seq' é um seqlock (ímpar durante a
+ * escrita) para leituras consistentes sem travar o feed.
+ */
+typedef struct {
+    atomic_uint seq;
+    int cabeca[NUM_PERIODOS_VELA];        // posição da vela corrente em cada anel
+    int num[NUM_PERIODOS_VELA];
+    Vela *anel;                           // VELAS_POR_ATIVO: 1 min | 1 h | 1 dia
+} VelasAtivo;
+
+/* períodos dos indicadores técnicos (em velas diárias) */
+typedef struct {
+    int sma, ema, rsi, bollinger;
+    float desvios;                        // largura das bandas de Bollinger em desvios-padrão
+} ParametrosIndicadores;
+
+/* estado incremental dos indicadores de um ativo: somas correntes e anel dos últimos fechamentos */
+typedef struct {
+    float janela[MAX_JANELA_INDICADOR];
+    int pos;                              // próxima posição do anel
+    int n;                                // fechamentos vistos
+    double somaSma, somaBoll, somaQuadBoll;
+    double ema, ganho, perda;             // ganho/perda: médias de Wilder do RSI
+    float anterior;
+} EstadoIndicadores;
+
+typedef struct {
+    float sma, ema, rsi, bandaInf, bandaSup;
+} Indicadores;
+
+/* lote de compra: instante, cotas ainda abertas e preço pago */
+typedef struct {
+    long long ts;
+    int quantidade;
+    float preco;
+} Lote;
+
+/* lotes abertos de uma posição em anel (capacidade potência de 2), do mais antigo ao mais novo */
+typedef struct {
+    Lote *itens;
+    int cabeca;
+    int num;
+    int cap;
+} FilaLotes;
+
+/* custo consumido numa venda, separado entre day trade (lotes do mesmo dia) e comum (FIFO) */
+typedef struct {
+    int qtdDayTrade;
+    double custoDayTrade;
+    int qtdComum;
+    double custoComum;
+} ConsumoLotes;
+
+/* Entrada de carteira (posse do usuário) */
+typedef struct {
+    char ticker[16];
+    int quantidade;
+    float precoMedio; // preço médio de compra
+    int mesesAcumuladosLocal; // opcional: se quiser contar por posição (não usado hoje)
+    float resultadoRealizado; // lucro/prejuízo das vendas desde a abertura da posição
+    float proventos;          // proventos recebidos desde a abertura da posição
+    float precoMarcado;       // último preço usado no resultado não realizado
+    FilaLotes lotes;          // lotes abertos (soma das cotas = quantidade)
+    float residuoDrip;        // DRIP: proventos que ainda não completaram uma cota (só em memória)
+    float alvoDrip;           // DRIP por alocação-alvo: fração desejada da carteira (só em memória)
+} AtivoCarteira;
+
+/* posição como gravada no snapshot (o resultado é reconstruído do journal) */
+typedef struct {
+    char ticker[16];
+    int quantidade;
+    float precoMedio;
+    int mesesAcumuladosLocal;
+} PosicaoSalva;
+
+/* posições (crescentes) de lançamentos no extrato de uma conta */
+typedef struct {
+    int *pos;
+    int num;
+    int cap;
+} ListaPosicoes;
+
+/* chave do índice: só tipo, só ativo ou o par (campo vazio = não filtra) */
+typedef struct {
+    char tipo[32];
+    char ativo[16];
+    ListaPosicoes lista;
+} ChaveIndice;
+
+/*
+ * Índice secundário de um extrato, uma lista de posições por filtro (tipo,
+ * ativo e tipo+ativo), com chaves próprias da conta: consultar não mexe nos
+ * dicionários globais do arquivo colunar. É construído sob demanda na
+ * consulta (só cobre os 'indexados' primeiros lançamentos e alcança o resto
+ * na próxima). O índice por tempo é o próprio extrato, mantido em ordem de ts.
+ */
+typedef struct {
+    int indexados;
+    ChaveIndice *chaves;
+    int numChaves, capChaves;
+} IndiceExtrato;
+
+/*
+ * Somas de prefixo do saldo de uma conta, alinhadas às posições do extrato:
+ * saldo em centavos após cada lançamento e a integral do saldo no tempo até
+ * o instante dele (centavos x segundos). Crescem a cada lançamento anexado.
+ */
+typedef struct {
+    long long *saldoCent;
+    double *integral;
+    int num;
+    int cap;
+} IndiceSaldo;
+
+/*
+ * Apuração de IR sobre ganho de capital em centavos, atualizada a cada
+ * venda: mês corrente, volume de ações vendido (isenção), ganhos por
+ * balde e prejuízos a compensar. O fechamento do mês gera o DARF.
+ */
+typedef struct {
+    int mes;                           // AAAAMM em apuração (0 = nenhuma venda ainda)
+    long long vendasAcoes;             // volume de ações vendido no mês (FII não conta)
+    long long ganhoComum, ganhoDayTrade, ganhoFII;
+    long long prejuizoComum, prejuizoDayTrade, prejuizoFII;   // a compensar nos meses seguintes
+    long long impostoAcumulado;        // abaixo do DARF mínimo, vai para o próximo
+    long long darfEmAberto;            // meses fechados na virada (sem o lote mensal) ainda não emitidos
+} ApuracaoIR;
+
+/*
+ * Tabela de faixas em arrays planos: a faixa de um valor é a contagem de
+ * limites 'ate' que ele ultrapassa; taxa = fixo + valor * ppm / 10^6.
+ */
+typedef struct {
+    int num;
+    long long ate[MAX_FAIXAS_TAXA];    // teto da faixa em centavos (LLONG_MAX a partir da última)
+    long long fixo[MAX_FAIXAS_TAXA];   // centavos
+    int ppm[MAX_FAIXAS_TAXA];          // partes por milhão do valor
+} TabelaFaixas;
+
+typedef struct {
+    TabelaFaixas corretagem;           // por ordem, sobre o valor negociado
+    TabelaFaixas custodia;             // mensal, sobre o valor de mercado da carteira
+    int emolumentosPpm[2];             // [0] operação comum, [1] day trade
+    int liquidacaoPpm[2];
+} TabelaTaxas;
+
+typedef struct {
+    long long corretagem, emolumentos, liquidacao;   // centavos
+} TaxasOperacao;
+
+/* Conta de investimento: saldo em caixa + carteira + extrato próprio */
+typedef struct {
+    float saldo;                       // caixa disponível para investir / resgatar
+    AtivoCarteira carteira[MAX_ATIVOS];
+    int numAtivos;
+    /* agregados da carteira, mantidos em O(1) por compra, venda, preço e provento */
+    double custoCarteira;              // soma de quantidade x preço médio
+    double valorMercado;               // soma de quantidade x preço marcado
+    double resultadoRealizado;         // vendas (inclui posições já encerradas)
+    double proventosRecebidos;
+    ApuracaoIR ir;                     // imposto sobre vendas (refeito do journal na carga)
+    Transacao *extrato;                // preenchido pelo consumidor da fila de extrato
+    int numTransacoes;
+    int capTransacoes;
+    unsigned long long seqArquivar;    // lançamentos com seq menor já estão selados
+    IndiceExtrato *indice;             // índice de consultas (criado na primeira consulta)
+    IndiceSaldo saldos;                // saldo por data (atualizado a cada lançamento)
+    long long diaCustodia;             // último dia local com custódia cobrada (refeito do journal na carga)
+} ContaInvestimento;
+
+/* Conta do banco: saldo + extrato */
+typedef struct {
+    float saldo;
+    float tedPendente;                 // TEDs enviados aguardando liquidação (reservado)
+    Transacao *extrato;                // preenchido pelo consumidor da fila de extrato
+    int numTransacoes;
+    int capTransacoes;
+    unsigned long long seqArquivar;    // lançamentos com seq menor já estão selados
+    IndiceExtrato *indice;             // índice de consultas (criado na primeira consulta)
+    IndiceSaldo saldos;                // saldo por data (atualizado a cada lançamento)
+} ContaBanco;
+
+/*
+ * Alertas de preço por ativo, um lado por direção. ABAIXO (dispara com
+ * preço < limite) fica em ordem crescente e ACIMA (preço > limite) em
+ * ordem decrescente: os próximos a disparar estão sempre no fim do array,
+ * que funciona como um cursor que recua a cada disparo.
+ */
+enum { ALERTA_ABAIXO = 0, ALERTA_ACIMA = 1 };
+enum { ALERTA_ATIVO = 0, ALERTA_DISPARADO, ALERTA_CANCELADO };
+
+typedef struct {
+    float limite;
+    uint32_t id;
+} GatilhoAlerta;
+
+typedef struct {
+    GatilhoAlerta *g;
+    int num, cap;
+    bool desordenado;                     // carga em lote: ordena no próximo tick
+} LadoAlertas;
+
+typedef struct {
+    int usuario;                          // Usuario.id (-1 = sintético)
+    int ativo;
+    float limite;
+    unsigned char direcao, estado;
+} RegistroAlerta;
+
+typedef struct {
+    uint32_t id;
+    int usuario, ativo;
+    float limite, preco;
+    long long ts;
+    unsigned char direcao;
+} EventoAlerta;
+
+/* fila SPSC de alertas disparados: o tick produz, a entrega consome */
+typedef struct {
+    EventoAlerta itens[TAM_FILA_ALERTAS];
+    atomic_uint cabeca, cauda;
+    atomic_llong perdidos;                // fila cheia: evento descartado
+} FilaEventosAlerta;
+
+typedef struct {
+    LadoAlertas (*lados)[2];              // [ativo][direção]
+    float *ultimoPreco;                   // por ativo
+    int numAtivos;
+    RegistroAlerta *reg;                  // por id
+    uint32_t num, cap;
+    FilaEventosAlerta *fila;
+} MotorAlertas;
+
+/*
+ * Retornos diários de um conjunto de ativos e a matriz de covariância
+ * deles. Os retornos ficam centrados na média, [ativo][dia], com cada linha
+ * completada com zeros até múltiplo de 4.
+ */
+typedef struct {
+    long long dia;                        // dia local do cálculo (-1 = nunca)
+    int numAtivos;
+    int dias, passo;                      // retornos por ativo e tamanho da linha
+    double *retornos;
+    double *media;                        // retorno médio diário por ativo
+    double *cov;                          // [numAtivos][numAtivos]
+} RiscoMercado;
+
+typedef struct {
+    double valor;                         // valor de mercado das posições (R$)
+    double volatilidade;                  // desvio-padrão do resultado em 1 dia (R$)
+    double varParametrico, varHistorico;  // perda em 1 dia com 95% de confiança (R$)
+    int dias;                             // retornos da janela usada
+} RiscoCarteira;
+
+/*
+ * Projeção Monte Carlo de uma carteira em passos mensais. Cada ativo segue
+ * um lognormal com um fator de mercado comum (choque = volMercado x zM +
+ * volProprio x zi) e paga proventos proporcionais ao preço a cada
+ * 'mesesPorPagamento'.
+ */
+typedef struct {
+    int k, meses, caminhos;
+    bool reinvestir;                      // provento compra cotas do próprio ativo
+    uint32_t semente;
+    float caixa;
+    float quantidade[MAX_ATIVOS], preco[MAX_ATIVOS];
+    float deriva[MAX_ATIVOS];             // log-retorno mensal esperado (já com -σ²/2)
+    float volMercado[MAX_ATIVOS], volProprio[MAX_ATIVOS];
+    float rendimento[MAX_ATIVOS];         // provento por pagamento / preço
+    int mesesPorPagamento[MAX_ATIVOS];
+} ParametrosMonteCarlo;
+
+/*
+ * Conta reduzida para reinvestimento de proventos (DRIP) em arrays planos,
+ * sem alocação: o laço de eventos anda mês a mês sobre ela.
+ */
+enum { DRIP_DESLIGADO = 0, DRIP_PROPRIO, DRIP_ALVO };
+enum { EVENTO_DRIP_PROVENTO = 0, EVENTO_DRIP_COMPRA };
+
+typedef struct {
+    int k;
+    int quantidade[MAX_ATIVOS];
+    float preco[MAX_ATIVOS];
+    float provento[MAX_ATIVOS];           // por cota por pagamento
+    int mesesPorPagamento[MAX_ATIVOS];
+    int fase[MAX_ATIVOS];                 // meses já acumulados no ciclo (mesesAcumulados)
+    float alvo[MAX_ATIVOS];               // DRIP_ALVO: fração desejada (soma 1)
+    double custo[MAX_ATIVOS];             // quantidade x preço médio
+    double residuo[MAX_ATIVOS];           // DRIP_PROPRIO: sobra por ativo
+    double residuoAlvo;                   // DRIP_ALVO: sobra comum
+    double caixa, proventos, taxas;
+} ContaDrip;
+
+typedef struct {
+    int mes, ativo, cotas;
+    unsigned char tipo;
+    float valor, taxa;                    // provento ou custo da compra
+} EventoDrip;
+
+/*
+ * Histórico do backtest em colunas: o ativo a ocupa precos[a * dias ..
+ * a * dias + dias) (fechamento de cada pregão, repetido nos dias sem
+ * cotação; 0 antes da primeira) e proventos[a * meses .. a * meses +
+ * meses) (provento por cota pago em cada mês com pregão).
+ */
+typedef struct {
+    int numAtivos, dias, meses;
+    float *precos;
+    float *proventos;
+    int *inicioMes;                       // primeiro pregão de cada mês; inicioMes[meses] = dias
+    int primeiroDia, ultimoDia;           // dias desde o epoch
+    double anos;
+    double caixaInicial;
+    float alvo[MAX_ATIVOS];               // alocação-alvo (soma 1)
+} DadosBacktest;
+
+/* um ponto da grade: regras da estratégia */
+typedef struct {
+    float aporte;                         // R$ depositados no caixa todo mês
+    int mesesCompra;                      // compra periódica: caixa dividido pela falta de cada ativo no alvo
+    int mesesRebalanceamento;             // 0 = nunca; vende o excesso acima da banda e recompra
+    float banda;                          // excesso sobre o alvo (fração do patrimônio) tolerado
+    float stop;                           // stop móvel: venda se o preço cair essa fração do pico (0 = sem)
+    int carencia;                         // meses sem recomprar um ativo após o stop
+    bool reinvestir;                      // proventos ficam no caixa (senão saem como renda)
+} ParametrosBacktest;
+
+typedef struct {
+    double patrimonio, aportado;
+    double proventos, renda12;            // proventos no período e nos últimos 12 meses
+    double taxas, custodia;
+    float cagr, drawdown;                 // pela cota (retorno ponderado no tempo)
+    int operacoes, stops;
+} ResultadoBacktest;
+
+/* watchlist, alertas criados e caixa de notificações de um usuário */
+typedef struct {
+    int watchlist[MAX_WATCHLIST];         // índices no catálogo
+    int numWatchlist;
+    uint32_t *ids;
+    int numIds, capIds;
+    EventoAlerta *caixa;
+    int numCaixa, capCaixa;
+} AlertasUsuario;
+
+/* Usuário */
+typedef struct {
+    int id;                            // posição no cadastro (estável)
+    bool efemero;                      // usuário sintético (benchmarks): não vai para o journal
+    char nome[MAX_NOME];
+    char cpf[MAX_CPF];
+    char senha[MAX_SENHA];
+    ContaBanco banco;
+    ContaInvestimento investimento;
+    AlertasUsuario *alertas;           // criado na primeira watchlist/alerta (vai no snapshot)
+} Usuario;
+
+/*
+ * Simulador de calendário: eventos com data real (dias desde o epoch) numa
+ * heap mínima por (dia, ordem de inserção). Proventos, aportes e custódia
+ * viram postagens, aplicadas às contas em lote ao fim de cada dia.
+ */
+enum { EV_DATA_COM = 0, EV_PAGAMENTO, EV_APORTE, EV_CUSTODIA, EV_LIQUIDACAO_TED, NUM_TIPOS_EVENTO };
+
+typedef struct {
+    int dia;
+    uint32_t seq;
+    unsigned char tipo;
+    int ativo;
+    int lote;                             // EV_PAGAMENTO: elegíveis gravados na data com
+} EventoCalendario;
+
+typedef struct {
+    EventoCalendario *itens;
+    int num, cap;
+    uint32_t seq;
+} HeapCalendario;
+
+typedef struct {
+    int usuario, posicao;                 // índice na lista e na carteira
+    int quantidade;
+} Elegivel;
+
+typedef struct {
+    int usuario, posicao;
+    unsigned char tipo;
+    float valor;
+    int quantidade;
+} PostagemCalendario;
+
+typedef struct {
+    Usuario **lista;
+    int n;
+    bool lancar;                          // grava no extrato (false: só saldos e resultado)
+    float aporte;                         // mensal, do banco para o investimento (0 = nenhum)
+    int diaAporte;
+    HeapCalendario heap;
+    Elegivel **detentores;                // por ativo; a simulação não negocia, então as cotas não mudam
+    int *numDetentores;
+    Elegivel **lotes;                     // elegíveis por pagamento pendente
+    int *numLote, numLotes, capLotes;
+    PostagemCalendario *postagens;
+    int numPostagens, capPostagens;
+    /* sem extrato, as postagens vão para arrays densos e voltam às contas no fim */
+    double *caixa, *banco, *provento;     // variação do caixa, banco disponível, proventos por posição
+    float *custodiaConta;                 // mensal (preços não mudam na simulação)
+    int *basePosicao;                     // início das posições da conta em 'provento'
+    long long eventos[NUM_TIPOS_EVENTO], lancamentos;
+    double proventos, aportes, custodia;
+    long long custodiaSemCaixa;           // cobranças puladas por falta de caixa
+} SimuladorCalendario;
+
+/* ======= Ativos pré-definidos ======= */
+extern AtivoRV ativosPadrao[];
+extern const int numAtivosPadrao;
+extern AtivoRV *ativosDisponiveis;             // catálogo em uso: o embutido ou o carregado na partida
+extern int NUM_ATIVOS;
+extern int *catalogoPorTicker;                  // posições ordenadas por ticker e por nome
+extern int *catalogoPorNome;
+
+/* ======= Cadastro de clientes (book) ======= */
+extern Usuario **usuarios;
+extern int numUsuarios;
+extern int capUsuarios;
+extern int *indiceCpf;     // ids ordenados por CPF (busca binária)
+
+/* ======= Fila de TED (liquidação em lote) ======= */
+typedef struct {
+    int origem;            // id do usuário que envia
+    int destino;           // id do usuário que recebe
+    float valor;           // valor debitado da origem
+    float taxa;            // taxa descontada do valor creditado no destino
+} TransferenciaTED;
+
+typedef struct {
+    TransferenciaTED *itens;
+    int num;
+    int cap;
+    int numLote;           // contador de lotes liquidados
+    time_t ultimaLiquidacao;
+} FilaTED;
+
+extern FilaTED filaTED;
+
+/* ======= Threads (portável) ======= */
+#ifdef _WIN32
+typedef HANDLE Thread;
+typedef struct { void *(*fn)(void *); void *arg; } ThreadInicio;
+static inline DWORD WINAPI trampolimThread(LPVOID p) {
+    ThreadInicio ini = *(ThreadInicio *)p;
+    free(p);
+    ini.fn(ini.arg);
+    return 0;
+}
+static inline bool thread_criar(Thread *t, void *(*fn)(void *), void *arg) {
+    ThreadInicio *ini = malloc(sizeof(ThreadInicio));
+    if (!ini) return false;
+    ini->fn = fn; ini->arg = arg;
+    *t = CreateThread(NULL, 0, trampolimThread, ini, 0, NULL);
+    if (*t == NULL) { free(ini); return false; }
+    return true;
+}
+static inline void thread_aguardar(Thread t) { WaitForSingleObject(t, INFINITE); CloseHandle(t); }
+static inline void thread_ceder(void) { SwitchToThread(); }
+static inline void thread_dormir_ms(int ms) { Sleep(ms); }
+
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Cond;
+static inline void mutex_iniciar(Mutex *m) { InitializeCriticalSection(m); }
+static inline void mutex_destruir(Mutex *m) { DeleteCriticalSection(m); }
+static inline void mutex_travar(Mutex *m) { EnterCriticalSection(m); }
+static inline void mutex_destravar(Mutex *m) { LeaveCriticalSection(m); }
+static inline void cond_iniciar(Cond *c) { InitializeConditionVariable(c); }
+static inline void cond_destruir(Cond *c) { (void)c; }
+static inline void cond_esperar(Cond *c, Mutex *m) { SleepConditionVariableCS(c, m, INFINITE); }
+static inline void cond_acordar_todos(Cond *c) { WakeAllConditionVariable(c); }
+#else
+typedef pthread_t Thread;
+static inline bool thread_criar(Thread *t, void *(*fn)(void *), void *arg) { return pthread_create(t, NULL, fn, arg) == 0; }
+static inline void thread_aguardar(Thread t) { pthread_join(t, NULL); }
+static inline void thread_ceder(void) { sched_yield(); }
+static inline void thread_dormir_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+static inline void mutex_iniciar(Mutex *m) { pthread_mutex_init(m, NULL); }
+static inline void mutex_destruir(Mutex *m) { pthread_mutex_destroy(m); }
+static inline void mutex_travar(Mutex *m) { pthread_mutex_lock(m); }
+static inline void mutex_destravar(Mutex *m) { pthread_mutex_unlock(m); }
+static inline void cond_iniciar(Cond *c) { pthread_cond_init(c, NULL); }
+static inline void cond_destruir(Cond *c) { pthread_cond_destroy(c); }
+static inline void cond_esperar(Cond *c, Mutex *m) { pthread_cond_wait(c, m); }
+static inline void cond_acordar_todos(Cond *c) { pthread_cond_broadcast(c); }
+#endif
+
+/* ======= Armazenamento: gravador assíncrono (io_uring ou pwrite+fdatasync) ======= */
+enum { BACKEND_PWRITE = 0, BACKEND_IO_URING = 1 };
+enum { BUF_LIVRE, BUF_ENCHENDO, BUF_SELADO, BUF_EM_VOO, BUF_DURAVEL };
+
+typedef struct {
+    char *dados;
+    int tam;
+    int estado;
+    bool falhou;
+    bool semFsync;           // o anel aceitou a escrita mas não a fsync: a escrita conclui (como falha)
+    long long offset;        // posição no arquivo (definida ao selar)
+    long long commit;        // id do commit (crescente, definido ao selar)
+} BufferGravador;
+
+#ifdef USAR_IO_URING
+typedef struct {
+    int fd;
+    unsigned entradas;
+    unsigned *sqCabeca, *sqCauda, *sqMascara, *sqVetor;
+    unsigned *cqCabeca, *cqCauda, *cqMascara;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sqMem, *cqMem;
+    size_t sqTam, cqTam, sqesTam;
+} Uring;
+#endif
+
+/*
+ * Quem grava só copia para um buffer e sela um commit; threads de fundo
+ * escrevem e fazem fdatasync. 'duravel' avança em ordem de commit.
+ */
+typedef struct {
+    int backend;
+    int fd;
+    char *memoria;                              // área contígua de todos os buffers
+    BufferGravador buf[NUM_BUFFERS_GRAVADOR];
+    int atual;                                  // buffer em preenchimento (-1 = nenhum)
+    int selados[NUM_BUFFERS_GRAVADOR];          // fila FIFO de buffers prontos
+    int iniSel, numSel;
+    int emVoo;
+    long long proxOffset;
+    long long ultimoCommit;
+    long long duravel;                          // commits <= duravel estão em disco
+    bool erro;
+    bool parar;
+    Mutex m;
+    Cond mudou;
+    Mutex mIo;                                  // seek+write no Windows (sem pwrite)
+    Thread threads[THREADS_GRAVADOR];
+    int numThreads;
+    void (*aoDuravel)(void *ctx, long long commit);
+    void *ctxDuravel;
+#ifdef USAR_IO_URING
+    Uring ring;
+#endif
+} Gravador;
+
+/*
+ * Snapshot de usuarios.dat: a thread de fundo grava num temporário, faz
+ * fdatasync e só então o renomeia sobre o arquivo, de modo que uma queda
+ * deixa o snapshot anterior ou o novo, nunca um pela metade. Quem salva só
+ * entrega o buffer montado; um snapshot mais novo substitui o que ainda não
+ * começou a ser gravado (ele já contém tudo o que o antigo tinha).
+ */
+typedef struct {
+    char arq[64];
+    char *pendente;                             // próximo a gravar (NULL = nenhum)
+    size_t tamPendente;
+    long long entregues;                        // ids crescentes dos snapshots entregues
+    long long gravados;                         // snapshots <= gravados estão em disco
+    bool erro;
+    bool parar;
+    bool ativo;
+    Mutex m;
+    Cond mudou;
+    Thread thread;
+} GravadorSnapshot;
+
+extern GravadorSnapshot gravUsuarios;
+
+/* cabeçalho dos arquivos persistidos */
+typedef struct {
+    char magica[8];
+    int versao;
+    int tamRegistro;
+} CabecalhoArquivo;
+
+/* ======= Fila de lançamentos do extrato (MPSC sem lock) ======= */
+enum { CONTA_BANCO = 0, CONTA_INVEST = 1 };
+
+/* lançamento em trânsito: produtor copia, consumidor anexa ao extrato da conta */
+typedef struct {
+    Usuario *u;
+    int conta;
+    Transacao t;
+} EventoExtrato;
+
+/*
+ * Posição do anel. 'seq' controla a posse: vale 'ticket' quando livre para o
+ * produtor daquele ticket, 'ticket + 1' quando publicada para o consumidor.
+ */
+typedef struct {
+    _Atomic unsigned long long seq;
+    EventoExtrato ev;
+} PosicaoAnel;
+
+typedef struct {
+    _Atomic unsigned long long cauda;     // próximo ticket (produtores, fetch_add)
+    unsigned long long seqBase;           // continua a numeração de execuções anteriores
+    char pad1[64 - sizeof(unsigned long long)];
+    _Atomic unsigned long long cabeca;    // próximo a consumir (só o consumidor escreve)
+    char pad2[64 - sizeof(unsigned long long)];
+    PosicaoAnel pos[TAM_ANEL_EXTRATO];
+} AnelExtrato;
+
+typedef struct {
+    AnelExtrato *shards;                  // NUM_SHARDS_EXTRATO anéis
+    Gravador *journal;                    // destino durável (NULL = só memória)
+    Thread consumidor;
+    bool temConsumidor;
+    _Atomic bool parar;
+    _Atomic unsigned long long drenados;  // total anexado aos extratos
+    _Atomic unsigned long long esperasAnelCheio;   // publicações que acharam a posição ainda ocupada
+    _Atomic unsigned long long tsAjustados;        // relógio atrás do último da conta: ts igualado ao dele
+} FilaExtrato;
+
+extern FilaExtrato filaExtrato;
+
+/* registro gravado no journal (um por lançamento) */
+typedef struct {
+    char cpf[MAX_CPF];
+    int conta;
+    Transacao t;
+} RegistroJournal;
+
+/* ======= Arquivo colunar do extrato (segmentos selados, mmap) ======= */
+
+/* conta presente num segmento: a coluna 'conta' guarda o índice nesta tabela */
+typedef struct {
+    char cpf[MAX_CPF];
+    int conta;
+    unsigned long long seqMax;            // maior seq selado desta conta
+} ContaSegmento;
+
+enum { CODEC_FIXO = 0, CODEC_COMPRIMIDO = 1 };
+
+typedef struct {
+    long long numLinhas;
+    int numBlocos;
+    int numTipos;
+    int numContas;
+    int codec;                            // CODEC_FIXO ou CODEC_COMPRIMIDO
+} InfoSegmento;
+
+/*
+ * Mapa de zona por bloco. Cada coluna numérica é gravada como uint32 em
+ * relação ao mínimo do bloco (ts, valor, taxa, saldo em centavos), o que
+ * permite filtrar e somar sem decodificar linha a linha.
+ */
+typedef struct {
+    long long tsMin, tsMax;
+    long long valorMin, valorMax;
+    long long taxaMin, saldoMin;
+    unsigned long long mascaraTipos;      // bit t ligado = tipo t aparece no bloco
+    long long offset;                     // início das colunas no arquivo
+    int linhas;
+    int tamComprimido;                    // bytes do bloco (CODEC_COMPRIMIDO)
+} ZonaBloco;
+
+/* segmento aberto para leitura */
+typedef struct {
+    char *base;
+    size_t tam;
+    const InfoSegmento *info;
+    const char (*tipos)[32];
+    const ContaSegmento *contas;
+    const ZonaBloco *zonas;
+    int numAtivos;                        // dicionário de ativos (só CODEC_COMPRIMIDO)
+    const char (*ativos)[16];
+} SegmentoColunar;
+
+/* linha antes da codificação */
+typedef struct {
+    long long ts;
+    long long valor, taxa, saldo;         // centavos
+    unsigned conta;
+    unsigned short ativo;                 // código no dicionário de ativos
+    unsigned char tipo;
+} LinhaArquivo;
+
+/* bloco decodificado (colunas completas) */
+typedef struct {
+    long long ts[TAM_BLOCO_COL];
+    long long valor[TAM_BLOCO_COL];
+    long long taxa[TAM_BLOCO_COL];
+    long long saldo[TAM_BLOCO_COL];
+    unsigned conta[TAM_BLOCO_COL];
+    unsigned short ativo[TAM_BLOCO_COL];
+    unsigned char tipo[TAM_BLOCO_COL];
+} BlocoDecodificado;
+
+enum { COL_TS = 1, COL_VALOR = 2, COL_TAXA = 4, COL_SALDO = 8, COL_TIPO = 16, COL_ATIVO = 32, COL_CONTA = 64, COL_TODAS = 127 };
+
+/* dicionário global de tipos de lançamento (código = posição) */
+extern char tiposDic[MAX_TIPOS_DIC][32];
+extern int numTiposDic;
+extern char (*ativosDic)[16];             // código 0 = sem ativo
+extern int numAtivosDic;
+extern int capAtivosDic;
+extern int numSegmentos;
+
+/* ======= Exportação de extratos (saída bufferizada) ======= */
+enum { FORMATO_CSV = 1, FORMATO_JSONL = 2, FORMATO_OFX = 3 };
+
+/* buffer de saída pré-alocado: formatação manual e write() em blocos grandes */
+typedef struct {
+    int fd;
+    bool fecharFd;
+    char *buf;
+    int tam;
+    bool erro;
+    long long total;                      // bytes já enviados ao fd
+    long long fusoSeg;                    // deslocamento do horário local (fixo na exportação)
+} SaidaBuffer;
+
+/* filtros e página de uma consulta ao extrato (mais recentes primeiro) */
+typedef struct {
+    int conta;                            // CONTA_BANCO ou CONTA_INVEST
+    long long tsIni, tsFim;               // intervalo fechado de instantes
+    const char *tipo;                     // NULL ou "" = qualquer
+    const char *ativo;                    // NULL ou "" = qualquer
+    int limite;                           // tamanho da página
+    int cursor;                           // -1 = do fim; senão o valor devolvido pela página anterior
+} ConsultaExtrato;
+
+/* extrato ordenado de uma conta, como fonte do extrato consolidado */
+typedef struct {
+    const Transacao *ext;
+    int num;
+    int pos;                              // próximo lançamento a sair
+    int conta;
+} FonteExtrato;
+
+/* intercalação k-way por heap mínimo de (ts, fonte, seq); não copia lançamentos */
+typedef struct {
+    FonteExtrato fontes[MAX_FONTES_EXTRATO];
+    int numFontes;
+    int heap[MAX_FONTES_EXTRATO];         // índices de fontes com lançamentos pendentes
+    int tamHeap;
+} IntercaladorExtrato;
+
+/* registro de usuário no snapshot usuarios.dat (extratos vêm do journal) */
+typedef struct {
+    char nome[MAX_NOME];
+    char cpf[MAX_CPF];
+    char senha[MAX_SENHA];
+    float saldoBanco;
+    float saldoInvest;
+    int numAtivos;
+    PosicaoSalva carteira[MAX_ATIVOS];
+} RegistroUsuario;
+
+/* item de watchlist ou alerta ativo no snapshot, depois da marca do journal */
+enum { ITEM_WATCHLIST = 0, ITEM_ALERTA_ABAIXO, ITEM_ALERTA_ACIMA };
+typedef struct {
+    char cpf[MAX_CPF];
+    char ticker[16];
+    float limite;                         // só alertas
+    int tipo;                             // ITEM_*
+} ItemAlertaSalvo;
+
+/* grupos do relatório mensal (movimentos internos entre contas do usuário: GRUPO_NENHUM) */
+enum { GRUPO_NENHUM = -1, GRUPO_DEPOSITO = 0, GRUPO_TRANSF, GRUPO_COMPRA, GRUPO_VENDA, GRUPO_PROVENTO };
+
+/* fechamento (e provento por cota, se houver) de um ativo em uma data */
+typedef struct {
+    int dia, ativo;
+    float preco, provento;
+} PontoBacktest;
+
+/* ======= Protótipos ======= */
+/* utilitários */
+void clear_input(void);
+void read_line(char *buf, int size);
+void timestamp_now(char *out, int size);
+void timestamp_formatar(long long ts, char *out, int size);
+double cronometro_seg(void);
+unsigned aleatorio(unsigned *semente);
+long long relogio_ns(void);
+long long relogio_seg(void);
+bool relogioEhVirtual(void);
+void relogioFixar(long long ts);
+void relogioAvancar(long long seg);
+void relogioReal(void);
+
+/* armazenamento */
+bool gravadorAbrir(Gravador *g, const char *arq, int backendPreferido);
+void gravadorAnexar(Gravador *g, const void *dados, int tam);
+long long gravadorCommit(Gravador *g);
+bool gravadorAguardar(Gravador *g, long long commit);
+void gravadorFechar(Gravador *g);
+bool snapshotAbrir(GravadorSnapshot *s, const char *arq);
+long long snapshotEntregar(GravadorSnapshot *s, char *dados, size_t tam);
+bool snapshotAguardar(GravadorSnapshot *s, long long id);
+void snapshotFechar(GravadorSnapshot *s);
+void benchmarkGravador(void);
+void carregarDados(void);
+bool salvarUsuarios(void);
+bool sincronizarDados(int fd);
+bool substituirArquivo(const char *tmp, const char *arq);
+void preencherCabecalho(CabecalhoArquivo *c, const char *magica, int tamRegistro);
+void refazerFilaTED(Usuario *u, const Transacao *t);
+extern _Atomic bool sessaoEnsaio;
+bool confirmarUsuario(Usuario *u);
+int alertasParaSalvar(ItemAlertaSalvo *out);
+void restaurarAlertas(const ItemAlertaSalvo *itens, int n);
+AtivoCarteira *posicaoDoTicker(Usuario *u, const char *ticker);
+AnelExtrato *shardDaConta(FilaExtrato *f, Usuario *u, int conta);
+bool anexarExtrato(Transacao **extrato, int *num, int *cap, IndiceSaldo *saldos, const Transacao *t);
+
+/* extrato */
+bool iniciarFilaExtrato(FilaExtrato *f, Gravador *journal);
+void encerrarFilaExtrato(FilaExtrato *f);
+bool criarAneisExtrato(FilaExtrato *f);
+void publicarLancamento(FilaExtrato *f, Usuario *u, int conta, const char *tipo, const char *desc,
+                        const char *ativo, float valor, float taxa, float saldoFinal,
+                        int quantidade, float resultado);
+void sincronizarExtrato(FilaExtrato *f);
+void liberarUsuario(Usuario *u);
+void testeEstresseExtrato(void);
+void registrarTransacaoBanco(Usuario *u, const char *tipo, const char *desc, float valor, float taxa);
+void registrarTransacaoInvest(Usuario *u, const char *tipo, const char *desc, float valor, float taxa);
+void registrarTransacaoAtivo(Usuario *u, const char *tipo, const char *desc, const char *ativo, float valor, float taxa,
+                             int quantidade, float resultado);
+void exibirExtratoBanco(Usuario *u);
+void exibirExtratoInvest(Usuario *u);
+
+/* exportação */
+bool saidaAbrirArquivo(SaidaBuffer *s, const char *arq);
+bool saidaAbrirFd(SaidaBuffer *s, int fd);
+bool saidaFechar(SaidaBuffer *s);
+void exportarConta(SaidaBuffer *s, int formato, Usuario *u, int conta);
+bool exportarUsuario(Usuario *u, int formato, const char *arq);
+int exportarTodos(int formato, const char *prefixo);
+void menuExportarExtrato(Usuario *u);
+void benchmarkExportacao(void);
+long long fusoLocal(void);
+long long fusoProcesso(void);
+void dataCivil(long long ts, long long fuso, int *ano, int *mes, int *dia, int *hora, int *min, int *seg);
+void saidaBytes(SaidaBuffer *s, const char *p, int n);
+void saidaTexto(SaidaBuffer *s, const char *txt);
+void saidaCaractere(SaidaBuffer *s, char c);
+void saidaInteiro(SaidaBuffer *s, long long v);
+void saidaCentavos(SaidaBuffer *s, long long c, int largura);
+void saidaDoisDigitos(char *p, int v);
+void extratoDaConta(Usuario *u, int conta, Transacao **ext, int *num);
+void cabecalhoCsv(SaidaBuffer *s);
+void exportarLancamento(SaidaBuffer *s, int formato, const Usuario *u, int conta, const Transacao *t);
+int lerFormatoExportacao(void);
+void saidaLinhaTabela(SaidaBuffer *s, const Transacao *t);
+
+/* consultas paginadas */
+int consultarExtrato(Usuario *u, const ConsultaExtrato *q, const Transacao **itens, int *proxCursor);
+void liberarIndiceExtrato(IndiceExtrato *ix);
+void menuConsultarExtrato(Usuario *u);
+void benchmarkConsultaExtrato(void);
+long long lerData(const char *txt);
+int executarComando(int argc, char **argv);
+
+/* extrato consolidado */
+void intercaladorIniciar(IntercaladorExtrato *it);
+bool intercaladorAdicionar(IntercaladorExtrato *it, const Transacao *ext, int num, int conta);
+const Transacao *intercaladorProximo(IntercaladorExtrato *it, int *conta);
+void intercaladorDoUsuario(IntercaladorExtrato *it, Usuario *u);
+void exibirExtratoConsolidado(Usuario *u);
+void benchmarkIntercalacao(void);
+
+/* saldo por data */
+long long saldoNaData(Usuario *u, int conta, long long ts);
+
+/* relatório mensal */
+int gerarRelatorioMensal(Usuario **lista, int n, int numThreads, const char *arq, long long *linhasLidas);
+void menuRelatorioMensal(void);
+void benchmarkRelatorioMensal(void);
+int grupoDoTipoEscalar(const char *tipo);
+#ifdef USAR_SIMD_X86
+void iniciarGruposSimd(void);
+__attribute__((target("sse2")))
+int grupoDoTipoSse2(const char *tipo);
+extern int sse2Disponivel;
+#endif
+double saldoMedioPeriodo(Usuario *u, int conta, long long tsIni, long long tsFim);
+void menuSaldoNaData(Usuario *u);
+void relatorioSaldosNaData(void);
+void benchmarkSaldoNaData(void);
+
+/* cadastro/login */
+Usuario *buscarUsuarioPorCpf(const char *cpf);
+Usuario *adicionarUsuario(void);
+Usuario *cadastrarUsuario(void);
+Usuario *validarLogin(void);
+
+/* menus */
+void menuPrincipal(Usuario *u);
+void menuContaBanco(Usuario *u);
+void menuContaInvestimento(Usuario *u);
+void submenuAtivos(Usuario *u);
+
+/* banco/transações */
+void depositarBanco(Usuario *u);
+void transferirParaInvestimento(Usuario *u);
+void transferirParaBanco(Usuario *u);
+void transferirParaBancoExterno(Usuario *u);
+void transferirPIX(Usuario *origem, Usuario *destino, float valor);
+bool agendarTED(FilaTED *f, Usuario *origem, Usuario *destino, float valor);
+float saldoDisponivelBanco(Usuario *u);
+
+/* liquidação de TED (compensação multilateral) */
+int liquidarLoteTED(FilaTED *f, Usuario **book);
+void liquidarTEDSeVencido(void);
+void benchmarkLiquidacaoTED(void);
+void menuAdministracao(void);
+void menuBancada(void);
+int verificarFuncionalidades(void);
+
+/* arquivo colunar */
+long long paraCentavos(float valor);
+int codigoTipo(const char *tipo);
+int codigoAtivo(const char *ticker);
+bool escreverSegmento(const char *arq, LinhaArquivo *linhas, long long n, const ContaSegmento *contas, int numContas, int codec);
+int codificarBloco(const LinhaArquivo *l, int n, long long tsBase, long long saldoBase, unsigned char *out);
+bool decodificarBloco(const SegmentoColunar *seg, int b, int colunas, BlocoDecodificado *out);
+void benchmarkCodec(void);
+bool abrirSegmento(const char *arq, SegmentoColunar *seg);
+void fecharSegmento(SegmentoColunar *seg);
+void carregarSegmentos(void);
+const SegmentoColunar *segmentoMapeado(int num);
+char *mapearArquivo(const char *arq, size_t *tam);
+void desmapearArquivo(char *p, size_t tam);
+extern bool codecUsarSimd;
+void liberarSegmentosMapeados(void);
+int selarExtratos(long long tsCorte);
+long long somarArquivoPorTipo(const SegmentoColunar *seg, int tipo, long long tsIni, long long tsFim, BlocoDecodificado *bd,
+                              long long *linhas, int *blocosLidos, int *blocosPulados);
+void consultarArquivoPorTipoAno(void);
+void benchmarkVarreduraArquivo(void);
+long long inicioDoAno(int ano);
+
+/* renda variável */
+void listarAtivosDisponiveis(void);
+bool lerCatalogo(const char *arq, AtivoRV **ativos, int *num);
+bool indexarCatalogo(const AtivoRV *ativos, int num, int **porTicker, int **porNome);
+int buscarPrefixoCatalogo(const AtivoRV *ativos, const int *ordem, int num, bool porNome, const char *prefixo, int *fim);
+bool carregarCatalogo(const char *arq);
+void liberarCatalogo(void);
+const char *campoCatalogo(const char *p, const char *fim, const char **fimCampo);
+float decimalCatalogo(const char *p, const char *fim, const char **parou);
+void copiarCampo(char *dest, size_t tam, const char *p, const char *fim);
+const char *nomeClasse(int classe);
+void benchmarkCatalogo(void);
+void comprarAtivoRV(Usuario *u);
+void venderAtivoRV(Usuario *u);
+void mostrarCarteira(Usuario *u);
+
+/* simulação de proventos RV (acumula meses) */
+void simularProventosRV(Usuario *u);
+int dripAvancar(ContaDrip *c, int modo, int meses, EventoDrip *eventos, int maxEventos);
+int dripCotas(double verba, float preco, double *custo, double *taxa);
+int mesesPorPagamentoAtivo(const AtivoRV *a);
+void simularProventosDrip(Usuario *u, int meses, int modo);
+bool calendarioInserir(HeapCalendario *h, int dia, int tipo, int ativo, int lote);
+bool calendarioRetirar(HeapCalendario *h, EventoCalendario *ev);
+bool simularCalendario(SimuladorCalendario *sim, int diaInicio, int diaFim);
+void liberarSimuladorCalendario(SimuladorCalendario *sim);
+int diaDaData(int ano, int mes, int dia);
+void dataDoDia(int d, int *ano, int *mes, int *dia);
+long long tsDoDia(int dia);
+long long somarMesesTs(long long ts, int meses);
+void menuSimularCalendario(void);
+void menuRelogio(void);
+void benchmarkCalendario(void);
+void benchmarkDrip(void);
+
+/* resultado da carteira (incremental) */
+int indiceCatalogo(const char *ticker);
+void resultadoCompra(Usuario *u, AtivoCarteira *pos, int quantidade, float preco);
+float resultadoVenda(Usuario *u, AtivoCarteira *pos, int quantidade, float preco, ConsumoLotes *consumo);
+
+/* lotes FIFO */
+bool lotesAnexar(FilaLotes *f, long long ts, int quantidade, float preco);
+void lotesConsumir(FilaLotes *f, int quantidade, long long tsVenda, ConsumoLotes *out);
+void lotesLiberar(FilaLotes *f);
+long long diaLocal(long long ts, long long fuso);
+void benchmarkLotes(void);
+
+/* taxas de negociação e custódia */
+long long taxaDaFaixa(const TabelaFaixas *t, long long valor);
+long long calcularTaxas(long long valor, long long valorDayTrade, TaxasOperacao *out);
+void taxasLote(const long long *valores, const long long *valoresDayTrade, int n, long long *totais);
+bool carregarTabelaTaxas(const char *arq);
+int cobrarCustodia(long long *total, int *semCaixa);
+long long custodiaMensal(const Usuario *u);
+extern TabelaTaxas tabelaTaxas;
+void menuCobrarCustodia(void);
+void benchmarkTaxas(void);
+
+/* imposto de renda sobre ganho de capital */
+int mesDoTs(long long ts);
+void apurarVenda(ApuracaoIR *ir, int mes, bool fii, long long valor, long long ganhoComum, long long ganhoDayTrade);
+long long fecharMesIR(ApuracaoIR *ir);
+void apurarVendaUsuario(Usuario *u, const char *ticker, long long ts, int quantidade, float valor, float taxa, float resultado, const ConsumoLotes *consumo);
+int fechamentoMensalIR(int mes, const char *arq, long long *totalDarf);
+void menuFechamentoIR(void);
+void benchmarkFechamentoIR(void);
+void resultadoProvento(Usuario *u, AtivoCarteira *pos, float valor);
+void remarcarAtivo(int idx, float preco);
+void atualizarPrecoAtivo(int idx, float preco);
+bool abrirRegistroPrecos(const char *arq);
+void fecharRegistroPrecos(void);
+int carregarPrecos(const char *arq);
+
+/* histórico de preços comprimido */
+bool serieAnexar(SeriePrecos *s, long long ts, float preco);
+int serieLer(const SeriePrecos *s, long long ini, long long fim, long long *ts, float *precos, int max);
+size_t serieBytes(const SeriePrecos *s);
+void serieLiberar(SeriePrecos *s);
+void historicoRegistrar(int idx, long long ts, float preco);
+void liberarHistorico(void);
+extern HistoricoAtivo *historico;
+void menuHistoricoPrecos(void);
+void benchmarkHistoricoPrecos(void);
+
+/* velas OHLCV */
+void velasAtualizar(VelasAtivo *v, long long ts, float preco, long long volume);
+int velasCopiar(VelasAtivo *v, int periodo, Vela *out, int max);
+void velasTick(int idx, long long ts, float preco, long long volume);
+int velasDoAtivo(int idx, int periodo, Vela *out, int max);
+void liberarVelas(void);
+void menuVelas(void);
+void benchmarkVelas(void);
+
+/* indicadores técnicos */
+void indicadoresAtualizar(EstadoIndicadores *e, const ParametrosIndicadores *p, float x);
+void indicadoresValores(const EstadoIndicadores *e, const ParametrosIndicadores *p, Indicadores *out);
+bool indicadoresLote(const float *fechamentos, const int *inicio, int numAtivos, int dias,
+                     const ParametrosIndicadores *p, EstadoIndicadores *estados);
+void indicadoresFechamento(int idx, float fechamento);
+bool recalcularIndicadores(void);
+void liberarIndicadores(void);
+extern ParametrosIndicadores parametrosIndicadores;
+extern EstadoIndicadores *indicadores;
+#ifdef USAR_SIMD_X86
+extern int avx2Disponivel;
+#endif
+void menuParametrosIndicadores(void);
+void benchmarkIndicadores(void);
+
+/* alertas de preço e watchlist */
+bool alertasIniciar(MotorAlertas *m, int numAtivos);
+void alertasLiberar(MotorAlertas *m);
+uint32_t alertasRegistrar(MotorAlertas *m, int usuario, int ativo, int direcao, float limite, bool emLote);
+bool alertasCancelar(MotorAlertas *m, uint32_t id);
+int alertasPreco(MotorAlertas *m, int ativo, float preco, long long ts);
+bool alertasRetirar(MotorAlertas *m, EventoAlerta *ev);
+void alertasPrecoCatalogo(int idx, float preco, long long ts);
+bool motorDoCatalogo(void);
+void entregarAlertas(void);
+void mostrarNotificacoes(Usuario *u);
+void liberarAlertasUsuario(Usuario *u);
+extern MotorAlertas motorAlertas;
+void menuAlertas(Usuario *u);
+void benchmarkAlertas(void);
+
+/* risco de carteira */
+bool riscoMercadoCalcular(RiscoMercado *r, const float *fechamentos, const int *inicio, int numAtivos, int dias);
+void covarianciaCalcular(RiscoMercado *r);
+void riscoMercadoLiberar(RiscoMercado *r);
+int riscoDosAtivos(RiscoMercado *r, const int *ativos, int k);
+double selecionarK(double *v, int n, int k);
+void riscoCarteira(const RiscoMercado *r, const int *ativos, const double *valores, int k, bool historicoVar, RiscoCarteira *out);
+int riscoUsuario(Usuario *u, RiscoCarteira *out);
+void benchmarkRisco(void);
+
+/* projeção Monte Carlo */
+bool monteCarloProjetar(const ParametrosMonteCarlo *p, int numThreads, bool usarSimd, double *patrimonio, double *renda);
+double normalInversa(double p);
+bool monteCarloDaCarteira(Usuario *u, int anos, int caminhos, bool reinvestir, ParametrosMonteCarlo *p);
+void menuMonteCarlo(Usuario *u);
+void benchmarkMonteCarlo(void);
+
+/* backtest de estratégias */
+void backtestExecutar(const DadosBacktest *h, const ParametrosBacktest *p, ResultadoBacktest *r);
+bool backtestGrade(const DadosBacktest *h, const ParametrosBacktest *grade, int n, int numThreads, ResultadoBacktest *out);
+void liberarDadosBacktest(DadosBacktest *h);
+PontoBacktest *pontosDoArquivo(const char *arq, const int *ativoGlobal, int k, int *n);
+void menuBacktest(Usuario *u);
+void benchmarkBacktest(void);
+void reconstruirResultados(Usuario *u);
+void removerDetentor(Usuario *u, const char *ticker);
+void liberarDetentores(void);
+void menuAtualizarPreco(void);
+void benchmarkResultadoCarteira(void);
+
+#endif /* CORRETORA_H */
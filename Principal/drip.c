@@ -0,0 +1,294 @@
+#include "corretora.h"
+
+/* ========== reinvestimento de proventos (DRIP) ========== */
+
+/*
+ * Como todo período de pagamento divide 12 (12 / periods_per_year), os
+ * ativos que pagam num mês só dependem do mês no ciclo de 12: o calendário
+ * é montado uma vez e o laço visita só os pagadores de cada mês. Cada
+ * provento entra no caixa; no modo próprio, a sobra do ativo compra cotas
+ * inteiras dele mesmo, e a fração fica para o próximo pagamento. No modo
+ * alvo, os proventos do mês vão para uma sobra comum, dividida entre os
+ * ativos abaixo da alocação-alvo em proporção à falta de cada um. As
+ * compras pagam as taxas de calcularTaxas, como uma compra comum.
+ */
+
+/* cotas inteiras que 'verba' compra a 'preco' com as taxas; custo e taxa em R$ */
+int dripCotas(double verba, float preco, double *custo, double *taxa) {
+    if (preco <= 0.0f || verba < preco) return 0;
+    for (int n = (int)(verba / preco); n > 0; --n) {
+        TaxasOperacao t;
+        double c = (double)preco * n, tx = calcularTaxas(paraCentavos((float)c), 0, &t) / 100.0;
+        if (c + tx <= verba) { *custo = c; *taxa = tx; return n; }
+    }
+    return 0;
+}
+
+static inline void dripEvento(EventoDrip *ev, int maxEv, int *num, int mes, int ativo, int tipo, int cotas, double valor, double taxa) {
+    if (!ev) return;
+    if (*num < maxEv) ev[*num] = (EventoDrip){ mes, ativo, cotas, (unsigned char)tipo, (float)valor, (float)taxa };
+    (*num)++;
+}
+
+static void dripComprar(ContaDrip *c, int i, double *verba, const double *minimo, int mes, EventoDrip *ev, int maxEv, int *num) {
+    if (*verba < minimo[i]) return;                                   // nem uma cota com taxa: sem cálculo
+    double custo, taxa;
+    int n = dripCotas(*verba, c->preco[i], &custo, &taxa);
+    if (n == 0) return;
+    *verba -= custo + taxa;
+    c->caixa -= custo + taxa;
+    c->taxas += taxa;
+    c->quantidade[i] += n;
+    c->custo[i] += custo;
+    dripEvento(ev, maxEv, num, mes, i, EVENTO_DRIP_COMPRA, n, custo, taxa);
+}
+
+/*
+ * Avança 'meses' meses da conta no modo dado. Se 'eventos' não for NULL,
+ * grava até 'maxEventos' proventos e compras em ordem; retorna quantos
+ * eventos houve (pode passar de maxEventos, para o chamador redimensionar).
+ */
+int dripAvancar(ContaDrip *c, int modo, int meses, EventoDrip *eventos, int maxEventos) {
+    unsigned char pagantes[12][MAX_ATIVOS];
+    int numPagantes[12] = { 0 }, num = 0;
+    double minimo[MAX_ATIVOS];                                        // custo de 1 cota com taxas
+    for (int i = 0; modo != DRIP_DESLIGADO && i < c->k; ++i) {
+        TaxasOperacao t;
+        minimo[i] = c->preco[i] + calcularTaxas(paraCentavos(c->preco[i]), 0, &t) / 100.0;
+    }
+    for (int r = 0; r < 12; ++r)
+        for (int i = 0; i < c->k; ++i)
+            if (c->mesesPorPagamento[i] > 0 && (c->fase[i] + r) % c->mesesPorPagamento[i] == 0)
+                pagantes[r][numPagantes[r]++] = (unsigned char)i;
+    for (int m = 1; m <= meses; ++m) {
+        int r = m % 12;
+        if (numPagantes[r] == 0) continue;
+        for (int q = 0; q < numPagantes[r]; ++q) {
+            int i = pagantes[r][q];
+            double v = (double)c->provento[i] * c->quantidade[i];
+            if (v <= 0.0) continue;
+            c->caixa += v;
+            c->proventos += v;
+            dripEvento(eventos, maxEventos, &num, m, i, EVENTO_DRIP_PROVENTO, c->quantidade[i], v, 0.0);
+            if (modo == DRIP_PROPRIO) {
+                c->residuo[i] += v;
+                dripComprar(c, i, &c->residuo[i], minimo, m, eventos, maxEventos, &num);
+            } else if (modo == DRIP_ALVO) {
+                c->residuoAlvo += v;
+            }
+        }
+        if (modo != DRIP_ALVO || c->residuoAlvo <= 0.0) continue;
+        double total = c->residuoAlvo, falta[MAX_ATIVOS], somaFalta = 0.0;
+        for (int i = 0; i < c->k; ++i) total += (double)c->preco[i] * c->quantidade[i];
+        for (int i = 0; i < c->k; ++i) {
+            double f = c->alvo[i] * total - (double)c->preco[i] * c->quantidade[i];
+            falta[i] = f > 0.0 ? f : 0.0;
+            somaFalta += falta[i];
+        }
+        if (somaFalta <= 0.0) continue;
+        double verba = c->residuoAlvo;
+        for (int i = 0; i < c->k; ++i) {
+            if (falta[i] <= 0.0) continue;
+            double parte = verba * falta[i] / somaFalta, antes = parte;
+            dripComprar(c, i, &parte, minimo, m, eventos, maxEventos, &num);
+            c->residuoAlvo -= antes - parte;
+        }
+    }
+    for (int i = 0; i < c->k; ++i)
+        if (c->mesesPorPagamento[i] > 0) c->fase[i] = (c->fase[i] + meses) % c->mesesPorPagamento[i];
+    return num;
+}
+
+int mesesPorPagamentoAtivo(const AtivoRV *a) {
+    int m = a->periods_per_year > 0 ? 12 / a->periods_per_year : 12;
+    return m <= 0 ? 12 : m;
+}
+
+static bool posicaoDrip(const AtivoCarteira *c) {
+    return c->quantidade > 0 && indiceCatalogo(c->ticker) >= 0;
+}
+
+/* lê a alocação-alvo (em %) das posições que entram no DRIP, se ainda não houver uma */
+static bool lerAlvosDrip(Usuario *u) {
+    float soma = 0.0f;
+    for (int i = 0; i < u->investimento.numAtivos; ++i)
+        if (posicaoDrip(&u->investimento.carteira[i])) soma += u->investimento.carteira[i].alvoDrip;
+    if (soma > 0.0f) {
+        char resp[8];
+        printf("Manter a alocação-alvo atual? (s/n): ");
+        if (scanf("%7s", resp) == 1 && (resp[0] == 's' || resp[0] == 'S')) return true;
+    }
+    soma = 0.0f;
+    for (int i = 0; i < u->investimento.numAtivos; ++i) {
+        AtivoCarteira *c = &u->investimento.carteira[i];
+        c->alvoDrip = 0.0f;
+        if (!posicaoDrip(c)) continue;
+        float pct;
+        printf("Alocação-alvo de %s (%%): ", c->ticker);
+        if (scanf("%f", &pct) != 1 || pct < 0.0f || pct > 100.0f) { clear_input(); printf("Entrada inválida.\n"); return false; }
+        c->alvoDrip = pct / 100.0f;
+        soma += c->alvoDrip;
+    }
+    if (soma <= 0.0f) { printf("Alocação-alvo vazia.\n"); return false; }
+    for (int i = 0; i < u->investimento.numAtivos; ++i) u->investimento.carteira[i].alvoDrip /= soma;
+    return true;
+}
+
+/* simulação com DRIP: roda o laço de eventos e aplica os eventos à conta com os lançamentos */
+void simularProventosDrip(Usuario *u, int meses, int modo) {
+    if (modo == DRIP_ALVO && !lerAlvosDrip(u)) return;
+    ContaDrip conta;
+    memset(&conta, 0, sizeof(conta));
+    int posicao[MAX_ATIVOS], ativoGlobal[MAX_ATIVOS];
+    for (int i = 0; i < u->investimento.numAtivos; ++i) {
+        AtivoCarteira *c = &u->investimento.carteira[i];
+        if (!posicaoDrip(c)) continue;
+        int j = indiceCatalogo(c->ticker);
+        const AtivoRV *a = &ativosDisponiveis[j];
+        int k = conta.k++;
+        posicao[k] = i; ativoGlobal[k] = j;
+        conta.quantidade[k] = c->quantidade;
+        conta.preco[k] = a->preco;
+        conta.provento[k] = a->dividend_per_period;
+        conta.mesesPorPagamento[k] = mesesPorPagamentoAtivo(a);
+        conta.fase[k] = a->mesesAcumulados % conta.mesesPorPagamento[k];
+        conta.alvo[k] = c->alvoDrip;
+        conta.custo[k] = (double)c->precoMedio * c->quantidade;
+        conta.residuo[k] = c->residuoDrip;
+        conta.residuoAlvo += c->residuoDrip;
+    }
+    if (conta.k == 0) { printf("Carteira sem posições.\n"); return; }
+    float somaAlvo = 0.0f;                                            // alvos valem sobre as posições do DRIP
+    for (int k = 0; k < conta.k; ++k) somaAlvo += conta.alvo[k];
+    for (int k = 0; somaAlvo > 0.0f && k < conta.k; ++k) conta.alvo[k] /= somaAlvo;
+    double sobras = conta.residuoAlvo;
+    if (sobras > u->investimento.saldo) {                             // caixa gasto desde o último DRIP
+        double f = u->investimento.saldo > 0.0f ? u->investimento.saldo / sobras : 0.0;
+        for (int k = 0; k < conta.k; ++k) conta.residuo[k] *= f;
+        conta.residuoAlvo *= f;
+    }
+    if (modo == DRIP_PROPRIO) conta.residuoAlvo = 0.0;
+    else memset(conta.residuo, 0, sizeof(conta.residuo));
+
+    int cap = 0;                                                      // proventos, e no máximo uma compra por provento (k por mês no alvo)
+    for (int k = 0; k < conta.k; ++k) cap += meses / conta.mesesPorPagamento[k] + 1;
+    cap *= modo == DRIP_ALVO ? conta.k + 1 : 2;
+    EventoDrip *ev = malloc(sizeof(EventoDrip) * (size_t)cap);
+    if (!ev) { printf("Memória insuficiente.\n"); return; }
+    int num = dripAvancar(&conta, modo, meses, ev, cap);
+    if (num > cap) {                                                  // só os gravados são lançados
+        printf("Aviso: %d evento(s) além do limite de %d não foram lançados.\n", num - cap, cap);
+        num = cap;
+    }
+
+    printf("\n=== Simulação de Proventos com DRIP (%s) por %d meses ===\n",
+           modo == DRIP_PROPRIO ? "no próprio ativo" : "por alocação-alvo", meses);
+    float porAtivo[MAX_ATIVOS] = { 0.0f };
+    int cotasDrip[MAX_ATIVOS] = { 0 };
+    bool carimbar = relogioEhVirtual();                              // relógio virtual: cada evento na data do seu mês
+    long long inicio = relogio_seg();
+    for (int e = 0; e < num; ++e) {
+        const EventoDrip *x = &ev[e];
+        AtivoCarteira *c = &u->investimento.carteira[posicao[x->ativo]];
+        const AtivoRV *a = &ativosDisponiveis[ativoGlobal[x->ativo]];
+        char desc[100];
+        if (carimbar) relogioFixar(somarMesesTs(inicio, x->mes));
+        if (x->tipo == EVENTO_DRIP_PROVENTO) {
+            u->investimento.saldo += x->valor;
+            porAtivo[x->ativo] += x->valor;
+            resultadoProvento(u, c, x->valor);
+            snprintf(desc, sizeof(desc), "Provento %s (%d meses) R$ %.2f", a->ticker, conta.mesesPorPagamento[x->ativo], x->valor);
+            registrarTransacaoAtivo(u, "Provento", desc, a->ticker, x->valor, 0.0f, x->cotas, 0.0f);
+        } else {
+            u->investimento.saldo -= x->valor + x->taxa;
+            resultadoCompra(u, c, x->cotas, a->preco);
+            cotasDrip[x->ativo] += x->cotas;
+            snprintf(desc, sizeof(desc), "Reinvestimento %dx %s @ R$ %.2f", x->cotas, a->ticker, a->preco);
+            registrarTransacaoAtivo(u, "Compra", desc, a->ticker, -x->valor, x->taxa, x->cotas, 0.0f);
+        }
+    }
+    free(ev);
+    if (carimbar) relogioFixar(somarMesesTs(inicio, meses));
+    for (int k = 0; k < conta.k; ++k) {
+        AtivoCarteira *c = &u->investimento.carteira[posicao[k]];
+        c->residuoDrip = (float)(modo == DRIP_PROPRIO ? conta.residuo[k] : 0.0);
+        ativosDisponiveis[ativoGlobal[k]].mesesAcumulados = conta.fase[k];
+    }
+    if (modo == DRIP_ALVO && conta.k > 0)                              // sobra comum fica na primeira posição
+        u->investimento.carteira[posicao[0]].residuoDrip = (float)conta.residuoAlvo;
+
+    printf("\n--- Resumo da Simulação ---\n");
+    for (int k = 0; k < conta.k; ++k)
+        if (porAtivo[k] != 0.0f || cotasDrip[k] != 0)
+            printf("%s -> proventos R$ %.2f | +%d cotas reinvestidas | posição: %d cotas\n",
+                   u->investimento.carteira[posicao[k]].ticker, porAtivo[k], cotasDrip[k], conta.quantidade[k]);
+    double sobra = conta.residuoAlvo;
+    for (int k = 0; k < conta.k; ++k) sobra += conta.residuo[k];
+    printf("Total de proventos: R$ %.2f | taxas das compras: R$ %.2f | sobra aguardando cota: R$ %.2f\n",
+           conta.proventos, conta.taxas, sobra);
+    printf("Saldo caixa investimento agora: R$ %.2f\n", u->investimento.saldo);
+}
+
+/*
+ * 200k contas de 8 ativos por 30 anos em cada modo, sem eventos (como no
+ * lote noturno); o modo próprio é conferido com uma simulação ingênua
+ * ativo a ativo e mês a mês.
+ */
+void benchmarkDrip(void) {
+    const int contas = 200000, meses = 30 * 12, k = 8;
+    printf("\n=== Benchmark de DRIP (%d contas x %d ativos x %d anos) ===\n", contas, k, meses / 12);
+    ContaDrip modelo;
+    memset(&modelo, 0, sizeof(modelo));
+    modelo.k = k;
+    static const int periodos[] = { 12, 4, 2, 1, 12, 12, 4, 2 };
+    for (int i = 0; i < k; ++i) {
+        modelo.preco[i] = 8.0f + 4.5f * i;
+        modelo.provento[i] = modelo.preco[i] * 0.08f / periodos[i];
+        modelo.mesesPorPagamento[i] = 12 / periodos[i];
+        modelo.fase[i] = i % modelo.mesesPorPagamento[i];
+        modelo.alvo[i] = 1.0f / k;
+    }
+    double tempo[3] = { 0 }, proventos[3] = { 0 };
+    long long cotas[3] = { 0 }, divergentes = 0;
+    unsigned semente = 99u;
+    for (int modo = DRIP_DESLIGADO; modo <= DRIP_ALVO; ++modo) {
+        double t0 = cronometro_seg();
+        for (int n = 0; n < contas; ++n) {
+            ContaDrip c = modelo;
+            aleatorio(&semente);
+            for (int i = 0; i < k; ++i) c.quantidade[i] = 50 + (int)((semente >> (i + 8)) % 400);
+            dripAvancar(&c, modo, meses, NULL, 0);
+            proventos[modo] += c.proventos;
+            for (int i = 0; i < k; ++i) cotas[modo] += c.quantidade[i];
+        }
+        tempo[modo] = cronometro_seg() - t0;
+    }
+    /* referência do modo próprio: mês a mês, ativo a ativo */
+    for (int n = 0; n < 2000; ++n) {
+        ContaDrip c = modelo;
+        aleatorio(&semente);
+        for (int i = 0; i < k; ++i) c.quantidade[i] = 50 + (int)((semente >> (i + 8)) % 400);
+        ContaDrip ref = c;
+        dripAvancar(&c, DRIP_PROPRIO, meses, NULL, 0);
+        for (int i = 0; i < k; ++i) {
+            int q = ref.quantidade[i], fase = ref.fase[i];
+            double sobra = 0.0;
+            for (int m = 1; m <= meses; ++m) {
+                if (++fase < ref.mesesPorPagamento[i]) continue;
+                fase = 0;
+                sobra += (double)ref.provento[i] * q;
+                double custo, taxa;
+                int novas = dripCotas(sobra, ref.preco[i], &custo, &taxa);
+                q += novas;
+                if (novas) sobra -= custo + taxa;
+            }
+            divergentes += q != c.quantidade[i];
+        }
+    }
+    static const char *nomes[] = { "sem DRIP", "DRIP próprio", "DRIP alvo" };
+    for (int modo = 0; modo < 3; ++modo)
+        printf("%-13s %.2f s | %.1f ns por conta-ano | proventos médios R$ %.2f | cotas médias %.0f\n", nomes[modo],
+               tempo[modo], tempo[modo] / contas / (meses / 12) * 1e9, proventos[modo] / contas, (double)cotas[modo] / contas);
+    printf("Projeção para 1M de contas (DRIP alvo): %.1f s\n", tempo[DRIP_ALVO] * 1e6 / contas);
+    printf("Conferência (modo próprio x simulação ingênua, 2.000 contas): %lld posição(ões) divergente(s)\n", divergentes);
+}
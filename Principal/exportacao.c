@@ -0,0 +1,447 @@
+#include "corretora.h"
+
+/* ======= Exportação / exibição de extratos ======= */
+
+#ifdef _WIN32
+static int escreverFd(int fd, const char *p, int n) { return _write(fd, p, (unsigned)n); }
+static int criarArquivoSaida(const char *arq) { return _open(arq, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE); }
+#else
+static int escreverFd(int fd, const char *p, int n) { return (int)write(fd, p, (size_t)n); }
+static int criarArquivoSaida(const char *arq) { return open(arq, O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+#endif
+
+/* deslocamento do horário local em relação ao UTC, calculado uma vez */
+long long fusoLocal(void) {
+    time_t agora = time(NULL);
+    struct tm g;
+#ifdef _WIN32
+    gmtime_s(&g, &agora);
+#else
+    gmtime_r(&agora, &g);
+#endif
+    g.tm_isdst = -1;
+    return (long long)agora - (long long)mktime(&g);
+}
+
+/* fuso fixado na primeira chamada: evita mktime no caminho de cada venda */
+long long fusoProcesso(void) {
+    static long long fuso = LLONG_MIN;
+    if (fuso == LLONG_MIN) fuso = fusoLocal();
+    return fuso;
+}
+
+bool saidaAbrirFd(SaidaBuffer *s, int fd) {
+    memset(s, 0, sizeof(*s));
+    s->fd = fd;
+    s->buf = malloc(TAM_BUFFER_SAIDA);
+    s->fusoSeg = fusoLocal();
+    return s->buf != NULL;
+}
+
+bool saidaAbrirArquivo(SaidaBuffer *s, const char *arq) {
+    int fd = criarArquivoSaida(arq);
+    if (fd < 0) return false;
+    if (!saidaAbrirFd(s, fd)) { close(fd); return false; }
+    s->fecharFd = true;
+    return true;
+}
+
+static void saidaDescarregar(SaidaBuffer *s) {
+    int pos = 0;
+    while (pos < s->tam && !s->erro) {
+        int n = escreverFd(s->fd, s->buf + pos, s->tam - pos);
+        if (n <= 0) s->erro = true;
+        else pos += n;
+    }
+    s->total += pos;
+    s->tam = 0;
+}
+
+bool saidaFechar(SaidaBuffer *s) {
+    if (!s->buf) return false;
+    saidaDescarregar(s);
+    if (s->fecharFd && close(s->fd) != 0) s->erro = true;
+    free(s->buf);
+    s->buf = NULL;
+    return !s->erro;
+}
+
+/* garante espaço contíguo para n bytes (n pequeno) */
+static char *saidaReservar(SaidaBuffer *s, int n) {
+    if (s->tam + n > TAM_BUFFER_SAIDA) saidaDescarregar(s);
+    return s->buf + s->tam;
+}
+
+void saidaBytes(SaidaBuffer *s, const char *p, int n) {
+    if (n > TAM_BUFFER_SAIDA / 2) {
+        saidaDescarregar(s);
+        int pos = 0;
+        while (pos < n && !s->erro) {
+            int k = escreverFd(s->fd, p + pos, n - pos);
+            if (k <= 0) s->erro = true; else pos += k;
+        }
+        s->total += pos;
+        return;
+    }
+    memcpy(saidaReservar(s, n), p, (size_t)n);
+    s->tam += n;
+}
+
+void saidaTexto(SaidaBuffer *s, const char *txt) { saidaBytes(s, txt, (int)strlen(txt)); }
+void saidaCaractere(SaidaBuffer *s, char c) { *saidaReservar(s, 1) = c; s->tam++; }
+
+/* texto com largura mínima (preenche com espaços à direita, como %-Ns) */
+static void saidaTextoLargura(SaidaBuffer *s, const char *txt, int largura) {
+    int n = (int)strlen(txt);
+    saidaBytes(s, txt, n);
+    while (n++ < largura) saidaCaractere(s, ' ');
+}
+
+static const char digitosPares[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* escreve os dígitos de v no fim de 'fim' (para trás); retorna o início */
+static char *formatarDigitos(unsigned long long v, char *fim) {
+    while (v >= 100) {
+        unsigned d = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--fim = digitosPares[d + 1];
+        *--fim = digitosPares[d];
+    }
+    if (v >= 10) {
+        unsigned d = (unsigned)v * 2;
+        *--fim = digitosPares[d + 1];
+        *--fim = digitosPares[d];
+    } else {
+        *--fim = (char)('0' + v);
+    }
+    return fim;
+}
+
+void saidaInteiro(SaidaBuffer *s, long long v) {
+    char tmp[24], *fim = tmp + sizeof(tmp);
+    unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    char *ini = formatarDigitos(u, fim);
+    if (v < 0) *--ini = '-';
+    saidaBytes(s, ini, (int)(fim - ini));
+}
+
+/* centavos -> "-1234.56", alinhado à direita em 'largura' (0 = sem alinhamento) */
+void saidaCentavos(SaidaBuffer *s, long long c, int largura) {
+    char tmp[32], *fim = tmp + sizeof(tmp);
+    unsigned long long u = c < 0 ? 0ULL - (unsigned long long)c : (unsigned long long)c;
+    unsigned frac = (unsigned)(u % 100) * 2;
+    *--fim = digitosPares[frac + 1];
+    *--fim = digitosPares[frac];
+    *--fim = '.';
+    char *ini = formatarDigitos(u / 100, fim);
+    if (c < 0) *--ini = '-';
+    int n = (int)(tmp + sizeof(tmp) - ini);
+    while (n < largura) { *--ini = ' '; n++; }
+    saidaBytes(s, ini, n);
+}
+
+/* data civil a partir do epoch (algoritmo de dias -> ano/mês/dia, sem localtime por linha) */
+void dataCivil(long long ts, long long fuso, int *ano, int *mes, int *dia, int *hora, int *min, int *seg) {
+    long long t = ts + fuso;
+    long long dias = t >= 0 ? t / 86400 : (t - 86399) / 86400;
+    long long resto = t - dias * 86400;
+    *hora = (int)(resto / 3600); *min = (int)(resto / 60 % 60); *seg = (int)(resto % 60);
+    dias += 719468;
+    long long era = (dias >= 0 ? dias : dias - 146096) / 146097;
+    unsigned doe = (unsigned)(dias - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *dia = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *mes = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *ano = (int)(yoe + era * 400 + (*mes <= 2));
+}
+
+void saidaDoisDigitos(char *p, int v) { p[0] = digitosPares[v * 2]; p[1] = digitosPares[v * 2 + 1]; }
+
+/* "AAAA-MM-DD HH:MM:SS" ou, compacto (OFX), "AAAAMMDDHHMMSS" */
+static void saidaData(SaidaBuffer *s, long long ts, bool compacto) {
+    int ano, mes, dia, hora, min, seg;
+    dataCivil(ts, s->fusoSeg, &ano, &mes, &dia, &hora, &min, &seg);
+    char *p = saidaReservar(s, 19), *ini = p;
+    saidaDoisDigitos(p, ano / 100); saidaDoisDigitos(p + 2, ano % 100); p += 4;
+    if (!compacto) *p++ = '-';
+    saidaDoisDigitos(p, mes); p += 2;
+    if (!compacto) *p++ = '-';
+    saidaDoisDigitos(p, dia); p += 2;
+    if (!compacto) *p++ = ' ';
+    saidaDoisDigitos(p, hora); p += 2;
+    if (!compacto) *p++ = ':';
+    saidaDoisDigitos(p, min); p += 2;
+    if (!compacto) *p++ = ':';
+    saidaDoisDigitos(p, seg); p += 2;
+    s->tam += (int)(p - ini);
+}
+
+/* campo CSV: aspas só quando há vírgula, aspas ou quebra de linha */
+static void saidaCampoCsv(SaidaBuffer *s, const char *txt) {
+    if (!strpbrk(txt, ",\"\n\r")) { saidaTexto(s, txt); return; }
+    saidaCaractere(s, '"');
+    for (const char *p = txt; *p; ++p) {
+        if (*p == '"') saidaCaractere(s, '"');
+        saidaCaractere(s, *p);
+    }
+    saidaCaractere(s, '"');
+}
+
+static void saidaStringJson(SaidaBuffer *s, const char *txt) {
+    static const char hex[] = "0123456789abcdef";
+    saidaCaractere(s, '"');
+    for (const unsigned char *p = (const unsigned char *)txt; *p; ++p) {
+        if (*p == '"' || *p == '\\') { saidaCaractere(s, '\\'); saidaCaractere(s, (char)*p); }
+        else if (*p < 0x20) {
+            char *q = saidaReservar(s, 6);
+            q[0] = '\\'; q[1] = 'u'; q[2] = '0'; q[3] = '0'; q[4] = hex[*p >> 4]; q[5] = hex[*p & 15];
+            s->tam += 6;
+        }
+        else saidaCaractere(s, (char)*p);
+    }
+    saidaCaractere(s, '"');
+}
+
+static void saidaTextoOfx(SaidaBuffer *s, const char *txt) {
+    for (const char *p = txt; *p; ++p) {
+        if (*p == '&') saidaTexto(s, "&amp;");
+        else if (*p == '<') saidaTexto(s, "&lt;");
+        else if (*p == '>') saidaTexto(s, "&gt;");
+        else saidaCaractere(s, *p);
+    }
+}
+
+void extratoDaConta(Usuario *u, int conta, Transacao **ext, int *num) {
+    *ext = conta == CONTA_BANCO ? u->banco.extrato : u->investimento.extrato;
+    *num = conta == CONTA_BANCO ? u->banco.numTransacoes : u->investimento.numTransacoes;
+}
+
+void cabecalhoCsv(SaidaBuffer *s) {
+    saidaTexto(s, "cpf,conta,seq,data,tipo,ativo,descricao,valor,taxa,saldo\n");
+}
+
+/* uma linha de lançamento no formato pedido */
+void exportarLancamento(SaidaBuffer *s, int formato, const Usuario *u, int conta, const Transacao *t) {
+    const char *nomeConta = conta == CONTA_BANCO ? "banco" : "investimento";
+    switch (formato) {
+        case FORMATO_CSV:
+            saidaTexto(s, u->cpf); saidaCaractere(s, ',');
+            saidaTexto(s, nomeConta); saidaCaractere(s, ',');
+            saidaInteiro(s, (long long)t->seq); saidaCaractere(s, ',');
+            saidaData(s, t->ts, false); saidaCaractere(s, ',');
+            saidaCampoCsv(s, t->tipo); saidaCaractere(s, ',');
+            saidaCampoCsv(s, t->ativo); saidaCaractere(s, ',');
+            saidaCampoCsv(s, t->descricao); saidaCaractere(s, ',');
+            saidaCentavos(s, paraCentavos(t->valor), 0); saidaCaractere(s, ',');
+            saidaCentavos(s, paraCentavos(t->taxa), 0); saidaCaractere(s, ',');
+            saidaCentavos(s, paraCentavos(t->saldoFinal), 0); saidaCaractere(s, '\n');
+            break;
+        case FORMATO_JSONL:
+            saidaTexto(s, "{\"cpf\":"); saidaStringJson(s, u->cpf);
+            saidaTexto(s, ",\"conta\":\""); saidaTexto(s, nomeConta);
+            saidaTexto(s, "\",\"seq\":"); saidaInteiro(s, (long long)t->seq);
+            saidaTexto(s, ",\"data\":\""); saidaData(s, t->ts, false);
+            saidaTexto(s, "\",\"tipo\":"); saidaStringJson(s, t->tipo);
+            saidaTexto(s, ",\"ativo\":"); saidaStringJson(s, t->ativo);
+            saidaTexto(s, ",\"descricao\":"); saidaStringJson(s, t->descricao);
+            saidaTexto(s, ",\"valor\":"); saidaCentavos(s, paraCentavos(t->valor), 0);
+            saidaTexto(s, ",\"taxa\":"); saidaCentavos(s, paraCentavos(t->taxa), 0);
+            saidaTexto(s, ",\"saldo\":"); saidaCentavos(s, paraCentavos(t->saldoFinal), 0);
+            saidaTexto(s, "}\n");
+            break;
+        case FORMATO_OFX:
+            saidaTexto(s, "<STMTTRN><TRNTYPE>");
+            saidaTexto(s, t->valor < 0.0f ? "DEBIT" : "CREDIT");
+            saidaTexto(s, "<DTPOSTED>"); saidaData(s, t->ts, true);
+            saidaTexto(s, "<TRNAMT>"); saidaCentavos(s, paraCentavos(t->valor), 0);
+            saidaTexto(s, "<FITID>"); saidaTexto(s, nomeConta); saidaCaractere(s, '-'); saidaInteiro(s, (long long)t->seq);
+            saidaTexto(s, "<MEMO>"); saidaTextoOfx(s, t->descricao);
+            saidaTexto(s, "</STMTTRN>\n");
+            break;
+    }
+}
+
+/* uma conta inteira; no OFX vira um STMTTRNRS com saldo final */
+void exportarConta(SaidaBuffer *s, int formato, Usuario *u, int conta) {
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, conta, &ext, &num);
+    if (formato == FORMATO_OFX) {
+        saidaTexto(s, "<STMTTRNRS><TRNUID>"); saidaInteiro(s, conta + 1);
+        saidaTexto(s, "<STATUS><CODE>0<SEVERITY>INFO</STATUS>\n<STMTRS><CURDEF>BRL<BANKACCTFROM><BANKID>0001<ACCTID>");
+        saidaTexto(s, u->cpf); saidaTexto(s, conta == CONTA_BANCO ? "-1" : "-2");
+        saidaTexto(s, "<ACCTTYPE>CHECKING</BANKACCTFROM>\n<BANKTRANLIST><DTSTART>");
+        saidaData(s, num ? ext[0].ts : relogio_seg(), true);
+        saidaTexto(s, "<DTEND>");
+        saidaData(s, num ? ext[num - 1].ts : relogio_seg(), true);
+        saidaCaractere(s, '\n');
+    }
+    for (int i = 0; i < num; ++i) exportarLancamento(s, formato, u, conta, &ext[i]);
+    if (formato == FORMATO_OFX) {
+        float saldo = conta == CONTA_BANCO ? u->banco.saldo : u->investimento.saldo;
+        saidaTexto(s, "</BANKTRANLIST><LEDGERBAL><BALAMT>"); saidaCentavos(s, paraCentavos(saldo), 0);
+        saidaTexto(s, "<DTASOF>"); saidaData(s, relogio_seg(), true);
+        saidaTexto(s, "</LEDGERBAL></STMTRS></STMTTRNRS>\n");
+    }
+}
+
+static void iniciarArquivoExportacao(SaidaBuffer *s, int formato) {
+    if (formato == FORMATO_CSV) cabecalhoCsv(s);
+    else if (formato == FORMATO_OFX)
+        saidaTexto(s, "OFXHEADER:100\nDATA:OFXSGML\nVERSION:102\nSECURITY:NONE\nENCODING:UTF-8\nCHARSET:NONE\n"
+                      "COMPRESSION:NONE\nOLDFILEUID:NONE\nNEWFILEUID:NONE\n\n<OFX>\n<BANKMSGSRSV1>\n");
+}
+
+static void finalizarArquivoExportacao(SaidaBuffer *s, int formato) {
+    if (formato == FORMATO_OFX) saidaTexto(s, "</BANKMSGSRSV1>\n</OFX>\n");
+}
+
+bool exportarUsuario(Usuario *u, int formato, const char *arq) {
+    sincronizarExtrato(&filaExtrato);
+    SaidaBuffer s;
+    if (!saidaAbrirArquivo(&s, arq)) return false;
+    iniciarArquivoExportacao(&s, formato);
+    exportarConta(&s, formato, u, CONTA_BANCO);
+    exportarConta(&s, formato, u, CONTA_INVEST);
+    finalizarArquivoExportacao(&s, formato);
+    return saidaFechar(&s);
+}
+
+static const char *extensaoFormato(int formato) {
+    return formato == FORMATO_CSV ? "csv" : formato == FORMATO_JSONL ? "jsonl" : "ofx";
+}
+
+/* CSV/JSONL: um arquivo com todos; OFX: um arquivo por usuário. Retorna arquivos gerados (-1 erro) */
+int exportarTodos(int formato, const char *prefixo) {
+    char arq[128];
+    sincronizarExtrato(&filaExtrato);
+    if (formato == FORMATO_OFX) {
+        int n = 0;
+        for (int i = 0; i < numUsuarios; ++i) {
+            snprintf(arq, sizeof(arq), "%s_%s.ofx", prefixo, usuarios[i]->cpf);
+            if (!exportarUsuario(usuarios[i], formato, arq)) return -1;
+            n++;
+        }
+        return n;
+    }
+    snprintf(arq, sizeof(arq), "%s.%s", prefixo, extensaoFormato(formato));
+    SaidaBuffer s;
+    if (!saidaAbrirArquivo(&s, arq)) return -1;
+    iniciarArquivoExportacao(&s, formato);
+    for (int i = 0; i < numUsuarios; ++i) {
+        exportarConta(&s, formato, usuarios[i], CONTA_BANCO);
+        exportarConta(&s, formato, usuarios[i], CONTA_INVEST);
+    }
+    return saidaFechar(&s) ? 1 : -1;
+}
+
+int lerFormatoExportacao(void) {
+    int formato;
+    printf("Formato: 1 - CSV | 2 - JSON lines | 3 - OFX\n");
+    printf("Escolha: ");
+    if (scanf("%d", &formato) != 1 || formato < FORMATO_CSV || formato > FORMATO_OFX) {
+        clear_input(); printf("Formato inválido.\n"); return 0;
+    }
+    return formato;
+}
+
+void menuExportarExtrato(Usuario *u) {
+    printf("\n=== Exportar extrato ===\n");
+    int formato = lerFormatoExportacao();
+    if (!formato) return;
+    char arq[128];
+    snprintf(arq, sizeof(arq), "extrato_%s.%s", u->cpf, extensaoFormato(formato));
+    if (exportarUsuario(u, formato, arq)) printf("Extrato exportado para %s.\n", arq);
+    else printf("Falha ao gravar %s.\n", arq);
+}
+
+/* mede a exportação de 10M lançamentos sintéticos (uma conta de 200k exportada 50 vezes) */
+void benchmarkExportacao(void) {
+    const int porConta = 200000, repeticoes = 50;
+    const char *arq = "bench_exportacao.tmp";
+    printf("\n=== Benchmark de exportação: %lld lançamentos ===\n", (long long)porConta * repeticoes);
+    Usuario *u = calloc(1, sizeof(Usuario));
+    if (!u) { printf("Memória insuficiente.\n"); return; }
+    u->efemero = true;
+    snprintf(u->cpf, sizeof(u->cpf), "12345678901");
+    u->banco.extrato = malloc(sizeof(Transacao) * porConta);
+    if (!u->banco.extrato) { printf("Memória insuficiente.\n"); liberarUsuario(u); return; }
+    u->banco.numTransacoes = u->banco.capTransacoes = porConta;
+    long long ts = 1704067200LL;          // 01/01/2024 00:00 UTC
+    float saldo = 0.0f;
+    for (int i = 0; i < porConta; ++i) {
+        Transacao *t = &u->banco.extrato[i];
+        memset(t, 0, sizeof(*t));
+        t->valor = (float)((i * 7919) % 100000) / 100.0f - (i % 3 == 0 ? 500.0f : 0.0f);
+        saldo += t->valor;
+        t->saldoFinal = saldo;
+        t->taxa = (i % 10 == 0) ? 1.25f : 0.0f;
+        t->seq = (unsigned long long)i;
+        t->ts = ts + (long long)i * 37;
+        snprintf(t->tipo, sizeof(t->tipo), "%s", (i % 3 == 0) ? "Compra" : "PIX");
+        snprintf(t->descricao, sizeof(t->descricao), "Lançamento sintético %d", i);
+        if (i % 3 == 0) snprintf(t->ativo, sizeof(t->ativo), "BBAS3");
+    }
+
+    for (int formato = FORMATO_CSV; formato <= FORMATO_OFX; ++formato) {
+        SaidaBuffer s;
+        if (!saidaAbrirArquivo(&s, arq)) { printf("Falha ao criar %s.\n", arq); break; }
+        double t0 = cronometro_seg();
+        iniciarArquivoExportacao(&s, formato);
+        for (int r = 0; r < repeticoes; ++r) exportarConta(&s, formato, u, CONTA_BANCO);
+        finalizarArquivoExportacao(&s, formato);
+        bool ok = saidaFechar(&s);
+        double d = cronometro_seg() - t0;
+        printf("%-10s: %.2f s | %.1f M lançamentos/s | %.0f MB/s (%.0f MB)%s\n",
+               extensaoFormato(formato), d, porConta * (double)repeticoes / d / 1e6,
+               s.total / d / 1e6, s.total / 1e6, ok ? "" : " (ERRO DE E/S)");
+        remove(arq);
+    }
+    liberarUsuario(u);
+}
+
+/* linha da tabela de extrato no terminal */
+void saidaLinhaTabela(SaidaBuffer *s, const Transacao *t) {
+    saidaCaractere(s, '['); saidaTexto(s, t->dataHora); saidaTexto(s, "] ");
+    saidaTextoLargura(s, t->tipo, 12); saidaTexto(s, " | ");
+    saidaTextoLargura(s, t->descricao, 30);
+    saidaTexto(s, " | Valor: R$ "); saidaCentavos(s, paraCentavos(t->valor), 8);
+    saidaTexto(s, " | Taxa: R$ "); saidaCentavos(s, paraCentavos(t->taxa), 7);
+    saidaTexto(s, " | Saldo: R$ "); saidaCentavos(s, paraCentavos(t->saldoFinal), 8);
+    saidaCaractere(s, '\n');
+}
+
+/* tabela de um extrato no terminal, pelo mesmo formatador (uma escrita por MB) */
+static void exibirExtratoConta(Usuario *u, int conta, const char *titulo, const char *vazio,
+                               const char *rotuloSaldo, float saldo) {
+    sincronizarExtrato(&filaExtrato);
+    fflush(stdout);
+    SaidaBuffer s;
+    if (!saidaAbrirFd(&s, 1)) return;
+    saidaTexto(&s, titulo);
+    Transacao *ext;
+    int num;
+    extratoDaConta(u, conta, &ext, &num);
+    if (num == 0) {
+        saidaTexto(&s, vazio);
+    } else {
+        for (int i = 0; i < num; ++i) saidaLinhaTabela(&s, &ext[i]);
+    }
+    saidaTexto(&s, rotuloSaldo); saidaCentavos(&s, paraCentavos(saldo), 0); saidaCaractere(&s, '\n');
+    saidaFechar(&s);
+}
+
+void exibirExtratoBanco(Usuario *u) {
+    exibirExtratoConta(u, CONTA_BANCO, "\n=== EXTRATO - CONTA BANCO ===\n", "Nenhuma transação no banco.\n",
+                       "Saldo Banco: R$ ", u->banco.saldo);
+}
+
+void exibirExtratoInvest(Usuario *u) {
+    exibirExtratoConta(u, CONTA_INVEST, "\n=== EXTRATO - CONTA INVESTIMENTO (CAIXA) ===\n", "Nenhuma transação no investimento.\n",
+                       "Saldo caixa investimento: R$ ", u->investimento.saldo);
+}
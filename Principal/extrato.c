@@ -0,0 +1,326 @@
+#include "corretora.h"
+
+/* ======= Extrato / registro de transações ======= */
+
+FilaExtrato filaExtrato;
+
+/*
+ * Lançamentos entram num anel MPSC por shard: o produtor pega um ticket com
+ * fetch_add (o ticket é o número de sequência), copia o evento e publica com
+ * store-release. Uma thread consumidora drena os anéis em lotes, anexa aos
+ * extratos das contas e grava o lote no journal.
+ */
+
+static int drenarShard(FilaExtrato *f, AnelExtrato *a, int max);
+
+AnelExtrato *shardDaConta(FilaExtrato *f, Usuario *u, int conta) {
+    return &f->shards[(unsigned)(u->id * 2 + conta) % NUM_SHARDS_EXTRATO];
+}
+
+void publicarLancamento(FilaExtrato *f, Usuario *u, int conta, const char *tipo, const char *desc,
+                        const char *ativo, float valor, float taxa, float saldoFinal,
+                        int quantidade, float resultado) {
+    AnelExtrato *a = shardDaConta(f, u, conta);
+    unsigned long long ticket = atomic_fetch_add_explicit(&a->cauda, 1, memory_order_relaxed);
+    PosicaoAnel *p = &a->pos[ticket & (TAM_ANEL_EXTRATO - 1)];
+
+    /* anel cheio: espera o consumidor liberar a posição; cede a CPU e, se demorar, dorme */
+    if (atomic_load_explicit(&p->seq, memory_order_acquire) != ticket) {
+        atomic_fetch_add_explicit(&f->esperasAnelCheio, 1, memory_order_relaxed);
+        for (int espera = 0; atomic_load_explicit(&p->seq, memory_order_acquire) != ticket; ++espera) {
+            if (!f->temConsumidor) drenarShard(f, a, LOTE_EXTRATO);
+            else if (espera < 64) thread_ceder();
+            else thread_dormir_ms(1);
+        }
+    }
+
+    EventoExtrato *ev = &p->ev;
+    ev->u = u;
+    ev->conta = conta;
+    Transacao *t = &ev->t;
+    strncpy(t->tipo, tipo, sizeof(t->tipo)-1); t->tipo[sizeof(t->tipo)-1] = '\0';
+    strncpy(t->descricao, desc, sizeof(t->descricao)-1); t->descricao[sizeof(t->descricao)-1] = '\0';
+    if (ativo) { strncpy(t->ativo, ativo, sizeof(t->ativo)-1); t->ativo[sizeof(t->ativo)-1] = '\0'; }
+    else t->ativo[0] = '\0';
+    t->valor = valor;
+    t->taxa = taxa;
+    t->saldoFinal = saldoFinal;
+    t->quantidade = quantidade;
+    t->resultado = resultado;
+    t->seq = a->seqBase + ticket;
+    t->tsNs = relogio_ns();
+    t->ts = t->tsNs / 1000000000LL;
+
+    atomic_store_explicit(&p->seq, ticket + 1, memory_order_release);
+}
+
+/* estende as somas de prefixo com o lançamento da posição 'pos' (O(1)) */
+static bool indiceSaldoAnexar(IndiceSaldo *ix, const Transacao *ext, int pos) {
+    if (ix->num != pos) return false;     // índice incompleto (extrato montado sem anexarExtrato)
+    if (ix->num == ix->cap) {
+        int novaCap = ix->cap ? ix->cap * 2 : MAX_TRANSACOES;
+        long long *s = realloc(ix->saldoCent, sizeof(long long) * (size_t)novaCap);
+        if (!s) return false;
+        ix->saldoCent = s;
+        double *in = realloc(ix->integral, sizeof(double) * (size_t)novaCap);
+        if (!in) return false;
+        ix->integral = in;
+        ix->cap = novaCap;
+    }
+    ix->saldoCent[pos] = paraCentavos(ext[pos].saldoFinal);
+    ix->integral[pos] = pos == 0 ? 0.0
+        : ix->integral[pos - 1] + (double)ix->saldoCent[pos - 1] * (double)(ext[pos].ts - ext[pos - 1].ts);
+    ix->num++;
+    return true;
+}
+
+/* anexa um lançamento ao extrato da conta (somente o consumidor chama) */
+bool anexarExtrato(Transacao **extrato, int *num, int *cap, IndiceSaldo *saldos, const Transacao *t) {
+    if (*num == *cap) {
+        int novaCap = *cap ? *cap * 2 : MAX_TRANSACOES;
+        Transacao *n = realloc(*extrato, sizeof(Transacao) * novaCap);
+        if (!n) return false;
+        *extrato = n; *cap = novaCap;
+    }
+    Transacao *novo = &(*extrato)[*num];
+    *novo = *t;
+    /* mantém o extrato ordenado por ts, que serve de índice por tempo (journals antigos vêm sem o ajuste) */
+    if (*num > 0 && novo->ts < novo[-1].ts) novo->ts = novo[-1].ts;
+    if (*num > 0 && novo->tsNs < novo[-1].tsNs) novo->tsNs = novo[-1].tsNs;
+    indiceSaldoAnexar(saldos, *extrato, *num);
+    (*num)++;
+    return true;
+}
+
+/* drena até 'max' lançamentos de um shard; retorna quantos foram consumidos */
+static int drenarShard(FilaExtrato *f, AnelExtrato *a, int max) {
+    RegistroJournal lote[LOTE_EXTRATO];
+    int nLote = 0;
+    int n = 0;
+    unsigned long long cabeca = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+    while (n < max) {
+        PosicaoAnel *p = &a->pos[cabeca & (TAM_ANEL_EXTRATO - 1)];
+        if (atomic_load_explicit(&p->seq, memory_order_acquire) != cabeca + 1) break;
+
+        EventoExtrato *ev = &p->ev;
+        /* produtores concorrentes podem ler o relógio fora da ordem do ticket: o
+           lançamento fica com o instante do anterior da conta (e assim vai ao journal) */
+        bool banco = ev->conta == CONTA_BANCO;
+        int num = banco ? ev->u->banco.numTransacoes : ev->u->investimento.numTransacoes;
+        const Transacao *ult = num > 0 ? (banco ? ev->u->banco.extrato : ev->u->investimento.extrato) + num - 1 : NULL;
+        if (ult && ev->t.tsNs < ult->tsNs) {
+            ev->t.tsNs = ult->tsNs;
+            ev->t.ts = ult->ts;
+            atomic_fetch_add_explicit(&f->tsAjustados, 1, memory_order_relaxed);
+        }
+        timestamp_formatar(ev->t.ts, ev->t.dataHora, sizeof(ev->t.dataHora));
+        if (ev->conta == CONTA_BANCO)
+            anexarExtrato(&ev->u->banco.extrato, &ev->u->banco.numTransacoes, &ev->u->banco.capTransacoes,
+                          &ev->u->banco.saldos, &ev->t);
+        else
+            anexarExtrato(&ev->u->investimento.extrato, &ev->u->investimento.numTransacoes, &ev->u->investimento.capTransacoes,
+                          &ev->u->investimento.saldos, &ev->t);
+
+        if (f->journal && !ev->u->efemero && !atomic_load_explicit(&sessaoEnsaio, memory_order_relaxed)
+            && nLote < LOTE_EXTRATO) {
+            RegistroJournal *r = &lote[nLote++];
+            memset(r, 0, sizeof(*r));
+            memcpy(r->cpf, ev->u->cpf, sizeof(r->cpf));
+            r->conta = ev->conta;
+            r->t = ev->t;
+        }
+
+        /* libera a posição para o ticket da próxima volta do anel */
+        atomic_store_explicit(&p->seq, cabeca + TAM_ANEL_EXTRATO, memory_order_release);
+        cabeca++;
+        n++;
+    }
+    if (n > 0) {
+        if (nLote > 0) {
+            gravadorAnexar(f->journal, lote, (int)(sizeof(RegistroJournal) * nLote));
+            gravadorCommit(f->journal);
+        }
+        atomic_store_explicit(&a->cabeca, cabeca, memory_order_release);
+        atomic_fetch_add_explicit(&f->drenados, (unsigned long long)n, memory_order_release);
+    }
+    return n;
+}
+
+static void *threadConsumidorExtrato(void *arg) {
+    FilaExtrato *f = arg;
+    for (;;) {
+        bool parar = atomic_load_explicit(&f->parar, memory_order_acquire);
+        int total = 0;
+        for (int i = 0; i < NUM_SHARDS_EXTRATO; ++i)
+            total += drenarShard(f, &f->shards[i], LOTE_EXTRATO);
+        if (total == 0) {
+            if (parar) break;
+            thread_dormir_ms(1);
+        }
+    }
+    return NULL;
+}
+
+/* prepara os anéis (sem consumidor ainda: a carga do journal ajusta seqBase antes) */
+bool criarAneisExtrato(FilaExtrato *f) {
+    memset(f, 0, sizeof(*f));
+    f->shards = calloc(NUM_SHARDS_EXTRATO, sizeof(AnelExtrato));
+    if (!f->shards) return false;
+    for (int s = 0; s < NUM_SHARDS_EXTRATO; ++s)
+        for (unsigned long long i = 0; i < TAM_ANEL_EXTRATO; ++i)
+            atomic_init(&f->shards[s].pos[i].seq, i);
+    return true;
+}
+
+bool iniciarFilaExtrato(FilaExtrato *f, Gravador *journal) {
+    if (!f->shards && !criarAneisExtrato(f)) return false;
+    f->journal = journal;
+    /* sem thread, quem sincroniza drena (continua havendo um único consumidor por vez) */
+    f->temConsumidor = thread_criar(&f->consumidor, threadConsumidorExtrato, f);
+    return true;
+}
+
+void encerrarFilaExtrato(FilaExtrato *f) {
+    if (!f->shards) return;
+    if (f->temConsumidor) {
+        atomic_store_explicit(&f->parar, true, memory_order_release);
+        thread_aguardar(f->consumidor);
+        f->temConsumidor = false;
+    }
+    sincronizarExtrato(f);
+    if (f->journal) gravadorFechar(f->journal);
+    free(f->shards);
+    f->shards = NULL;
+}
+
+/* espera até que tudo o que já foi publicado esteja nos extratos */
+void sincronizarExtrato(FilaExtrato *f) {
+    for (int i = 0; i < NUM_SHARDS_EXTRATO; ++i) {
+        AnelExtrato *a = &f->shards[i];
+        unsigned long long alvo = atomic_load_explicit(&a->cauda, memory_order_acquire);
+        while (atomic_load_explicit(&a->cabeca, memory_order_acquire) < alvo) {
+            if (f->temConsumidor) thread_ceder();
+            else drenarShard(f, a, LOTE_EXTRATO);
+        }
+    }
+}
+
+/* registra em extrato do banco */
+void registrarTransacaoBanco(Usuario *u, const char *tipo, const char *desc, float valor, float taxa) {
+    publicarLancamento(&filaExtrato, u, CONTA_BANCO, tipo, desc, NULL, valor, taxa, u->banco.saldo, 0, 0.0f);
+}
+
+/* registra em extrato do investimento */
+void registrarTransacaoInvest(Usuario *u, const char *tipo, const char *desc, float valor, float taxa) {
+    publicarLancamento(&filaExtrato, u, CONTA_INVEST, tipo, desc, NULL, valor, taxa, u->investimento.saldo, 0, 0.0f);
+}
+
+/* registra no extrato do investimento um lançamento ligado a um ativo */
+void registrarTransacaoAtivo(Usuario *u, const char *tipo, const char *desc, const char *ativo, float valor, float taxa,
+                             int quantidade, float resultado) {
+    publicarLancamento(&filaExtrato, u, CONTA_INVEST, tipo, desc, ativo, valor, taxa, u->investimento.saldo,
+                       quantidade, resultado);
+}
+
+void liberarUsuario(Usuario *u) {
+    if (!u) return;
+    free(u->banco.extrato);
+    free(u->investimento.extrato);
+    liberarIndiceExtrato(u->banco.indice);
+    liberarIndiceExtrato(u->investimento.indice);
+    for (int i = 0; i < u->investimento.numAtivos; ++i) lotesLiberar(&u->investimento.carteira[i].lotes);
+    liberarAlertasUsuario(u);
+    free(u->banco.saldos.saldoCent);
+    free(u->banco.saldos.integral);
+    free(u->investimento.saldos.saldoCent);
+    free(u->investimento.saldos.integral);
+    free(u);
+}
+
+/* ---- teste de estresse: 16 produtores, verifica ordem e ausência de perda ---- */
+
+#define ESTRESSE_PRODUTORES 16
+#define ESTRESSE_EVENTOS 100000        // por produtor
+#define ESTRESSE_CONTAS 4
+
+typedef struct {
+    FilaExtrato *f;
+    Usuario **contas;
+    int produtor;
+} ArgProdutor;
+
+static void *threadProdutorEstresse(void *arg) {
+    ArgProdutor *a = arg;
+    unsigned int semente = 2654435761u * (unsigned)(a->produtor + 1);
+    for (int i = 0; i < ESTRESSE_EVENTOS; ++i) {
+        aleatorio(&semente);
+        Usuario *u = a->contas[(semente >> 16) % ESTRESSE_CONTAS];
+        int conta = (semente >> 8) & 1;
+        /* valor = contador do produtor, taxa = id do produtor (exatos em float) */
+        publicarLancamento(a->f, u, conta, "Teste", "estresse", NULL, (float)i, (float)a->produtor, 0.0f, 0, 0.0f);
+    }
+    return NULL;
+}
+
+void testeEstresseExtrato(void) {
+    printf("\n=== Teste de estresse do extrato: %d produtores x %d lançamentos ===\n",
+           ESTRESSE_PRODUTORES, ESTRESSE_EVENTOS);
+    FilaExtrato f;
+    Usuario *contas[ESTRESSE_CONTAS] = { NULL };
+    memset(&f, 0, sizeof(f));
+    if (!iniciarFilaExtrato(&f, NULL)) { printf("Memória insuficiente.\n"); return; }
+    for (int i = 0; i < ESTRESSE_CONTAS; ++i) {
+        contas[i] = calloc(1, sizeof(Usuario));
+        if (!contas[i]) { printf("Memória insuficiente.\n"); goto fim; }
+        contas[i]->id = i;
+        contas[i]->efemero = true;
+    }
+
+    Thread th[ESTRESSE_PRODUTORES];
+    ArgProdutor args[ESTRESSE_PRODUTORES];
+    int criadas = 0;
+    double t0 = cronometro_seg();
+    for (int p = 0; p < ESTRESSE_PRODUTORES; ++p) {
+        args[p].f = &f; args[p].contas = contas; args[p].produtor = p;
+        if (thread_criar(&th[p], threadProdutorEstresse, &args[p])) criadas++;
+        else threadProdutorEstresse(&args[p]);
+    }
+    for (int p = 0; p < criadas; ++p) thread_aguardar(th[p]);
+    sincronizarExtrato(&f);
+    double t1 = cronometro_seg();
+
+    /* cada (produtor, contador) deve aparecer exatamente uma vez, em ordem por conta */
+    long long esperado = (long long)ESTRESSE_PRODUTORES * ESTRESSE_EVENTOS;
+    unsigned char *visto = calloc((size_t)esperado, 1);
+    long long total = 0, duplicados = 0, foraDeOrdem = 0;
+    if (!visto) { printf("Memória insuficiente.\n"); goto fim; }
+    for (int c = 0; c < ESTRESSE_CONTAS; ++c) {
+        for (int conta = 0; conta < 2; ++conta) {
+            Transacao *ext = conta == CONTA_BANCO ? contas[c]->banco.extrato : contas[c]->investimento.extrato;
+            int n = conta == CONTA_BANCO ? contas[c]->banco.numTransacoes : contas[c]->investimento.numTransacoes;
+            int ultimo[ESTRESSE_PRODUTORES];
+            for (int p = 0; p < ESTRESSE_PRODUTORES; ++p) ultimo[p] = -1;
+            for (int i = 0; i < n; ++i) {
+                int prod = (int)ext[i].taxa, cont = (int)ext[i].valor;
+                if (i > 0 && ext[i].seq <= ext[i-1].seq) foraDeOrdem++;
+                if (cont <= ultimo[prod]) foraDeOrdem++;
+                ultimo[prod] = cont;
+                long long k = (long long)prod * ESTRESSE_EVENTOS + cont;
+                if (visto[k]) duplicados++;
+                visto[k] = 1;
+                total++;
+            }
+        }
+    }
+    free(visto);
+
+    printf("Lançamentos: %lld de %lld | duplicados: %lld | fora de ordem: %lld\n",
+           total, esperado, duplicados, foraDeOrdem);
+    printf("Tempo: %.3f s (%.0f lançamentos/s) | esperas com anel cheio: %llu | horários ajustados: %llu\n",
+           t1 - t0, (double)esperado / (t1 - t0), atomic_load(&f.esperasAnelCheio), atomic_load(&f.tsAjustados));
+    printf("%s\n", (total == esperado && duplicados == 0 && foraDeOrdem == 0) ? "OK" : "FALHA");
+
+fim:
+    encerrarFilaExtrato(&f);
+    for (int i = 0; i < ESTRESSE_CONTAS; ++i) liberarUsuario(contas[i]);
+}
@@ -0,0 +1,289 @@
+#include "corretora.h"
+
+/* ======= Histórico de preços (séries comprimidas) ======= */
+
+/*
+ * Por ponto: ts em delta-de-delta ('0' se o intervalo se repete, senão
+ * prefixo de 2 a 4 bits + 7/9/12/32 bits) e o preço (float) em XOR com o
+ * anterior ('0' se igual; '10' + bits dentro da janela do XOR anterior;
+ * '11' + 5 bits de zeros à esquerda + 5 de tamanho + bits). O primeiro
+ * ponto de cada bloco vai cru, então cada bloco decodifica sozinho.
+ */
+
+HistoricoAtivo *historico = NULL;         // um por ativo do catálogo (alocado no primeiro tick)
+
+static void serieEscrever(BlocoSerie *b, unsigned long long v, int n) {
+    while (n > 0) {
+        int livre = 8 - (b->bits & 7), k = n < livre ? n : livre;
+        unsigned parte = (unsigned)(v >> (n - k)) & ((1u << k) - 1);
+        b->dados[b->bits >> 3] |= (unsigned char)(parte << (livre - k));
+        b->bits += k;
+        n -= k;
+    }
+}
+
+/* até 32 bits a partir de *bit (big-endian) */
+static inline unsigned serieLerBits(const unsigned char *d, int *bit, int n) {
+    unsigned long long w;
+    memcpy(&w, d + (*bit >> 3), 8);
+    w = __builtin_bswap64(w);
+    *bit += n;
+    return n ? (unsigned)((w << ((*bit - n) & 7)) >> (64 - n)) : 0;
+}
+
+static inline uint32_t bitsDoPreco(float preco) { uint32_t v; memcpy(&v, &preco, 4); return v; }
+static inline float precoDosBits(uint32_t v) { float f; memcpy(&f, &v, 4); return f; }
+
+static bool serieNovoBloco(SeriePrecos *s, long long ts, float preco) {
+    if (s->num == s->cap) {
+        int novaCap = s->cap ? s->cap * 2 : 4;
+        BlocoSerie **b = realloc(s->blocos, sizeof(BlocoSerie *) * (size_t)novaCap);
+        if (!b) return false;
+        s->blocos = b;
+        long long *t = realloc(s->tsBloco, sizeof(long long) * (size_t)novaCap);
+        if (!t) return false;
+        s->tsBloco = t;
+        s->cap = novaCap;
+    }
+    BlocoSerie *b = calloc(1, sizeof(BlocoSerie));
+    if (!b) return false;
+    s->blocos[s->num] = b;
+    s->tsBloco[s->num++] = s->escala > 1 ? ts * s->escala : ts;
+    uint32_t v = bitsDoPreco(preco);
+    serieEscrever(b, (unsigned long long)ts, 64);
+    serieEscrever(b, v, 32);
+    b->pontos = 1;
+    s->tsAnt = ts; s->deltaAnt = 0; s->valorAnt = v;
+    s->zerosEsq = 32; s->zerosDir = 0;
+    return true;
+}
+
+/* ts fora de ordem é grudado no último (a série é sempre crescente) */
+bool serieAnexar(SeriePrecos *s, long long ts, float preco) {
+    if (s->escala > 1) ts /= s->escala;
+    if (s->num == 0) { if (!serieNovoBloco(s, ts, preco)) return false; s->pontos++; return true; }
+    if (ts < s->tsAnt) ts = s->tsAnt;
+    BlocoSerie *b = s->blocos[s->num - 1];
+    if (b->bits + 4 + 32 + 2 + 5 + 5 + 32 > TAM_BLOCO_SERIE * 8) {
+        if (!serieNovoBloco(s, ts, preco)) return false;
+        s->pontos++;
+        return true;
+    }
+    long long delta = ts - s->tsAnt, dod = delta - s->deltaAnt;
+    if (dod == 0) serieEscrever(b, 0, 1);
+    else if (dod >= -63 && dod <= 64) { serieEscrever(b, 2, 2); serieEscrever(b, (unsigned long long)(dod + 63), 7); }
+    else if (dod >= -255 && dod <= 256) { serieEscrever(b, 6, 3); serieEscrever(b, (unsigned long long)(dod + 255), 9); }
+    else if (dod >= -2047 && dod <= 2048) { serieEscrever(b, 14, 4); serieEscrever(b, (unsigned long long)(dod + 2047), 12); }
+    else if (dod >= INT32_MIN && dod <= INT32_MAX) { serieEscrever(b, 15, 4); serieEscrever(b, (uint32_t)(int32_t)dod, 32); }
+    else { if (!serieNovoBloco(s, ts, preco)) return false; s->pontos++; return true; }   // salto enorme: bloco novo
+    s->deltaAnt = delta;
+    s->tsAnt = ts;
+
+    uint32_t v = bitsDoPreco(preco), x = v ^ s->valorAnt;
+    s->valorAnt = v;
+    if (x == 0) {
+        serieEscrever(b, 0, 1);
+    } else {
+        int esq = __builtin_clz(x), dir = __builtin_ctz(x);
+        if (esq >= s->zerosEsq && dir >= s->zerosDir) {
+            serieEscrever(b, 2, 2);
+            serieEscrever(b, x >> s->zerosDir, 32 - s->zerosEsq - s->zerosDir);
+        } else {
+            int tam = 32 - esq - dir;
+            serieEscrever(b, 3, 2);
+            serieEscrever(b, (unsigned long long)esq, 5);
+            serieEscrever(b, (unsigned long long)(tam - 1), 5);
+            serieEscrever(b, x >> dir, tam);
+            s->zerosEsq = esq; s->zerosDir = dir;
+        }
+    }
+    b->pontos++;
+    s->pontos++;
+    return true;
+}
+
+/* decodifica um bloco inteiro; retorna os pontos */
+static int serieDecodificarBloco(const BlocoSerie *b, int escala, long long *ts, float *precos) {
+    int bit = 0;
+    long long t = (long long)serieLerBits(b->dados, &bit, 32) << 32;
+    t |= serieLerBits(b->dados, &bit, 32);
+    uint32_t v = serieLerBits(b->dados, &bit, 32);
+    long long delta = 0;
+    int zerosEsq = 32, zerosDir = 0;
+    ts[0] = t; precos[0] = precoDosBits(v);
+    for (int i = 1; i < b->pontos; ++i) {
+        long long dod;
+        if (!serieLerBits(b->dados, &bit, 1)) dod = 0;
+        else if (!serieLerBits(b->dados, &bit, 1)) dod = (long long)serieLerBits(b->dados, &bit, 7) - 63;
+        else if (!serieLerBits(b->dados, &bit, 1)) dod = (long long)serieLerBits(b->dados, &bit, 9) - 255;
+        else if (!serieLerBits(b->dados, &bit, 1)) dod = (long long)serieLerBits(b->dados, &bit, 12) - 2047;
+        else dod = (int32_t)serieLerBits(b->dados, &bit, 32);
+        delta += dod;
+        t += delta;
+        if (serieLerBits(b->dados, &bit, 1)) {
+            if (serieLerBits(b->dados, &bit, 1)) {
+                zerosEsq = (int)serieLerBits(b->dados, &bit, 5);
+                int tam = (int)serieLerBits(b->dados, &bit, 5) + 1;
+                zerosDir = 32 - zerosEsq - tam;
+            }
+            v ^= serieLerBits(b->dados, &bit, 32 - zerosEsq - zerosDir) << zerosDir;
+        }
+        ts[i] = t; precos[i] = precoDosBits(v);
+    }
+    if (escala > 1) for (int i = 0; i < b->pontos; ++i) ts[i] *= escala;
+    return b->pontos;
+}
+
+/*
+ * Pontos com ini <= ts <= fim, em ordem, até 'max'. O índice de tempo
+ * acha o primeiro bloco que pode conter 'ini'; só os blocos da faixa são
+ * decodificados.
+ */
+int serieLer(const SeriePrecos *s, long long ini, long long fim, long long *ts, float *precos, int max) {
+    if (s->num == 0 || max <= 0) return 0;
+    int lo = 0, hi = s->num;
+    while (lo < hi) {                      // primeiro bloco com tsBloco >= ini; o anterior pode ter 'ini'
+        int m = (lo + hi) / 2;
+        if (s->tsBloco[m] < ini) lo = m + 1; else hi = m;
+    }
+    int b = lo > 0 ? lo - 1 : 0, n = 0;
+    long long bts[MAX_PONTOS_BLOCO];
+    float bp[MAX_PONTOS_BLOCO];
+    for (; b < s->num && s->tsBloco[b] <= fim && n < max; ++b) {
+        int k = serieDecodificarBloco(s->blocos[b], s->escala, bts, bp);
+        for (int i = 0; i < k && n < max; ++i) {
+            if (bts[i] < ini) continue;
+            if (bts[i] > fim) return n;
+            ts[n] = bts[i]; precos[n] = bp[i]; n++;
+        }
+    }
+    return n;
+}
+
+size_t serieBytes(const SeriePrecos *s) {
+    size_t t = (size_t)s->cap * (sizeof(BlocoSerie *) + sizeof(long long));
+    for (int i = 0; i < s->num; ++i) t += sizeof(BlocoSerie);
+    return t;
+}
+
+void serieLiberar(SeriePrecos *s) {
+    for (int i = 0; i < s->num; ++i) free(s->blocos[i]);
+    free(s->blocos);
+    free(s->tsBloco);
+    memset(s, 0, sizeof(*s));
+}
+
+/* tick de preço de um ativo; a virada de dia grava o fechamento do dia anterior (último tick) */
+void historicoRegistrar(int idx, long long ts, float preco) {
+    if (idx < 0 || idx >= NUM_ATIVOS) return;
+    if (!historico && !(historico = calloc((size_t)NUM_ATIVOS, sizeof(HistoricoAtivo)))) return;
+    HistoricoAtivo *h = &historico[idx];
+    long long dia = diaLocal(ts, fusoProcesso());
+    h->fechamentos.escala = 86400;
+    if (h->ticks.pontos > 0 && dia > h->diaUltimo) {
+        serieAnexar(&h->fechamentos, h->diaUltimo * 86400, h->precoUltimo);
+        indicadoresFechamento(idx, h->precoUltimo);
+    }
+    serieAnexar(&h->ticks, ts, preco);
+    if (ts >= h->tsUltimo) { h->tsUltimo = ts; h->diaUltimo = dia; h->precoUltimo = preco; }
+}
+
+void liberarHistorico(void) {
+    if (!historico) return;
+    for (int j = 0; j < NUM_ATIVOS; ++j) {
+        serieLiberar(&historico[j].ticks);
+        serieLiberar(&historico[j].fechamentos);
+    }
+    free(historico);
+    historico = NULL;
+}
+
+void menuHistoricoPrecos(void) {
+    int idx;
+    listarAtivosDisponiveis();
+    printf("Ativo (número): ");
+    if (scanf("%d", &idx) != 1 || idx < 1 || idx > NUM_ATIVOS) { clear_input(); printf("Ativo inválido.\n"); return; }
+    HistoricoAtivo *h = historico ? &historico[idx - 1] : NULL;
+    if (!h || h->ticks.pontos == 0) { printf("Sem histórico para %s.\n", ativosDisponiveis[idx - 1].ticker); return; }
+    printf("%s: %lld tick(s) em %d bloco(s) (%zu bytes) | %lld fechamento(s)\n", ativosDisponiveis[idx - 1].ticker,
+           h->ticks.pontos, h->ticks.num, serieBytes(&h->ticks), h->fechamentos.pontos);
+    long long ts[10];
+    float precos[10];
+    int n = serieLer(&h->fechamentos, 0, LLONG_MAX, ts, precos, 10);
+    for (int i = 0; i < n; ++i) {
+        char data[32];
+        time_t t = (time_t)ts[i];
+        strftime(data, sizeof(data), "%d/%m/%Y", gmtime(&t));   // ts do fechamento é a data, não o instante
+        printf("  Fechamento %s: R$ %.2f\n", data, precos[i]);
+    }
+    printf("Último tick: R$ %.2f\n", h->precoUltimo);
+}
+
+/*
+ * 10 anos de ticks de 1 s no pregão (passeio aleatório em centavos, 60%
+ * dos ticks sem mudança) para um ativo: bytes por tick, leitura de um dia
+ * e dos 10 anos de fechamentos; confere a decodificação com o original.
+ */
+void benchmarkHistoricoPrecos(void) {
+    const int dias = 2520, ticksDia = 2000;
+    const long long total = (long long)dias * ticksDia;
+    printf("\n=== Benchmark do histórico de preços (%d pregões, %lld ticks) ===\n", dias, total);
+    float *orig = malloc(sizeof(float) * (size_t)total);
+    long long *ts = malloc(sizeof(long long) * (size_t)ticksDia);
+    float *lidos = malloc(sizeof(float) * (size_t)ticksDia);
+    if (!orig || !ts || !lidos) { free(orig); free(ts); free(lidos); printf("Memória insuficiente.\n"); return; }
+    SeriePrecos ticks, fech;
+    memset(&ticks, 0, sizeof(ticks)); memset(&fech, 0, sizeof(fech));
+    fech.escala = 86400;
+    unsigned semente = 2024u;
+    long long cent = 3000, base = 1420106400LL;   // 01/01/2015 10h (UTC-3)
+    double t0 = cronometro_seg();
+    for (int d = 0; d < dias; ++d) {
+        long long inicio = base + (long long)(d / 5 * 7 + d % 5) * 86400;   // só dias úteis
+        for (int i = 0; i < ticksDia; ++i) {
+            aleatorio(&semente);
+            unsigned r = (semente >> 16) % 10;
+            if (r >= 8) cent++; else if (r >= 6 && cent > 100) cent--;
+            float p = (float)cent / 100.0f;
+            orig[(long long)d * ticksDia + i] = p;
+            serieAnexar(&ticks, inicio + i + ((semente & 63) == 0), p);   // alguns ticks com 1 s de atraso
+        }
+        serieAnexar(&fech, diaLocal(inicio, -3 * 3600) * 86400, orig[(long long)d * ticksDia + ticksDia - 1]);
+    }
+    double dGravar = cronometro_seg() - t0;
+    size_t bytes = serieBytes(&ticks);
+    printf("Gravação: %.1f ns por tick | %.2f bytes por tick (%d blocos, %.1f MB vs %.1f MB crus)\n",
+           dGravar / total * 1e9, (double)bytes / total, ticks.num, bytes / 1048576.0,
+           total * (sizeof(long long) + sizeof(float)) / 1048576.0);
+
+    /* um pregão qualquer, várias vezes */
+    const int leituras = 2000;
+    int n = 0;
+    t0 = cronometro_seg();
+    for (int k = 0; k < leituras; ++k) {
+        int d = (k * 131) % dias;
+        long long inicio = base + (long long)(d / 5 * 7 + d % 5) * 86400;
+        n = serieLer(&ticks, inicio, inicio + 86399, ts, lidos, ticksDia);
+    }
+    double dDia = (cronometro_seg() - t0) / leituras;
+    long long tsF[2600];
+    float pF[2600];
+    t0 = cronometro_seg();
+    int nF = 0;
+    for (int k = 0; k < leituras; ++k) nF = serieLer(&fech, 0, LLONG_MAX, tsF, pF, 2600);
+    double dFech = (cronometro_seg() - t0) / leituras;
+    printf("Leitura: um pregão (%d ticks) em %.1f us | 10 anos de fechamentos (%d) em %.1f us (%.2f bytes/ponto)\n",
+           n, dDia * 1e6, nF, dFech * 1e6, (double)serieBytes(&fech) / nF);
+
+    /* conferência: todos os ticks, pregão a pregão */
+    long long divergentes = 0;
+    for (int d = 0; d < dias; ++d) {
+        long long inicio = base + (long long)(d / 5 * 7 + d % 5) * 86400;
+        int k = serieLer(&ticks, inicio, inicio + 86399, ts, lidos, ticksDia);
+        if (k != ticksDia) { divergentes += ticksDia; continue; }
+        for (int i = 0; i < k; ++i) divergentes += lidos[i] != orig[(long long)d * ticksDia + i];
+    }
+    printf("Conferência: %lld tick(s) divergente(s)\n", divergentes);
+    serieLiberar(&ticks); serieLiberar(&fech);
+    free(orig); free(ts); free(lidos);
+}
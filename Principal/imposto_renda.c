@@ -0,0 +1,171 @@
+#include "corretora.h"
+
+/* ======= Imposto de renda sobre ganho de capital ======= */
+
+/*
+ * Cada venda soma seu ganho no balde do mês: comum (ações, contra o preço
+ * médio), day trade (lotes do mesmo dia) ou FII. Ao fechar o mês, o ganho
+ * comum é isento se as vendas de ações ficaram até R$ 20 mil; prejuízos
+ * de cada balde só compensam ganhos do mesmo balde. O fechamento é O(1)
+ * por usuário, então o lote mensal é O(usuários) sem reler extratos. O
+ * DARF emitido vira um lançamento "DARF" no extrato (mês e valor na
+ * descrição), que marca o mês como fechado quando a apuração é refeita do
+ * journal. Mês sem DARF não deixa lançamento: refeito, fecha igual depois.
+ */
+
+int mesDoTs(long long ts) {
+    int ano, mes, dia, hora, min, seg;
+    dataCivil(ts, fusoProcesso(), &ano, &mes, &dia, &hora, &min, &seg);
+    return ano * 100 + mes;
+}
+
+static int mesSeguinte(int mes) {
+    return mes % 100 == 12 ? (mes / 100 + 1) * 100 + 1 : mes + 1;
+}
+
+/* imposto de um balde: compensa o prejuízo acumulado ou acumula o novo */
+static long long impostoDoBalde(long long ganho, long long *prejuizo, double aliquota, bool isento) {
+    if (ganho < 0) { *prejuizo -= ganho; return 0; }
+    if (isento) return 0;
+    long long comp = ganho < *prejuizo ? ganho : *prejuizo;
+    *prejuizo -= comp;
+    return (long long)((double)(ganho - comp) * aliquota + 0.5);
+}
+
+/* fecha o mês em apuração; retorna o DARF do mês (0 se isento ou abaixo do mínimo) */
+long long fecharMesIR(ApuracaoIR *ir) {
+    if (ir->mes == 0) return 0;
+    long long imposto = ir->impostoAcumulado
+        + impostoDoBalde(ir->ganhoComum, &ir->prejuizoComum, ALIQUOTA_COMUM, ir->vendasAcoes <= LIMITE_ISENCAO_ACOES)
+        + impostoDoBalde(ir->ganhoDayTrade, &ir->prejuizoDayTrade, ALIQUOTA_DAY_TRADE, false)
+        + impostoDoBalde(ir->ganhoFII, &ir->prejuizoFII, ALIQUOTA_FII, false);
+    ir->vendasAcoes = ir->ganhoComum = ir->ganhoDayTrade = ir->ganhoFII = 0;
+    ir->mes = mesSeguinte(ir->mes);
+    if (imposto < DARF_MINIMO) { ir->impostoAcumulado = imposto; return 0; }
+    ir->impostoAcumulado = 0;
+    return imposto;
+}
+
+/* uma venda (valores em centavos); vira o mês se a venda é de um mês posterior */
+void apurarVenda(ApuracaoIR *ir, int mes, bool fii, long long valor, long long ganhoComum, long long ganhoDayTrade) {
+    while (ir->mes != 0 && ir->mes < mes) ir->darfEmAberto += fecharMesIR(ir);
+    ir->mes = mes;
+    if (fii) { ir->ganhoFII += ganhoComum + ganhoDayTrade; return; }
+    ir->vendasAcoes += valor;
+    ir->ganhoComum += ganhoComum;
+    ir->ganhoDayTrade += ganhoDayTrade;
+}
+
+/*
+ * Separa o ganho de uma venda entre comum e day trade pelo custo dos lotes
+ * consumidos: os do dia vão para o day trade e os demais (FIFO) para o
+ * comum, então compras do dia não contaminam o custo da operação comum.
+ * A parte não coberta por lotes (histórico antigo) usa o preço médio.
+ */
+void apurarVendaUsuario(Usuario *u, const char *ticker, long long ts, int quantidade, float valor, float taxa,
+                               float resultado, const ConsumoLotes *consumo) {
+    if (quantidade <= 0) return;
+    int j = indiceCatalogo(ticker);
+    bool fii = j >= 0 && ativosDisponiveis[j].isFII;
+    /* taxas da venda reduzem o ganho, rateadas entre comum e day trade (em double: o custo dos lotes já é) */
+    double precoUnit = ((double)valor - taxa) / quantidade;
+    int semLote = quantidade - consumo->qtdComum - consumo->qtdDayTrade;
+    double ganhoComum = precoUnit * consumo->qtdComum - consumo->custoComum
+                      + ((double)resultado - taxa) * semLote / quantidade;
+    double ganhoDayTrade = precoUnit * consumo->qtdDayTrade - consumo->custoDayTrade;
+    apurarVenda(&u->investimento.ir, mesDoTs(ts), fii, paraCentavos(valor),
+                (long long)llround(ganhoComum * 100.0), (long long)llround(ganhoDayTrade * 100.0));
+}
+
+/*
+ * Fecha o mês 'mes' (AAAAMM) de todos os usuários e grava os DARFs em
+ * 'arq' (cpf, mês, valor). Retorna quantos DARFs foram emitidos.
+ */
+int fechamentoMensalIR(int mes, const char *arq, long long *totalDarf) {
+    sincronizarExtrato(&filaExtrato);
+    SaidaBuffer s;
+    if (!saidaAbrirArquivo(&s, arq)) return -1;
+    saidaTexto(&s, "cpf,mes,darf\n");
+    int emitidos = 0;
+    *totalDarf = 0;
+    for (int i = 0; i < numUsuarios; ++i) {
+        Usuario *u = usuarios[i];
+        ApuracaoIR *ir = &u->investimento.ir;
+        if (ir->mes == 0 && ir->darfEmAberto == 0) continue;
+        if (ir->mes > mes && ir->darfEmAberto == 0) continue;   // já apurando um mês posterior
+        long long darf = ir->darfEmAberto;
+        while (ir->mes != 0 && ir->mes <= mes) darf += fecharMesIR(ir);
+        ir->darfEmAberto = 0;
+        if (darf == 0) continue;
+        char desc[80];
+        snprintf(desc, sizeof(desc), "DARF %04d-%02d R$ %lld.%02lld", mes / 100, mes % 100, darf / 100, darf % 100);
+        publicarLancamento(&filaExtrato, u, CONTA_INVEST, "DARF", desc, NULL, 0.0f, 0.0f, u->investimento.saldo, 0, 0.0f);
+        saidaTexto(&s, u->cpf); saidaCaractere(&s, ',');
+        saidaInteiro(&s, mes / 100); saidaCaractere(&s, '-');
+        char mm[2]; saidaDoisDigitos(mm, mes % 100); saidaBytes(&s, mm, 2); saidaCaractere(&s, ',');
+        saidaCentavos(&s, darf, 0); saidaCaractere(&s, '\n');
+        emitidos++;
+        *totalDarf += darf;
+    }
+    return saidaFechar(&s) ? emitidos : -1;
+}
+
+void menuFechamentoIR(void) {
+    int ano, m;
+    printf("Mês a fechar (AAAA-MM): ");
+    if (scanf("%d-%d", &ano, &m) != 2 || m < 1 || m > 12) { clear_input(); printf("Mês inválido.\n"); return; }
+    int mes = ano * 100 + m;
+    char arq[64];
+    snprintf(arq, sizeof(arq), "darf_%04d%02d.csv", ano, m);
+    long long total;
+    int n = fechamentoMensalIR(mes, arq, &total);
+    if (n < 0) printf("Falha ao gravar %s.\n", arq);
+    else printf("%d DARF(s) emitido(s) em %s | total R$ %.2f\n", n, arq, total / 100.0);
+}
+
+/* 1M apurações com vendas sintéticas: custo por venda e do fechamento mensal; confere as regras */
+void benchmarkFechamentoIR(void) {
+    const int contas = 1000000, vendasPorConta = 8;
+    printf("\n=== Benchmark do fechamento mensal de IR (%d contas) ===\n", contas);
+    ApuracaoIR *ir = calloc((size_t)contas, sizeof(ApuracaoIR));
+    if (!ir) { printf("Memória insuficiente.\n"); return; }
+    unsigned semente = 31337u;
+    double t0 = cronometro_seg();
+    for (int v = 0; v < vendasPorConta; ++v)
+        for (int i = 0; i < contas; ++i) {
+            aleatorio(&semente);
+            long long valor = 100000 + (semente >> 8) % 800000;           // R$ 1 mil a R$ 9 mil
+            long long ganho = (long long)((semente >> 4) % 40001) - 15000; // -R$ 150 a +R$ 250
+            apurarVenda(&ir[i], 202501, (semente & 7) == 0, valor, ganho, (semente & 15) == 1 ? ganho / 2 : 0);
+        }
+    double d = cronometro_seg() - t0;
+    printf("Vendas apuradas: %.1f ns por venda\n", d / ((double)contas * vendasPorConta) * 1e9);
+    long long total = 0;
+    int emitidos = 0;
+    t0 = cronometro_seg();
+    for (int i = 0; i < contas; ++i) {
+        long long darf = fecharMesIR(&ir[i]);
+        total += darf;
+        emitidos += darf > 0;
+    }
+    d = cronometro_seg() - t0;
+    printf("Fechamento: %.1f ms (%.1f ns por conta) | %d DARFs | total R$ %.2f\n",
+           d * 1e3, d / contas * 1e9, emitidos, total / 100.0);
+    free(ir);
+
+    /* regras: isenção até R$ 20 mil, compensação por balde, DARF mínimo */
+    ApuracaoIR a;
+    memset(&a, 0, sizeof(a));
+    apurarVenda(&a, 202501, false, 1500000, 300000, 0);       // R$ 15 mil vendidos, ganho R$ 3 mil: isento
+    long long jan = fecharMesIR(&a);
+    apurarVenda(&a, 202502, false, 3000000, -100000, 0);      // prejuízo comum de R$ 1 mil
+    apurarVenda(&a, 202502, true, 500000, -50000, 0);         // prejuízo FII de R$ 500
+    long long fev = fecharMesIR(&a);
+    apurarVenda(&a, 202503, false, 2500000, 300000, 20000);   // ganho comum R$ 3 mil (compensa R$ 1 mil) + day trade R$ 200
+    apurarVenda(&a, 202503, true, 100000, 40000, 0);          // ganho FII R$ 400 (compensa R$ 400 do prejuízo)
+    long long mar = fecharMesIR(&a);
+    apurarVenda(&a, 202504, false, 3000000, 3000, 0);         // imposto de R$ 4,50: abaixo do mínimo
+    long long abr = fecharMesIR(&a);
+    printf("Regras: jan %.2f (esp. 0.00) | fev %.2f (0.00) | mar %.2f (340.00) | abr %.2f (0.00, acumula %.2f)\n",
+           jan / 100.0, fev / 100.0, mar / 100.0, abr / 100.0, a.impostoAcumulado / 100.0);
+}
@@ -0,0 +1,289 @@
+#include "corretora.h"
+
+/* ======= Indicadores técnicos (incrementais e em lote) ======= */
+
+/*
+ * SMA e Bollinger por somas correntes (entra o fechamento novo, sai o de
+ * 'período' velas atrás, lido do anel), EMA semeada com o primeiro
+ * fechamento e RSI com médias de Wilder semeadas em zero. Cada fechamento
+ * diário custa O(1). Ao mudar os períodos, indicadoresLote refaz tudo a
+ * partir do histórico de fechamentos, numa matriz [dia][ativo] varrida
+ * dia a dia com o laço interno sobre os ativos (contíguo e sem desvios,
+ * vetorizável). As duas versões fazem as mesmas operações em double e
+ * chegam ao mesmo estado.
+ */
+
+ParametrosIndicadores parametrosIndicadores = { 20, 20, 14, 20, 2.0f };
+EstadoIndicadores *indicadores = NULL;    // um por ativo do catálogo (alocado no primeiro fechamento)
+
+void indicadoresAtualizar(EstadoIndicadores *e, const ParametrosIndicadores *p, float x) {
+    double v = x;
+    double saiSma = e->n >= p->sma ? e->janela[(e->pos - p->sma + MAX_JANELA_INDICADOR) % MAX_JANELA_INDICADOR] : 0.0;
+    double saiBoll = e->n >= p->bollinger
+        ? e->janela[(e->pos - p->bollinger + MAX_JANELA_INDICADOR) % MAX_JANELA_INDICADOR] : 0.0;
+    e->somaSma += v - saiSma;
+    e->somaBoll += v - saiBoll;
+    e->somaQuadBoll += v * v - saiBoll * saiBoll;
+    e->ema += (e->n == 0 ? 1.0 : 2.0 / (p->ema + 1)) * (v - e->ema);
+    double dif = e->n == 0 ? 0.0 : v - (double)e->anterior;
+    double aR = 1.0 / p->rsi;
+    e->ganho += aR * ((dif > 0.0 ? dif : 0.0) - e->ganho);
+    e->perda += aR * ((dif < 0.0 ? -dif : 0.0) - e->perda);
+    e->anterior = x;
+    e->janela[e->pos] = x;
+    e->pos = (e->pos + 1) % MAX_JANELA_INDICADOR;
+    e->n++;
+}
+
+void indicadoresValores(const EstadoIndicadores *e, const ParametrosIndicadores *p, Indicadores *out) {
+    memset(out, 0, sizeof(*out));
+    if (e->n == 0) return;
+    int kS = e->n < p->sma ? e->n : p->sma, kB = e->n < p->bollinger ? e->n : p->bollinger;
+    out->sma = (float)(e->somaSma / kS);
+    out->ema = (float)e->ema;
+    out->rsi = e->perda == 0.0 ? (e->ganho == 0.0 ? 50.0f : 100.0f) : (float)(100.0 - 100.0 / (1.0 + e->ganho / e->perda));
+    double media = e->somaBoll / kB, var = e->somaQuadBoll / kB - media * media;
+    double dp = var > 0.0 ? sqrt(var) : 0.0;
+    out->bandaInf = (float)(media - p->desvios * dp);
+    out->bandaSup = (float)(media + p->desvios * dp);
+}
+
+/* colunas do recálculo em lote (uma entrada por ativo) e o dia em processamento */
+typedef struct {
+    double *somaS, *somaB, *quadB, *ema, *ganho, *perda;
+    float *anterior;
+    const float *x, *xs, *xb;             // fechamentos do dia, de 'sma' e de 'bollinger' dias atrás
+    const int *inicio;
+    int d, sma, bollinger;
+    double aE, aR;
+} ColunasIndicadores;
+
+/* ativos [i0, i1) de um dia; máscaras em vez de desvios, todas as cargas incondicionais */
+static void indicadoresDiaEscalar(const ColunasIndicadores *c, int i0, int i1) {
+    for (int i = i0; i < i1; ++i) {
+        double m = (double)(c->d >= c->inicio[i]), primeiro = (double)(c->d == c->inicio[i]);
+        double v = c->x[i], va = c->anterior[i];
+        double saiSma = (double)(c->d - c->sma >= c->inicio[i]) * c->xs[i];
+        double saiBoll = (double)(c->d - c->bollinger >= c->inicio[i]) * c->xb[i];
+        c->somaS[i] += m * (v - saiSma);
+        c->somaB[i] += m * (v - saiBoll);
+        c->quadB[i] += m * (v * v - saiBoll * saiBoll);
+        double coef = primeiro != 0.0 ? 1.0 : c->aE;
+        c->ema[i] += m * (coef * (v - c->ema[i]));
+        double dif = (1.0 - primeiro) * (v - va);
+        c->ganho[i] += m * (c->aR * ((dif > 0.0 ? dif : 0.0) - c->ganho[i]));
+        c->perda[i] += m * (c->aR * ((dif < 0.0 ? -dif : 0.0) - c->perda[i]));
+        c->anterior[i] = (float)(m * v + (1.0 - m) * va);
+    }
+}
+
+#ifdef USAR_SIMD_X86
+int avx2Disponivel = -1;
+
+/* 4 ativos por iteração em AVX2, mesmas operações (sem FMA) do escalar; devolve até onde foi */
+__attribute__((target("avx2")))
+static int indicadoresDiaAvx2(const ColunasIndicadores *c, int n) {
+    const __m128i um = _mm_set1_epi32(1), vd = _mm_set1_epi32(c->d);
+    const __m128i vdS = _mm_set1_epi32(c->d - c->sma), vdB = _mm_set1_epi32(c->d - c->bollinger);
+    const __m256d zero = _mm256_setzero_pd(), uns = _mm256_set1_pd(1.0);
+    const __m256d aE = _mm256_set1_pd(c->aE), aR = _mm256_set1_pd(c->aR);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i ini = _mm_loadu_si128((const __m128i *)(c->inicio + i));
+        __m256d m = _mm256_cvtepi32_pd(_mm_andnot_si128(_mm_cmpgt_epi32(ini, vd), um));
+        __m256d primeiro = _mm256_cvtepi32_pd(_mm_and_si128(_mm_cmpeq_epi32(ini, vd), um));
+        __m256d mS = _mm256_cvtepi32_pd(_mm_andnot_si128(_mm_cmpgt_epi32(ini, vdS), um));
+        __m256d mB = _mm256_cvtepi32_pd(_mm_andnot_si128(_mm_cmpgt_epi32(ini, vdB), um));
+        __m256d v = _mm256_cvtps_pd(_mm_loadu_ps(c->x + i)), va = _mm256_cvtps_pd(_mm_loadu_ps(c->anterior + i));
+        __m256d saiSma = _mm256_mul_pd(mS, _mm256_cvtps_pd(_mm_loadu_ps(c->xs + i)));
+        __m256d saiBoll = _mm256_mul_pd(mB, _mm256_cvtps_pd(_mm_loadu_ps(c->xb + i)));
+        __m256d t;
+        t = _mm256_mul_pd(m, _mm256_sub_pd(v, saiSma));
+        _mm256_storeu_pd(c->somaS + i, _mm256_add_pd(_mm256_loadu_pd(c->somaS + i), t));
+        t = _mm256_mul_pd(m, _mm256_sub_pd(v, saiBoll));
+        _mm256_storeu_pd(c->somaB + i, _mm256_add_pd(_mm256_loadu_pd(c->somaB + i), t));
+        t = _mm256_mul_pd(m, _mm256_sub_pd(_mm256_mul_pd(v, v), _mm256_mul_pd(saiBoll, saiBoll)));
+        _mm256_storeu_pd(c->quadB + i, _mm256_add_pd(_mm256_loadu_pd(c->quadB + i), t));
+        __m256d coef = _mm256_blendv_pd(aE, uns, _mm256_cmp_pd(primeiro, zero, _CMP_NEQ_OQ));
+        __m256d ema = _mm256_loadu_pd(c->ema + i);
+        _mm256_storeu_pd(c->ema + i, _mm256_add_pd(ema, _mm256_mul_pd(m, _mm256_mul_pd(coef, _mm256_sub_pd(v, ema)))));
+        __m256d dif = _mm256_mul_pd(_mm256_sub_pd(uns, primeiro), _mm256_sub_pd(v, va));
+        __m256d ganhoDia = _mm256_and_pd(dif, _mm256_cmp_pd(dif, zero, _CMP_GT_OQ));
+        __m256d perdaDia = _mm256_and_pd(_mm256_sub_pd(zero, dif), _mm256_cmp_pd(dif, zero, _CMP_LT_OQ));
+        __m256d g = _mm256_loadu_pd(c->ganho + i), l = _mm256_loadu_pd(c->perda + i);
+        _mm256_storeu_pd(c->ganho + i, _mm256_add_pd(g, _mm256_mul_pd(m, _mm256_mul_pd(aR, _mm256_sub_pd(ganhoDia, g)))));
+        _mm256_storeu_pd(c->perda + i, _mm256_add_pd(l, _mm256_mul_pd(m, _mm256_mul_pd(aR, _mm256_sub_pd(perdaDia, l)))));
+        __m256d novo = _mm256_add_pd(_mm256_mul_pd(m, v), _mm256_mul_pd(_mm256_sub_pd(uns, m), va));
+        _mm_storeu_ps(c->anterior + i, _mm256_cvtpd_ps(novo));
+    }
+    return i;
+}
+#endif
+
+/*
+ * Recalcula o estado de 'numAtivos' ativos a partir de 'fechamentos'
+ * ([dia][ativo], 'dias' linhas); o ativo i só tem dados a partir do dia
+ * inicio[i]. Os estados ficam prontos para seguir com indicadoresAtualizar.
+ * AVX2 se a CPU tiver (verificado em tempo de execução), senão escalar.
+ */
+bool indicadoresLote(const float *fechamentos, const int *inicio, int numAtivos, int dias,
+                     const ParametrosIndicadores *p, EstadoIndicadores *estados) {
+    double *col = calloc((size_t)numAtivos * 6, sizeof(double));
+    float *ant = calloc((size_t)numAtivos * 2, sizeof(float));
+    if (!col || !ant) { free(col); free(ant); return false; }
+    ColunasIndicadores c = {
+        .somaS = col, .somaB = col + numAtivos, .quadB = col + 2 * (size_t)numAtivos,
+        .ema = col + 3 * (size_t)numAtivos, .ganho = col + 4 * (size_t)numAtivos, .perda = col + 5 * (size_t)numAtivos,
+        .anterior = ant, .inicio = inicio, .sma = p->sma, .bollinger = p->bollinger,
+        .aE = 2.0 / (p->ema + 1), .aR = 1.0 / p->rsi,
+    };
+    const float *zeros = ant + numAtivos;
+#ifdef USAR_SIMD_X86
+    if (avx2Disponivel < 0) avx2Disponivel = __builtin_cpu_supports("avx2") ? 1 : 0;
+#endif
+    for (int d = 0; d < dias; ++d) {
+        c.d = d;
+        c.x = fechamentos + (size_t)d * numAtivos;
+        c.xs = d >= p->sma ? fechamentos + (size_t)(d - p->sma) * numAtivos : zeros;
+        c.xb = d >= p->bollinger ? fechamentos + (size_t)(d - p->bollinger) * numAtivos : zeros;
+        int i = 0;
+#ifdef USAR_SIMD_X86
+        if (avx2Disponivel) i = indicadoresDiaAvx2(&c, numAtivos);
+#endif
+        indicadoresDiaEscalar(&c, i, numAtivos);
+    }
+    const double *somaS = c.somaS, *somaB = c.somaB, *quadB = c.quadB, *ema = c.ema, *ganho = c.ganho, *perda = c.perda;
+    const float *anterior = c.anterior;
+    for (int i = 0; i < numAtivos; ++i) {
+        EstadoIndicadores *e = &estados[i];
+        memset(e, 0, sizeof(*e));
+        int n = inicio[i] < dias ? dias - inicio[i] : 0;
+        e->n = n;
+        e->pos = n % MAX_JANELA_INDICADOR;
+        for (int j = n > MAX_JANELA_INDICADOR ? n - MAX_JANELA_INDICADOR : 0; j < n; ++j)
+            e->janela[j % MAX_JANELA_INDICADOR] = fechamentos[(size_t)(inicio[i] + j) * numAtivos + i];
+        e->somaSma = somaS[i]; e->somaBoll = somaB[i]; e->somaQuadBoll = quadB[i];
+        e->ema = ema[i]; e->ganho = ganho[i]; e->perda = perda[i];
+        e->anterior = anterior[i];
+    }
+    free(col); free(ant);
+    return true;
+}
+
+void indicadoresFechamento(int idx, float fechamento) {
+    if (idx < 0 || idx >= NUM_ATIVOS) return;
+    if (!indicadores && !(indicadores = calloc((size_t)NUM_ATIVOS, sizeof(EstadoIndicadores)))) return;
+    indicadoresAtualizar(&indicadores[idx], &parametrosIndicadores, fechamento);
+}
+
+/* refaz os indicadores do catálogo a partir dos fechamentos gravados (alinhados pelo último dia) */
+bool recalcularIndicadores(void) {
+    if (!historico) return true;
+    int dias = 0;
+    for (int j = 0; j < NUM_ATIVOS; ++j)
+        if (historico[j].fechamentos.pontos > dias) dias = (int)historico[j].fechamentos.pontos;
+    if (dias == 0) return true;
+    if (!indicadores && !(indicadores = calloc((size_t)NUM_ATIVOS, sizeof(EstadoIndicadores)))) return false;
+    float *matriz = calloc((size_t)dias * NUM_ATIVOS, sizeof(float));
+    int *inicio = malloc(sizeof(int) * (size_t)NUM_ATIVOS);
+    long long *ts = malloc(sizeof(long long) * (size_t)dias);
+    float *col = malloc(sizeof(float) * (size_t)dias);
+    bool ok = matriz && inicio && ts && col;
+    for (int j = 0; ok && j < NUM_ATIVOS; ++j) {
+        int n = serieLer(&historico[j].fechamentos, 0, LLONG_MAX, ts, col, dias);
+        inicio[j] = dias - n;
+        for (int k = 0; k < n; ++k) matriz[(size_t)(inicio[j] + k) * NUM_ATIVOS + j] = col[k];
+    }
+    ok = ok && indicadoresLote(matriz, inicio, NUM_ATIVOS, dias, &parametrosIndicadores, indicadores);
+    free(matriz); free(inicio); free(ts); free(col);
+    return ok;
+}
+
+void liberarIndicadores(void) {
+    free(indicadores);
+    indicadores = NULL;
+}
+
+void menuParametrosIndicadores(void) {
+    ParametrosIndicadores p;
+    printf("Períodos atuais: SMA %d | EMA %d | RSI %d | Bollinger %d (%.1f desvios)\n",
+           parametrosIndicadores.sma, parametrosIndicadores.ema, parametrosIndicadores.rsi,
+           parametrosIndicadores.bollinger, parametrosIndicadores.desvios);
+    printf("Novos períodos (SMA EMA RSI Bollinger desvios): ");
+    if (scanf("%d %d %d %d %f", &p.sma, &p.ema, &p.rsi, &p.bollinger, &p.desvios) != 5 ||
+        p.sma < 1 || p.sma > MAX_JANELA_INDICADOR || p.bollinger < 1 || p.bollinger > MAX_JANELA_INDICADOR ||
+        p.ema < 1 || p.rsi < 1 || p.desvios <= 0.0f) {
+        clear_input();
+        printf("Parâmetros inválidos (períodos de 1 a %d).\n", MAX_JANELA_INDICADOR);
+        return;
+    }
+    parametrosIndicadores = p;
+    double t0 = cronometro_seg();
+    if (!recalcularIndicadores()) { printf("Memória insuficiente.\n"); return; }
+    printf("Indicadores recalculados em %.2f ms.\n", (cronometro_seg() - t0) * 1e3);
+}
+
+/* 2.000 ativos x 20 anos de fechamentos: recálculo em lote, atualização incremental e conferência */
+void benchmarkIndicadores(void) {
+    const int num = 2000, dias = 20 * 252;
+    printf("\n=== Benchmark de indicadores (%d ativos x %d fechamentos) ===\n", num, dias);
+    float *matriz = malloc(sizeof(float) * (size_t)num * dias);
+    int *inicio = malloc(sizeof(int) * (size_t)num);
+    EstadoIndicadores *lote = malloc(sizeof(EstadoIndicadores) * (size_t)num);
+    EstadoIndicadores *incr = calloc((size_t)num, sizeof(EstadoIndicadores));
+    if (!matriz || !inicio || !lote || !incr) {
+        free(matriz); free(inicio); free(lote); free(incr);
+        printf("Memória insuficiente.\n");
+        return;
+    }
+    unsigned semente = 8080u;
+    for (int i = 0; i < num; ++i) inicio[i] = (i % 10 == 0) ? (int)(semente % 2000) + i % 7 : 0;   // 10% listados depois
+    for (int i = 0; i < num; ++i) matriz[i] = 10.0f + (float)(i % 50);
+    for (int d = 1; d < dias; ++d)
+        for (int i = 0; i < num; ++i) {
+            aleatorio(&semente);
+            float ant = matriz[(size_t)(d - 1) * num + i];
+            float passo = ((float)((semente >> 8) % 201) - 100.0f) / 5000.0f;   // até ±2% ao dia
+            matriz[(size_t)d * num + i] = ant * (1.0f + passo) > 0.5f ? ant * (1.0f + passo) : 0.5f;
+        }
+    const ParametrosIndicadores p = { 50, 21, 14, 20, 2.0f };
+
+    double t0 = cronometro_seg();
+    indicadoresLote(matriz, inicio, num, dias, &p, lote);
+    double dLote = cronometro_seg() - t0;
+
+    t0 = cronometro_seg();
+    long long atualizacoes = 0;
+    for (int d = 0; d < dias; ++d)
+        for (int i = 0; i < num; ++i)
+            if (d >= inicio[i]) { indicadoresAtualizar(&incr[i], &p, matriz[(size_t)d * num + i]); atualizacoes++; }
+    double dIncr = cronometro_seg() - t0;
+
+    double maiorDif = 0.0;
+    for (int i = 0; i < num; ++i) {
+        Indicadores a, b;
+        indicadoresValores(&lote[i], &p, &a);
+        indicadoresValores(&incr[i], &p, &b);
+        double difs[5] = { a.sma - b.sma, a.ema - b.ema, a.rsi - b.rsi, a.bandaInf - b.bandaInf, a.bandaSup - b.bandaSup };
+        for (int k = 0; k < 5; ++k) if (fabs(difs[k]) > maiorDif) maiorDif = fabs(difs[k]);
+    }
+    /* o estado do lote segue incremental: mais um fechamento em ambos */
+    for (int i = 0; i < num; ++i) {
+        indicadoresAtualizar(&lote[i], &p, matriz[(size_t)(dias - 1) * num + i] * 1.01f);
+        indicadoresAtualizar(&incr[i], &p, matriz[(size_t)(dias - 1) * num + i] * 1.01f);
+    }
+    for (int i = 0; i < num; ++i) {
+        Indicadores a, b;
+        indicadoresValores(&lote[i], &p, &a);
+        indicadoresValores(&incr[i], &p, &b);
+        if (fabs(a.sma - b.sma) > maiorDif) maiorDif = fabs(a.sma - b.sma);
+        if (fabs(a.bandaSup - b.bandaSup) > maiorDif) maiorDif = fabs(a.bandaSup - b.bandaSup);
+    }
+    printf("Lote: %.1f ms (%.2f ns por fechamento) | Incremental: %.2f ns por atualização\n",
+           dLote * 1e3, dLote / ((double)num * dias) * 1e9, dIncr / atualizacoes * 1e9);
+    Indicadores v;
+    indicadoresValores(&lote[1], &p, &v);
+    printf("Ativo 2: SMA %.2f | EMA %.2f | RSI %.1f | Bollinger [%.2f, %.2f] | maior diferença lote x incremental: %.2g\n",
+           v.sma, v.ema, v.rsi, v.bandaInf, v.bandaSup, maiorDif);
+    free(matriz); free(inicio); free(lote); free(incr);
+}
@@ -0,0 +1,113 @@
+#include "corretora.h"
+
+/* ======= Liquidação de TED: compensação multilateral ======= */
+
+/*
+ * Liquida todos os TEDs da fila em um único lote. Cada transferência só
+ * acumula no saldo líquido dos participantes; depois cada participante recebe
+ * uma única atualização de saldo e um único lançamento no extrato.
+ * Retorna o número de participantes atualizados.
+ */
+int liquidarLoteTED(FilaTED *f, Usuario **book) {
+    if (f->num == 0) return 0;
+
+    /* acumuladores por id de usuário (double para não perder centavos em lotes grandes) */
+    int maxId = 0;
+    for (int i = 0; i < f->num; ++i) {
+        if (f->itens[i].origem > maxId) maxId = f->itens[i].origem;
+        if (f->itens[i].destino > maxId) maxId = f->itens[i].destino;
+    }
+    int n = maxId + 1;
+    double *liquido = calloc(n, sizeof(double));
+    double *enviado = calloc(n, sizeof(double));
+    double *taxas = calloc(n, sizeof(double));
+    int *participantes = malloc(sizeof(int) * n);
+    unsigned char *marcado = calloc(n, 1);
+    if (!liquido || !enviado || !taxas || !participantes || !marcado) {
+        free(liquido); free(enviado); free(taxas); free(participantes); free(marcado);
+        return -1;
+    }
+
+    int numPart = 0;
+    for (int i = 0; i < f->num; ++i) {
+        TransferenciaTED *t = &f->itens[i];
+        liquido[t->origem] -= t->valor;
+        enviado[t->origem] += t->valor;
+        liquido[t->destino] += t->valor - t->taxa;
+        taxas[t->destino] += t->taxa;
+        if (!marcado[t->origem]) { marcado[t->origem] = 1; participantes[numPart++] = t->origem; }
+        if (!marcado[t->destino]) { marcado[t->destino] = 1; participantes[numPart++] = t->destino; }
+    }
+
+    f->numLote++;
+    for (int i = 0; i < numPart; ++i) {
+        int id = participantes[i];
+        Usuario *u = book[id];
+        u->banco.saldo += (float)liquido[id];
+        u->banco.tedPendente -= (float)enviado[id];
+        if (u->banco.tedPendente < 0.005f) u->banco.tedPendente = 0.0f;
+        char desc[80];
+        snprintf(desc, sizeof(desc), "Lote TED #%d (líquido) R$ %.2f", f->numLote, liquido[id]);
+        registrarTransacaoBanco(u, "TED", desc, (float)liquido[id], (float)taxas[id]);
+    }
+
+    f->num = 0;
+    free(liquido); free(enviado); free(taxas); free(participantes); free(marcado);
+    return numPart;
+}
+
+/* liquida a fila se já passou o intervalo desde o último lote */
+void liquidarTEDSeVencido(void) {
+    time_t agora = (time_t)relogio_seg();
+    if (filaTED.ultimaLiquidacao == 0 || agora < filaTED.ultimaLiquidacao) filaTED.ultimaLiquidacao = agora;   // relógio virtual pode voltar
+    if (filaTED.num > 0 && agora - filaTED.ultimaLiquidacao >= INTERVALO_LIQUIDACAO_TED) {
+        liquidarLoteTED(&filaTED, usuarios);
+        filaTED.ultimaLiquidacao = agora;
+    }
+}
+
+/* mede a liquidação de 1M TEDs entre participantes sintéticos (não toca no cadastro real) */
+void benchmarkLiquidacaoTED(void) {
+    const int numPart = 1000;
+    const int numTed = 1000000;
+    printf("\n=== Benchmark: liquidação de %d TEDs entre %d participantes ===\n", numTed, numPart);
+
+    Usuario **book = malloc(sizeof(Usuario *) * numPart);
+    if (!book) { printf("Memória insuficiente.\n"); return; }
+    for (int i = 0; i < numPart; ++i) {
+        book[i] = calloc(1, sizeof(Usuario));
+        if (!book[i]) { printf("Memória insuficiente.\n"); while (i--) free(book[i]); free(book); return; }
+        book[i]->id = i;
+        book[i]->efemero = true;
+        snprintf(book[i]->cpf, sizeof(book[i]->cpf), "%011d", i);
+        book[i]->banco.saldo = 1000000.0f;
+    }
+
+    FilaTED fila = { NULL, 0, 0, 0, 0 };
+    unsigned int semente = 12345u;
+    double t0 = cronometro_seg();
+    for (int i = 0; i < numTed; ++i) {
+        aleatorio(&semente);
+        int o = (int)((semente >> 8) % (unsigned)numPart);
+        aleatorio(&semente);
+        int d = (int)((semente >> 8) % (unsigned)(numPart - 1));
+        if (d >= o) d++;
+        agendarTED(&fila, book[o], book[d], (float)(1 + (semente >> 20) % 500));
+    }
+    double t1 = cronometro_seg();
+    int atualizados = liquidarLoteTED(&fila, book);
+    double t2 = cronometro_seg();
+
+    double total = 0.0;
+    for (int i = 0; i < numPart; ++i) total += book[i]->banco.saldo;
+    printf("Enfileiramento: %.3f s (%.0f TED/s)\n", t1 - t0, numTed / (t1 - t0));
+    printf("Liquidação:     %.3f s (%.0f TED/s) | %d atualizações de saldo\n",
+           t2 - t1, numTed / (t2 - t1), atualizados);
+    printf("Saldo total após lote: R$ %.2f (taxas retidas: R$ %.2f)\n",
+           total, 1000000.0 * numPart - total);
+
+    sincronizarExtrato(&filaExtrato);
+    for (int i = 0; i < numPart; ++i) liberarUsuario(book[i]);
+    free(book);
+    free(fila.itens);
+}
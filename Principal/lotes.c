@@ -0,0 +1,115 @@
+#include "corretora.h"
+
+/* ======= Lotes de compra (FIFO) ======= */
+
+/*
+ * Cada posição guarda seus lotes abertos num anel. Compra anexa no fim;
+ * venda consome primeiro os lotes do mesmo dia a partir do fim (day trade:
+ * compra e venda no mesmo pregão) e o restante do início, na ordem FIFO.
+ * Cada lote entra e sai uma vez, então o custo é O(1) amortizado; o anel
+ * encolhe à metade quando fica com menos de 1/4 ocupado.
+ */
+
+static bool lotesRedimensionar(FilaLotes *f, int novaCap) {
+    Lote *n = malloc(sizeof(Lote) * (size_t)novaCap);
+    if (!n) return false;
+    for (int i = 0; i < f->num; ++i) n[i] = f->itens[(f->cabeca + i) & (f->cap - 1)];
+    free(f->itens);
+    f->itens = n;
+    f->cap = novaCap;
+    f->cabeca = 0;
+    return true;
+}
+
+bool lotesAnexar(FilaLotes *f, long long ts, int quantidade, float preco) {
+    if (quantidade <= 0) return true;
+    if (f->num == f->cap && !lotesRedimensionar(f, f->cap ? f->cap * 2 : 4)) return false;
+    Lote *l = &f->itens[(f->cabeca + f->num) & (f->cap - 1)];
+    l->ts = ts;
+    l->quantidade = quantidade;
+    l->preco = preco;
+    f->num++;
+    return true;
+}
+
+long long diaLocal(long long ts, long long fuso) {
+    long long t = ts + fuso;
+    return t >= 0 ? t / 86400 : (t - 86399) / 86400;
+}
+
+void lotesConsumir(FilaLotes *f, int quantidade, long long tsVenda, ConsumoLotes *out) {
+    memset(out, 0, sizeof(*out));
+    long long fuso = fusoProcesso(), dia = diaLocal(tsVenda, fuso);
+    /* day trade: lotes de hoje, do mais novo para o mais antigo */
+    while (quantidade > 0 && f->num > 0) {
+        Lote *l = &f->itens[(f->cabeca + f->num - 1) & (f->cap - 1)];
+        if (diaLocal(l->ts, fuso) != dia) break;
+        int q = l->quantidade < quantidade ? l->quantidade : quantidade;
+        out->qtdDayTrade += q;
+        out->custoDayTrade += (double)q * l->preco;
+        quantidade -= q;
+        if ((l->quantidade -= q) == 0) f->num--;
+    }
+    /* comum: FIFO a partir do lote mais antigo */
+    while (quantidade > 0 && f->num > 0) {
+        Lote *l = &f->itens[f->cabeca];
+        int q = l->quantidade < quantidade ? l->quantidade : quantidade;
+        out->qtdComum += q;
+        out->custoComum += (double)q * l->preco;
+        quantidade -= q;
+        if ((l->quantidade -= q) == 0) { f->cabeca = (f->cabeca + 1) & (f->cap - 1); f->num--; }
+    }
+    if (f->num == 0) lotesLiberar(f);
+    else if (f->cap > 16 && f->num < f->cap / 4) lotesRedimensionar(f, f->cap / 2);
+}
+
+void lotesLiberar(FilaLotes *f) {
+    free(f->itens);
+    memset(f, 0, sizeof(*f));
+}
+
+/* robô de preço médio: 100k compras de 1 cota, depois vendas de 7 em 7 até zerar */
+void benchmarkLotes(void) {
+    const int compras = 100000;
+    printf("\n=== Benchmark de lotes FIFO (%d compras pequenas) ===\n", compras);
+    FilaLotes f;
+    memset(&f, 0, sizeof(f));
+    long long ts0 = 1704067200LL;
+    double custoTotal = 0.0;
+    double t0 = cronometro_seg();
+    for (int i = 0; i < compras; ++i) {
+        float preco = 10.0f + (float)(i % 500) / 100.0f;
+        if (!lotesAnexar(&f, ts0 + (long long)i * 3600, 1, preco)) { printf("Memória insuficiente.\n"); lotesLiberar(&f); return; }
+        custoTotal += preco;
+    }
+    double d = cronometro_seg() - t0;
+    printf("Compras: %.1f ns por lote | %d lotes em %.1f KB\n", d / compras * 1e9, f.num, f.cap * sizeof(Lote) / 1024.0);
+
+    /* primeiras vendas devem custar o preço dos lotes mais antigos */
+    ConsumoLotes c;
+    double custoVendido = 0.0, esperadoPrimeira = 0.0;
+    for (int i = 0; i < 7; ++i) esperadoPrimeira += 10.0f + (float)(i % 500) / 100.0f;
+    long long tsVenda = ts0 + (long long)compras * 3600 + 86400 * 2;   // dia sem compras: tudo comum
+    int vendas = 0, capMaxima = f.cap;
+    bool fifoOk = true;
+    t0 = cronometro_seg();
+    while (f.num > 0) {
+        lotesConsumir(&f, 7, tsVenda, &c);
+        if (vendas == 0 && (c.custoComum - esperadoPrimeira > 1e-3 || esperadoPrimeira - c.custoComum > 1e-3)) fifoOk = false;
+        if (c.qtdDayTrade != 0) fifoOk = false;
+        custoVendido += c.custoComum;
+        vendas++;
+    }
+    d = cronometro_seg() - t0;
+    printf("Vendas: %.1f ns por venda de 7 cotas (%d vendas) | anel: %d -> %d lotes de capacidade\n",
+           d / vendas * 1e9, vendas, capMaxima, f.cap);
+    printf("Custo consumido R$ %.2f de R$ %.2f | ordem FIFO %s\n", custoVendido, custoTotal, fifoOk ? "OK" : "INCORRETA");
+
+    /* day trade: compra e venda no mesmo dia saem dos lotes de hoje */
+    lotesAnexar(&f, ts0, 10, 20.0f);
+    lotesAnexar(&f, tsVenda, 5, 30.0f);
+    lotesConsumir(&f, 8, tsVenda, &c);
+    printf("Day trade: %d cotas a R$ %.2f | comum: %d cotas a R$ %.2f (esperado 5 a 150.00 e 3 a 60.00)\n",
+           c.qtdDayTrade, c.custoDayTrade, c.qtdComum, c.custoComum);
+    lotesLiberar(&f);
+}
@@ -0,0 +1,396 @@
+#include "corretora.h"
+
+/* ======= Projeção Monte Carlo ======= */
+
+/*
+ * Os números aleatórios vêm do Philox4x32-10 indexado por (caminho, mês,
+ * chamada): cada caminho tem sempre os mesmos sorteios, qualquer que seja
+ * a divisão entre threads ou o uso de SIMD, e a projeção é reproduzível
+ * pela semente. Cada chamada dá 4 sorteios; o primeiro do mês é o fator
+ * de mercado. A normal vem de uma tabela da inversa interpolada (caudas
+ * cortadas em ~4 desvios). 8 caminhos andam juntos, um por lane AVX2.
+ */
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+static float tabelaNormal[TAM_TABELA_NORMAL + 1], inclinacaoNormal[TAM_TABELA_NORMAL];
+static bool tabelaNormalPronta = false;
+
+/* inversa da normal padrão (aproximação racional de Acklam, erro ~1e-9) */
+double normalInversa(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    if (p < 0.02425) {
+        double q = sqrt(-2.0 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - 0.02425) return -normalInversa(1.0 - p);
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+static void prepararTabelaNormal(void) {
+    if (tabelaNormalPronta) return;
+    for (int i = 0; i <= TAM_TABELA_NORMAL; ++i) {
+        double u = (double)i / TAM_TABELA_NORMAL;
+        if (u < 1.0 / (64.0 * TAM_TABELA_NORMAL)) u = 1.0 / (64.0 * TAM_TABELA_NORMAL);
+        if (u > 1.0 - 1.0 / (64.0 * TAM_TABELA_NORMAL)) u = 1.0 - 1.0 / (64.0 * TAM_TABELA_NORMAL);
+        tabelaNormal[i] = (float)normalInversa(u);
+    }
+    for (int i = 0; i < TAM_TABELA_NORMAL; ++i) inclinacaoNormal[i] = tabelaNormal[i + 1] - tabelaNormal[i];
+    tabelaNormalPronta = true;
+}
+
+static inline void philox4x32(uint32_t c[4], uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; ++r) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c[0], p1 = (uint64_t)PHILOX_M1 * c[2];
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k0, n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k1;
+        c[1] = (uint32_t)p1; c[3] = (uint32_t)p0; c[0] = n0; c[2] = n2;
+        k0 += PHILOX_W0; k1 += PHILOX_W1;
+    }
+}
+
+static inline float normalDeU32(uint32_t w) {
+    uint32_t i = w >> 22;
+    return tabelaNormal[i] + (float)(w & 0x3FFFFFu) * (1.0f / 4194304.0f) * inclinacaoNormal[i];
+}
+
+/* e^r por Taylor de grau 5 em r/4, elevado à 4ª (r mensal é pequeno) */
+static inline float expMensal(float r) {
+    float y = r * 0.25f;
+    float q = 1.0f + y * (1.0f + y * (0.5f + y * (1.0f / 6.0f + y * (1.0f / 24.0f + y * (1.0f / 120.0f)))));
+    q = q * q;
+    return q * q;
+}
+
+/* LANES_MONTE_CARLO caminhos a partir de 'caminho': patrimônio final e proventos pagos */
+static void monteCarloBlocoEscalar(const ParametrosMonteCarlo *p, uint32_t caminho, double *patrimonio, double *renda) {
+    float q[MAX_ATIVOS][LANES_MONTE_CARLO], pr[MAX_ATIVOS][LANES_MONTE_CARLO];
+    float caixa[LANES_MONTE_CARLO], pago[LANES_MONTE_CARLO];
+    for (int l = 0; l < LANES_MONTE_CARLO; ++l) {
+        caixa[l] = p->caixa; pago[l] = 0.0f;
+        for (int i = 0; i < p->k; ++i) { q[i][l] = p->quantidade[i]; pr[i][l] = p->preco[i]; }
+    }
+    int chamadas = (p->k + 4) / 4;
+    for (int m = 1; m <= p->meses; ++m) {
+        for (int l = 0; l < LANES_MONTE_CARLO; ++l) {
+            float zM = 0.0f;
+            for (int c = 0; c < chamadas; ++c) {
+                uint32_t w[4] = { caminho + (uint32_t)l, (uint32_t)m, (uint32_t)c, 0 };
+                philox4x32(w, p->semente, 0x5EEDu);
+                for (int s = 0; s < 4; ++s) {
+                    int i = 4 * c + s - 1;
+                    float z = normalDeU32(w[s]);
+                    if (i < 0) { zM = z; continue; }
+                    if (i >= p->k) break;
+                    pr[i][l] *= expMensal(p->deriva[i] + p->volMercado[i] * zM + p->volProprio[i] * z);
+                }
+            }
+        }
+        for (int i = 0; i < p->k; ++i) {
+            if (p->mesesPorPagamento[i] <= 0 || m % p->mesesPorPagamento[i] != 0) continue;
+            for (int l = 0; l < LANES_MONTE_CARLO; ++l) {
+                float provento = q[i][l] * pr[i][l] * p->rendimento[i];
+                pago[l] += provento;
+                if (p->reinvestir) q[i][l] += q[i][l] * p->rendimento[i];
+                else caixa[l] += provento;
+            }
+        }
+    }
+    for (int l = 0; l < LANES_MONTE_CARLO; ++l) {
+        double total = caixa[l];
+        for (int i = 0; i < p->k; ++i) total += (double)q[i][l] * pr[i][l];
+        patrimonio[l] = total;
+        renda[l] = pago[l];
+    }
+}
+
+#ifdef USAR_SIMD_X86
+__attribute__((target("avx2")))
+static inline __m256i mulhiAvx2(__m256i a, __m256i m) {
+    __m256i par = _mm256_srli_epi64(_mm256_mul_epu32(a, m), 32);
+    __m256i impar = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    return _mm256_blend_epi32(par, impar, 0xAA);
+}
+
+__attribute__((target("avx2")))
+static inline __m256 normalAvx2(__m256i w) {
+    __m256i i = _mm256_srli_epi32(w, 22);
+    __m256 f = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(w, _mm256_set1_epi32(0x3FFFFF))), _mm256_set1_ps(1.0f / 4194304.0f));
+    return _mm256_add_ps(_mm256_i32gather_ps(tabelaNormal, i, 4), _mm256_mul_ps(f, _mm256_i32gather_ps(inclinacaoNormal, i, 4)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256 expMensalAvx2(__m256 r) {
+    __m256 y = _mm256_mul_ps(r, _mm256_set1_ps(0.25f));
+    __m256 q = _mm256_add_ps(_mm256_set1_ps(1.0f / 24.0f), _mm256_mul_ps(y, _mm256_set1_ps(1.0f / 120.0f)));
+    q = _mm256_add_ps(_mm256_set1_ps(1.0f / 6.0f), _mm256_mul_ps(y, q));
+    q = _mm256_add_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(y, q));
+    q = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(y, q));
+    q = _mm256_add_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(y, q));
+    q = _mm256_mul_ps(q, q);
+    return _mm256_mul_ps(q, q);
+}
+
+/* o mesmo bloco com as 8 lanes em registradores AVX2 (mesmas operações, sem FMA) */
+__attribute__((target("avx2")))
+static void monteCarloBlocoAvx2(const ParametrosMonteCarlo *p, uint32_t caminho, double *patrimonio, double *renda) {
+    __m256 q[MAX_ATIVOS], pr[MAX_ATIVOS];
+    __m256 caixa = _mm256_set1_ps(p->caixa), pago = _mm256_setzero_ps();
+    for (int i = 0; i < p->k; ++i) { q[i] = _mm256_set1_ps(p->quantidade[i]); pr[i] = _mm256_set1_ps(p->preco[i]); }
+    const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32((int)caminho), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i m0 = _mm256_set1_epi32((int)PHILOX_M0), m1 = _mm256_set1_epi32((int)PHILOX_M1);
+    int chamadas = (p->k + 4) / 4;
+    for (int m = 1; m <= p->meses; ++m) {
+        __m256 zM = _mm256_setzero_ps();
+        for (int c = 0; c < chamadas; ++c) {
+            __m256i w0 = lanes, w1 = _mm256_set1_epi32(m), w2 = _mm256_set1_epi32(c), w3 = _mm256_setzero_si256();
+            uint32_t k0 = p->semente, k1 = 0x5EEDu;
+            for (int r = 0; r < 10; ++r) {
+                __m256i h0 = mulhiAvx2(w0, m0), l0 = _mm256_mullo_epi32(w0, m0);
+                __m256i h1 = mulhiAvx2(w2, m1), l1 = _mm256_mullo_epi32(w2, m1);
+                w0 = _mm256_xor_si256(_mm256_xor_si256(h1, w1), _mm256_set1_epi32((int)k0));
+                w2 = _mm256_xor_si256(_mm256_xor_si256(h0, w3), _mm256_set1_epi32((int)k1));
+                w1 = l1; w3 = l0;
+                k0 += PHILOX_W0; k1 += PHILOX_W1;
+            }
+            __m256i w[4] = { w0, w1, w2, w3 };
+            for (int s = 0; s < 4; ++s) {
+                int i = 4 * c + s - 1;
+                __m256 z = normalAvx2(w[s]);
+                if (i < 0) { zM = z; continue; }
+                if (i >= p->k) break;
+                __m256 choque = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(p->deriva[i]), _mm256_mul_ps(_mm256_set1_ps(p->volMercado[i]), zM)),
+                                              _mm256_mul_ps(_mm256_set1_ps(p->volProprio[i]), z));
+                pr[i] = _mm256_mul_ps(pr[i], expMensalAvx2(choque));
+            }
+        }
+        for (int i = 0; i < p->k; ++i) {
+            if (p->mesesPorPagamento[i] <= 0 || m % p->mesesPorPagamento[i] != 0) continue;
+            __m256 rend = _mm256_set1_ps(p->rendimento[i]);
+            __m256 provento = _mm256_mul_ps(_mm256_mul_ps(q[i], pr[i]), rend);
+            pago = _mm256_add_ps(pago, provento);
+            if (p->reinvestir) q[i] = _mm256_add_ps(q[i], _mm256_mul_ps(q[i], rend));
+            else caixa = _mm256_add_ps(caixa, provento);
+        }
+    }
+    float fc[8], fp[8], fq[8], fr[8];
+    _mm256_storeu_ps(fc, caixa);
+    _mm256_storeu_ps(fp, pago);
+    for (int l = 0; l < LANES_MONTE_CARLO; ++l) { patrimonio[l] = fc[l]; renda[l] = fp[l]; }
+    for (int i = 0; i < p->k; ++i) {
+        _mm256_storeu_ps(fq, q[i]);
+        _mm256_storeu_ps(fr, pr[i]);
+        for (int l = 0; l < LANES_MONTE_CARLO; ++l) patrimonio[l] += (double)fq[l] * fr[l];
+    }
+}
+#endif
+
+typedef struct {
+    const ParametrosMonteCarlo *p;
+    bool simd;
+    atomic_int proximo;                   // próximo bloco de BLOCO_MONTE_CARLO caminhos
+    double *patrimonio, *renda;
+} TrabalhoMonteCarlo;
+
+static void *threadMonteCarlo(void *arg) {
+    TrabalhoMonteCarlo *tm = arg;
+    const ParametrosMonteCarlo *p = tm->p;
+    double pat[LANES_MONTE_CARLO], ren[LANES_MONTE_CARLO];
+    for (;;) {
+        int ini = atomic_fetch_add_explicit(&tm->proximo, BLOCO_MONTE_CARLO, memory_order_relaxed);
+        if (ini >= p->caminhos) break;
+        for (int c = ini; c < ini + BLOCO_MONTE_CARLO && c < p->caminhos; c += LANES_MONTE_CARLO) {
+#ifdef USAR_SIMD_X86
+            if (tm->simd) monteCarloBlocoAvx2(p, (uint32_t)c, pat, ren);
+            else
+#endif
+            monteCarloBlocoEscalar(p, (uint32_t)c, pat, ren);
+            for (int l = 0; l < LANES_MONTE_CARLO && c + l < p->caminhos; ++l) {
+                tm->patrimonio[c + l] = pat[l];
+                tm->renda[c + l] = ren[l];
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Simula p->caminhos caminhos em 'numThreads' workers; patrimonio[c] e
+ * renda[c] recebem o valor final e os proventos pagos no caminho c.
+ * 'usarSimd' pede o kernel AVX2 (só se a CPU tiver).
+ */
+bool monteCarloProjetar(const ParametrosMonteCarlo *p, int numThreads, bool usarSimd, double *patrimonio, double *renda) {
+    prepararTabelaNormal();
+    TrabalhoMonteCarlo *tm = calloc(1, sizeof(TrabalhoMonteCarlo));
+    if (!tm) return false;
+    tm->p = p;
+    tm->patrimonio = patrimonio;
+    tm->renda = renda;
+#ifdef USAR_SIMD_X86
+    if (avx2Disponivel < 0) avx2Disponivel = __builtin_cpu_supports("avx2") ? 1 : 0;
+    tm->simd = usarSimd && avx2Disponivel;
+#else
+    (void)usarSimd;
+#endif
+    if (numThreads > THREADS_MONTE_CARLO) numThreads = THREADS_MONTE_CARLO;
+    Thread th[THREADS_MONTE_CARLO];
+    int criadas = 0;
+    for (int i = 1; i < numThreads; ++i)
+        if (thread_criar(&th[criadas], threadMonteCarlo, tm)) criadas++;
+    threadMonteCarlo(tm);                 // a thread chamadora também trabalha
+    for (int i = 0; i < criadas; ++i) thread_aguardar(th[i]);
+    free(tm);
+    return true;
+}
+
+/*
+ * Parâmetros a partir da carteira do usuário. Retorno e volatilidade vêm
+ * da covariância das posições (riscoDosAtivos) quando há ao menos 60
+ * pregões; senão, premissas por classe (ação/BDR/ETF 8% a.a. e 25% de
+ * volatilidade, FII 2% a.a. e 15%). Correlação de 0,6 com o mercado.
+ */
+bool monteCarloDaCarteira(Usuario *u, int anos, int caminhos, bool reinvestir, ParametrosMonteCarlo *p) {
+    memset(p, 0, sizeof(*p));
+    p->meses = anos * 12;
+    p->caminhos = caminhos;
+    p->reinvestir = reinvestir;
+    p->semente = 20240601u;
+    p->caixa = u->investimento.saldo;
+    int ativos[MAX_ATIVOS], posicao[MAX_ATIVOS], n = 0;
+    for (int i = 0; i < u->investimento.numAtivos; ++i) {
+        const AtivoCarteira *c = &u->investimento.carteira[i];
+        int j = indiceCatalogo(c->ticker);
+        if (j < 0 || c->quantidade <= 0 || ativosDisponiveis[j].preco <= 0.0f) continue;
+        ativos[n] = j;
+        posicao[n++] = i;
+    }
+    RiscoMercado r = { .dia = -1 };
+    bool comHistorico = n > 0 && riscoDosAtivos(&r, ativos, n) == 0 && r.dias >= 60;
+    const float beta = 0.6f, residual = 0.8f;                        // sqrt(1 - 0,6²)
+    for (int m = 0; m < n; ++m) {
+        const AtivoCarteira *c = &u->investimento.carteira[posicao[m]];
+        const AtivoRV *a = &ativosDisponiveis[ativos[m]];
+        double mu, sigma;
+        if (comHistorico) {
+            mu = r.media[m] * 21.0;
+            sigma = sqrt(r.cov[(size_t)m * r.numAtivos + m] * 21.0);
+        } else {
+            mu = a->classe == CLASSE_FII ? 0.02 / 12 : 0.08 / 12;
+            sigma = (a->classe == CLASSE_FII ? 0.15 : 0.25) / sqrt(12.0);
+        }
+        int k = p->k++;
+        p->quantidade[k] = (float)c->quantidade;
+        p->preco[k] = a->preco;
+        p->deriva[k] = (float)(mu - 0.5 * sigma * sigma);
+        p->volMercado[k] = (float)sigma * beta;
+        p->volProprio[k] = (float)sigma * residual;
+        p->rendimento[k] = a->dividend_per_period / a->preco;
+        p->mesesPorPagamento[k] = a->periods_per_year > 0 ? 12 / a->periods_per_year : 0;
+    }
+    riscoMercadoLiberar(&r);
+    return p->k > 0;
+}
+
+static void imprimirFaixas(const char *titulo, double *v, int n) {
+    static const double pct[] = { 0.05, 0.25, 0.50, 0.75, 0.95 };
+    printf("%-22s", titulo);
+    for (int i = 0; i < 5; ++i) printf(" | P%-2d R$ %12.2f", (int)(pct[i] * 100 + 0.5), selecionarK(v, n, (int)(pct[i] * (n - 1))));
+    printf("\n");
+}
+
+void menuMonteCarlo(Usuario *u) {
+    int anos, caminhos;
+    char resp[8];
+    printf("\nHorizonte em anos (1 a 50): ");
+    if (scanf("%d", &anos) != 1 || anos < 1 || anos > 50) { clear_input(); printf("Entrada inválida.\n"); return; }
+    printf("Número de caminhos (1000 a 1000000): ");
+    if (scanf("%d", &caminhos) != 1 || caminhos < 1000 || caminhos > 1000000) { clear_input(); printf("Entrada inválida.\n"); return; }
+    printf("Reinvestir proventos? (s/n): ");
+    if (scanf("%7s", resp) != 1) { clear_input(); printf("Entrada inválida.\n"); return; }
+    ParametrosMonteCarlo p;
+    if (!monteCarloDaCarteira(u, anos, caminhos, resp[0] == 's' || resp[0] == 'S', &p)) {
+        printf("Carteira sem posições com preço.\n");
+        return;
+    }
+    double *patrimonio = malloc(sizeof(double) * (size_t)caminhos), *renda = malloc(sizeof(double) * (size_t)caminhos);
+    if (!patrimonio || !renda) { free(patrimonio); free(renda); printf("Memória insuficiente.\n"); return; }
+    double t0 = cronometro_seg();
+    monteCarloProjetar(&p, THREADS_MONTE_CARLO, true, patrimonio, renda);
+    double dt = cronometro_seg() - t0;
+    printf("\n=== Projeção Monte Carlo: %d caminhos x %d anos, %d ativos, proventos %s ===\n",
+           caminhos, anos, p.k, p.reinvestir ? "reinvestidos" : "em caixa");
+    imprimirFaixas("Patrimônio final", patrimonio, caminhos);
+    imprimirFaixas("Proventos no período", renda, caminhos);
+    printf("(simulação em %.2f s; valores nominais)\n", dt);
+    free(patrimonio);
+    free(renda);
+}
+
+/*
+ * 100k caminhos x 30 anos x 20 ativos: tempo com 1..8 threads e no
+ * escalar; confere que o resultado não depende da divisão entre threads e
+ * que AVX2 e escalar coincidem.
+ */
+void benchmarkMonteCarlo(void) {
+    const int caminhos = 100000, anos = 30;
+    ParametrosMonteCarlo p;
+    memset(&p, 0, sizeof(p));
+    p.k = 20; p.meses = anos * 12; p.caminhos = caminhos; p.reinvestir = true; p.semente = 777u; p.caixa = 1000.0f;
+    for (int i = 0; i < p.k; ++i) {
+        double sigma = (0.15 + 0.01 * i) / sqrt(12.0);
+        p.quantidade[i] = 100.0f + 10.0f * i;
+        p.preco[i] = 10.0f + 3.0f * i;
+        p.deriva[i] = (float)(0.07 / 12 - 0.5 * sigma * sigma);
+        p.volMercado[i] = (float)(sigma * 0.6);
+        p.volProprio[i] = (float)(sigma * 0.8);
+        p.rendimento[i] = i % 2 ? 0.008f : 0.015f;
+        p.mesesPorPagamento[i] = i % 2 ? 1 : 6;
+    }
+    printf("\n=== Benchmark Monte Carlo (%d caminhos x %d anos x %d ativos) ===\n", caminhos, anos, p.k);
+    double *pat = malloc(sizeof(double) * (size_t)caminhos * 2), *ren = malloc(sizeof(double) * (size_t)caminhos * 2);
+    if (!pat || !ren) { free(pat); free(ren); printf("Memória insuficiente.\n"); return; }
+    double *patRef = pat + caminhos, *renRef = ren + caminhos;
+    double t0 = cronometro_seg();
+    monteCarloProjetar(&p, 1, true, patRef, renRef);
+    double dUm = cronometro_seg() - t0;
+    printf("1 thread: %.2f s (%.1f ns por ativo-mês)\n", dUm, dUm / ((double)caminhos * p.meses * p.k) * 1e9);
+    long long divergentes = 0;
+    for (int th = 2; th <= THREADS_MONTE_CARLO; th *= 2) {
+        t0 = cronometro_seg();
+        monteCarloProjetar(&p, th, true, pat, ren);
+        double dt = cronometro_seg() - t0;
+        for (int c = 0; c < caminhos; ++c) divergentes += pat[c] != patRef[c] || ren[c] != renRef[c];
+        printf("%d threads: %.2f s\n", th, dt);
+    }
+    const int escalar = caminhos / 10;
+    ParametrosMonteCarlo pe = p;
+    pe.caminhos = escalar;
+    t0 = cronometro_seg();
+    monteCarloProjetar(&pe, 1, false, pat, ren);
+    double dEsc = cronometro_seg() - t0;
+    double difMax = 0.0;
+    for (int c = 0; c < escalar; ++c) {
+        double d = fabs(pat[c] - patRef[c]) / patRef[c];
+        if (d > difMax) difMax = d;
+    }
+    printf("Escalar, 1 thread: %.2f s para %d caminhos (%.1f ns por ativo-mês)\n", dEsc, escalar,
+           dEsc / ((double)escalar * p.meses * p.k) * 1e9);
+    printf("Conferência: %lld caminho(s) diferente(s) entre divisões de threads | AVX2 x escalar: diferença relativa máx. %.1e\n",
+           divergentes, difMax);
+    imprimirFaixas("Patrimônio final", patRef, caminhos);
+    imprimirFaixas("Proventos no período", renRef, caminhos);
+    free(pat);
+    free(ren);
+}
@@ -0,0 +1,315 @@
+#include "corretora.h"
+
+/* ======= Relatório mensal (fluxo de caixa e resultado) ======= */
+
+/*
+ * Uma passada pelo extrato consolidado de cada usuário (intercalador k-way,
+ * já em ordem de tempo): cada lançamento vira um grupo pelo tipo e é somado
+ * em centavos no mês corrente. O grupo sai de uma comparação SSE2 dos 16
+ * primeiros bytes do tipo contra a tabela de nomes (escalar: desvio pela
+ * primeira letra e strcmp). O mês só é recalculado quando o ts passa do fim
+ * do mês atual. Usuários são distribuídos entre workers por um contador
+ * atômico.
+ */
+
+enum {
+    CAT_DEPOSITOS, CAT_TAXAS, CAT_TRANSF_ENVIADAS, CAT_TRANSF_RECEBIDAS, CAT_COMPRAS, CAT_VENDAS,
+    CAT_PROVENTOS, CAT_RESULTADO, NUM_CATEGORIAS
+};
+
+typedef struct {
+    int mes;                              // AAAAMM
+    long long cent[NUM_CATEGORIAS];
+} LinhaRelatorioMensal;
+
+typedef struct {
+    LinhaRelatorioMensal *linhas;
+    int num, cap;
+} RelatorioUsuario;
+
+typedef struct {
+    Usuario **lista;
+    int n;
+    RelatorioUsuario *saida;
+    atomic_int proximo;
+    atomic_llong lidas;
+    long long fuso;
+} TrabalhoRelatorio;
+
+/* movimentos internos entre as contas do próprio usuário ficam de fora (GRUPO_NENHUM) */
+int grupoDoTipoEscalar(const char *tipo) {
+    switch (tipo[0]) {
+        case 'D': return strcmp(tipo, "Depósito") == 0 ? GRUPO_DEPOSITO : GRUPO_NENHUM;
+        case 'C': return strcmp(tipo, "Compra") == 0 ? GRUPO_COMPRA : GRUPO_NENHUM;
+        case 'V': return strcmp(tipo, "Venda") == 0 ? GRUPO_VENDA : GRUPO_NENHUM;
+        case 'P':
+            if (strcmp(tipo, "PIX") == 0) return GRUPO_TRANSF;
+            return strcmp(tipo, "Provento") == 0 ? GRUPO_PROVENTO : GRUPO_NENHUM;
+        case 'T':
+            if (strcmp(tipo, "TED") == 0) return GRUPO_TRANSF;
+            return strcmp(tipo, "Transferência Ext") == 0 ? GRUPO_TRANSF : GRUPO_NENHUM;
+        default: return GRUPO_NENHUM;
+    }
+}
+
+#ifdef USAR_SIMD_X86
+/* nomes agrupados cortados em 16 bytes (completados com zeros) e o que passa disso */
+static const struct { const char *nome; int grupo; } nomesGrupo[] = {
+    { "Depósito", GRUPO_DEPOSITO }, { "Compra", GRUPO_COMPRA }, { "Venda", GRUPO_VENDA }, { "PIX", GRUPO_TRANSF },
+    { "Provento", GRUPO_PROVENTO }, { "TED", GRUPO_TRANSF }, { "Transferência Ext", GRUPO_TRANSF },
+};
+#define NUM_NOMES_GRUPO (int)(sizeof(nomesGrupo) / sizeof(nomesGrupo[0]))
+static char padroesGrupo[NUM_NOMES_GRUPO][16];
+int sse2Disponivel = -1;
+
+/* chamado antes de criar os workers */
+void iniciarGruposSimd(void) {
+    if (sse2Disponivel >= 0) return;
+    for (int k = 0; k < NUM_NOMES_GRUPO; ++k) strncpy(padroesGrupo[k], nomesGrupo[k].nome, 16);
+    sse2Disponivel = __builtin_cpu_supports("sse2") ? 1 : 0;
+}
+
+/* 'tipo' tem 32 bytes: a carga de 16 é sempre válida; compara só até o terminador */
+__attribute__((target("sse2")))
+int grupoDoTipoSse2(const char *tipo) {
+    __m128i x = _mm_loadu_si128((const __m128i *)tipo);
+    unsigned nul = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128()));
+    unsigned valido = nul ? ((nul & -nul) << 1) - 1 : 0xFFFFu;
+    for (int k = 0; k < NUM_NOMES_GRUPO; ++k) {
+        unsigned igual = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i *)padroesGrupo[k])));
+        if ((igual & valido) != valido) continue;
+        if (nul) return nomesGrupo[k].grupo;
+        /* sem terminador nos 16 bytes só casa nome de 16 ou mais: confere o resto */
+        return strcmp(tipo + 16, nomesGrupo[k].nome + 16) == 0 ? nomesGrupo[k].grupo : GRUPO_NENHUM;
+    }
+    return GRUPO_NENHUM;
+}
+#endif
+
+static bool relatorioUsarSimd = true;     // desligável para o benchmark comparar
+
+static int grupoDoTipo(const char *tipo) {
+#ifdef USAR_SIMD_X86
+    if (sse2Disponivel > 0 && relatorioUsarSimd) return grupoDoTipoSse2(tipo);
+#endif
+    return grupoDoTipoEscalar(tipo);
+}
+
+/* início do mês seguinte ao de 'ts' (horário local fixo no relatório) e o mês AAAAMM */
+static long long limiteDoMes(long long ts, long long fuso, int *mes) {
+    int ano, m, dia, hora, min, seg;
+    dataCivil(ts, fuso, &ano, &m, &dia, &hora, &min, &seg);
+    *mes = ano * 100 + m;
+    long long inicioDia = ts - (hora * 3600LL + min * 60 + seg);
+    static const int diasMes[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int dm = diasMes[m - 1] + (m == 2 && (ano % 4 == 0 && (ano % 100 != 0 || ano % 400 == 0)));
+    return inicioDia + (long long)(dm - dia + 1) * 86400;
+}
+
+static LinhaRelatorioMensal *novaLinhaMes(RelatorioUsuario *r, int mes) {
+    if (r->num == r->cap) {
+        int novaCap = r->cap ? r->cap * 2 : 16;
+        LinhaRelatorioMensal *n = realloc(r->linhas, sizeof(*n) * (size_t)novaCap);
+        if (!n) return NULL;
+        r->linhas = n; r->cap = novaCap;
+    }
+    LinhaRelatorioMensal *l = &r->linhas[r->num++];
+    memset(l, 0, sizeof(*l));
+    l->mes = mes;
+    return l;
+}
+
+static long long agregarUsuario(TrabalhoRelatorio *tr, Usuario *u, RelatorioUsuario *r) {
+    IntercaladorExtrato it;
+    intercaladorDoUsuario(&it, u);
+    LinhaRelatorioMensal *l = NULL;
+    long long fimMes = LLONG_MIN, lidas = 0;
+    const Transacao *t;
+    while ((t = intercaladorProximo(&it, NULL)) != NULL) {
+        lidas++;
+        if (t->ts >= fimMes) {
+            int mes;
+            fimMes = limiteDoMes(t->ts, tr->fuso, &mes);
+            if (!(l = novaLinhaMes(r, mes))) break;
+        }
+        long long v = paraCentavos(t->valor);
+        l->cent[CAT_TAXAS] += paraCentavos(t->taxa);
+        switch (grupoDoTipo(t->tipo)) {
+            case GRUPO_DEPOSITO: l->cent[CAT_DEPOSITOS] += v; break;
+            case GRUPO_TRANSF: l->cent[v < 0 ? CAT_TRANSF_ENVIADAS : CAT_TRANSF_RECEBIDAS] += v < 0 ? -v : v; break;
+            case GRUPO_COMPRA: l->cent[CAT_COMPRAS] -= v; break;
+            case GRUPO_VENDA:
+                l->cent[CAT_VENDAS] += v;
+                l->cent[CAT_RESULTADO] += paraCentavos(t->resultado);
+                break;
+            case GRUPO_PROVENTO: l->cent[CAT_PROVENTOS] += v; break;
+            default: break;
+        }
+    }
+    return lidas;
+}
+
+static void *threadRelatorio(void *arg) {
+    TrabalhoRelatorio *tr = arg;
+    long long lidas = 0;
+    for (;;) {
+        int i = atomic_fetch_add_explicit(&tr->proximo, 1, memory_order_relaxed);
+        if (i >= tr->n) break;
+        lidas += agregarUsuario(tr, tr->lista[i], &tr->saida[i]);
+    }
+    atomic_fetch_add_explicit(&tr->lidas, lidas, memory_order_relaxed);
+    return NULL;
+}
+
+static void escreverRelatorioCsv(SaidaBuffer *s, Usuario **lista, int n, const RelatorioUsuario *rel) {
+    saidaTexto(s, "cpf,mes,depositos,taxas,transf_enviadas,transf_recebidas,compras,vendas,proventos,resultado_realizado\n");
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < rel[i].num; ++k) {
+            const LinhaRelatorioMensal *l = &rel[i].linhas[k];
+            saidaTexto(s, lista[i]->cpf); saidaCaractere(s, ',');
+            saidaInteiro(s, l->mes / 100); saidaCaractere(s, '-');
+            char mm[2]; saidaDoisDigitos(mm, l->mes % 100); saidaBytes(s, mm, 2);
+            for (int c = 0; c < NUM_CATEGORIAS; ++c) { saidaCaractere(s, ','); saidaCentavos(s, l->cent[c], 0); }
+            saidaCaractere(s, '\n');
+        }
+    }
+}
+
+/*
+ * Agrega 'lista' em 'numThreads' workers e grava o CSV em 'arq' (NULL = não
+ * grava, só mede). Retorna o número de linhas (usuário x mês) ou -1 em erro.
+ */
+int gerarRelatorioMensal(Usuario **lista, int n, int numThreads, const char *arq, long long *linhasLidas) {
+    if (lista == usuarios) sincronizarExtrato(&filaExtrato);
+    TrabalhoRelatorio *tr = calloc(1, sizeof(TrabalhoRelatorio));
+    RelatorioUsuario *rel = calloc((size_t)(n ? n : 1), sizeof(RelatorioUsuario));
+    if (!tr || !rel) { free(tr); free(rel); return -1; }
+    tr->lista = lista;
+    tr->n = n;
+    tr->saida = rel;
+    tr->fuso = fusoLocal();
+#ifdef USAR_SIMD_X86
+    iniciarGruposSimd();
+#endif
+
+    if (numThreads > THREADS_RELATORIO) numThreads = THREADS_RELATORIO;
+    Thread th[THREADS_RELATORIO];
+    int criadas = 0;
+    for (int i = 1; i < numThreads; ++i)
+        if (thread_criar(&th[criadas], threadRelatorio, tr)) criadas++;
+    threadRelatorio(tr);                  // a thread chamadora também trabalha
+    for (int i = 0; i < criadas; ++i) thread_aguardar(th[i]);
+    if (linhasLidas) *linhasLidas = atomic_load(&tr->lidas);
+
+    int linhas = 0;
+    for (int i = 0; i < n; ++i) linhas += rel[i].num;
+    if (arq) {
+        SaidaBuffer s;
+        if (!saidaAbrirArquivo(&s, arq)) linhas = -1;
+        else {
+            escreverRelatorioCsv(&s, lista, n, rel);
+            if (!saidaFechar(&s)) linhas = -1;
+        }
+    }
+    for (int i = 0; i < n; ++i) free(rel[i].linhas);
+    free(rel);
+    free(tr);
+    return linhas;
+}
+
+void menuRelatorioMensal(void) {
+    const char *arq = "relatorio_mensal.csv";
+    long long lidas = 0;
+    double t0 = cronometro_seg();
+    int linhas = gerarRelatorioMensal(usuarios, numUsuarios, THREADS_RELATORIO, arq, &lidas);
+    if (linhas < 0) { printf("Falha ao gerar %s.\n", arq); return; }
+    printf("%s: %d linhas (cliente x mês) a partir de %lld lançamentos em %.1f ms.\n",
+           arq, linhas, lidas, (cronometro_seg() - t0) * 1e3);
+}
+
+/* 4000 usuários sintéticos x 1000 lançamentos: 1 worker contra todos */
+void benchmarkRelatorioMensal(void) {
+    const int numU = 4000, porConta = 500;
+    static const char *tiposBanco[] = { "Depósito", "PIX", "TED", "Transferência", "Transferência Ext", "TED agendado" };
+    static const char *tiposInvest[] = { "Compra", "Venda", "Provento", "Recebido", "Custódia", "DARF" };
+    printf("\n=== Benchmark do relatório mensal (%d usuários, %d lançamentos) ===\n", numU, numU * porConta * 2);
+    Usuario **lista = calloc((size_t)numU, sizeof(Usuario *));
+    if (!lista) { printf("Memória insuficiente.\n"); return; }
+    unsigned semente = 99u;
+    int criados = 0;
+    for (; criados < numU; ++criados) {
+        Usuario *u = calloc(1, sizeof(Usuario));
+        if (!u) break;
+        lista[criados] = u;
+        u->efemero = true;
+        snprintf(u->cpf, sizeof(u->cpf), "%011d", criados);
+        u->banco.extrato = calloc((size_t)porConta, sizeof(Transacao));
+        u->investimento.extrato = calloc((size_t)porConta, sizeof(Transacao));
+        if (!u->banco.extrato || !u->investimento.extrato) { criados++; break; }
+        u->banco.numTransacoes = u->banco.capTransacoes = porConta;
+        u->investimento.numTransacoes = u->investimento.capTransacoes = porConta;
+        long long ts = 1704067200LL;
+        for (int i = 0; i < porConta; ++i) {
+            aleatorio(&semente);
+            ts += 3600 + (semente >> 16) % 36000;   // ~1 ano de histórico
+            Transacao *b = &u->banco.extrato[i], *v = &u->investimento.extrato[i];
+            snprintf(b->tipo, sizeof(b->tipo), "%s", tiposBanco[(semente >> 4) % 6]);
+            snprintf(v->tipo, sizeof(v->tipo), "%s", tiposInvest[(semente >> 8) % 6]);
+            b->valor = (float)((int)((semente >> 12) % 20001) - 10000) / 100.0f;
+            b->taxa = strcmp(b->tipo, "TED") == 0 ? 0.5f : 0.0f;
+            v->valor = (float)((semente >> 10) % 5000) / 10.0f * (strcmp(v->tipo, "Compra") == 0 ? -1.0f : 1.0f);
+            v->resultado = strcmp(v->tipo, "Venda") == 0 ? v->valor * 0.1f : 0.0f;
+            b->ts = v->ts = ts;
+            b->tsNs = v->tsNs = ts * 1000000000LL;
+        }
+    }
+    if (criados < numU) printf("Memória insuficiente para todos os usuários; usando %d.\n", criados);
+
+    int linhasRef = -1;
+    for (int th = 1; th <= THREADS_RELATORIO; th *= 2) {
+        long long lidas = 0;
+        double t0 = cronometro_seg();
+        int linhas = gerarRelatorioMensal(lista, criados, th, NULL, &lidas);
+        double d = cronometro_seg() - t0;
+        printf("%d worker(s): %.1f ms | %.1f M lançamentos/s | %d linhas%s\n", th, d * 1e3, lidas / d / 1e6,
+               linhas, linhasRef >= 0 && linhas != linhasRef ? " (DIVERGENTE)" : "");
+        if (linhasRef < 0) linhasRef = linhas;
+    }
+
+    /* agrupamento isolado: SSE2 x escalar sobre a coluna de tipos, com conferência */
+#ifdef USAR_SIMD_X86
+    iniciarGruposSimd();
+#endif
+    long long divergentes = 0, total = 0;
+    for (int i = 0; i < criados; ++i)
+        for (int k = 0; k < porConta; ++k) {
+            divergentes += grupoDoTipo(lista[i]->banco.extrato[k].tipo) != grupoDoTipoEscalar(lista[i]->banco.extrato[k].tipo);
+            divergentes += grupoDoTipo(lista[i]->investimento.extrato[k].tipo)
+                        != grupoDoTipoEscalar(lista[i]->investimento.extrato[k].tipo);
+            total += 2;
+        }
+    for (int modo = 0; modo < 2; ++modo) {
+        relatorioUsarSimd = modo == 0;
+        long long soma = 0;
+        double a = cronometro_seg();
+        for (int i = 0; i < criados; ++i)
+            for (int k = 0; k < porConta; ++k)
+                soma += grupoDoTipo(lista[i]->banco.extrato[k].tipo) + grupoDoTipo(lista[i]->investimento.extrato[k].tipo);
+        double d = cronometro_seg() - a;
+        long long lidas = 0;
+        a = cronometro_seg();
+        gerarRelatorioMensal(lista, criados, 1, NULL, &lidas);
+        double dr = cronometro_seg() - a;
+        printf("Agrupamento %-8s: %.1f M tipos/s | relatório com 1 worker: %.1f M lançamentos/s (verif. %lld)\n",
+               modo == 0 ? "SIMD" : "escalar", total / d / 1e6, lidas / dr / 1e6, soma % 1000);
+    }
+    relatorioUsarSimd = true;
+    printf("Grupos SIMD x escalar: %lld divergente(s) em %lld tipos\n", divergentes, total);
+
+    double t0 = cronometro_seg();
+    int linhas = gerarRelatorioMensal(lista, criados, THREADS_RELATORIO, "bench_relatorio.tmp", NULL);
+    printf("Com gravação do CSV: %.1f ms (%d linhas)\n", (cronometro_seg() - t0) * 1e3, linhas);
+    remove("bench_relatorio.tmp");
+    for (int i = 0; i < criados; ++i) liberarUsuario(lista[i]);
+    free(lista);
+}
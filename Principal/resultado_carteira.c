@@ -0,0 +1,383 @@
+#include "corretora.h"
+
+/* ======= Resultado da carteira (incremental) ======= */
+
+/*
+ * Cada posição contribui com quantidade x preço médio para o custo e
+ * quantidade x preço marcado para o valor de mercado da conta. Compra,
+ * venda e mudança de preço tiram a contribuição antiga e somam a nova, em
+ * O(1); o resultado não realizado é valorMercado - custoCarteira. Para que
+ * uma mudança de preço só visite quem tem o ativo, cada ativo do catálogo
+ * guarda a lista dos seus detentores.
+ */
+
+typedef struct {
+    Usuario **u;
+    int num;
+    int cap;
+} DetentoresAtivo;
+
+DetentoresAtivo *detentores = NULL;       // um por ativo do catálogo
+
+/* busca binária no índice por ticker (varredura linear se o índice ainda não existe) */
+int indiceCatalogo(const char *ticker) {
+    if (!catalogoPorTicker) {
+        for (int j = 0; j < NUM_ATIVOS; ++j)
+            if (strcmp(ativosDisponiveis[j].ticker, ticker) == 0) return j;
+        return -1;
+    }
+    int lo = 0, hi = NUM_ATIVOS;
+    while (lo < hi) {
+        int m = (lo + hi) / 2;
+        if (strcmp(ativosDisponiveis[catalogoPorTicker[m]].ticker, ticker) < 0) lo = m + 1; else hi = m;
+    }
+    return lo < NUM_ATIVOS && strcmp(ativosDisponiveis[catalogoPorTicker[lo]].ticker, ticker) == 0
+        ? catalogoPorTicker[lo] : -1;
+}
+
+AtivoCarteira *posicaoDoTicker(Usuario *u, const char *ticker) {
+    for (int i = 0; i < u->investimento.numAtivos; ++i)
+        if (strcmp(u->investimento.carteira[i].ticker, ticker) == 0) return &u->investimento.carteira[i];
+    return NULL;
+}
+
+static void desmarcarPosicao(ContaInvestimento *c, const AtivoCarteira *p) {
+    c->custoCarteira -= (double)p->quantidade * p->precoMedio;
+    c->valorMercado -= (double)p->quantidade * p->precoMarcado;
+}
+
+static void marcarPosicao(ContaInvestimento *c, const AtivoCarteira *p) {
+    c->custoCarteira += (double)p->quantidade * p->precoMedio;
+    c->valorMercado += (double)p->quantidade * p->precoMarcado;
+}
+
+static void adicionarDetentor(Usuario *u, const char *ticker) {
+    int j = indiceCatalogo(ticker);
+    if (j < 0) return;
+    if (!detentores && !(detentores = calloc((size_t)NUM_ATIVOS, sizeof(DetentoresAtivo)))) return;
+    DetentoresAtivo *d = &detentores[j];
+    if (d->num == d->cap) {
+        int novaCap = d->cap ? d->cap * 2 : 16;
+        Usuario **n = realloc(d->u, sizeof(Usuario *) * (size_t)novaCap);
+        if (!n) return;
+        d->u = n; d->cap = novaCap;
+    }
+    d->u[d->num++] = u;
+}
+
+void removerDetentor(Usuario *u, const char *ticker) {
+    int j = indiceCatalogo(ticker);
+    if (j < 0 || !detentores) return;
+    DetentoresAtivo *d = &detentores[j];
+    for (int i = 0; i < d->num; ++i)
+        if (d->u[i] == u) { d->u[i] = d->u[--d->num]; return; }
+}
+
+void liberarDetentores(void) {
+    if (!detentores) return;
+    for (int j = 0; j < NUM_ATIVOS; ++j) free(detentores[j].u);
+    free(detentores);
+    detentores = NULL;
+}
+
+/* compra de 'quantidade' a 'preco' (pos já existe; nova posição vem zerada) */
+void resultadoCompra(Usuario *u, AtivoCarteira *pos, int quantidade, float preco) {
+    ContaInvestimento *c = &u->investimento;
+    if (pos->quantidade == 0) {
+        pos->resultadoRealizado = 0.0f;
+        pos->proventos = 0.0f;
+        adicionarDetentor(u, pos->ticker);
+    }
+    desmarcarPosicao(c, pos);
+    int novaQtd = pos->quantidade + quantidade;
+    pos->precoMedio = (pos->precoMedio * (float)pos->quantidade + preco * (float)quantidade) / (float)novaQtd;
+    pos->quantidade = novaQtd;
+    pos->precoMarcado = preco;
+    marcarPosicao(c, pos);
+    lotesAnexar(&pos->lotes, relogio_seg(), quantidade, preco);
+}
+
+/*
+ * venda de 'quantidade' a 'preco'; retorna o resultado realizado (contra o
+ * preço médio) e, se 'consumo' não for NULL, o custo dos lotes consumidos
+ */
+float resultadoVenda(Usuario *u, AtivoCarteira *pos, int quantidade, float preco, ConsumoLotes *consumo) {
+    ContaInvestimento *c = &u->investimento;
+    ConsumoLotes local;
+    lotesConsumir(&pos->lotes, quantidade, relogio_seg(), consumo ? consumo : &local);
+    float resultado = (preco - pos->precoMedio) * (float)quantidade;
+    desmarcarPosicao(c, pos);
+    pos->quantidade -= quantidade;
+    pos->precoMarcado = preco;
+    marcarPosicao(c, pos);
+    pos->resultadoRealizado += resultado;
+    c->resultadoRealizado += resultado;
+    if (pos->quantidade == 0) removerDetentor(u, pos->ticker);
+    return resultado;
+}
+
+void resultadoProvento(Usuario *u, AtivoCarteira *pos, float valor) {
+    pos->proventos += valor;
+    u->investimento.proventosRecebidos += valor;
+}
+
+/* novo preço de um ativo do catálogo: remarca só as posições dos detentores (sem histórico, velas nem alertas) */
+void remarcarAtivo(int idx, float preco) {
+    if (idx < 0 || idx >= NUM_ATIVOS) return;
+    ativosDisponiveis[idx].preco = preco;
+    if (!detentores) return;
+    DetentoresAtivo *d = &detentores[idx];
+    for (int i = 0; i < d->num; ++i) {
+        AtivoCarteira *pos = posicaoDoTicker(d->u[i], ativosDisponiveis[idx].ticker);
+        if (!pos) continue;
+        ContaInvestimento *c = &d->u[i]->investimento;
+        c->valorMercado += (double)pos->quantidade * (double)(preco - pos->precoMarcado);
+        pos->precoMarcado = preco;
+    }
+}
+
+/*
+ * Cotações do feed vão para ARQ_PRECOS, uma linha por tick com o preço em
+ * centavos (inteiro: não depende do locale), gravada antes de voltar. Na
+ * carga elas refazem histórico, velas e indicadores e remarcam o catálogo
+ * pelo último preço de cada ativo. Ensaio não grava.
+ */
+static FILE *registroPrecos;
+
+bool abrirRegistroPrecos(const char *arq) {
+    registroPrecos = fopen(arq, "a");
+    return registroPrecos != NULL;
+}
+
+void fecharRegistroPrecos(void) {
+    if (registroPrecos) fclose(registroPrecos);
+    registroPrecos = NULL;
+}
+
+/* relê ARQ_PRECOS; retorna quantas cotações foram aplicadas (linhas inválidas são puladas) */
+int carregarPrecos(const char *arq) {
+    FILE *fp = fopen(arq, "r");
+    if (!fp) return 0;
+    float *ultimo = calloc((size_t)NUM_ATIVOS, sizeof(float));
+    if (!ultimo) { fclose(fp); return 0; }
+    char linha[96], ticker[16];
+    int aplicadas = 0;
+    while (fgets(linha, sizeof(linha), fp)) {
+        long long ts, centavos;
+        int usados = 0;
+        if (sscanf(linha, "%15[^;];%lld;%lld%n", ticker, &ts, &centavos, &usados) != 3 || centavos <= 0
+            || (linha[usados] != '\n' && linha[usados] != '\0')) continue;
+        int idx = indiceCatalogo(ticker);
+        if (idx < 0) continue;
+        float preco = (float)(centavos / 100.0);
+        historicoRegistrar(idx, ts, preco);
+        velasTick(idx, ts, preco, 0);
+        ultimo[idx] = preco;
+        aplicadas++;
+    }
+    fclose(fp);
+    for (int j = 0; j < NUM_ATIVOS; ++j) if (ultimo[j] > 0.0f) remarcarAtivo(j, ultimo[j]);
+    free(ultimo);
+    return aplicadas;
+}
+
+/* cotação real do mercado: grava, remarca e alimenta histórico, velas e alertas */
+void atualizarPrecoAtivo(int idx, float preco) {
+    if (idx < 0 || idx >= NUM_ATIVOS) return;
+    long long agora = relogio_seg();
+    if (registroPrecos && !atomic_load_explicit(&sessaoEnsaio, memory_order_relaxed)) {
+        fprintf(registroPrecos, "%s;%lld;%lld\n", ativosDisponiveis[idx].ticker, agora, paraCentavos(preco));
+        if (fflush(registroPrecos) != 0 || !sincronizarDados(fileno(registroPrecos)))
+            printf("Aviso: falha ao gravar %s; a cotação fica só em memória.\n", ARQ_PRECOS);
+    }
+    remarcarAtivo(idx, preco);
+    historicoRegistrar(idx, agora, preco);
+    velasTick(idx, agora, preco, 0);
+    alertasPrecoCatalogo(idx, preco, agora);
+}
+
+/* lotes e quantidade de um ticker durante a releitura do journal (inclusive já zerado na carteira) */
+typedef struct {
+    char ticker[16];
+    int qtd;
+    FilaLotes lotes;
+} ReplayTicker;
+
+static ReplayTicker *replayTicker(ReplayTicker **v, int *num, int *cap, const char *ticker) {
+    for (int i = 0; i < *num; ++i) if (strcmp((*v)[i].ticker, ticker) == 0) return &(*v)[i];
+    if (*num == *cap) {
+        int novaCap = *cap ? *cap * 2 : 16;
+        ReplayTicker *n = realloc(*v, sizeof(ReplayTicker) * (size_t)novaCap);
+        if (!n) return NULL;
+        *v = n; *cap = novaCap;
+    }
+    ReplayTicker *r = &(*v)[(*num)++];
+    memset(r, 0, sizeof(*r));
+    snprintf(r->ticker, sizeof(r->ticker), "%s", ticker);
+    return r;
+}
+
+/*
+ * Na carga: marca as posições pelo preço atual e refaz realizado,
+ * proventos e a apuração de IR pelo journal (uma passada). Lotes e
+ * quantidade são seguidos por ticker, também dos já zerados, para que
+ * vendas de posições encerradas entrem na apuração.
+ */
+void reconstruirResultados(Usuario *u) {
+    ContaInvestimento *c = &u->investimento;
+    c->custoCarteira = c->valorMercado = c->resultadoRealizado = c->proventosRecebidos = 0.0;
+    memset(&c->ir, 0, sizeof(c->ir));
+    ReplayTicker *est = NULL;
+    int numEst = 0, capEst = 0;
+    for (int i = 0; i < c->numAtivos; ++i) {
+        AtivoCarteira *pos = &c->carteira[i];
+        int j = indiceCatalogo(pos->ticker);
+        pos->precoMarcado = j >= 0 ? ativosDisponiveis[j].preco : pos->precoMedio;
+        pos->resultadoRealizado = pos->proventos = 0.0f;
+        memset(&pos->lotes, 0, sizeof(pos->lotes));
+        marcarPosicao(c, pos);
+        if (pos->quantidade > 0) adicionarDetentor(u, pos->ticker);
+    }
+    for (int k = 0; k < c->numTransacoes; ++k) {
+        const Transacao *t = &c->extrato[k];
+        if (strcmp(t->tipo, "Custódia") == 0) {
+            c->diaCustodia = diaLocal(t->ts, fusoProcesso());
+            continue;
+        }
+        if (strcmp(t->tipo, "DARF") == 0) {
+            /* mês já emitido pelo lote mensal (AAAA-MM na descrição): fecha sem reemitir */
+            int ano, mes;
+            if (sscanf(t->descricao, "DARF %4d-%2d", &ano, &mes) == 2) {
+                while (c->ir.mes != 0 && c->ir.mes <= ano * 100 + mes) fecharMesIR(&c->ir);
+                c->ir.darfEmAberto = 0;
+            }
+            continue;
+        }
+        if (!t->ativo[0]) continue;
+        bool venda = strcmp(t->tipo, "Venda") == 0, provento = !venda && strcmp(t->tipo, "Provento") == 0;
+        if (venda) c->resultadoRealizado += t->resultado;
+        if (provento) c->proventosRecebidos += t->valor;
+        AtivoCarteira *pos = posicaoDoTicker(u, t->ativo);
+        ReplayTicker *r = replayTicker(&est, &numEst, &capEst, t->ativo);
+        if (!r) continue;
+        if (strcmp(t->tipo, "Compra") == 0) {
+            if (r->qtd == 0 && pos) pos->resultadoRealizado = pos->proventos = 0.0f;
+            r->qtd += t->quantidade;
+            if (t->quantidade > 0) lotesAnexar(&r->lotes, t->ts, t->quantidade, -t->valor / (float)t->quantidade);
+        } else if (venda) {
+            ConsumoLotes consumo;
+            if (pos) pos->resultadoRealizado += t->resultado;
+            r->qtd -= t->quantidade;
+            lotesConsumir(&r->lotes, t->quantidade, t->ts, &consumo);
+            apurarVendaUsuario(u, t->ativo, t->ts, t->quantidade, t->valor, t->taxa, t->resultado, &consumo);
+            if (r->qtd <= 0) { r->qtd = 0; if (pos) pos->resultadoRealizado = pos->proventos = 0.0f; }
+        } else if (provento && pos) {
+            pos->proventos += t->valor;
+        }
+    }
+    /* lotes dos tickers ainda em carteira vão para a posição; os dos encerrados são descartados */
+    for (int k = 0; k < numEst; ++k) {
+        AtivoCarteira *pos = posicaoDoTicker(u, est[k].ticker);
+        if (pos) pos->lotes = est[k].lotes;
+        else lotesLiberar(&est[k].lotes);
+    }
+    free(est);
+    /* journal não cobre a posição toda (histórico antigo): o resto vira um lote ao preço médio */
+    for (int i = 0; i < c->numAtivos; ++i) {
+        AtivoCarteira *pos = &c->carteira[i];
+        int abertas = 0;
+        for (int k = 0; k < pos->lotes.num; ++k) abertas += pos->lotes.itens[(pos->lotes.cabeca + k) & (pos->lotes.cap - 1)].quantidade;
+        if (abertas > pos->quantidade) {
+            lotesLiberar(&pos->lotes);
+            lotesAnexar(&pos->lotes, 0, pos->quantidade, pos->precoMedio);
+        } else if (abertas < pos->quantidade) {
+            /* lote sintético mais antigo que todos: entra na frente */
+            FilaLotes antigos = pos->lotes;
+            memset(&pos->lotes, 0, sizeof(pos->lotes));
+            lotesAnexar(&pos->lotes, 0, pos->quantidade - abertas, pos->precoMedio);
+            for (int k = 0; k < antigos.num; ++k) {
+                const Lote *l = &antigos.itens[(antigos.cabeca + k) & (antigos.cap - 1)];
+                lotesAnexar(&pos->lotes, l->ts, l->quantidade, l->preco);
+            }
+            lotesLiberar(&antigos);
+        }
+    }
+}
+
+void menuAtualizarPreco(void) {
+    int idx;
+    float preco;
+    listarAtivosDisponiveis();
+    printf("Ativo (número): ");
+    if (scanf("%d", &idx) != 1 || idx < 1 || idx > NUM_ATIVOS) { clear_input(); printf("Ativo inválido.\n"); return; }
+    printf("Novo preço de %s: R$ ", ativosDisponiveis[idx - 1].ticker);
+    if (scanf("%f", &preco) != 1 || preco <= 0.0f) { clear_input(); printf("Preço inválido.\n"); return; }
+    atualizarPrecoAtivo(idx - 1, preco);
+    printf("Preço atualizado; %d posição(ões) remarcada(s).\n", detentores ? detentores[idx - 1].num : 0);
+}
+
+/* 20k usuários com todos os ativos, 2k mudanças de preço; confere com recálculo completo */
+void benchmarkResultadoCarteira(void) {
+    const int numU = 20000, ticks = 2000;
+    printf("\n=== Benchmark de resultado da carteira (%d usuários, %d mudanças de preço) ===\n", numU, ticks);
+    float *precoOriginal = malloc(sizeof(float) * (size_t)NUM_ATIVOS);
+    Usuario **lista = calloc((size_t)numU, sizeof(Usuario *));
+    if (!precoOriginal || !lista) { free(precoOriginal); free(lista); printf("Memória insuficiente.\n"); return; }
+    for (int j = 0; j < NUM_ATIVOS; ++j) precoOriginal[j] = ativosDisponiveis[j].preco;
+    int criados = 0;
+    for (; criados < numU; ++criados) {
+        Usuario *u = calloc(1, sizeof(Usuario));
+        if (!u) break;
+        u->efemero = true;
+        lista[criados] = u;
+        for (int j = 0; j < NUM_ATIVOS && j < MAX_ATIVOS; ++j) {
+            AtivoCarteira *pos = &u->investimento.carteira[u->investimento.numAtivos++];
+            memcpy(pos->ticker, ativosDisponiveis[j].ticker, sizeof(pos->ticker));
+            resultadoCompra(u, pos, 10 + (criados + j) % 90, ativosDisponiveis[j].preco);
+        }
+    }
+    unsigned semente = 2024u;
+    double t0 = cronometro_seg();
+    for (int i = 0; i < ticks; ++i) {
+        aleatorio(&semente);
+        int j = (int)((semente >> 16) % (unsigned)NUM_ATIVOS);
+        float fator = 0.98f + (float)((semente >> 4) % 41) / 1000.0f;   // -2% a +2%
+        remarcarAtivo(j, precoOriginal[j] * fator);
+    }
+    double d = cronometro_seg() - t0;
+    long long visitas = (long long)ticks * criados;      // cada usuário detém todos os ativos
+    printf("%.2f s | %.1f ns por posição remarcada\n", d, d / (double)visitas * 1e9);
+
+    /* vende metade de cada posição e confere os agregados com um recálculo completo */
+    t0 = cronometro_seg();
+    for (int i = 0; i < criados; ++i)
+        for (int k = 0; k < lista[i]->investimento.numAtivos; ++k) {
+            AtivoCarteira *pos = &lista[i]->investimento.carteira[k];
+            resultadoVenda(lista[i], pos, pos->quantidade / 2, ativosDisponiveis[indiceCatalogo(pos->ticker)].preco, NULL);
+        }
+    printf("Vendas: %.1f ns por operação\n", (cronometro_seg() - t0) / ((double)criados * NUM_ATIVOS) * 1e9);
+    int divergentes = 0;
+    for (int i = 0; i < criados; ++i) {
+        const ContaInvestimento *c = &lista[i]->investimento;
+        double custo = 0.0, mercado = 0.0;
+        for (int k = 0; k < c->numAtivos; ++k) {
+            custo += (double)c->carteira[k].quantidade * c->carteira[k].precoMedio;
+            mercado += (double)c->carteira[k].quantidade * ativosDisponiveis[indiceCatalogo(c->carteira[k].ticker)].preco;
+        }
+        double dif = (mercado - custo) - (c->valorMercado - c->custoCarteira);
+        if (dif > 0.05 || dif < -0.05) divergentes++;
+    }
+    printf("Conferência por recálculo: %d de %d contas divergentes\n", divergentes, criados);
+
+    /* tira os sintéticos das listas de detentores e devolve os preços do catálogo */
+    for (int j = 0; detentores && j < NUM_ATIVOS; ++j) {
+        DetentoresAtivo *dt = &detentores[j];
+        int m = 0;
+        for (int i = 0; i < dt->num; ++i) if (!dt->u[i]->efemero) dt->u[m++] = dt->u[i];
+        dt->num = m;
+    }
+    for (int j = 0; j < NUM_ATIVOS; ++j) remarcarAtivo(j, precoOriginal[j]);
+    for (int i = 0; i < criados; ++i) liberarUsuario(lista[i]);
+    free(lista);
+    free(precoOriginal);
+}
@@ -0,0 +1,332 @@
+#include "corretora.h"
+
+/* ======= Risco de carteira (covariância, volatilidade e VaR) ======= */
+
+/*
+ * Na consulta, a covariância cobre só os k ativos da carteira, a partir dos
+ * fechamentos do histórico: O(k² x dias) e k x dias retornos na memória,
+ * qualquer que seja o tamanho do catálogo. O risco é v' C v, O(k²), e o VaR
+ * histórico reaplica os retornos da janela às posições atuais, O(k x dias).
+ * A covariância em painéis de muitos ativos fica para o processamento em
+ * lote (benchmarkRisco mede 1.000 ativos).
+ */
+
+/*
+ * Monta os retornos simples a partir de 'fechamentos' ([dia][ativo], mesmo
+ * formato de indicadoresLote): o ativo i só tem preço a partir de
+ * inicio[i] e tem retorno zero antes disso. Calcula a covariância.
+ */
+bool riscoMercadoCalcular(RiscoMercado *r, const float *fechamentos, const int *inicio, int numAtivos, int dias) {
+    riscoMercadoLiberar(r);
+    int t = dias > 1 ? dias - 1 : 0;
+    r->numAtivos = numAtivos;
+    r->dias = t;
+    r->passo = (t + 3) & ~3;
+    r->retornos = calloc((size_t)numAtivos * (size_t)(r->passo ? r->passo : 1), sizeof(double));
+    r->media = calloc((size_t)(numAtivos ? numAtivos : 1), sizeof(double));
+    r->cov = calloc((size_t)numAtivos * (size_t)numAtivos + 1, sizeof(double));
+    if (!r->retornos || !r->media || !r->cov) { riscoMercadoLiberar(r); return false; }
+    for (int i = 0; i < numAtivos; ++i) {
+        double *ri = r->retornos + (size_t)i * r->passo, soma = 0.0;
+        int ini = inicio[i] < t ? inicio[i] : t;                     // antes disso, retorno zero
+        for (int d = ini + 1; d < dias; ++d) {
+            double ant = fechamentos[(size_t)(d - 1) * numAtivos + i];
+            ri[d - 1] = ant > 0.0 ? fechamentos[(size_t)d * numAtivos + i] / ant - 1.0 : 0.0;
+            soma += ri[d - 1];
+        }
+        r->media[i] = t > ini ? soma / (t - ini) : 0.0;
+        for (int d = ini; d < t; ++d) ri[d] -= r->media[i];
+    }
+    covarianciaCalcular(r);
+    return true;
+}
+
+/* bloco 2x4 da covariância: 8 produtos escalares lendo cada série uma vez */
+static void covarianciaBlocoEscalar(const double *a0, const double *a1, const double *const *b, int n, double *out) {
+    double s[8] = { 0 };
+    for (int d = 0; d < n; ++d) {
+        double x0 = a0[d], x1 = a1[d];
+        for (int k = 0; k < 4; ++k) { s[k] += x0 * b[k][d]; s[4 + k] += x1 * b[k][d]; }
+    }
+    memcpy(out, s, sizeof(s));
+}
+
+#ifdef USAR_SIMD_X86
+static int fmaDisponivel = -1;
+
+static inline double somaAvx(__m256d v) __attribute__((target("avx2")));
+static inline double somaAvx(__m256d v) {
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+}
+
+/* o mesmo bloco 2x4 com 4 dias por instrução (8 acumuladores + 6 cargas cabem nos 16 registradores) */
+__attribute__((target("avx2,fma")))
+static void covarianciaBlocoAvx2(const double *a0, const double *a1, const double *const *b, int n, double *out) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0, s4 = s0, s5 = s0, s6 = s0, s7 = s0;
+    const double *b0 = b[0], *b1 = b[1], *b2 = b[2], *b3 = b[3];
+    for (int d = 0; d < n; d += 4) {
+        __m256d x0 = _mm256_loadu_pd(a0 + d), x1 = _mm256_loadu_pd(a1 + d);
+        __m256d y;
+        y = _mm256_loadu_pd(b0 + d); s0 = _mm256_fmadd_pd(x0, y, s0); s4 = _mm256_fmadd_pd(x1, y, s4);
+        y = _mm256_loadu_pd(b1 + d); s1 = _mm256_fmadd_pd(x0, y, s1); s5 = _mm256_fmadd_pd(x1, y, s5);
+        y = _mm256_loadu_pd(b2 + d); s2 = _mm256_fmadd_pd(x0, y, s2); s6 = _mm256_fmadd_pd(x1, y, s6);
+        y = _mm256_loadu_pd(b3 + d); s3 = _mm256_fmadd_pd(x0, y, s3); s7 = _mm256_fmadd_pd(x1, y, s7);
+    }
+    out[0] = somaAvx(s0); out[1] = somaAvx(s1); out[2] = somaAvx(s2); out[3] = somaAvx(s3);
+    out[4] = somaAvx(s4); out[5] = somaAvx(s5); out[6] = somaAvx(s6); out[7] = somaAvx(s7);
+}
+#endif
+
+/*
+ * C = R R' / (dias - 1) sobre os retornos centrados. Percorre painéis de
+ * PAINEL_COVARIANCIA colunas (as séries do painel ficam na cache enquanto
+ * todas as linhas passam por ele) em blocos 2x4; só o triângulo j >= i é
+ * calculado e espelhado. AVX2+FMA se a CPU tiver, senão escalar.
+ */
+void covarianciaCalcular(RiscoMercado *r) {
+    int n = r->numAtivos;
+    double div = r->dias > 1 ? 1.0 / (r->dias - 1) : 0.0;
+    void (*bloco)(const double *, const double *, const double *const *, int, double *) = covarianciaBlocoEscalar;
+#ifdef USAR_SIMD_X86
+    if (fmaDisponivel < 0) fmaDisponivel = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? 1 : 0;
+    if (fmaDisponivel) bloco = covarianciaBlocoAvx2;
+#endif
+    for (int p = 0; p < n; p += PAINEL_COVARIANCIA) {
+        int fimP = p + PAINEL_COVARIANCIA < n ? p + PAINEL_COVARIANCIA : n;
+        for (int i = 0; i < fimP; i += 2) {
+            const double *a0 = r->retornos + (size_t)i * r->passo;
+            const double *a1 = i + 1 < n ? a0 + r->passo : a0;
+            int j0 = p > (i & ~3) ? p : (i & ~3);                    // só o triângulo superior
+            for (int j = j0; j < fimP; j += 4) {
+                const double *b[4];                                  // colunas além do painel repetem a0 (descartadas)
+                for (int k = 0; k < 4; ++k) b[k] = j + k < fimP ? r->retornos + (size_t)(j + k) * r->passo : a0;
+                double s[8];
+                bloco(a0, a1, b, r->passo, s);
+                for (int k = 0; k < 4 && j + k < fimP; ++k) {
+                    if (j + k >= i) r->cov[(size_t)i * n + j + k] = r->cov[(size_t)(j + k) * n + i] = s[k] * div;
+                    if (i + 1 < n && j + k >= i + 1)
+                        r->cov[(size_t)(i + 1) * n + j + k] = r->cov[(size_t)(j + k) * n + i + 1] = s[4 + k] * div;
+                }
+            }
+        }
+    }
+}
+
+void riscoMercadoLiberar(RiscoMercado *r) {
+    free(r->retornos);
+    free(r->media);
+    free(r->cov);
+    memset(r, 0, sizeof(*r));
+    r->dia = -1;
+}
+
+/*
+ * Retornos e covariância dos ativos pedidos (índices do catálogo), na
+ * ordem dada, com os até JANELA_RISCO + 1 fechamentos mais recentes de
+ * cada um. 0 = ok, -1 = menos de 2 fechamentos, -2 = sem memória.
+ */
+int riscoDosAtivos(RiscoMercado *r, const int *ativos, int k) {
+    int dias = 0;
+    for (int a = 0; historico && a < k; ++a)
+        if ((int)historico[ativos[a]].fechamentos.pontos > dias) dias = (int)historico[ativos[a]].fechamentos.pontos;
+    int maxPontos = dias;
+    if (dias > JANELA_RISCO + 1) dias = JANELA_RISCO + 1;
+    if (dias < 2) return -1;
+    float *matriz = calloc((size_t)dias * (size_t)k, sizeof(float));
+    int *inicio = malloc(sizeof(int) * (size_t)k);
+    long long *ts = malloc(sizeof(long long) * (size_t)maxPontos);
+    float *col = malloc(sizeof(float) * (size_t)maxPontos);
+    bool ok = matriz && inicio && ts && col;
+    for (int a = 0; ok && a < k; ++a) {
+        int n = serieLer(&historico[ativos[a]].fechamentos, 0, LLONG_MAX, ts, col, maxPontos);
+        int usar = n < dias ? n : dias;                              // os 'dias' fechamentos mais recentes
+        inicio[a] = dias - usar;
+        for (int d = 0; d < usar; ++d) matriz[(size_t)(inicio[a] + d) * k + a] = col[n - usar + d];
+    }
+    ok = ok && riscoMercadoCalcular(r, matriz, inicio, k, dias);
+    free(matriz); free(inicio); free(ts); free(col);
+    if (!ok) return -2;
+    r->dia = diaLocal(relogio_seg(), fusoProcesso());
+    return 0;
+}
+
+/* k-ésimo menor de v (reordena v), seleção em O(n) médio */
+double selecionarK(double *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        double pivo = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivo) i++;
+            while (v[j] > pivo) j--;
+            if (i <= j) { double t = v[i]; v[i] = v[j]; v[j] = t; i++; j--; }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return v[k];
+}
+
+/*
+ * Risco em 1 dia de k posições (índice no catálogo e valor de mercado):
+ * volatilidade sqrt(v' C v) e VaR paramétrico 95% em O(k²); com
+ * 'historicoVar', também o 5º pior resultado percentual da janela
+ * reaplicado às posições atuais, O(k x dias).
+ */
+void riscoCarteira(const RiscoMercado *r, const int *ativos, const double *valores, int k, bool historicoVar, RiscoCarteira *out) {
+    double var = 0.0, valor = 0.0, media = 0.0;
+    for (int a = 0; a < k; ++a) {
+        const double *linha = r->cov + (size_t)ativos[a] * r->numAtivos;
+        double s = 0.5 * linha[ativos[a]] * valores[a];             // C simétrica: só b >= a
+        for (int b = a + 1; b < k; ++b) s += linha[ativos[b]] * valores[b];
+        var += 2.0 * valores[a] * s;
+        valor += valores[a];
+        media += valores[a] * r->media[ativos[a]];
+    }
+    out->valor = valor;
+    out->volatilidade = var > 0.0 ? sqrt(var) : 0.0;
+    out->varParametrico = Z_VAR_95 * out->volatilidade - media;
+    if (out->varParametrico < 0.0) out->varParametrico = 0.0;
+    out->varHistorico = 0.0;
+    out->dias = r->dias;
+    if (!historicoVar || r->dias == 0) return;
+    double resultados[JANELA_RISCO + 4];
+    int t = r->dias < JANELA_RISCO ? r->dias : JANELA_RISCO;
+    for (int d = 0; d < t; ++d) resultados[d] = 0.0;
+    for (int a = 0; a < k; ++a) {
+        const double *ra = r->retornos + (size_t)ativos[a] * r->passo;
+        double v = valores[a], m = r->media[ativos[a]];
+        for (int d = 0; d < t; ++d) resultados[d] += v * (ra[d] + m);
+    }
+    double pior = selecionarK(resultados, t, (int)(0.05 * t));
+    out->varHistorico = pior < 0.0 ? -pior : 0.0;
+}
+
+/* risco das posições do usuário a preço de mercado; códigos de riscoDosAtivos */
+int riscoUsuario(Usuario *u, RiscoCarteira *out) {
+    int ativos[MAX_ATIVOS], locais[MAX_ATIVOS], k = 0;
+    double valores[MAX_ATIVOS];
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < u->investimento.numAtivos; ++i) {
+        const AtivoCarteira *c = &u->investimento.carteira[i];
+        int j = indiceCatalogo(c->ticker);
+        if (j < 0 || c->quantidade <= 0) continue;
+        ativos[k] = j;
+        locais[k] = k;
+        valores[k++] = (double)ativosDisponiveis[j].preco * c->quantidade;
+    }
+    if (k == 0) return 0;
+    RiscoMercado r = { .dia = -1 };
+    int st = riscoDosAtivos(&r, ativos, k);
+    if (st == 0) riscoCarteira(&r, locais, valores, k, true, out);   // r indexado na ordem de 'ativos'
+    riscoMercadoLiberar(&r);
+    return st;
+}
+
+/*
+ * 1.000 ativos x 1 ano de fechamentos sintéticos (fator de mercado +
+ * idiossincrático): covariância em blocos contra o produto ingênuo, 1M
+ * carteiras de 10 posições pelo VaR paramétrico, 100k também pelo
+ * histórico, e conferência v' C v = variância amostral do resultado.
+ */
+void benchmarkRisco(void) {
+    const int num = 1000, dias = JANELA_RISCO + 1, carteiras = 1000000, k = 10;
+    printf("\n=== Benchmark de risco (%d ativos x %d fechamentos, %d carteiras de %d posições) ===\n",
+           num, dias, carteiras, k);
+    float *matriz = malloc(sizeof(float) * (size_t)num * dias);
+    int *inicio = calloc((size_t)num, sizeof(int));
+    double *ref = malloc(sizeof(double) * (size_t)num * num);
+    RiscoMercado r = { .dia = -1 };
+    if (!matriz || !inicio || !ref) {
+        free(matriz); free(inicio); free(ref);
+        printf("Memória insuficiente.\n");
+        return;
+    }
+    unsigned semente = 4242u;
+    for (int i = 0; i < num; ++i) { matriz[i] = 10.0f + (float)(i % 90); if (i % 25 == 0) inicio[i] = 100 + i % 50; }
+    for (int d = 1; d < dias; ++d) {
+        aleatorio(&semente);
+        double mercado = ((double)(semente >> 8) / 16777216.0 - 0.5) * 0.03;
+        for (int i = 0; i < num; ++i) {
+            aleatorio(&semente);
+            double beta = 0.5 + (i % 10) * 0.1, ruido = ((double)(semente >> 8) / 16777216.0 - 0.5) * 0.04;
+            matriz[(size_t)d * num + i] = (float)(matriz[(size_t)(d - 1) * num + i] * (1.0 + beta * mercado + ruido));
+        }
+    }
+    double t0 = cronometro_seg();
+    if (!riscoMercadoCalcular(&r, matriz, inicio, num, dias)) {
+        free(matriz); free(inicio); free(ref);
+        printf("Memória insuficiente.\n");
+        return;
+    }
+    double dCov = cronometro_seg() - t0;
+    t0 = cronometro_seg();
+    for (int i = 0; i < num; ++i)
+        for (int j = 0; j < num; ++j) {
+            const double *a = r.retornos + (size_t)i * r.passo, *b = r.retornos + (size_t)j * r.passo;
+            double s = 0.0;
+            for (int d = 0; d < r.dias; ++d) s += a[d] * b[d];
+            ref[(size_t)i * num + j] = s / (r.dias - 1);
+        }
+    double dRef = cronometro_seg() - t0;
+    double difMax = 0.0;
+    for (size_t q = 0; q < (size_t)num * num; ++q) {
+        double dq = fabs(ref[q] - r.cov[q]) / (fabs(ref[q]) + 1e-12);
+        if (dq > difMax) difMax = dq;
+    }
+
+    int *ativos = malloc(sizeof(int) * (size_t)carteiras * k);
+    double *valores = malloc(sizeof(double) * (size_t)carteiras * k);
+    if (!ativos || !valores) {
+        free(ativos); free(valores); free(matriz); free(inicio); free(ref); riscoMercadoLiberar(&r);
+        printf("Memória insuficiente.\n");
+        return;
+    }
+    for (size_t q = 0; q < (size_t)carteiras * k; ++q) {
+        aleatorio(&semente);
+        ativos[q] = (int)((semente >> 8) % (unsigned)num);
+        valores[q] = 1000.0 + (semente >> 12) % 50000;
+    }
+    RiscoCarteira rc;
+    double somaVar = 0.0;
+    t0 = cronometro_seg();
+    for (int c = 0; c < carteiras; ++c) {
+        riscoCarteira(&r, ativos + (size_t)c * k, valores + (size_t)c * k, k, false, &rc);
+        somaVar += rc.varParametrico;
+    }
+    double dPar = cronometro_seg() - t0;
+    const int comHist = carteiras / 10;
+    double somaHist = 0.0;
+    t0 = cronometro_seg();
+    for (int c = 0; c < comHist; ++c) {
+        riscoCarteira(&r, ativos + (size_t)c * k, valores + (size_t)c * k, k, true, &rc);
+        somaHist += rc.varHistorico;
+    }
+    double dHist = cronometro_seg() - t0;
+
+    /* v' C v deve bater com a variância amostral do resultado diário da carteira 0 */
+    double amostral = 0.0;
+    for (int d = 0; d < r.dias; ++d) {
+        double res = 0.0;
+        for (int a = 0; a < k; ++a) res += valores[a] * r.retornos[(size_t)ativos[a] * r.passo + d];
+        amostral += res * res;
+    }
+    amostral /= (r.dias - 1);
+    riscoCarteira(&r, ativos, valores, k, false, &rc);
+
+    printf("Covariância: %.1f ms em blocos%s | %.1f ms ingênua | diferença relativa máx. %.1e\n",
+           dCov * 1e3,
+#ifdef USAR_SIMD_X86
+           fmaDisponivel ? " (AVX2+FMA)" : " (escalar)",
+#else
+           " (escalar)",
+#endif
+           dRef * 1e3, difMax);
+    printf("VaR paramétrico: %.1f ns por carteira (média R$ %.2f) | histórico: %.2f us por carteira (média R$ %.2f)\n",
+           dPar / carteiras * 1e9, somaVar / carteiras, dHist / comHist * 1e6, somaHist / comHist);
+    printf("Conferência: volatilidade R$ %.4f pela matriz x R$ %.4f pela série\n", rc.volatilidade, sqrt(amostral));
+    free(ativos); free(valores); free(matriz); free(inicio); free(ref);
+    riscoMercadoLiberar(&r);
+}
@@ -0,0 +1,233 @@
+#include "corretora.h"
+
+/* ======= Taxas de negociação e custódia ======= */
+
+/*
+ * Corretagem por faixa de valor da ordem, emolumentos e liquidação da B3
+ * (alíquota menor no day trade) e custódia mensal por faixa do valor da
+ * carteira. A tabela embutida pode ser trocada por ARQ_TAXAS na partida;
+ * em ambos os casos vira arrays planos e o cálculo de uma ordem é uma
+ * contagem de faixas mais três multiplicações em centavos.
+ */
+TabelaTaxas tabelaTaxas = {
+    .corretagem = {
+        .num = 5,
+        .ate  = { 13507, 49862, 151469, 302938, LLONG_MAX, LLONG_MAX, LLONG_MAX, LLONG_MAX },
+        .fixo = { 270, 0, 249, 1006, 2521 },
+        .ppm  = { 0, 20000, 15000, 10000, 5000 },
+    },
+    .custodia = {
+        .num = 3,
+        .ate  = { 1000000, 10000000, LLONG_MAX, LLONG_MAX, LLONG_MAX, LLONG_MAX, LLONG_MAX, LLONG_MAX },
+        .fixo = { 0, 500, 1000 },
+        .ppm  = { 0, 0, 20 },
+    },
+    .emolumentosPpm = { 50, 50 },
+    .liquidacaoPpm = { 250, 180 },
+};
+
+static inline long long aplicarPpm(long long valor, int ppm) {
+    return (valor * ppm + 500000) / 1000000;
+}
+
+/* tetos sem faixa ficam em LLONG_MAX: a contagem tem tamanho fixo e o compilador a desenrola */
+static inline int faixaDoValor(const TabelaFaixas *t, long long valor) {
+    int f = 0;
+    for (int k = 0; k < MAX_FAIXAS_TAXA - 1; ++k) f += valor > t->ate[k];
+    return f;
+}
+
+long long taxaDaFaixa(const TabelaFaixas *t, long long valor) {
+    int f = faixaDoValor(t, valor);
+    return t->fixo[f] + aplicarPpm(valor, t->ppm[f]);
+}
+
+/* taxas de uma ordem de 'valor' centavos, dos quais 'valorDayTrade' são day trade; retorna o total */
+long long calcularTaxas(long long valor, long long valorDayTrade, TaxasOperacao *out) {
+    const TabelaTaxas *t = &tabelaTaxas;
+    long long comum = valor - valorDayTrade;
+    out->corretagem = taxaDaFaixa(&t->corretagem, valor);
+    /* emolumentos e liquidação incidem sobre a mesma base: o total B3 arredonda uma vez e a liquidação é o resto */
+    long long b3 = aplicarPpm(comum, t->emolumentosPpm[0] + t->liquidacaoPpm[0])
+                 + aplicarPpm(valorDayTrade, t->emolumentosPpm[1] + t->liquidacaoPpm[1]);
+    out->emolumentos = aplicarPpm(comum, t->emolumentosPpm[0]) + aplicarPpm(valorDayTrade, t->emolumentosPpm[1]);
+    out->liquidacao = b3 - out->emolumentos;
+    return out->corretagem + b3;
+}
+
+/*
+ * Variante em lote para a apuração de fim do dia: só o total, com as
+ * alíquotas B3 somadas carregadas uma vez (duas divisões por ordem além da
+ * corretagem). 'valoresDayTrade' pode ser NULL (nenhuma ordem em day
+ * trade): o laço sem day trade fica com uma só.
+ */
+void taxasLote(const long long *valores, const long long *valoresDayTrade, int n, long long *totais) {
+    const TabelaTaxas *t = &tabelaTaxas;
+    const TabelaFaixas faixas = t->corretagem, *c = &faixas;     // cópia local: a escrita em 'totais' não a invalida
+    const int b3Comum = t->emolumentosPpm[0] + t->liquidacaoPpm[0];
+    const int b3DayTrade = t->emolumentosPpm[1] + t->liquidacaoPpm[1];
+    if (!valoresDayTrade) {
+        for (int i = 0; i < n; ++i) {
+            long long v = valores[i];
+            int f = faixaDoValor(c, v);
+            totais[i] = c->fixo[f] + aplicarPpm(v, c->ppm[f]) + aplicarPpm(v, b3Comum);
+        }
+        return;
+    }
+    for (int i = 0; i < n; ++i) {
+        long long v = valores[i], dt = valoresDayTrade[i];
+        int f = faixaDoValor(c, v);
+        totais[i] = c->fixo[f] + aplicarPpm(v, c->ppm[f]) + aplicarPpm(v - dt, b3Comum) + aplicarPpm(dt, b3DayTrade);
+    }
+}
+
+/*
+ * Formato (uma entrada por linha, valores em centavos, '#' comenta):
+ *   corretagem <ate|-> <fixo> <ppm>   faixas em ordem crescente; '-' = sem teto
+ *   custodia <ate|-> <fixo> <ppm>
+ *   emolumentos <ppm comum> <ppm day trade>
+ *   liquidacao <ppm comum> <ppm day trade>
+ * Uma tabela citada no arquivo substitui a embutida por inteiro.
+ */
+bool carregarTabelaTaxas(const char *arq) {
+    FILE *fp = fopen(arq, "r");
+    if (!fp) return false;
+    TabelaTaxas t = tabelaTaxas;
+    bool zerouCorretagem = false, zerouCustodia = false, ok = true;
+    char linha[160];
+    int nLinha = 0;
+    while (fgets(linha, sizeof(linha), fp)) {
+        nLinha++;
+        char chave[24], ate[24];
+        long long fixo;
+        int a, b;
+        if (sscanf(linha, "%23s", chave) != 1 || chave[0] == '#') continue;
+        if (strcmp(chave, "corretagem") == 0 || strcmp(chave, "custodia") == 0) {
+            bool corr = strcmp(chave, "corretagem") == 0;
+            TabelaFaixas *f = corr ? &t.corretagem : &t.custodia;
+            bool *zerou = corr ? &zerouCorretagem : &zerouCustodia;
+            if (sscanf(linha, "%*s %23s %lld %d", ate, &fixo, &a) != 3) { ok = false; break; }
+            if (!*zerou) { f->num = 0; *zerou = true; }
+            if (f->num > 0 && f->ate[f->num - 1] == LLONG_MAX) { ok = false; break; }   // faixa após a sem teto
+            if (f->num == MAX_FAIXAS_TAXA) { ok = false; break; }
+            f->ate[f->num] = strcmp(ate, "-") == 0 ? LLONG_MAX : atoll(ate);
+            for (int k = f->num + 1; k < MAX_FAIXAS_TAXA; ++k) f->ate[k] = LLONG_MAX;
+            f->fixo[f->num] = fixo;
+            f->ppm[f->num] = a;
+            f->num++;
+        } else if (strcmp(chave, "emolumentos") == 0 && sscanf(linha, "%*s %d %d", &a, &b) == 2) {
+            t.emolumentosPpm[0] = a; t.emolumentosPpm[1] = b;
+        } else if (strcmp(chave, "liquidacao") == 0 && sscanf(linha, "%*s %d %d", &a, &b) == 2) {
+            t.liquidacaoPpm[0] = a; t.liquidacaoPpm[1] = b;
+        } else {
+            ok = false;
+            break;
+        }
+    }
+    fclose(fp);
+    if (ok && (t.corretagem.num == 0 || t.custodia.num == 0)) ok = false;
+    if (!ok) {
+        printf("Aviso: %s inválido (linha %d); mantida a tabela de taxas embutida.\n", arq, nLinha);
+        return false;
+    }
+    tabelaTaxas = t;
+    return true;
+}
+
+/* custódia mensal em centavos sobre o valor de mercado da conta */
+long long custodiaMensal(const Usuario *u) {
+    long long carteira = (long long)(u->investimento.valorMercado * 100.0 + 0.5);
+    return carteira > 0 ? taxaDaFaixa(&tabelaTaxas.custodia, carteira) : 0;
+}
+
+/*
+ * Custódia do dia para todos os usuários (1/30 da faixa mensal sobre o
+ * valor de mercado já mantido incrementalmente), debitada do caixa de
+ * investimento. Cada conta paga no máximo uma vez por dia; caixa que não
+ * cobre a taxa fica sem cobrança (contada em 'semCaixa', se não for NULL).
+ * Retorna quantas contas foram cobradas.
+ */
+int cobrarCustodia(long long *total, int *semCaixa) {
+    int cobradas = 0;
+    *total = 0;
+    if (semCaixa) *semCaixa = 0;
+    long long hoje = diaLocal(relogio_seg(), fusoProcesso());
+    for (int i = 0; i < numUsuarios; ++i) {
+        Usuario *u = usuarios[i];
+        if (u->investimento.diaCustodia == hoje) continue;
+        long long carteira = (long long)(u->investimento.valorMercado * 100.0 + 0.5);
+        long long taxa = (custodiaMensal(u) + 15) / 30;
+        if (taxa <= 0) continue;
+        if (paraCentavos(u->investimento.saldo) < taxa) { if (semCaixa) (*semCaixa)++; continue; }
+        u->investimento.diaCustodia = hoje;
+        u->investimento.saldo -= (float)(taxa / 100.0);
+        char desc[80];
+        snprintf(desc, sizeof(desc), "Custódia diária (carteira R$ %.2f)", carteira / 100.0);
+        registrarTransacaoInvest(u, "Custódia", desc, 0.0f, (float)(taxa / 100.0));
+        cobradas++;
+        *total += taxa;
+    }
+    return cobradas;
+}
+
+void menuCobrarCustodia(void) {
+    long long total;
+    int semCaixa;
+    int n = cobrarCustodia(&total, &semCaixa);
+    printf("Custódia cobrada de %d conta(s) | total R$ %.2f\n", n, total / 100.0);
+    if (semCaixa) printf("%d conta(s) sem caixa para a custódia de hoje.\n", semCaixa);
+}
+
+/* custo por ordem no caminho da negociação e na variante em lote; confere que as duas coincidem */
+void benchmarkTaxas(void) {
+    const int n = 4000000;
+    printf("\n=== Benchmark do cálculo de taxas (%d ordens) ===\n", n);
+    long long *valores = malloc(sizeof(long long) * (size_t)n);
+    long long *dayTrade = malloc(sizeof(long long) * (size_t)n);
+    long long *totais = malloc(sizeof(long long) * (size_t)n);
+    if (!valores || !dayTrade || !totais) {
+        free(valores); free(dayTrade); free(totais);
+        printf("Memória insuficiente.\n");
+        return;
+    }
+    unsigned semente = 4242u;
+    for (int i = 0; i < n; ++i) {
+        aleatorio(&semente);
+        valores[i] = 1000 + (long long)((semente >> 4) % 2000000);   // R$ 10 a R$ 20 mil
+        dayTrade[i] = (semente & 7) == 0 ? valores[i] / 2 : 0;
+    }
+    memset(totais, 0, sizeof(long long) * (size_t)n);   // páginas já mapeadas antes de cronometrar
+    /*
+     * As duas pontas gravam o total em 'totais'; a por ordem também entrega a
+     * divisão corretagem/emolumentos/liquidação, como no caminho da negociação
+     * (somada aqui para o compilador não descartá-la). Melhor de 3 rodadas.
+     */
+    long long soma = 0, emolumentos = 0;
+    double dUnit = 1e9, dLote = 1e9;
+    for (int rodada = 0; rodada < 3; ++rodada) {
+        emolumentos = 0;
+        double t0 = cronometro_seg();
+        for (int i = 0; i < n; ++i) {
+            TaxasOperacao o;
+            totais[i] = calcularTaxas(valores[i], dayTrade[i], &o);
+            emolumentos += o.emolumentos;
+        }
+        double t1 = cronometro_seg();
+        if (t1 - t0 < dUnit) dUnit = t1 - t0;
+        if (rodada == 0) for (int i = 0; i < n; ++i) soma += totais[i];
+        taxasLote(valores, dayTrade, n, totais);
+        double t2 = cronometro_seg();
+        if (t2 - t1 < dLote) dLote = t2 - t1;
+    }
+    long long somaLote = 0;
+    int divergentes = 0;
+    for (int i = 0; i < n; ++i) {
+        TaxasOperacao o;
+        somaLote += totais[i];
+        divergentes += totais[i] != calcularTaxas(valores[i], dayTrade[i], &o);
+    }
+    printf("Por ordem: %.2f ns | Em lote: %.2f ns por ordem\n", dUnit / n * 1e9, dLote / n * 1e9);
+    printf("Total de taxas: R$ %.2f (emolumentos R$ %.2f) | lote R$ %.2f | %d divergente(s)\n",
+           soma / 100.0, emolumentos / 100.0, somaLote / 100.0, divergentes);
+    free(valores); free(dayTrade); free(totais);
+}
@@ -0,0 +1,177 @@
+#include "corretora.h"
+
+/* ======= Velas OHLCV (agregação em streaming) ======= */
+
+/*
+ * Cada tick atualiza a vela corrente dos três períodos (O(1)): se o tick
+ * cai num período novo, a cabeça do anel avança e a vela mais antiga é
+ * sobrescrita. Períodos sem tick não geram vela. Volume vem das compras e
+ * vendas; ticks de preço entram com volume 0. Os períodos são alinhados
+ * ao horário local (a vela diária vai da meia-noite à meia-noite).
+ */
+
+static const int periodoVela[NUM_PERIODOS_VELA] = { 60, 3600, 86400 };
+static const int capVela[NUM_PERIODOS_VELA] = { VELAS_1MIN, VELAS_1H, VELAS_1D };
+static const int baseVela[NUM_PERIODOS_VELA] = { 0, VELAS_1MIN, VELAS_1MIN + VELAS_1H };
+static const char *nomePeriodoVela[NUM_PERIODOS_VELA] = { "1 min", "1 h", "1 dia" };
+
+VelasAtivo *velas = NULL;                 // um por ativo do catálogo (alocado no primeiro tick)
+Vela *velasMemoria = NULL;
+
+void velasAtualizar(VelasAtivo *v, long long ts, float preco, long long volume) {
+    long long local = ts + fusoProcesso();
+    unsigned s = atomic_load_explicit(&v->seq, memory_order_relaxed);
+    atomic_store_explicit(&v->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (int p = 0; p < NUM_PERIODOS_VELA; ++p) {
+        long long inicio = local - (local % periodoVela[p] + periodoVela[p]) % periodoVela[p] - fusoProcesso();
+        Vela *anel = v->anel + baseVela[p];
+        Vela *c = &anel[v->cabeca[p]];
+        if (v->num[p] == 0 || inicio > c->inicio) {
+            if (v->num[p] > 0) v->cabeca[p] = v->cabeca[p] + 1 == capVela[p] ? 0 : v->cabeca[p] + 1;
+            if (v->num[p] < capVela[p]) v->num[p]++;
+            c = &anel[v->cabeca[p]];
+            c->inicio = inicio;
+            c->abertura = c->maxima = c->minima = c->fechamento = preco;
+            c->volume = volume;
+            continue;
+        }
+        /* tick atrasado (período já fechado) entra na vela corrente */
+        if (preco > c->maxima) c->maxima = preco;
+        if (preco < c->minima) c->minima = preco;
+        c->fechamento = preco;
+        c->volume += volume;
+    }
+    atomic_store_explicit(&v->seq, s + 2, memory_order_release);
+}
+
+/* até 'max' velas mais recentes do período, da mais antiga para a mais nova; cópia consistente */
+int velasCopiar(VelasAtivo *v, int periodo, Vela *out, int max) {
+    for (;;) {
+        unsigned s1 = atomic_load_explicit(&v->seq, memory_order_acquire);
+        if (s1 & 1) { thread_ceder(); continue; }
+        int n = v->num[periodo], cab = v->cabeca[periodo], cap = capVela[periodo];
+        if (n > max) n = max;
+        const Vela *anel = v->anel + baseVela[periodo];
+        for (int i = 0; i < n; ++i) {
+            int k = cab - (n - 1 - i);
+            out[i] = anel[k < 0 ? k + cap : k];
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&v->seq, memory_order_relaxed) == s1) return n;
+    }
+}
+
+static bool criarVelas(VelasAtivo **v, Vela **memoria, int num) {
+    *v = calloc((size_t)num, sizeof(VelasAtivo));
+    *memoria = calloc((size_t)num * VELAS_POR_ATIVO, sizeof(Vela));
+    if (!*v || !*memoria) { free(*v); free(*memoria); *v = NULL; *memoria = NULL; return false; }
+    for (int i = 0; i < num; ++i) (*v)[i].anel = *memoria + (size_t)i * VELAS_POR_ATIVO;
+    return true;
+}
+
+void velasTick(int idx, long long ts, float preco, long long volume) {
+    if (idx < 0 || idx >= NUM_ATIVOS) return;
+    if (!velas && !criarVelas(&velas, &velasMemoria, NUM_ATIVOS)) return;
+    velasAtualizar(&velas[idx], ts, preco, volume);
+}
+
+int velasDoAtivo(int idx, int periodo, Vela *out, int max) {
+    if (!velas || idx < 0 || idx >= NUM_ATIVOS || periodo < 0 || periodo >= NUM_PERIODOS_VELA) return 0;
+    return velasCopiar(&velas[idx], periodo, out, max);
+}
+
+void liberarVelas(void) {
+    free(velas);
+    free(velasMemoria);
+    velas = NULL;
+    velasMemoria = NULL;
+}
+
+void menuVelas(void) {
+    int idx, periodo;
+    listarAtivosDisponiveis();
+    printf("Ativo (número): ");
+    if (scanf("%d", &idx) != 1 || idx < 1 || idx > NUM_ATIVOS) { clear_input(); printf("Ativo inválido.\n"); return; }
+    printf("Período (1 = 1 min, 2 = 1 h, 3 = 1 dia): ");
+    if (scanf("%d", &periodo) != 1 || periodo < 1 || periodo > NUM_PERIODOS_VELA) { clear_input(); printf("Período inválido.\n"); return; }
+    Vela v[10];
+    int n = velasDoAtivo(idx - 1, periodo - 1, v, 10);
+    if (n == 0) { printf("Sem velas para %s.\n", ativosDisponiveis[idx - 1].ticker); return; }
+    printf("Velas de %s (%s):\n", ativosDisponiveis[idx - 1].ticker, nomePeriodoVela[periodo - 1]);
+    for (int i = 0; i < n; ++i) {
+        char data[32];
+        time_t t = (time_t)v[i].inicio;
+        strftime(data, sizeof(data), "%d/%m %H:%M", localtime(&t));
+        printf("  [%s] A %.2f | Max %.2f | Min %.2f | F %.2f | Vol %lld\n",
+               data, v[i].abertura, v[i].maxima, v[i].minima, v[i].fechamento, v[i].volume);
+    }
+}
+
+typedef struct {
+    VelasAtivo *v;
+    int num;
+    atomic_int parar;
+    long long leituras, inconsistentes;
+} LeitorVelas;
+
+/* leitor concorrente do benchmark: cópias de velas de ativos aleatórios, conferindo invariantes */
+static void *threadLeitorVelas(void *arg) {
+    LeitorVelas *l = arg;
+    Vela buf[VELAS_1D];
+    unsigned semente = 99u;
+    while (!atomic_load_explicit(&l->parar, memory_order_relaxed)) {
+        aleatorio(&semente);
+        int n = velasCopiar(&l->v[(semente >> 8) % (unsigned)l->num], (int)((semente >> 4) % NUM_PERIODOS_VELA), buf, VELAS_1D);
+        for (int i = 0; i < n; ++i)
+            if (buf[i].minima > buf[i].abertura || buf[i].minima > buf[i].fechamento || buf[i].maxima < buf[i].abertura ||
+                buf[i].maxima < buf[i].fechamento || (i > 0 && buf[i].inicio <= buf[i - 1].inicio))
+                { l->inconsistentes++; break; }
+        l->leituras++;
+    }
+    return NULL;
+}
+
+/* 2.000 ativos, 4M ticks em ~1,5 pregão simulado, com um leitor concorrente fazendo cópias */
+void benchmarkVelas(void) {
+    const int num = 2000, ticks = 4000000;
+    printf("\n=== Benchmark de velas OHLCV (%d ativos, %d ticks) ===\n", num, ticks);
+    VelasAtivo *v;
+    Vela *memoria;
+    if (!criarVelas(&v, &memoria, num)) { printf("Memória insuficiente.\n"); return; }
+    float *preco = malloc(sizeof(float) * (size_t)num);
+    if (!preco) { free(v); free(memoria); printf("Memória insuficiente.\n"); return; }
+    for (int i = 0; i < num; ++i) preco[i] = 10.0f + (float)(i % 90);
+    LeitorVelas leitor = { v, num, 0, 0, 0 };
+    Thread t;
+    bool temLeitor = thread_criar(&t, threadLeitorVelas, &leitor);
+    unsigned semente = 1234u;
+    long long ts = 1735725600LL;           // 01/01/2025 07h (UTC-3)
+    long long volumeTotal = 0;
+    double t0 = cronometro_seg();
+    for (int k = 0; k < ticks; ++k) {
+        aleatorio(&semente);
+        int i = (int)((semente >> 8) % (unsigned)num);
+        preco[i] += ((semente >> 4) & 1) ? 0.01f : -0.01f;
+        long long vol = (semente & 3) == 0 ? 100 : 0;
+        volumeTotal += vol;
+        velasAtualizar(&v[i], ts + k / 40, preco[i], vol);   // 40 ticks por segundo no mercado todo
+    }
+    double d = cronometro_seg() - t0;
+    atomic_store(&leitor.parar, 1);
+    if (temLeitor) thread_aguardar(t);
+    printf("Feed: %.1f ns por tick (%.2f M ticks/s) | leitor: %lld cópias, %lld inconsistentes\n",
+           d / ticks * 1e9, ticks / d / 1e6, leitor.leituras, leitor.inconsistentes);
+
+    /* conferência: volume das velas diárias = volume do feed; 1 min cobre o fim do feed */
+    long long volumeVelas = 0;
+    Vela buf[VELAS_1D];
+    for (int i = 0; i < num; ++i) {
+        int n = velasCopiar(&v[i], 2, buf, VELAS_1D);
+        for (int j = 0; j < n; ++j) volumeVelas += buf[j].volume;
+    }
+    int n = velasCopiar(&v[0], 0, buf, VELAS_1MIN);
+    printf("Volume: velas diárias %lld | feed %lld | %d vela(s) de 1 min no anel do primeiro ativo\n",
+           volumeVelas, volumeTotal, n);
+    free(preco); free(v); free(memoria);
+}
@@ -0,0 +1,409 @@
+#include "corretora.h"
+
+/* ======= Verificação (checagens por funcionalidade) ======= */
+
+/*
+ * corretora verificar: checagens com resultado conhecido das regras que os
+ * benchmarks não conferem (caixa da custódia, DARF, histórico fora do
+ * locale, dicionário cheio, ...). Só usa contas sintéticas e arquivos
+ * temporários; do cadastro carregado, só lê. Conta as falhas.
+ */
+static int verificacoesOk, verificacoesFalha;
+
+static void conferir(bool ok, const char *oque) {
+    if (ok) verificacoesOk++;
+    else verificacoesFalha++;
+    printf("  [%s] %s\n", ok ? "ok" : "FALHA", oque);
+}
+
+static Usuario *contaDeVerificacao(float caixa, double valorMercado) {
+    Usuario *u = calloc(1, sizeof(Usuario));
+    if (!u) return NULL;
+    u->id = -1;
+    u->efemero = true;
+    snprintf(u->cpf, sizeof(u->cpf), "00000000000");
+    u->investimento.saldo = caixa;
+    u->investimento.valorMercado = valorMercado;
+    return u;
+}
+
+/* custódia mensal do calendário: conta sem caixa pula a cobrança, nunca fica negativa */
+static void verificarCustodiaCalendario(void) {
+    printf("Custódia no simulador de calendário\n");
+    for (int lancar = 0; lancar < 2; ++lancar) {
+        const char *modo = lancar ? "com extrato" : "sem extrato";
+        char rot[128];
+        Usuario *lista[2] = { contaDeVerificacao(0.0f, 50000.0), contaDeVerificacao(0.0f, 50000.0) };
+        if (!lista[0] || !lista[1]) { conferir(false, "memória para as contas"); free(lista[0]); free(lista[1]); return; }
+        long long taxa = custodiaMensal(lista[0]);
+        if (taxa <= 0) {
+            printf("  [--] tabela de taxas sem custódia para R$ 50 mil; pulada\n");
+            liberarUsuario(lista[0]); liberarUsuario(lista[1]);
+            return;
+        }
+        lista[1]->investimento.saldo = (float)(taxa * 5 / 2 / 100.0);        // cobre duas das três cobranças
+        SimuladorCalendario sim;
+        memset(&sim, 0, sizeof(sim));
+        sim.lista = lista; sim.n = 2; sim.lancar = lancar;
+        bool ok = simularCalendario(&sim, diaDaData(2025, 1, 1), diaDaData(2025, 4, 15));
+        sincronizarExtrato(&filaExtrato);
+        snprintf(rot, sizeof(rot), "%s: nenhum caixa negativo", modo);
+        conferir(ok && lista[0]->investimento.saldo >= 0.0f && lista[1]->investimento.saldo >= 0.0f, rot);
+        snprintf(rot, sizeof(rot), "%s: 3 cobranças puladas na conta vazia e 1 na que cobre duas", modo);
+        conferir(sim.custodiaSemCaixa == 4
+                 && llabs(paraCentavos(lista[1]->investimento.saldo) - (taxa * 5 / 2 - 2 * taxa)) <= 1, rot);
+        if (lancar) {
+            conferir(lista[1]->investimento.diaCustodia == diaDaData(2025, 3, 1) && lista[0]->investimento.diaCustodia == 0
+                     && lista[0]->investimento.numTransacoes == 0 && lista[1]->investimento.numTransacoes == 2,
+                     "com extrato: só as cobranças feitas vão ao extrato e marcam o dia");
+        }
+        liberarSimuladorCalendario(&sim);
+        liberarUsuario(lista[0]); liberarUsuario(lista[1]);
+    }
+}
+
+/* lançamento montado à mão para a releitura (sem passar pela fila) */
+static void lancamentoDeVerificacao(Transacao *t, const char *tipo, const char *desc, const char *ativo,
+                                    long long ts, float valor, int quantidade, float resultado) {
+    memset(t, 0, sizeof(*t));
+    snprintf(t->tipo, sizeof(t->tipo), "%s", tipo);
+    snprintf(t->descricao, sizeof(t->descricao), "%s", desc);
+    snprintf(t->ativo, sizeof(t->ativo), "%s", ativo);
+    t->ts = ts;
+    t->tsNs = ts * 1000000000LL;
+    t->valor = valor;
+    t->quantidade = quantidade;
+    t->resultado = resultado;
+}
+
+static void verificarIR(void) {
+    printf("Apuração de IR e DARF\n");
+    ApuracaoIR ir;
+    memset(&ir, 0, sizeof(ir));
+    apurarVenda(&ir, 202501, false, 1500000, 100000, 0);                 // R$ 15 mil vendidos: ganho isento
+    conferir(fecharMesIR(&ir) == 0 && ir.impostoAcumulado == 0 && ir.mes == 202502, "mês isento não gera DARF");
+    apurarVenda(&ir, 202502, true, 100000, 3000, 0);                     // FII: 20% de R$ 30 = R$ 6
+    conferir(fecharMesIR(&ir) == 0 && ir.impostoAcumulado == 600, "DARF abaixo de R$ 10 fica zerado e acumula");
+    apurarVenda(&ir, 202503, true, 100000, 3000, 0);
+    conferir(fecharMesIR(&ir) == 1200 && ir.impostoAcumulado == 0, "acumulado sai no DARF do mês seguinte");
+    apurarVenda(&ir, 202504, false, 3000000, -50000, 0);                 // prejuízo compensa o ganho de maio
+    fecharMesIR(&ir);
+    apurarVenda(&ir, 202505, false, 3000000, 80000, 0);
+    conferir(fecharMesIR(&ir) == 4500 && ir.prejuizoComum == 0, "prejuízo do mês anterior compensa o ganho comum");
+
+    /* releitura: venda de janeiro não isenta; o lançamento "DARF 2025-01" fecha o mês sem reemitir */
+    for (int comDarf = 0; comDarf < 2; ++comDarf) {
+        Usuario *u = contaDeVerificacao(0.0f, 0.0);
+        Transacao *ext = u ? malloc(sizeof(Transacao) * 3) : NULL;
+        if (!ext) { conferir(false, "memória para a conta"); liberarUsuario(u); return; }
+        lancamentoDeVerificacao(&ext[0], "Compra", "Compra 100 VERF3", "VERF3", tsDoDia(diaDaData(2025, 1, 6)), -10000.0f, 100, 0.0f);
+        lancamentoDeVerificacao(&ext[1], "Venda", "Venda 100 VERF3", "VERF3", tsDoDia(diaDaData(2025, 1, 20)), 30000.0f, 100, 20000.0f);
+        lancamentoDeVerificacao(&ext[2], "DARF", "DARF 2025-01 R$ 3000.00", "", tsDoDia(diaDaData(2025, 2, 3)), 0.0f, 0, 0.0f);
+        u->investimento.extrato = ext;
+        u->investimento.numTransacoes = comDarf ? 3 : 2;
+        u->investimento.capTransacoes = 3;
+        reconstruirResultados(u);
+        ApuracaoIR *r = &u->investimento.ir;
+        if (comDarf) conferir(r->mes == 202502 && r->darfEmAberto == 0 && r->impostoAcumulado == 0,
+                              "releitura com o DARF emitido: janeiro já fechado, nada em aberto");
+        else conferir(r->mes == 202501 && fecharMesIR(r) == 300000, "releitura sem DARF: janeiro fecha em R$ 3000,00");
+        liberarUsuario(u);
+    }
+}
+
+/* histórico de preços: o mesmo número em qualquer locale, linha que não casa inteira é descartada */
+static void verificarHistoricoLocale(void) {
+    printf("Leitura do histórico de preços\n");
+    const char *arq = "verificar_historico.tmp";
+    FILE *fp = fopen(arq, "w");
+    if (!fp) { conferir(false, "criar o arquivo temporário"); return; }
+    const char *tk = ativosDisponiveis[0].ticker;
+    fprintf(fp, "ticker;data;fechamento;provento\n");
+    fprintf(fp, "%s;2025-01-02;28.50\n", tk);
+    fprintf(fp, "%s;2025-01-03;28,75\n", tk);           // vírgula decimal (aceita, como no catálogo)
+    fprintf(fp, "%s;2025-01-06;28.50x\n", tk);          // sobra depois do número
+    fprintf(fp, "%s;2025-01-07\n", tk);                 // campo faltando
+    fprintf(fp, "%s;2025-01-08;28.50;0.10;9\n", tk);    // campo sobrando
+    fprintf(fp, "%s;2025-1-9x;28.50\n", tk);            // data com sobra
+    fprintf(fp, "%s;2025-01-09;29.00;0.35\n", tk);
+    fclose(fp);
+
+    const char *locais[] = { NULL, "pt_BR.UTF-8", "de_DE.UTF-8" };
+    char *anterior = strdup(setlocale(LC_NUMERIC, NULL));
+    int ativo = 0;
+    for (int l = 0; l < 3; ++l) {
+        if (locais[l] && !setlocale(LC_NUMERIC, locais[l])) { printf("  [--] locale %s indisponível; pulado\n", locais[l]); continue; }
+        int n = 0;
+        PontoBacktest *p = pontosDoArquivo(arq, &ativo, 1, &n);
+        char rot[96];
+        snprintf(rot, sizeof(rot), "locale %s: só as 3 linhas completas, com os mesmos valores", locais[l] ? locais[l] : "do processo");
+        conferir(p && n == 3 && p[0].dia == diaDaData(2025, 1, 2) && p[0].preco == 28.5f && p[0].provento == 0.0f
+                 && p[1].dia == diaDaData(2025, 1, 3) && p[1].preco == 28.75f
+                 && p[2].dia == diaDaData(2025, 1, 9) && p[2].preco == 29.0f && fabsf(p[2].provento - 0.35f) < 1e-6f, rot);
+        free(p);
+    }
+    if (anterior) setlocale(LC_NUMERIC, anterior);
+    free(anterior);
+    remove(arq);
+}
+
+/* ida e volta do codec com saldos que seguem e que não seguem a previsão */
+static void verificarCodec(void) {
+    printf("Codec do arquivo colunar\n");
+    const int n = 3 * TAM_BLOCO_COL + 123, numContas = 7;
+    const char *arq = "verificar_codec.tmp";
+    LinhaArquivo *linhas = malloc(sizeof(LinhaArquivo) * (size_t)n);
+    BlocoDecodificado *bd = malloc(sizeof(BlocoDecodificado));
+    ContaSegmento *contas = calloc((size_t)numContas, sizeof(ContaSegmento));
+    int tipos[3] = { codigoTipo("PIX"), codigoTipo("Compra"), codigoTipo("Provento") };
+    if (!linhas || !bd || !contas || tipos[0] < 0 || tipos[1] < 0 || tipos[2] < 0) {
+        conferir(false, "memória e tipos para o segmento");
+        free(linhas); free(bd); free(contas);
+        return;
+    }
+    unsigned short ativos[2] = { 0, (unsigned short)codigoAtivo(ativosDisponiveis[0].ticker) };
+    long long saldos[7] = { 0 }, ts = inicioDoAno(2025);
+    unsigned semente = 7u;
+    for (int i = 0; i < n; ++i) {
+        aleatorio(&semente);
+        int c = (int)((semente >> 8) % (unsigned)numContas), t = (int)((semente >> 16) % 3u);
+        LinhaArquivo *l = &linhas[i];
+        ts += (semente >> 24) % 3;                                   // instantes repetidos
+        l->ts = ts;
+        l->valor = i % 5 ? 0 : (long long)((semente >> 4) % 100000) - 50000;   // coluna esparsa
+        l->taxa = t == 1 ? 15 : 0;
+        saldos[c] += l->valor - l->taxa;
+        /* contas pares seguem o extrato; as ímpares têm saldos soltos (e um valor grande de vez em quando) */
+        l->saldo = c % 2 == 0 ? saldos[c] : (long long)(semente % 1000000) + (i % 997 == 0 ? 5000000000LL : 0);
+        l->conta = (unsigned)c;
+        l->tipo = (unsigned char)tipos[t];
+        l->ativo = ativos[t == 1];
+    }
+    SegmentoColunar seg;
+    if (!escreverSegmento(arq, linhas, n, contas, numContas, CODEC_COMPRIMIDO) || !abrirSegmento(arq, &seg)) {
+        conferir(false, "gravar e abrir o segmento");
+        remove(arq); free(linhas); free(bd); free(contas);
+        return;
+    }
+    long long divergTodas[2] = { 0, 0 }, divergSaldo = 0, divergTs = 0, linha = 0;
+    for (int b = 0; b < seg.info->numBlocos; ++b) {
+        for (int modo = 0; modo < 2; ++modo) {
+            codecUsarSimd = modo == 0;
+            decodificarBloco(&seg, b, COL_TODAS, bd);
+            for (int i = 0; i < seg.zonas[b].linhas; ++i) {
+                const LinhaArquivo *l = &linhas[linha + i];
+                divergTodas[modo] += bd->ts[i] != l->ts || bd->valor[i] != l->valor || bd->taxa[i] != l->taxa
+                    || bd->saldo[i] != l->saldo || bd->conta[i] != l->conta || bd->tipo[i] != l->tipo || bd->ativo[i] != l->ativo;
+            }
+        }
+        codecUsarSimd = true;
+        decodificarBloco(&seg, b, COL_SALDO, bd);
+        for (int i = 0; i < seg.zonas[b].linhas; ++i) divergSaldo += bd->saldo[i] != linhas[linha + i].saldo;
+        decodificarBloco(&seg, b, COL_TS, bd);
+        for (int i = 0; i < seg.zonas[b].linhas; ++i) divergTs += bd->ts[i] != linhas[linha + i].ts;
+        linha += seg.zonas[b].linhas;
+    }
+    conferir(linha == n && divergTodas[0] == 0 && divergTodas[1] == 0, "todas as colunas voltam iguais (SIMD e escalar)");
+    conferir(divergSaldo == 0, "só o saldo: a previsão lê valor, taxa e conta sozinha");
+    conferir(divergTs == 0, "só o instante");
+    fecharSegmento(&seg);
+    remove(arq);
+    free(linhas); free(bd); free(contas);
+}
+
+/* dicionário cheio: tipo novo devolve -1 (o selo recusa) e os já registrados continuam valendo */
+static void verificarDicionarioTipos(void) {
+    printf("Dicionário de tipos\n");
+    int antes = numTiposDic;
+    const char *conhecido = antes > 0 ? tiposDic[0] : "PIX";
+    int codigo = codigoTipo(conhecido);
+    bool ok = codigo >= 0;
+    char tipo[32];
+    for (int i = 0; ok && numTiposDic < MAX_TIPOS_DIC; ++i) {
+        snprintf(tipo, sizeof(tipo), "verificação %d", i);
+        ok = codigoTipo(tipo) >= 0;
+    }
+    conferir(ok && numTiposDic == MAX_TIPOS_DIC, "aceita até MAX_TIPOS_DIC tipos");
+    conferir(codigoTipo("tipo que não cabe") == -1 && numTiposDic == MAX_TIPOS_DIC, "tipo novo com o dicionário cheio devolve -1");
+    conferir(codigoTipo(conhecido) == codigo, "tipo já registrado continua com o mesmo código");
+    numTiposDic = antes > codigo ? antes : codigo + 1;
+}
+
+/* ordem dos instantes por conta e consultas pelo índice x filtro linear */
+static void verificarExtratoConsultas(void) {
+    printf("Extrato: instantes e consultas pelo índice\n");
+    static const char *tipos[] = { "Compra", "Venda", "Provento", "Custódia" };
+    static const char *ativos[] = { "", "AAAA3", "BBBB4" };
+    static const char *filtroTipo[] = { NULL, "Compra", "Venda", "Provento", "Custódia", "Resgate" };
+    static const char *filtroAtivo[] = { NULL, "AAAA3", "BBBB4", "CCCC3" };
+    Usuario *u = contaDeVerificacao(0.0f, 0.0);
+    const Transacao **itens = malloc(sizeof(*itens) * 1000);
+    if (!u || !itens) { conferir(false, "memória para a conta"); liberarUsuario(u); free(itens); return; }
+    long long ts0 = inicioDoAno(2025) + 43200;
+    unsigned long long ajustadosAntes = atomic_load_explicit(&filaExtrato.tsAjustados, memory_order_relaxed);
+    long long divergentes = 0, consultas = 0;
+    int total = 0;
+    for (int rodada = 0; rodada < 2; ++rodada) {
+        /* a segunda rodada anexa depois do índice montado: ele tem de alcançar os novos */
+        for (int fim = total + 300; total < fim; ++total) {
+            relogioFixar(ts0 + total * 60 - (total % 50 == 49 ? 3600 : 0));   // a cada 50, um relógio atrasado
+            const char *tipo = tipos[total % 4], *ativo = total % 4 == 3 ? "" : ativos[(total / 4) % 3];
+            publicarLancamento(&filaExtrato, u, CONTA_INVEST, tipo, "verificação", ativo, 1.0f, 0.0f, 0.0f, 1, 0.0f);
+        }
+        sincronizarExtrato(&filaExtrato);
+        const Transacao *ext = u->investimento.extrato;
+        int num = u->investimento.numTransacoes;
+        for (int ft = 0; ft < 6; ++ft)
+            for (int fa = 0; fa < 4; ++fa)
+                for (int janela = 0; janela < 2; ++janela) {
+                    ConsultaExtrato q = { CONTA_INVEST, janela ? ts0 + 6000 : 0, janela ? ts0 + 12000 : LLONG_MAX,
+                                          filtroTipo[ft], filtroAtivo[fa], 7, -1 };
+                    int esperado = num - 1, paginas = 0, prox;
+                    consultas++;
+                    do {
+                        int k = consultarExtrato(u, &q, itens, &prox);
+                        for (int i = 0; i < k; ++i) {
+                            while (esperado >= 0 && !(ext[esperado].ts >= q.tsIni && ext[esperado].ts <= q.tsFim
+                                   && (!q.tipo || strcmp(ext[esperado].tipo, q.tipo) == 0)
+                                   && (!q.ativo || strcmp(ext[esperado].ativo, q.ativo) == 0))) esperado--;
+                            if (esperado < 0 || itens[i] != &ext[esperado]) { divergentes++; break; }
+                            esperado--;
+                        }
+                        q.cursor = prox;
+                    } while (prox >= 0 && ++paginas < num);
+                    /* nada que passe no filtro pode ter ficado de fora */
+                    while (esperado >= 0 && !(ext[esperado].ts >= q.tsIni && ext[esperado].ts <= q.tsFim
+                           && (!q.tipo || strcmp(ext[esperado].tipo, q.tipo) == 0)
+                           && (!q.ativo || strcmp(ext[esperado].ativo, q.ativo) == 0))) esperado--;
+                    divergentes += esperado >= 0;
+                }
+    }
+    const Transacao *ext = u->investimento.extrato;
+    bool ordem = u->investimento.numTransacoes == total;
+    for (int i = 1; ordem && i < total; ++i) ordem = ext[i].tsNs >= ext[i - 1].tsNs && ext[i].ts >= ext[i - 1].ts;
+    unsigned long long ajustados = atomic_load_explicit(&filaExtrato.tsAjustados, memory_order_relaxed) - ajustadosAntes;
+    conferir(ordem && ajustados == (unsigned long long)total / 50, "relógio atrasado: o lançamento fica com o instante do anterior");
+    char rot[96];
+    snprintf(rot, sizeof(rot), "%lld consultas paginadas iguais ao filtro linear", consultas);
+    conferir(divergentes == 0, rot);
+    free(itens);
+    liberarUsuario(u);
+}
+
+static void verificarTaxas(void) {
+    printf("Taxas em lote x por ordem\n");
+    enum { MAX_VALORES = 64 };
+    long long valores[MAX_VALORES], dayTrade[MAX_VALORES], totais[MAX_VALORES];
+    static const long long base[] = { 0, 1, 99, 100000, 12345678, 1000000000LL };
+    int n = 0;
+    for (int i = 0; i < (int)(sizeof(base) / sizeof(base[0])); ++i) valores[n++] = base[i];
+    const TabelaFaixas *c = &tabelaTaxas.corretagem;
+    for (int f = 0; f < c->num && n + 3 <= MAX_VALORES; ++f)
+        if (c->ate[f] != LLONG_MAX && c->ate[f] > 0)
+            for (long long d = -1; d <= 1; ++d) valores[n++] = c->ate[f] + d;          // limites da faixa
+    for (int i = 0; i < n; ++i) dayTrade[i] = i % 3 == 0 ? 0 : valores[i] / (i % 3 + 1);
+    TaxasOperacao o;
+    int divergComum = 0, divergDayTrade = 0;
+    taxasLote(valores, NULL, n, totais);
+    for (int i = 0; i < n; ++i) divergComum += totais[i] != calcularTaxas(valores[i], 0, &o);
+    taxasLote(valores, dayTrade, n, totais);
+    for (int i = 0; i < n; ++i) divergDayTrade += totais[i] != calcularTaxas(valores[i], dayTrade[i], &o);
+    conferir(divergComum == 0, "sem day trade, nos limites de cada faixa");
+    conferir(divergDayTrade == 0, "com parte em day trade");
+}
+
+/* dripAvancar não passa de maxEventos, mas conta todos */
+static void verificarDrip(void) {
+    printf("Eventos do DRIP\n");
+    ContaDrip inicial;
+    memset(&inicial, 0, sizeof(inicial));
+    inicial.k = 1;
+    inicial.quantidade[0] = 1000;
+    inicial.preco[0] = 10.0f;
+    inicial.provento[0] = 0.5f;
+    inicial.mesesPorPagamento[0] = 1;
+    EventoDrip todos[64], poucos[2];
+    ContaDrip a = inicial, b = inicial;
+    int total = dripAvancar(&a, DRIP_PROPRIO, 12, todos, 64);
+    memset(&poucos[1], 0x5A, sizeof(poucos[1]));
+    EventoDrip canario = poucos[1];
+    int contados = dripAvancar(&b, DRIP_PROPRIO, 12, poucos, 1);
+    conferir(total > 1 && total <= 64 && contados == total, "com vetor curto, devolve o total de eventos");
+    conferir(memcmp(&poucos[1], &canario, sizeof(canario)) == 0 && memcmp(&poucos[0], &todos[0], sizeof(todos[0])) == 0,
+             "não escreve além de maxEventos");
+    conferir(a.quantidade[0] == b.quantidade[0] && a.caixa == b.caixa, "a conta anda igual com qualquer vetor");
+}
+
+/* agrupamento do relatório mensal: SSE2 igual ao escalar, inclusive com lixo depois do terminador */
+static void verificarGruposRelatorio(void) {
+    printf("Agrupamento do relatório mensal\n");
+#ifdef USAR_SIMD_X86
+    iniciarGruposSimd();
+    if (sse2Disponivel <= 0) { printf("  [--] sem SSE2; pulada\n"); return; }
+    static const char *nomes[] = { "Depósito", "Compra", "Venda", "PIX", "Provento", "TED", "Transferência Ext",
+                                   "Transferência", "Transferência Ex", "Transferência Extra", "TEDx", "PI", "",
+                                   "Compras", "Custódia", "DARF", "Resgate", "TED agendado" };
+    int diverg = 0;
+    for (int i = 0; i < (int)(sizeof(nomes) / sizeof(nomes[0])); ++i)
+        for (int lixo = 0; lixo < 2; ++lixo) {
+            char tipo[32];
+            memset(tipo, lixo ? 'X' : 0, sizeof(tipo));
+            tipo[sizeof(tipo) - 1] = '\0';
+            memcpy(tipo, nomes[i], strlen(nomes[i]) + 1);
+            diverg += grupoDoTipoSse2(tipo) != grupoDoTipoEscalar(tipo);
+        }
+    conferir(diverg == 0, "SSE2 e escalar dão o mesmo grupo");
+    conferir(grupoDoTipoSse2("Transferência Ext\0..............") == GRUPO_TRANSF, "nome de mais de 16 bytes");
+#else
+    printf("  [--] sem SIMD x86 nesta compilação; pulada\n");
+#endif
+}
+
+/* TED agendado é refeito do journal e sai da fila quando liquidado */
+static void verificarFilaTED(void) {
+    printf("Fila de TED na releitura do journal\n");
+    if (numUsuarios == 0) { printf("  [--] sem contas cadastradas para o destino; pulada\n"); return; }
+    Usuario *u = contaDeVerificacao(0.0f, 0.0);
+    if (!u) { conferir(false, "memória para a conta"); return; }
+    FilaTED salva = filaTED;                           // a fila real não é tocada
+    memset(&filaTED, 0, sizeof(filaTED));
+    Transacao t;
+    char desc[80];
+    snprintf(desc, sizeof(desc), "TED agendado p/ %s R$ 1234.56", usuarios[0]->cpf);
+    lancamentoDeVerificacao(&t, "TED agendado", desc, "", 0, 0.0f, 0, 0.0f);
+    refazerFilaTED(u, &t);
+    conferir(filaTED.num == 1 && filaTED.itens[0].destino == usuarios[0]->id && fabsf(filaTED.itens[0].valor - 1234.56f) < 0.005f
+             && fabsf(u->banco.tedPendente - 1234.56f) < 0.005f, "TED agendado volta para a fila, reservado na origem");
+    snprintf(desc, sizeof(desc), "TED agendado p/ %s R$ 10.00 e mais", usuarios[0]->cpf);
+    lancamentoDeVerificacao(&t, "TED agendado", desc, "", 0, 0.0f, 0, 0.0f);
+    refazerFilaTED(u, &t);
+    conferir(filaTED.num == 1, "descrição que não casa inteira não agenda");
+    lancamentoDeVerificacao(&t, "TED", "TED enviado", "", 0, -1234.56f, 0, 0.0f);
+    refazerFilaTED(u, &t);
+    conferir(filaTED.num == 0 && u->banco.tedPendente == 0.0f, "TED liquidado sai da fila e libera a reserva");
+    free(filaTED.itens);
+    filaTED = salva;
+    liberarUsuario(u);
+}
+
+/* roda todas as checagens; retorna quantas falharam */
+int verificarFuncionalidades(void) {
+    bool virtual = relogioEhVirtual();
+    long long agora = relogio_seg();
+    verificacoesOk = verificacoesFalha = 0;
+    printf("=== Verificação das funcionalidades ===\n");
+    verificarCustodiaCalendario();
+    verificarIR();
+    verificarHistoricoLocale();
+    verificarCodec();
+    verificarDicionarioTipos();
+    verificarExtratoConsultas();
+    verificarTaxas();
+    verificarDrip();
+    verificarGruposRelatorio();
+    verificarFilaTED();
+    if (virtual) relogioFixar(agora);
+    else relogioReal();
+    printf("%d checagem(ns) ok, %d falha(s)\n", verificacoesOk, verificacoesFalha);
+    return verificacoesFalha;
+}